@@ -0,0 +1,447 @@
+#include "../include/PicoLED.h"
+#include "../src/protocols/ws2812_parallel_driver.h"
+#include "../src/protocols/apa102_driver.h"
+#include "pico/stdlib.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef PICOLED_HOST_HAL
+#include <chrono>
+#endif
+
+/**
+ * @brief Microbenchmarks for the per-pixel and per-channel hot paths
+ *
+ * Times the WS2812Driver buffer operations, the WS2812ParallelDriver bit
+ * transposition, the APA102Driver frame encoding and the PicoLED DMX <->
+ * LED conversions for every ColorFormat and for pixel counts up to
+ * MAX_LED_COUNT. Nothing is sent to the LEDs; only the CPU work is timed.
+ *
+ * On the host build the wall clock of the PC is used and the results are
+ * reported in ns/pixel. On the RP2040 the 1 MHz system timer is used and
+ * the results are also converted to clk_sys cycles per pixel.
+ */
+
+// Each measurement repeats the operation until it has run at least this long
+#define BENCH_MIN_TIME_US       20000
+#define BENCH_MAX_ITERATIONS    (1u << 24)
+
+// Benchmarked pixel counts (the last one is MAX_LED_COUNT)
+static const uint BENCH_PIXEL_COUNTS[] = {16, 64, 170, 256, MAX_LED_COUNT};
+static const uint BENCH_NUM_PIXEL_COUNTS = sizeof(BENCH_PIXEL_COUNTS) / sizeof(BENCH_PIXEL_COUNTS[0]);
+
+static const WS2812Driver::ColorFormat BENCH_FORMATS[] = {
+    WS2812Driver::ColorFormat::RGB,
+    WS2812Driver::ColorFormat::GRB,
+    WS2812Driver::ColorFormat::RGBW
+};
+
+// Keeps the compiler from discarding results that are otherwise unused
+static volatile uint32_t bench_sink;
+
+// Source data shared by the benchmarks (4 bytes per pixel covers RGBW)
+static uint8_t bench_input[MAX_LED_COUNT * 4];
+
+static uint64_t bench_now_ns() {
+#ifdef PICOLED_HOST_HAL
+    // The simulated timer does not advance while firmware code runs
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    return time_us_64() * 1000;
+#endif
+}
+
+static const char* format_name(WS2812Driver::ColorFormat format) {
+    switch (format) {
+        case WS2812Driver::ColorFormat::RGB:
+            return "RGB";
+        case WS2812Driver::ColorFormat::GRB:
+            return "GRB";
+        case WS2812Driver::ColorFormat::RGBW:
+            return "RGBW";
+    }
+    return "?";
+}
+
+static void print_header() {
+#ifdef PICOLED_HOST_HAL
+    printf("%-22s %-5s %6s %12s %10s %12s\n",
+           "Benchmark", "Fmt", "Pixels", "Iterations", "ns/pixel", "MB/s");
+#else
+    printf("%-22s %-5s %6s %12s %10s %12s %10s\n",
+           "Benchmark", "Fmt", "Pixels", "Iterations", "ns/pixel", "MB/s", "cyc/pixel");
+#endif
+}
+
+/**
+ * @brief Time an operation and print one result row
+ * @param name Benchmark name
+ * @param format Color format the operation runs with
+ * @param pixels Pixels processed per call
+ * @param bytes_per_pixel Bytes read or written per pixel, for the MB/s column
+ * @param op Operation to time
+ * @return Time per pixel in ns
+ */
+template <typename Op>
+static double run_benchmark(const char* name, WS2812Driver::ColorFormat format,
+                          uint pixels, uint bytes_per_pixel, Op op) {
+    // Warm up caches and branch predictors before timing
+    op();
+
+    uint32_t iterations = 1;
+    uint64_t elapsed_ns = 0;
+    while (true) {
+        uint64_t start_ns = bench_now_ns();
+        for (uint32_t i = 0; i < iterations; i++) {
+            op();
+        }
+        elapsed_ns = bench_now_ns() - start_ns;
+
+        if (elapsed_ns >= (uint64_t)BENCH_MIN_TIME_US * 1000 || iterations >= BENCH_MAX_ITERATIONS) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double total_pixels = (double)iterations * pixels;
+    double ns_per_pixel = elapsed_ns / total_pixels;
+    double mb_per_s = (elapsed_ns > 0) ? total_pixels * bytes_per_pixel * 1000.0 / elapsed_ns : 0.0;
+
+#ifdef PICOLED_HOST_HAL
+    printf("%-22s %-5s %6u %12u %10.2f %12.1f\n",
+           name, format_name(format), pixels, (unsigned)iterations, ns_per_pixel, mb_per_s);
+#else
+    double cycles_per_pixel = ns_per_pixel * clock_get_hz(clk_sys) / 1e9;
+    printf("%-22s %-5s %6u %12u %10.2f %12.1f %10.1f\n",
+           name, format_name(format), pixels, (unsigned)iterations, ns_per_pixel, mb_per_s, cycles_per_pixel);
+#endif
+
+    return ns_per_pixel;
+}
+
+// ===========================================
+// WS2812Driver benchmarks
+// ===========================================
+
+static void bench_ws2812(WS2812Driver::ColorFormat format, uint num_pixels) {
+    WS2812Driver::Config config = {
+        .pio_instance = WS2812_PIO,
+        .pio_sm = WS2812_SM,
+        .gpio_pin = DEFAULT_LED_PIN,
+        .num_pixels = num_pixels,
+        .format = format,
+        .use_dma = false,
+        .num_buffers = 1,
+        .extract_white = true   // RGBW only
+    };
+
+    WS2812Driver driver(config);
+    if (!driver.begin()) {
+        printf("ERROR: Failed to initialize WS2812 driver (%u pixels)\n", num_pixels);
+        return;
+    }
+
+    uint bytes_per_pixel = (format == WS2812Driver::ColorFormat::RGBW) ? 4 : 3;
+
+    // convert_color is private; colorToNative is its public wrapper
+    run_benchmark("convert_color", format, num_pixels, sizeof(uint32_t), [&]() {
+        uint32_t acc = 0;
+        for (uint i = 0; i < num_pixels; i++) {
+            const uint8_t* p = &bench_input[i * 4];
+            acc ^= driver.colorToNative(p[0], p[1], p[2], p[3]);
+        }
+        bench_sink = acc;
+    });
+
+    run_benchmark("setPixelData", format, num_pixels, bytes_per_pixel, [&]() {
+        driver.setPixelData(bench_input, num_pixels);
+    });
+
+    static uint8_t raw[MAX_LED_COUNT * 4];
+    run_benchmark("getPixelData", format, num_pixels, bytes_per_pixel, [&]() {
+        driver.getPixelData(raw, num_pixels);
+        bench_sink = raw[0];
+    });
+
+    // The format-specialized kernel behind setPixelData, dispatched once
+    // per call like the driver does
+    static uint32_t natives[MAX_LED_COUNT];
+    run_benchmark("packPixels", format, num_pixels, bytes_per_pixel, [&]() {
+        switch (format) {
+            case WS2812Driver::ColorFormat::RGB:
+                WS2812Driver::packPixels<WS2812Driver::ColorFormat::RGB>(bench_input, num_pixels, natives);
+                break;
+            case WS2812Driver::ColorFormat::GRB:
+                WS2812Driver::packPixels<WS2812Driver::ColorFormat::GRB>(bench_input, num_pixels, natives);
+                break;
+            case WS2812Driver::ColorFormat::RGBW:
+                WS2812Driver::packPixels<WS2812Driver::ColorFormat::RGBW>(bench_input, num_pixels, natives);
+                break;
+        }
+        bench_sink = natives[0];
+    });
+
+    // RGB content (DMX input) into the strip, with white extraction for RGBW
+    run_benchmark("setPixelDataRGB", format, num_pixels, 3, [&]() {
+        driver.setPixelDataRGB(bench_input, num_pixels);
+    });
+
+    if (format == WS2812Driver::ColorFormat::RGBW) {
+        static uint32_t extracted[MAX_LED_COUNT];
+        run_benchmark("extractWhitePixels", format, num_pixels, 3, [&]() {
+            WS2812Driver::extractWhitePixels(bench_input, num_pixels, extracted);
+            bench_sink = extracted[0];
+        });
+    }
+
+    run_benchmark("fill", format, num_pixels, sizeof(uint32_t), [&]() {
+        driver.fill(0x12, 0x34, 0x56, 0x78);
+    });
+
+    // Buffer effects on the PixelMath SWAR kernels. The work per pixel does
+    // not depend on the colors, so the buffer is left to fade or saturate.
+    run_benchmark("fadeToBlackBy", format, num_pixels, sizeof(uint32_t), [&]() {
+        driver.fadeToBlackBy(32);
+    });
+
+    run_benchmark("addColor", format, num_pixels, sizeof(uint32_t), [&]() {
+        driver.addColor(1, 2, 3, 4);
+    });
+
+    run_benchmark("blendColor", format, num_pixels, sizeof(uint32_t), [&]() {
+        driver.blendColor(100, 0x12, 0x34, 0x56, 0x78);
+    });
+
+    // setBrightness and setGamma only rebuild the output table, so their
+    // cost does not depend on the pixel count. The values alternate so the
+    // cached gamma curve is recomputed every time.
+    uint8_t brightness = 200;
+    run_benchmark("setBrightness", format, num_pixels, sizeof(uint32_t), [&]() {
+        brightness ^= 1;
+        driver.setBrightness(brightness);
+    });
+
+    float gamma = 2.2f;
+    run_benchmark("setGamma", format, num_pixels, sizeof(uint32_t), [&]() {
+        gamma = (gamma == 2.2f) ? 2.3f : 2.2f;
+        driver.setGamma(gamma);
+    });
+
+    // The output stage kernels are static and timed on plain buffers, so
+    // the 8-bit and 16-bit pixel paths are compared in either build
+    static uint32_t pixels[MAX_LED_COUNT];
+    static uint64_t pixels16[MAX_LED_COUNT];
+    static uint32_t encoded[MAX_LED_COUNT];
+    for (uint i = 0; i < num_pixels; i++) {
+        const uint8_t* p = &bench_input[i * 4];
+        pixels[i] = WS2812Driver::packColor(format, p[0], p[1], p[2], p[3]);
+        pixels16[i] = WS2812Driver::packColor16(format, p[0] * 257, p[1] * 257, p[2] * 257, p[3] * 257);
+    }
+
+    // Output stage encoding done by update()/present() while the
+    // brightness or gamma is not the identity
+    run_benchmark("encodePixels", format, num_pixels, sizeof(uint32_t), [&]() {
+        WS2812Driver::encodePixels(pixels, num_pixels, driver.getOutputTable(), encoded);
+        bench_sink = encoded[0];
+    });
+
+    // The same with brightness only (gamma 1.0), scaled a word at a time
+    run_benchmark("scaleWords", format, num_pixels, sizeof(uint32_t), [&]() {
+        PixelMath::scaleWords(pixels, num_pixels, 200, encoded);
+        bench_sink = encoded[0];
+    });
+
+    // Temporal dithering runs once per refresh in continuous refresh mode,
+    // in the latch interrupt while the previous frame is on the wire
+    uint frame = 0;
+    double dither_ns = run_benchmark("ditherPixels", format, num_pixels, sizeof(uint32_t), [&]() {
+        WS2812Driver::ditherPixels(pixels, num_pixels, driver.getOutputTable16(), frame++, encoded);
+        bench_sink = encoded[0];
+    });
+
+    // Encoding with WS2812_CHANNEL_BITS 16: every frame is quantized
+    run_benchmark("quantizePixels", format, num_pixels, sizeof(uint64_t), [&]() {
+        WS2812Driver::quantizePixels(pixels16, num_pixels, driver.getOutputTable16(), false, 0, encoded);
+        bench_sink = encoded[0];
+    });
+
+    run_benchmark("quantizePixels dither", format, num_pixels, sizeof(uint64_t), [&]() {
+        WS2812Driver::quantizePixels(pixels16, num_pixels, driver.getOutputTable16(), true, frame++, encoded);
+        bench_sink = encoded[0];
+    });
+
+    // Packed 3-byte pixels (Config::packed_pixels), RGB and GRB only
+    if (format != WS2812Driver::ColorFormat::RGBW) {
+        alignas(4) static uint8_t packed[MAX_LED_COUNT * 3];
+        alignas(4) static uint8_t packed_encoded[MAX_LED_COUNT * 3];
+        memcpy(packed, bench_input, num_pixels * 3);
+
+        run_benchmark("encodePackedPixels", format, num_pixels, 3, [&]() {
+            WS2812Driver::encodePackedPixels(packed, num_pixels, driver.getOutputTable(), packed_encoded);
+            bench_sink = packed_encoded[0];
+        });
+
+        run_benchmark("scaleBytes", format, num_pixels, 3, [&]() {
+            PixelMath::scaleBytes(packed, num_pixels * 3, 200, packed_encoded);
+            bench_sink = packed_encoded[0];
+        });
+
+        run_benchmark("ditherPackedPixels", format, num_pixels, 3, [&]() {
+            WS2812Driver::ditherPackedPixels(packed, num_pixels, driver.getOutputTable16(), frame++, packed_encoded);
+            bench_sink = packed_encoded[0];
+        });
+    }
+
+    if (num_pixels == MAX_LED_COUNT) {
+        double kernel_us = dither_ns * num_pixels / 1000.0;
+        double frame_us = num_pixels * bytes_per_pixel * 8 * 1.25 + WS2812_RESET_TIME_US;
+        printf("  -> dither budget at %u pixels: %.1f us of %.1f us per refresh (%.2f%%)\n",
+               num_pixels, kernel_us, frame_us, kernel_us * 100.0 / frame_us);
+    }
+
+    driver.end();
+}
+
+// ===========================================
+// WS2812ParallelDriver benchmarks
+// ===========================================
+
+static void bench_ws2812_parallel(WS2812Driver::ColorFormat format, uint pixels_per_strip) {
+    const uint num_strips = WS2812_PARALLEL_MAX_STRIPS;
+    uint bytes_per_pixel = (format == WS2812Driver::ColorFormat::RGBW) ? 4 : 3;
+
+    // The kernel is static, so it is timed on plain buffers; the input is
+    // the packed colors of all strips, strip after strip
+    static uint32_t pixels[WS2812_PARALLEL_MAX_STRIPS * MAX_LED_COUNT];
+    static uint32_t output[MAX_LED_COUNT * 8];
+    for (uint i = 0; i < num_strips * pixels_per_strip; i++) {
+        const uint8_t* p = &bench_input[(i % MAX_LED_COUNT) * 4];
+        pixels[i] = WS2812Driver::packColor(format, p[0], p[1], p[2], p[3]);
+    }
+
+    // Reported per pixel over all strips, against the packed input size
+    run_benchmark("parallel transpose", format, num_strips * pixels_per_strip, sizeof(uint32_t), [&]() {
+        WS2812ParallelDriver::transpose(pixels, num_strips, pixels_per_strip, bytes_per_pixel, output);
+        bench_sink = output[0];
+    });
+}
+
+// ===========================================
+// APA102Driver benchmarks
+// ===========================================
+
+static void bench_apa102(uint num_pixels) {
+    // The encoder is static, so it is timed on plain buffers; APA102
+    // pixels are always RGB, stored as one word each
+    static uint32_t pixels[MAX_LED_COUNT];
+    static uint32_t frames[MAX_LED_COUNT];
+    for (uint i = 0; i < num_pixels; i++) {
+        const uint8_t* p = &bench_input[i * 3];
+        pixels[i] = APA102Driver::packColor(p[0], p[1], p[2]);
+    }
+
+    run_benchmark("APA102 encodePixels", WS2812Driver::ColorFormat::RGB, num_pixels, sizeof(uint32_t), [&]() {
+        APA102Driver::encodePixels(pixels, num_pixels, 200, false, frames);
+        bench_sink = frames[0];
+    });
+
+    run_benchmark("APA102 encodePixels HD", WS2812Driver::ColorFormat::RGB, num_pixels, sizeof(uint32_t), [&]() {
+        APA102Driver::encodePixels(pixels, num_pixels, 200, true, frames);
+        bench_sink = frames[0];
+    });
+}
+
+// ===========================================
+// PicoLED conversion benchmarks
+// ===========================================
+
+static void bench_picoled(uint num_pixels) {
+    PicoLED::PinConfig pins = {
+        .led_panel_pin = DEFAULT_LED_PIN,
+        .dmx512_pin = DEFAULT_DMX_PIN,
+        .rs485_data_pin = DEFAULT_RS485_DATA_PIN,
+        .rs485_enable_pin = DEFAULT_RS485_ENABLE_PIN
+    };
+
+    PicoLED::LEDConfig led_config = {
+        .num_pixels = num_pixels,
+        .grid_width = DEFAULT_GRID_WIDTH,
+        .grid_height = (num_pixels + DEFAULT_GRID_WIDTH - 1) / DEFAULT_GRID_WIDTH,
+        .pio_instance = WS2812_PIO,
+        .pio_sm = WS2812_SM
+    };
+
+    PicoLED picoled(pins, led_config);
+    if (!picoled.begin()) {
+        printf("ERROR: Failed to initialize PicoLED (%u pixels)\n", num_pixels);
+        return;
+    }
+
+    // PicoLED always drives the panel in GRB; both conversions move 3
+    // DMX channels per LED and stop at the end of the universe
+    run_benchmark("PicoLED::dmxToLEDs", WS2812Driver::ColorFormat::GRB, num_pixels, 3, [&]() {
+        picoled.dmxToLEDs(bench_input, 1, num_pixels);
+    });
+
+    run_benchmark("PicoLED::ledsToDMX", WS2812Driver::ColorFormat::GRB, num_pixels, 3, [&]() {
+        picoled.ledsToDMX();
+    });
+
+    picoled.end();
+}
+
+int main() {
+    stdio_init_all();
+
+#ifndef PICOLED_HOST_HAL
+    // Give the USB serial console time to connect
+    sleep_ms(2000);
+#endif
+
+    for (uint i = 0; i < sizeof(bench_input); i++) {
+        bench_input[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    printf("PicoLED Hot Path Benchmark\n");
+    printf("==========================\n");
+#ifdef PICOLED_HOST_HAL
+    printf("Timing: host wall clock\n\n");
+#else
+    printf("Timing: RP2040 timer, clk_sys %lu Hz\n\n", clock_get_hz(clk_sys));
+#endif
+
+    print_header();
+    for (WS2812Driver::ColorFormat format : BENCH_FORMATS) {
+        for (uint i = 0; i < BENCH_NUM_PIXEL_COUNTS; i++) {
+            bench_ws2812(format, BENCH_PIXEL_COUNTS[i]);
+        }
+    }
+    for (WS2812Driver::ColorFormat format : BENCH_FORMATS) {
+        for (uint i = 0; i < BENCH_NUM_PIXEL_COUNTS; i++) {
+            bench_ws2812_parallel(format, BENCH_PIXEL_COUNTS[i]);
+        }
+    }
+
+    for (uint i = 0; i < BENCH_NUM_PIXEL_COUNTS; i++) {
+        bench_apa102(BENCH_PIXEL_COUNTS[i]);
+    }
+
+    // One universe holds 170 RGB LEDs; larger panels convert the same work
+    for (uint i = 0; i < BENCH_NUM_PIXEL_COUNTS; i++) {
+        if (BENCH_PIXEL_COUNTS[i] > DMX_UNIVERSE_SIZE / 3) {
+            break;
+        }
+        bench_picoled(BENCH_PIXEL_COUNTS[i]);
+    }
+
+    printf("\nBenchmark complete\n");
+
+#ifdef PICOLED_HOST_HAL
+    return 0;
+#else
+    while (true) {
+        tight_loop_contents();
+    }
+#endif
+}
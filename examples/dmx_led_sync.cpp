@@ -1,6 +1,7 @@
 #include "../include/PicoLED.h"
 #include "pico/stdlib.h"
 #include <cstdio>
+#include <cmath>
 
 /**
  * @brief DMX-LED Synchronization Example
@@ -141,7 +142,10 @@ int main() {
         // Update LED panel
         picoled.updateLEDPanel();
 
-        // Convert LED data to DMX and transmit
+        // Convert LED data to DMX and transmit; all channels below are
+        // committed together so no packet mixes two loops
+        picoled.beginDMXUpdate();
+
         // LEDs use channels 1-192 (64 LEDs * 3 channels each)
         picoled.ledsToDMX(1);
 
@@ -155,6 +159,7 @@ int main() {
         picoled.setDMXChannel(198, 0);    // Prism
         picoled.setDMXChannel(199, 0);    // Focus
         picoled.setDMXChannel(200, 0);    // Reserved
+        picoled.commitDMXUpdate();
 
         // Transmit exactly 512 channels of DMX
         picoled.transmitDMX();
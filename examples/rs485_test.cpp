@@ -1,6 +1,7 @@
 #include "../include/PicoLED.h"
 #include "pico/stdlib.h"
 #include <cstdio>
+#include <cmath>
 
 /**
  * @brief RS485 Serial Communication Test
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "pico.h"
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the frequency of a clock in Hz
+ *
+ * clk_sys and clk_peri follow the simulated system clock (125 MHz by default).
+ */
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+/**
+ * @brief Change the simulated system clock
+ * @return true (every frequency is achievable in simulation)
+ */
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "pico.h"
+
+#define NUM_DMA_CHANNELS            12
+#define NUM_DMA_TIMERS              4
+
+// DREQ numbers used by the simulation
+#define DREQ_PIO0_TX0               0
+#define DREQ_PIO0_RX0               4
+#define DREQ_PIO1_TX0               8
+#define DREQ_PIO1_RX0               12
+#define DREQ_SPI0_TX                16
+#define DREQ_SPI0_RX                17
+#define DREQ_SPI1_TX                18
+#define DREQ_SPI1_RX                19
+#define DREQ_UART0_TX               20
+#define DREQ_UART0_RX               21
+#define DREQ_UART1_TX               22
+#define DREQ_UART1_RX               23
+#define DREQ_DMA_TIMER0             0x3b
+#define DREQ_DMA_TIMER1             0x3c
+#define DREQ_DMA_TIMER2             0x3d
+#define DREQ_DMA_TIMER3             0x3e
+#define DREQ_FORCE                  0x3f
+
+// CTRL register layout (same bit positions as the RP2040 CH0_CTRL_TRIG)
+#define DMA_CH0_CTRL_TRIG_EN_BITS               0x00000001u
+#define DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS    0x00000002u
+#define DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB         2u
+#define DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS        0x0000000cu
+#define DMA_CH0_CTRL_TRIG_INCR_READ_BITS        0x00000010u
+#define DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS       0x00000020u
+#define DMA_CH0_CTRL_TRIG_RING_SIZE_LSB         6u
+#define DMA_CH0_CTRL_TRIG_RING_SIZE_BITS        0x000003c0u
+#define DMA_CH0_CTRL_TRIG_RING_SEL_BITS         0x00000400u
+#define DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB          11u
+#define DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS         0x00007800u
+#define DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB          15u
+#define DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS         0x001f8000u
+#define DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS        0x00200000u
+#define DMA_CH0_CTRL_TRIG_BSWAP_BITS            0x00400000u
+#define DMA_CH0_CTRL_TRIG_SNIFF_EN_BITS         0x00800000u
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+/**
+ * @brief Channel register block, with the RP2040 layout and aliases
+ *
+ * DMA writes are modelled: a transfer whose write address is one of these
+ * registers reprograms the channel (and triggers it for the *_trig
+ * aliases), so one channel can re-arm another. The CPU programs channels
+ * through the functions below; of the registers it can only read
+ * read_addr, which follows the channel's live read address. Addresses are
+ * 64-bit on the host, so a 32-bit write to an address register replaces
+ * its low half only; that is enough to point a channel back into memory
+ * it has been given before.
+ */
+typedef struct {
+    io_rw_32 read_addr;
+    io_rw_32 write_addr;
+    io_rw_32 transfer_count;
+    io_rw_32 ctrl_trig;
+    io_rw_32 al1_ctrl;
+    io_rw_32 al1_read_addr;
+    io_rw_32 al1_write_addr;
+    io_rw_32 al1_transfer_count_trig;
+    io_rw_32 al2_ctrl;
+    io_rw_32 al2_transfer_count;
+    io_rw_32 al2_read_addr;
+    io_rw_32 al2_write_addr_trig;
+    io_rw_32 al3_ctrl;
+    io_rw_32 al3_write_addr;
+    io_rw_32 al3_transfer_count;
+    io_rw_32 al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+} dma_hw_t;
+
+extern dma_hw_t host_dma_hw;
+
+#define dma_hw              (&host_dma_hw)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline dma_channel_hw_t* dma_channel_hw_addr(uint channel) {
+    return &dma_hw->ch[channel];
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | DMA_CH0_CTRL_TRIG_INCR_READ_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_INCR_READ_BITS);
+}
+static inline void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS);
+}
+static inline void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->ctrl = (c->ctrl & ~DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS) | (dreq << DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB);
+}
+static inline void channel_config_set_chain_to(dma_channel_config* c, uint chain_to) {
+    c->ctrl = (c->ctrl & ~DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS) | (chain_to << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB);
+}
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->ctrl = (c->ctrl & ~DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS) | ((uint)size << DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB);
+}
+static inline void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits) {
+    c->ctrl = (c->ctrl & ~(DMA_CH0_CTRL_TRIG_RING_SIZE_BITS | DMA_CH0_CTRL_TRIG_RING_SEL_BITS)) |
+              (size_bits << DMA_CH0_CTRL_TRIG_RING_SIZE_LSB) |
+              (write ? DMA_CH0_CTRL_TRIG_RING_SEL_BITS : 0);
+}
+static inline void channel_config_set_bswap(dma_channel_config* c, bool bswap) {
+    c->ctrl = bswap ? (c->ctrl | DMA_CH0_CTRL_TRIG_BSWAP_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_BSWAP_BITS);
+}
+static inline void channel_config_set_irq_quiet(dma_channel_config* c, bool irq_quiet) {
+    c->ctrl = irq_quiet ? (c->ctrl | DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS);
+}
+static inline void channel_config_set_high_priority(dma_channel_config* c, bool high_priority) {
+    c->ctrl = high_priority ? (c->ctrl | DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_HIGH_PRIORITY_BITS);
+}
+static inline void channel_config_set_enable(dma_channel_config* c, bool enable) {
+    c->ctrl = enable ? (c->ctrl | DMA_CH0_CTRL_TRIG_EN_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_EN_BITS);
+}
+static inline void channel_config_set_sniff_enable(dma_channel_config* c, bool sniff_enable) {
+    c->ctrl = sniff_enable ? (c->ctrl | DMA_CH0_CTRL_TRIG_SNIFF_EN_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_SNIFF_EN_BITS);
+}
+
+/**
+ * @brief Default channel configuration
+ *
+ * Read increment on, write increment off, 32-bit transfers, unpaced
+ * (DREQ_FORCE), chained to itself (i.e. no chaining), enabled.
+ */
+static inline dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = {0};
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    channel_config_set_chain_to(&c, channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_ring(&c, false, 0);
+    channel_config_set_bswap(&c, false);
+    channel_config_set_irq_quiet(&c, false);
+    channel_config_set_enable(&c, true);
+    return c;
+}
+
+dma_channel_config dma_get_channel_config(uint channel);
+
+// Channel claiming
+void dma_channel_claim(uint channel);
+void dma_claim_mask(uint32_t channel_mask);
+void dma_channel_unclaim(uint channel);
+void dma_unclaim_mask(uint32_t channel_mask);
+int dma_claim_unused_channel(bool required);
+bool dma_channel_is_claimed(uint channel);
+
+// Channel programming
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void* read_addr, uint32_t transfer_count);
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void* write_addr, uint32_t transfer_count);
+
+// Channel control
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+/**
+ * @brief Remaining transfer count of a channel (TRANS_COUNT register)
+ */
+uint32_t dma_channel_get_transfer_count(uint channel);
+
+/**
+ * @brief Current read address of a channel (READ_ADDR register)
+ */
+const volatile void* dma_channel_get_read_addr(uint channel);
+
+// Interrupts
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_set_irq0_channel_mask_enabled(uint32_t channel_mask, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+void dma_set_irq1_channel_mask_enabled(uint32_t channel_mask, bool enabled);
+void dma_irqn_set_channel_enabled(uint irq_index, uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+bool dma_irqn_get_channel_status(uint irq_index, uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+void dma_irqn_acknowledge_channel(uint irq_index, uint channel);
+
+#ifdef __cplusplus
+}
+#endif
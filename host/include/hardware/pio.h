@@ -0,0 +1,253 @@
+#pragma once
+
+#include "pico.h"
+#include "hardware/gpio.h"
+#include "hardware/pio_instructions.h"
+
+#define NUM_PIOS                    2
+#define NUM_PIO_STATE_MACHINES      4
+#define PIO_INSTRUCTION_COUNT       32
+
+/**
+ * @brief PIO register block
+ *
+ * Only the FIFO registers are modelled as addresses: DMA transfers to
+ * &pio->txf[sm] push into that state machine's TX FIFO and transfers from
+ * &pio->rxf[sm] pop its RX FIFO. CPU access goes through the pio_sm_* API.
+ */
+typedef struct {
+    io_wo_32 txf[NUM_PIO_STATE_MACHINES];
+    io_ro_32 rxf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t* PIO;
+
+extern pio_hw_t host_pio_hw[NUM_PIOS];
+
+#define pio0_hw                     (&host_pio_hw[0])
+#define pio1_hw                     (&host_pio_hw[1])
+#define pio0                        pio0_hw
+#define pio1                        pio1_hw
+
+typedef struct pio_program {
+    const uint16_t* instructions;
+    uint8_t length;
+    int8_t origin;     // required instruction memory origin or -1
+} pio_program_t;
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2,
+};
+
+enum pio_mov_status_type {
+    STATUS_TX_LESSTHAN = 0,
+    STATUS_RX_LESSTHAN = 1
+};
+
+enum pio_interrupt_source {
+    pis_interrupt0 = 8,
+    pis_interrupt1 = 9,
+    pis_interrupt2 = 10,
+    pis_interrupt3 = 11,
+    pis_sm0_tx_fifo_not_full = 4,
+    pis_sm1_tx_fifo_not_full = 5,
+    pis_sm2_tx_fifo_not_full = 6,
+    pis_sm3_tx_fifo_not_full = 7,
+    pis_sm0_rx_fifo_not_empty = 0,
+    pis_sm1_rx_fifo_not_empty = 1,
+    pis_sm2_rx_fifo_not_empty = 2,
+    pis_sm3_rx_fifo_not_empty = 3,
+};
+
+/**
+ * @brief State machine configuration
+ *
+ * Same role as the SDK's pio_sm_config, but held as decoded fields rather
+ * than packed CLKDIV/EXECCTRL/SHIFTCTRL/PINCTRL register images.
+ */
+typedef struct {
+    uint16_t clkdiv_int;
+    uint8_t clkdiv_frac;
+    uint8_t wrap_bottom;
+    uint8_t wrap_top;
+    uint8_t sideset_count;      // includes the enable bit when optional
+    bool sideset_optional;
+    bool sideset_pindirs;
+    uint8_t jmp_pin;
+    bool out_sticky;
+    bool inline_out_en;
+    uint8_t out_en_sel;
+    uint8_t mov_status_sel;
+    uint8_t mov_status_n;
+    bool in_shift_right;
+    bool autopush;
+    uint8_t push_threshold;     // 0 means 32
+    bool out_shift_right;
+    bool autopull;
+    uint8_t pull_threshold;     // 0 means 32
+    uint8_t fifo_join;
+    uint8_t out_base;
+    uint8_t out_count;
+    uint8_t set_base;
+    uint8_t set_count;
+    uint8_t sideset_base;
+    uint8_t in_base;
+} pio_sm_config;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline pio_sm_config pio_get_default_sm_config(void) {
+    pio_sm_config c = {};
+    c.clkdiv_int = 1;
+    c.wrap_bottom = 0;
+    c.wrap_top = 31;
+    c.in_shift_right = true;
+    c.out_shift_right = true;
+    return c;
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config* c, uint out_base, uint out_count) {
+    c->out_base = (uint8_t)out_base;
+    c->out_count = (uint8_t)out_count;
+}
+static inline void sm_config_set_set_pins(pio_sm_config* c, uint set_base, uint set_count) {
+    c->set_base = (uint8_t)set_base;
+    c->set_count = (uint8_t)set_count;
+}
+static inline void sm_config_set_in_pins(pio_sm_config* c, uint in_base) {
+    c->in_base = (uint8_t)in_base;
+}
+static inline void sm_config_set_sideset_pins(pio_sm_config* c, uint sideset_base) {
+    c->sideset_base = (uint8_t)sideset_base;
+}
+static inline void sm_config_set_sideset(pio_sm_config* c, uint bit_count, bool optional, bool pindirs) {
+    c->sideset_count = (uint8_t)bit_count;
+    c->sideset_optional = optional;
+    c->sideset_pindirs = pindirs;
+}
+static inline void sm_config_set_clkdiv_int_frac(pio_sm_config* c, uint16_t div_int, uint8_t div_frac) {
+    c->clkdiv_int = div_int;
+    c->clkdiv_frac = div_frac;
+}
+static inline void sm_config_set_clkdiv(pio_sm_config* c, float div) {
+    uint16_t div_int = (uint16_t)div;
+    uint8_t div_frac = div_int ? (uint8_t)((div - (float)div_int) * (1u << 8u)) : 0;
+    sm_config_set_clkdiv_int_frac(c, div_int, div_frac);
+}
+static inline void sm_config_set_wrap(pio_sm_config* c, uint wrap_target, uint wrap) {
+    c->wrap_bottom = (uint8_t)wrap_target;
+    c->wrap_top = (uint8_t)wrap;
+}
+static inline void sm_config_set_jmp_pin(pio_sm_config* c, uint pin) {
+    c->jmp_pin = (uint8_t)pin;
+}
+static inline void sm_config_set_in_shift(pio_sm_config* c, bool shift_right, bool autopush, uint push_threshold) {
+    c->in_shift_right = shift_right;
+    c->autopush = autopush;
+    c->push_threshold = (uint8_t)(push_threshold & 0x1fu);
+}
+static inline void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = (uint8_t)(pull_threshold & 0x1fu);
+}
+static inline void sm_config_set_fifo_join(pio_sm_config* c, enum pio_fifo_join join) {
+    c->fifo_join = (uint8_t)join;
+}
+static inline void sm_config_set_out_special(pio_sm_config* c, bool sticky, bool has_enable_pin, uint enable_pin_index) {
+    c->out_sticky = sticky;
+    c->inline_out_en = has_enable_pin;
+    c->out_en_sel = (uint8_t)enable_pin_index;
+}
+static inline void sm_config_set_mov_status(pio_sm_config* c, enum pio_mov_status_type status_sel, uint status_n) {
+    c->mov_status_sel = (uint8_t)status_sel;
+    c->mov_status_n = (uint8_t)status_n;
+}
+
+static inline uint pio_get_index(PIO pio) {
+    return pio == pio1 ? 1 : 0;
+}
+
+static inline PIO pio_get_instance(uint instance) {
+    return instance ? pio1 : pio0;
+}
+
+/**
+ * @brief DREQ number for a state machine FIFO (DREQ_PIO0_TX0 = 0)
+ */
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return pio_get_index(pio) * 8 + (is_tx ? 0 : 4) + sm;
+}
+
+// Instruction memory
+bool pio_can_add_program(PIO pio, const pio_program_t* program);
+bool pio_can_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset);
+uint pio_add_program(PIO pio, const pio_program_t* program);
+void pio_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset);
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset);
+void pio_clear_instruction_memory(PIO pio);
+
+// State machine claiming
+void pio_sm_claim(PIO pio, uint sm);
+void pio_claim_sm_mask(PIO pio, uint sm_mask);
+void pio_sm_unclaim(PIO pio, uint sm);
+int pio_claim_unused_sm(PIO pio, bool required);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+
+// State machine control
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_restart_sm_mask(PIO pio, uint32_t mask);
+void pio_sm_clkdiv_restart(PIO pio, uint sm);
+void pio_clkdiv_restart_sm_mask(PIO pio, uint32_t mask);
+
+/**
+ * @brief Enable several state machines with synchronised clock dividers
+ */
+void pio_enable_sm_mask_in_sync(PIO pio, uint32_t mask);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac);
+void pio_sm_set_wrap(PIO pio, uint sm, uint wrap_target, uint wrap);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_exec_wait_blocking(PIO pio, uint sm, uint instr);
+bool pio_sm_is_exec_stalled(PIO pio, uint sm);
+uint8_t pio_sm_get_pc(PIO pio, uint sm);
+
+// Pins
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+
+// FIFOs
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_drain_tx_fifo(PIO pio, uint sm);
+
+// Interrupt flags and IRQ lines
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num);
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num);
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+void pio_set_irq1_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+void pio_set_irqn_source_enabled(PIO pio, uint irq_index, enum pio_interrupt_source source, bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "pico.h"
+
+#define NUM_SPIS            2
+
+/**
+ * @brief SPI register block
+ *
+ * Only the data register is modelled as an address: DMA transfers whose
+ * write address is &spi_get_hw(spi)->dr are routed into the TX FIFO.
+ */
+typedef struct {
+    io_rw_32 dr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+
+extern spi_hw_t host_spi_hw[NUM_SPIS];
+
+#define spi0_hw             (&host_spi_hw[0])
+#define spi1_hw             (&host_spi_hw[1])
+#define spi0                ((spi_inst_t *)spi0_hw)
+#define spi1                ((spi_inst_t *)spi1_hw)
+
+typedef enum {
+    SPI_CPHA_0 = 0,
+    SPI_CPHA_1 = 1
+} spi_cpha_t;
+
+typedef enum {
+    SPI_CPOL_0 = 0,
+    SPI_CPOL_1 = 1
+} spi_cpol_t;
+
+typedef enum {
+    SPI_LSB_FIRST = 0,
+    SPI_MSB_FIRST = 1
+} spi_order_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint spi_get_index(const spi_inst_t* spi) {
+    return spi == spi1 ? 1 : 0;
+}
+
+static inline spi_hw_t* spi_get_hw(spi_inst_t* spi) {
+    return (spi_hw_t*)spi;
+}
+
+static inline spi_inst_t* spi_get_instance(uint instance) {
+    return instance ? spi1 : spi0;
+}
+
+/**
+ * @brief DREQ number for an SPI (DREQ_SPI0_TX = 16)
+ */
+static inline uint spi_get_dreq(spi_inst_t* spi, bool is_tx) {
+    return 16 + spi_get_index(spi) * 2 + (is_tx ? 0 : 1);
+}
+
+/**
+ * @brief Enable an SPI as master, Motorola format, 8 data bits, mode 0
+ * @return Actual baud rate (clk_peri / (prescale * postdiv), as on the SDK)
+ */
+uint spi_init(spi_inst_t* spi, uint baudrate);
+void spi_deinit(spi_inst_t* spi);
+uint spi_set_baudrate(spi_inst_t* spi, uint baudrate);
+uint spi_get_baudrate(const spi_inst_t* spi);
+
+/**
+ * @brief Set the frame format
+ *
+ * Only MSB first is supported, as on the PL022.
+ */
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+
+bool spi_is_writable(const spi_inst_t* spi);
+bool spi_is_readable(const spi_inst_t* spi);
+
+/**
+ * @brief True while the TX FIFO holds data or a frame is being shifted out
+ */
+bool spi_is_busy(const spi_inst_t* spi);
+
+/**
+ * @brief Write bytes, discarding whatever is clocked in
+ *
+ * Frames follow each other without a gap on SCK, which the PL022 only
+ * does with CPHA 1; the simulation does not model the CSn pulse between
+ * frames in CPHA 0, which does not change SCK or TX.
+ *
+ * @return Number of bytes written
+ */
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "pico.h"
+
+// ===========================================
+// Host HAL - system timer
+// ===========================================
+//
+// The 1 MHz system timer with its four hardware alarms. Alarm n raises
+// TIMER_IRQ_n when the timer reaches its target; the callback registered
+// with hardware_alarm_set_callback() runs from that interrupt.
+
+#define NUM_TIMERS  4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*hardware_alarm_callback_t)(uint alarm_num);
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+void hardware_alarm_claim(uint alarm_num);
+int hardware_alarm_claim_unused(bool required);
+void hardware_alarm_unclaim(uint alarm_num);
+bool hardware_alarm_is_claimed(uint alarm_num);
+
+/**
+ * @brief Install the callback for an alarm (nullptr to remove)
+ */
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback);
+
+/**
+ * @brief Arm an alarm
+ * @return true if the target time has already passed (the alarm is not armed)
+ */
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t);
+
+void hardware_alarm_cancel(uint alarm_num);
+void hardware_alarm_force_irq(uint alarm_num);
+
+#ifdef __cplusplus
+}
+#endif
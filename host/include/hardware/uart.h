@@ -0,0 +1,90 @@
+#pragma once
+
+#include "pico.h"
+
+#define NUM_UARTS           2
+
+/**
+ * @brief UART register block
+ *
+ * Only the data register is modelled as an address: DMA transfers whose
+ * write address is &uart_get_hw(uart)->dr are routed into the TX FIFO.
+ */
+typedef struct {
+    io_rw_32 dr;
+} uart_hw_t;
+
+typedef struct uart_inst uart_inst_t;
+
+extern uart_hw_t host_uart_hw[NUM_UARTS];
+
+#define uart0_hw            (&host_uart_hw[0])
+#define uart1_hw            (&host_uart_hw[1])
+#define uart0               ((uart_inst_t *)uart0_hw)
+#define uart1               ((uart_inst_t *)uart1_hw)
+
+typedef enum {
+    UART_PARITY_NONE,
+    UART_PARITY_EVEN,
+    UART_PARITY_ODD
+} uart_parity_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint uart_get_index(uart_inst_t* uart) {
+    return uart == uart1 ? 1 : 0;
+}
+
+static inline uart_hw_t* uart_get_hw(uart_inst_t* uart) {
+    return (uart_hw_t*)uart;
+}
+
+static inline uart_inst_t* uart_get_instance(uint instance) {
+    return instance ? uart1 : uart0;
+}
+
+/**
+ * @brief DREQ number for a UART (DREQ_UART0_TX = 20)
+ */
+static inline uint uart_get_dreq(uart_inst_t* uart, bool is_tx) {
+    return 20 + uart_get_index(uart) * 2 + (is_tx ? 0 : 1);
+}
+
+uint uart_init(uart_inst_t* uart, uint baudrate);
+void uart_deinit(uart_inst_t* uart);
+uint uart_set_baudrate(uart_inst_t* uart, uint baudrate);
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits, uart_parity_t parity);
+void uart_set_hw_flow(uart_inst_t* uart, bool cts, bool rts);
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled);
+void uart_set_translate_crlf(uart_inst_t* uart, bool translate);
+bool uart_is_enabled(uart_inst_t* uart);
+
+/**
+ * @brief Enable the RX / TX interrupt sources
+ *
+ * As on the SDK, enabling the TX source lowers the TX FIFO trigger level to
+ * 1/8 full. As on the PL011, the TX interrupt is raised when the FIFO level
+ * passes down through the trigger level or written data leaves the FIFO and
+ * it becomes empty, and is cleared once the FIFO is filled above the trigger
+ * level. Enabling the source on an idle UART does not raise it.
+ */
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data, bool tx_needs_data);
+
+/**
+ * @brief Assert or release a break condition (TX held low)
+ */
+void uart_set_break(uart_inst_t* uart, bool en);
+
+bool uart_is_writable(uart_inst_t* uart);
+bool uart_is_readable(uart_inst_t* uart);
+void uart_tx_wait_blocking(uart_inst_t* uart);
+void uart_putc_raw(uart_inst_t* uart, char c);
+void uart_putc(uart_inst_t* uart, char c);
+void uart_puts(uart_inst_t* uart, const char* s);
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
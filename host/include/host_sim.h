@@ -0,0 +1,83 @@
+#pragma once
+
+#include "pico.h"
+
+// ===========================================
+// Host HAL - simulation control
+// ===========================================
+//
+// The host HAL runs every peripheral on a single virtual timeline measured
+// in system clock cycles. Firmware code executes in zero simulated time;
+// the timeline only moves forward when the firmware waits (busy_wait_*,
+// sleep_*, tight_loop_contents, blocking FIFO/UART calls) or when a host
+// tool calls host_sim_run_*(). While time advances, PIO state machines
+// execute their programs cycle by cycle, DMA channels move data under DREQ
+// pacing, UARTs shift bits onto their TX pins and pending interrupts are
+// dispatched to the registered handlers.
+
+#define HOST_SIM_DEFAULT_SYS_CLOCK_HZ   125000000u  // RP2040 default clk_sys
+#define HOST_SIM_IRQ_ENTRY_CYCLES       24          // Exception entry + exit cost charged per dispatch
+#define HOST_SIM_POLL_CYCLES            8           // Cost of one tight_loop_contents() iteration
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback invoked whenever the level on a GPIO changes
+ * @param context User pointer passed to host_sim_set_gpio_trace()
+ * @param gpio GPIO number
+ * @param level New pin level
+ * @param cycle System clock cycle at which the change happened
+ */
+typedef void (*host_sim_gpio_trace_fn)(void* context, uint gpio, bool level, uint64_t cycle);
+
+/**
+ * @brief Per-interrupt dispatch statistics
+ */
+typedef struct {
+    uint32_t dispatch_count;    // Number of times the handler(s) ran
+    uint64_t cycles;            // Simulated cycles spent in handler context
+} host_sim_irq_stats_t;
+
+/**
+ * @brief Reset the whole simulation (time, peripherals, handlers, stats)
+ */
+void host_sim_reset(void);
+
+/**
+ * @brief Current position of the virtual timeline in system clock cycles
+ */
+uint64_t host_sim_get_cycles(void);
+
+/**
+ * @brief Current simulated system clock frequency
+ */
+uint32_t host_sim_get_sys_clock_hz(void);
+
+/**
+ * @brief Advance the timeline, running peripherals and interrupts
+ */
+void host_sim_run_cycles(uint64_t cycles);
+void host_sim_run_us(uint64_t us);
+void host_sim_run_until_cycle(uint64_t cycle);
+
+/**
+ * @brief Install a GPIO level-change observer (nullptr to remove)
+ */
+void host_sim_set_gpio_trace(host_sim_gpio_trace_fn fn, void* context);
+
+/**
+ * @brief Interrupt statistics
+ */
+host_sim_irq_stats_t host_sim_get_irq_stats(uint irq);
+void host_sim_reset_irq_stats(void);
+
+/**
+ * @brief True while an interrupt handler is executing
+ */
+bool host_sim_in_irq(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+// ===========================================
+// Host HAL - base definitions
+// ===========================================
+//
+// Minimal stand-in for the Pico SDK's <pico.h> so the drivers under src/
+// build unmodified on a desktop toolchain. Only the subset of the SDK that
+// this project uses is provided; everything is backed by the simulation in
+// host/src (see host_sim.h).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "pico/types.h"
+
+#define PICO_ON_DEVICE              0
+#define PICOLED_HOST_HAL            1
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name)  func_name
+#define __time_critical_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) func_name
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __aligned(x)                __attribute__((aligned(x)))
+#define __unused                    __attribute__((unused))
+#define __force_inline              inline __attribute__((always_inline))
+
+#define count_of(a)                 (sizeof(a) / sizeof((a)[0]))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Report a fatal error and terminate the host process
+ */
+void panic(const char* fmt, ...) __attribute__((noreturn, format(printf, 1, 2)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define hard_assert(x)              ((x) ? (void)0 : panic("hard_assert failed: %s", #x))
+#define valid_params_if(group, x)   ((void)0)
+#define invalid_params_if(group, x) ((void)0)
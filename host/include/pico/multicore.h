@@ -0,0 +1,23 @@
+#pragma once
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Launch a function on core 1
+ *
+ * The host simulation models a single core; calling this panics.
+ */
+void multicore_launch_core1(void (*entry)(void));
+
+/**
+ * @brief Reset core 1 (no-op on the host)
+ */
+void multicore_reset_core1(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "pico.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialise stdio (stdout is used directly on the host)
+ */
+bool stdio_init_all(void);
+
+#ifdef __cplusplus
+}
+#endif
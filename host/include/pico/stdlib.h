@@ -0,0 +1,23 @@
+#pragma once
+
+#include "pico.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief No-op body for busy-wait loops
+ *
+ * On the host this advances simulated time by a few cycles so that
+ * peripherals and interrupts make progress while the caller polls.
+ */
+void tight_loop_contents(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "pico.h"
+#include "hardware/timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Current simulated time
+ */
+absolute_time_t get_absolute_time(void);
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + (uint64_t)ms * 1000; }
+
+/**
+ * @brief Difference between two times in microseconds (to - from)
+ */
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t t);
+
+/**
+ * @brief Busy-wait helpers
+ *
+ * Simulated time advances by the requested amount; peripherals keep running
+ * and pending interrupts are dispatched while the caller waits.
+ */
+void busy_wait_us_32(uint32_t delay_us);
+void busy_wait_us(uint64_t delay_us);
+void busy_wait_ms(uint32_t delay_ms);
+void busy_wait_until(absolute_time_t t);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+
+// ===========================================
+// Alarms (default alarm pool)
+// ===========================================
+//
+// The default pool multiplexes up to PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS
+// alarms onto hardware alarm PICO_TIME_DEFAULT_ALARM_POOL_HARDWARE_ALARM_NUM.
+// Callbacks run in its TIMER_IRQ. A callback returns 0 to stop, >0 to fire
+// again that many microseconds after the previous target, or <0 to fire
+// again that many microseconds from now.
+
+#define PICO_TIME_DEFAULT_ALARM_POOL_HARDWARE_ALARM_NUM 3
+#define PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS         16
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void* user_data);
+
+/**
+ * @brief Add an alarm to the default pool
+ * @param fire_if_past If the time has already passed, call the callback
+ *        before returning instead of not adding the alarm
+ * @return Alarm id (>0), 0 if the time had passed (and the callback did not
+ *         ask to be rescheduled), or <0 if no alarm slot is free
+ */
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void* user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void* user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void* user_data, bool fire_if_past);
+
+/**
+ * @brief Cancel an alarm
+ * @return true if the alarm was pending
+ */
+bool cancel_alarm(alarm_id_t alarm_id);
+
+#ifdef __cplusplus
+}
+#endif
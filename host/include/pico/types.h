@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+/**
+ * @brief Absolute time in microseconds since (simulated) boot
+ */
+typedef uint64_t absolute_time_t;
+
+#define io_rw_32 volatile uint32_t
+// Read-only registers are not const-qualified so the simulated register
+// blocks can be ordinary globals
+#define io_ro_32 volatile uint32_t
+#define io_wo_32 volatile uint32_t
+#define io_rw_16 volatile uint16_t
+#define io_rw_8  volatile uint8_t
@@ -0,0 +1,370 @@
+#include "sim_internal.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+namespace host_sim {
+
+namespace {
+
+struct SharedHandler {
+    irq_handler_t handler;
+    uint8_t order_priority;
+};
+
+struct IrqSlot {
+    irq_handler_t exclusive;
+    std::vector<SharedHandler> shared;
+    bool enabled;
+    bool forced;
+    uint8_t priority;
+    host_sim_irq_stats_t stats;
+};
+
+uint64_t g_now = 0;
+bool g_in_irq = false;
+bool g_irqs_masked = false;
+IrqSlot g_irqs[NUM_IRQS];
+
+// Bring every peripheral into its power-on state before main() runs. All
+// other simulation state is plain data, so only g_irqs above needs to be
+// constructed first.
+struct PowerOnReset {
+    PowerOnReset() { host_sim_reset(); }
+} g_power_on_reset;
+
+bool irq_line_pending(uint num) {
+    if (g_irqs[num].forced) {
+        return true;
+    }
+
+    switch (num) {
+        case TIMER_IRQ_0: return timer_irq_pending(0);
+        case TIMER_IRQ_1: return timer_irq_pending(1);
+        case TIMER_IRQ_2: return timer_irq_pending(2);
+        case TIMER_IRQ_3: return timer_irq_pending(3);
+        case PIO0_IRQ_0: return pio_irq_pending(0, 0);
+        case PIO0_IRQ_1: return pio_irq_pending(0, 1);
+        case PIO1_IRQ_0: return pio_irq_pending(1, 0);
+        case PIO1_IRQ_1: return pio_irq_pending(1, 1);
+        case DMA_IRQ_0:  return dma_irq_pending(0);
+        case DMA_IRQ_1:  return dma_irq_pending(1);
+        case UART0_IRQ:  return uart_irq_pending(0);
+        case UART1_IRQ:  return uart_irq_pending(1);
+        default:         return false;
+    }
+}
+
+bool has_handler(const IrqSlot& slot) {
+    return slot.exclusive != nullptr || !slot.shared.empty();
+}
+
+// Dispatch the highest-priority pending interrupt, if any. The handler runs
+// with further dispatch suppressed (no nesting) and the exception entry cost
+// is charged to the timeline before it executes.
+bool dispatch_one_irq() {
+    if (g_in_irq || g_irqs_masked) {
+        return false;
+    }
+
+    int best = -1;
+    for (uint num = 0; num < NUM_IRQS; num++) {
+        IrqSlot& slot = g_irqs[num];
+        if (!slot.enabled || !has_handler(slot) || !irq_line_pending(num)) {
+            continue;
+        }
+        if (best < 0 || slot.priority < g_irqs[best].priority) {
+            best = (int)num;
+        }
+    }
+
+    if (best < 0) {
+        return false;
+    }
+
+    IrqSlot& slot = g_irqs[best];
+    slot.forced = false;
+
+    g_in_irq = true;
+    uint64_t start = g_now;
+    run_until(g_now + HOST_SIM_IRQ_ENTRY_CYCLES);
+
+    if (slot.exclusive != nullptr) {
+        slot.exclusive();
+    } else {
+        // Copy so handlers may add/remove themselves while running
+        std::vector<SharedHandler> handlers = slot.shared;
+        for (const SharedHandler& entry : handlers) {
+            entry.handler();
+        }
+    }
+
+    slot.stats.dispatch_count++;
+    slot.stats.cycles += g_now - start;
+    g_in_irq = false;
+    return true;
+}
+
+uint64_t next_event_cycle() {
+    uint64_t next = pio_next_event();
+    next = std::min(next, uart_next_event());
+    next = std::min(next, spi_next_event());
+    next = std::min(next, dma_next_event());
+    next = std::min(next, timer_next_event());
+    return next;
+}
+
+void process_events(uint64_t cycle) {
+    pio_process(cycle);
+    uart_process(cycle);
+    spi_process(cycle);
+    dma_process(cycle);
+    timer_process(cycle);
+}
+
+} // namespace
+
+uint64_t now() {
+    return g_now;
+}
+
+void run_until(uint64_t cycle) {
+    for (;;) {
+        if (dispatch_one_irq()) {
+            if (g_now >= cycle) {
+                break;
+            }
+            continue;
+        }
+
+        uint64_t next = next_event_cycle();
+        if (next > cycle) {
+            break;
+        }
+
+        if (next > g_now) {
+            g_now = next;
+        }
+        process_events(g_now);
+    }
+
+    if (g_now < cycle) {
+        g_now = cycle;
+    }
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+// ===========================================
+// Simulation control
+// ===========================================
+
+void host_sim_reset(void) {
+    for (uint num = 0; num < NUM_IRQS; num++) {
+        g_irqs[num].exclusive = nullptr;
+        g_irqs[num].shared.clear();
+        g_irqs[num].enabled = false;
+        g_irqs[num].forced = false;
+        g_irqs[num].priority = PICO_DEFAULT_IRQ_PRIORITY;
+        g_irqs[num].stats = {};
+    }
+
+    g_now = 0;
+    g_in_irq = false;
+    g_irqs_masked = false;
+
+    reset_time();
+    reset_timer();
+    reset_dma();
+    reset_pio();
+    reset_uart();
+    reset_spi();
+    reset_gpio();
+}
+
+uint64_t host_sim_get_cycles(void) {
+    return g_now;
+}
+
+void host_sim_run_cycles(uint64_t cycles) {
+    run_until(g_now + cycles);
+}
+
+void host_sim_run_until_cycle(uint64_t cycle) {
+    run_until(cycle);
+}
+
+void host_sim_run_us(uint64_t us) {
+    run_until(us_to_cycles_ceil(cycles_to_us(g_now) + us));
+}
+
+void host_sim_set_gpio_trace(host_sim_gpio_trace_fn fn, void* context) {
+    gpio_set_trace(fn, context);
+}
+
+host_sim_irq_stats_t host_sim_get_irq_stats(uint irq) {
+    if (irq >= NUM_IRQS) {
+        return host_sim_irq_stats_t{};
+    }
+    return g_irqs[irq].stats;
+}
+
+void host_sim_reset_irq_stats(void) {
+    for (uint num = 0; num < NUM_IRQS; num++) {
+        g_irqs[num].stats = {};
+    }
+}
+
+bool host_sim_in_irq(void) {
+    return g_in_irq;
+}
+
+// ===========================================
+// hardware/irq.h
+// ===========================================
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num < NUM_IRQS) {
+        g_irqs[num].enabled = enabled;
+    }
+}
+
+bool irq_is_enabled(uint num) {
+    return num < NUM_IRQS && g_irqs[num].enabled;
+}
+
+void irq_set_mask_enabled(uint32_t mask, bool enabled) {
+    for (uint num = 0; num < NUM_IRQS; num++) {
+        if (mask & (1u << num)) {
+            g_irqs[num].enabled = enabled;
+        }
+    }
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+    if (num < NUM_IRQS) {
+        g_irqs[num].priority = hardware_priority;
+    }
+}
+
+uint irq_get_priority(uint num) {
+    return num < NUM_IRQS ? g_irqs[num].priority : 0;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num >= NUM_IRQS) {
+        panic("irq_set_exclusive_handler: invalid IRQ %u", num);
+    }
+
+    IrqSlot& slot = g_irqs[num];
+    if (!slot.shared.empty()) {
+        panic("irq_set_exclusive_handler: IRQ %u already has shared handlers", num);
+    }
+    if (slot.exclusive != nullptr && slot.exclusive != handler) {
+        fprintf(stderr, "host-hal: warning: exclusive handler for IRQ %u replaced\n", num);
+    }
+    slot.exclusive = handler;
+}
+
+irq_handler_t irq_get_exclusive_handler(uint num) {
+    return num < NUM_IRQS ? g_irqs[num].exclusive : nullptr;
+}
+
+bool irq_has_shared_handler(uint num) {
+    return num < NUM_IRQS && !g_irqs[num].shared.empty();
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    if (num >= NUM_IRQS) {
+        panic("irq_add_shared_handler: invalid IRQ %u", num);
+    }
+
+    IrqSlot& slot = g_irqs[num];
+    if (slot.exclusive != nullptr) {
+        panic("irq_add_shared_handler: IRQ %u already has an exclusive handler", num);
+    }
+
+    // Higher order priority runs first; equal priorities keep insertion order
+    auto pos = std::find_if(slot.shared.begin(), slot.shared.end(),
+                            [order_priority](const SharedHandler& entry) {
+                                return entry.order_priority < order_priority;
+                            });
+    slot.shared.insert(pos, SharedHandler{handler, order_priority});
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    if (num >= NUM_IRQS) {
+        return;
+    }
+
+    IrqSlot& slot = g_irqs[num];
+    if (slot.exclusive == handler) {
+        slot.exclusive = nullptr;
+        return;
+    }
+
+    slot.shared.erase(std::remove_if(slot.shared.begin(), slot.shared.end(),
+                                     [handler](const SharedHandler& entry) {
+                                         return entry.handler == handler;
+                                     }),
+                      slot.shared.end());
+}
+
+void irq_set_pending(uint num) {
+    if (num < NUM_IRQS) {
+        g_irqs[num].forced = true;
+    }
+}
+
+// ===========================================
+// hardware/sync.h
+// ===========================================
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = g_irqs_masked ? 1 : 0;
+    g_irqs_masked = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    g_irqs_masked = (status != 0);
+}
+
+// ===========================================
+// Miscellaneous SDK runtime
+// ===========================================
+
+void panic(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "*** PANIC ***\n");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    abort();
+}
+
+bool stdio_init_all(void) {
+    // Line-buffer stdout so example output interleaves sensibly when piped
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    return true;
+}
+
+void tight_loop_contents(void) {
+    run_until(g_now + HOST_SIM_POLL_CYCLES);
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    (void)entry;
+    panic("multicore_launch_core1: core 1 is not simulated");
+}
+
+void multicore_reset_core1(void) {
+}
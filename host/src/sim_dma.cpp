@@ -0,0 +1,472 @@
+#include "sim_internal.h"
+#include "pico/stdlib.h"
+#include <cstring>
+
+namespace host_sim {
+
+namespace {
+
+struct Channel {
+    bool claimed;
+    bool busy;
+    uint32_t ctrl;
+    uintptr_t read_addr;
+    uintptr_t write_addr;
+    uint32_t trans_count;           // Live counter
+    uint32_t trans_count_reload;    // Value written to TRANS_COUNT
+};
+
+Channel g_channels[NUM_DMA_CHANNELS];
+uint32_t g_intr;
+uint32_t g_inte[2];
+uint64_t g_last_transfer_cycle;
+uint g_round_robin;
+
+void check_channel(uint channel) {
+    if (channel >= NUM_DMA_CHANNELS) {
+        panic("Invalid DMA channel %u", channel);
+    }
+}
+
+uint treq_of(const Channel& ch) {
+    return (ch.ctrl & DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS) >> DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB;
+}
+
+uint size_of(const Channel& ch) {
+    return 1u << ((ch.ctrl & DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB);
+}
+
+uint chain_of(const Channel& ch) {
+    return (ch.ctrl & DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS) >> DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB;
+}
+
+bool dreq_ready(uint dreq) {
+    if (dreq == DREQ_FORCE) {
+        return true;
+    }
+    if (dreq < 16) {
+        return pio_dreq_ready(dreq);
+    }
+    if (dreq >= DREQ_UART0_TX && dreq <= DREQ_UART1_RX) {
+        return uart_dreq_ready(dreq);
+    }
+    if (dreq >= DREQ_SPI0_TX && dreq <= DREQ_SPI1_RX) {
+        return spi_dreq_ready(dreq);
+    }
+    panic("DREQ %u is not simulated", dreq);
+}
+
+bool channel_ready(const Channel& ch) {
+    return ch.busy && (ch.trans_count == 0 || dreq_ready(treq_of(ch)));
+}
+
+uintptr_t advance_addr(uintptr_t addr, uint size, bool ring_selected, uint ring_bits) {
+    if (ring_selected && ring_bits > 0) {
+        uintptr_t mask = ((uintptr_t)1 << ring_bits) - 1;
+        return (addr & ~mask) | ((addr + size) & mask);
+    }
+    return addr + size;
+}
+
+void trigger(uint channel);
+
+// Register behind each word of dma_channel_hw_t
+enum class Reg : uint8_t { READ_ADDR, WRITE_ADDR, TRANS_COUNT, CTRL };
+
+constexpr Reg CHANNEL_REGS[16] = {
+    Reg::READ_ADDR, Reg::WRITE_ADDR, Reg::TRANS_COUNT, Reg::CTRL,
+    Reg::CTRL, Reg::READ_ADDR, Reg::WRITE_ADDR, Reg::TRANS_COUNT,
+    Reg::CTRL, Reg::TRANS_COUNT, Reg::READ_ADDR, Reg::WRITE_ADDR,
+    Reg::CTRL, Reg::WRITE_ADDR, Reg::TRANS_COUNT, Reg::READ_ADDR
+};
+
+uintptr_t replace_low_half(uintptr_t addr, uint32_t value) {
+    return (addr & ~(uintptr_t)0xffffffffu) | value;
+}
+
+// CPU reads of read_addr see the low half of the live read address
+void mirror_read_addr(uint channel) {
+    host_dma_hw.ch[channel].read_addr = (uint32_t)g_channels[channel].read_addr;
+}
+
+// A DMA write to a channel register; the last register of each alias
+// group triggers the channel
+bool dma_port_write(uintptr_t addr, uint32_t value) {
+    uintptr_t base = (uintptr_t)&host_dma_hw.ch[0];
+    if (addr < base || addr >= base + sizeof(host_dma_hw.ch)) {
+        return false;
+    }
+    uint channel = (uint)((addr - base) / sizeof(dma_channel_hw_t));
+    uint index = (uint)((addr - base) % sizeof(dma_channel_hw_t)) / 4;
+    Channel& ch = g_channels[channel];
+
+    switch (CHANNEL_REGS[index]) {
+        case Reg::READ_ADDR:
+            ch.read_addr = replace_low_half(ch.read_addr, value);
+            mirror_read_addr(channel);
+            break;
+        case Reg::WRITE_ADDR:
+            ch.write_addr = replace_low_half(ch.write_addr, value);
+            break;
+        case Reg::TRANS_COUNT:
+            ch.trans_count_reload = value;
+            if (!ch.busy) {
+                ch.trans_count = value;
+            }
+            break;
+        case Reg::CTRL:
+            ch.ctrl = value;
+            break;
+    }
+    if ((index & 3) == 3) {
+        trigger(channel);
+    }
+    return true;
+}
+
+void complete(uint channel) {
+    Channel& ch = g_channels[channel];
+    ch.busy = false;
+
+    if (!(ch.ctrl & DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS)) {
+        g_intr |= 1u << channel;
+    }
+
+    uint chain_to = chain_of(ch);
+    if (chain_to != channel) {
+        trigger(chain_to);
+    }
+}
+
+void transfer(uint channel) {
+    Channel& ch = g_channels[channel];
+    uint size = size_of(ch);
+
+    uint32_t value = 0;
+    if (!pio_port_read(ch.read_addr, value)) {
+        memcpy(&value, (const void*)ch.read_addr, size);
+    }
+
+    if (ch.ctrl & DMA_CH0_CTRL_TRIG_BSWAP_BITS) {
+        if (size == 4) {
+            value = __builtin_bswap32(value);
+        } else if (size == 2) {
+            value = __builtin_bswap16((uint16_t)value);
+        }
+    }
+
+    // Narrow writes to a peripheral register are replicated across all
+    // byte lanes of the 32-bit bus, as on the RP2040
+    uint32_t bus_value = value;
+    if (size == 1) {
+        bus_value = (value & 0xff) * 0x01010101u;
+    } else if (size == 2) {
+        bus_value = (value & 0xffff) * 0x00010001u;
+    }
+
+    if (!pio_port_write(ch.write_addr, bus_value) && !uart_port_write(ch.write_addr, bus_value) &&
+        !spi_port_write(ch.write_addr, bus_value) && !dma_port_write(ch.write_addr, bus_value)) {
+        memcpy((void*)ch.write_addr, &value, size);
+    }
+
+    bool ring_write = (ch.ctrl & DMA_CH0_CTRL_TRIG_RING_SEL_BITS) != 0;
+    uint ring_bits = (ch.ctrl & DMA_CH0_CTRL_TRIG_RING_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_RING_SIZE_LSB;
+    if (ch.ctrl & DMA_CH0_CTRL_TRIG_INCR_READ_BITS) {
+        ch.read_addr = advance_addr(ch.read_addr, size, !ring_write, ring_bits);
+        mirror_read_addr(channel);
+    }
+    if (ch.ctrl & DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS) {
+        ch.write_addr = advance_addr(ch.write_addr, size, ring_write, ring_bits);
+    }
+
+    ch.trans_count--;
+    if (ch.trans_count == 0) {
+        complete(channel);
+    }
+}
+
+void trigger(uint channel) {
+    Channel& ch = g_channels[channel];
+    if (!(ch.ctrl & DMA_CH0_CTRL_TRIG_EN_BITS)) {
+        return;
+    }
+
+    ch.trans_count = ch.trans_count_reload;
+    if (ch.trans_count == 0) {
+        // Null trigger: completes at once and always raises the interrupt
+        g_intr |= 1u << channel;
+        return;
+    }
+    ch.busy = true;
+}
+
+} // namespace
+
+uint64_t dma_next_event() {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (channel_ready(g_channels[i])) {
+            uint64_t cycle = now();
+            return (g_last_transfer_cycle == cycle) ? cycle + 1 : cycle;
+        }
+    }
+    return NO_EVENT;
+}
+
+// The bus moves at most one DMA transfer per system cycle; ready channels
+// are served round-robin.
+void dma_process(uint64_t cycle) {
+    if (g_last_transfer_cycle == cycle) {
+        return;
+    }
+
+    for (uint n = 0; n < NUM_DMA_CHANNELS; n++) {
+        uint channel = (g_round_robin + n) % NUM_DMA_CHANNELS;
+        if (!channel_ready(g_channels[channel])) {
+            continue;
+        }
+
+        g_round_robin = (channel + 1) % NUM_DMA_CHANNELS;
+        g_last_transfer_cycle = cycle;
+        if (g_channels[channel].trans_count == 0) {
+            complete(channel);
+        } else {
+            transfer(channel);
+        }
+        return;
+    }
+}
+
+bool dma_irq_pending(uint irq_index) {
+    return (g_intr & g_inte[irq_index]) != 0;
+}
+
+void reset_dma() {
+    memset(g_channels, 0, sizeof(g_channels));
+    g_intr = 0;
+    g_inte[0] = 0;
+    g_inte[1] = 0;
+    g_last_transfer_cycle = NO_EVENT;
+    g_round_robin = 0;
+    memset(&host_dma_hw, 0, sizeof(host_dma_hw));
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+dma_hw_t host_dma_hw;
+
+dma_channel_config dma_get_channel_config(uint channel) {
+    check_channel(channel);
+    dma_channel_config config = {g_channels[channel].ctrl};
+    return config;
+}
+
+// ===========================================
+// Channel claiming
+// ===========================================
+
+void dma_channel_claim(uint channel) {
+    check_channel(channel);
+    if (g_channels[channel].claimed) {
+        panic("DMA channel %u is already claimed", channel);
+    }
+    g_channels[channel].claimed = true;
+}
+
+void dma_claim_mask(uint32_t channel_mask) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (channel_mask & (1u << i)) {
+            dma_channel_claim(i);
+        }
+    }
+}
+
+void dma_channel_unclaim(uint channel) {
+    check_channel(channel);
+    g_channels[channel].claimed = false;
+}
+
+void dma_unclaim_mask(uint32_t channel_mask) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (channel_mask & (1u << i)) {
+            dma_channel_unclaim(i);
+        }
+    }
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!g_channels[i].claimed) {
+            g_channels[i].claimed = true;
+            return (int)i;
+        }
+    }
+    if (required) {
+        panic("No DMA channels are available");
+    }
+    return -1;
+}
+
+bool dma_channel_is_claimed(uint channel) {
+    check_channel(channel);
+    return g_channels[channel].claimed;
+}
+
+// ===========================================
+// Channel programming
+// ===========================================
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger_now) {
+    check_channel(channel);
+    g_channels[channel].ctrl = config->ctrl;
+    if (trigger_now) {
+        trigger(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger_now) {
+    check_channel(channel);
+    g_channels[channel].read_addr = (uintptr_t)read_addr;
+    mirror_read_addr(channel);
+    if (trigger_now) {
+        trigger(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger_now) {
+    check_channel(channel);
+    g_channels[channel].write_addr = (uintptr_t)write_addr;
+    if (trigger_now) {
+        trigger(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger_now) {
+    check_channel(channel);
+    Channel& ch = g_channels[channel];
+    ch.trans_count_reload = trans_count;
+    if (!ch.busy) {
+        ch.trans_count = trans_count;
+    }
+    if (trigger_now) {
+        trigger(channel);
+    }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger_now) {
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_config(channel, config, trigger_now);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void* read_addr, uint32_t transfer_count) {
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, true);
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void* write_addr, uint32_t transfer_count) {
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, true);
+}
+
+// ===========================================
+// Channel control
+// ===========================================
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (chan_mask & (1u << i)) {
+            trigger(i);
+        }
+    }
+}
+
+void dma_channel_start(uint channel) {
+    check_channel(channel);
+    trigger(channel);
+}
+
+void dma_channel_abort(uint channel) {
+    check_channel(channel);
+    g_channels[channel].busy = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    check_channel(channel);
+    return g_channels[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while (dma_channel_is_busy(channel)) {
+        tight_loop_contents();
+    }
+}
+
+uint32_t dma_channel_get_transfer_count(uint channel) {
+    check_channel(channel);
+    return g_channels[channel].trans_count;
+}
+
+const volatile void* dma_channel_get_read_addr(uint channel) {
+    check_channel(channel);
+    return (const volatile void*)g_channels[channel].read_addr;
+}
+
+// ===========================================
+// Interrupts
+// ===========================================
+
+void dma_irqn_set_channel_enabled(uint irq_index, uint channel, bool enabled) {
+    check_channel(channel);
+    if (enabled) {
+        g_inte[irq_index & 1] |= 1u << channel;
+    } else {
+        g_inte[irq_index & 1] &= ~(1u << channel);
+    }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    dma_irqn_set_channel_enabled(0, channel, enabled);
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    dma_irqn_set_channel_enabled(1, channel, enabled);
+}
+
+void dma_set_irq0_channel_mask_enabled(uint32_t channel_mask, bool enabled) {
+    g_inte[0] = enabled ? (g_inte[0] | channel_mask) : (g_inte[0] & ~channel_mask);
+}
+
+void dma_set_irq1_channel_mask_enabled(uint32_t channel_mask, bool enabled) {
+    g_inte[1] = enabled ? (g_inte[1] | channel_mask) : (g_inte[1] & ~channel_mask);
+}
+
+bool dma_irqn_get_channel_status(uint irq_index, uint channel) {
+    check_channel(channel);
+    return (g_intr & g_inte[irq_index & 1] & (1u << channel)) != 0;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return dma_irqn_get_channel_status(0, channel);
+}
+
+bool dma_channel_get_irq1_status(uint channel) {
+    return dma_irqn_get_channel_status(1, channel);
+}
+
+void dma_irqn_acknowledge_channel(uint irq_index, uint channel) {
+    (void)irq_index;
+    check_channel(channel);
+    g_intr &= ~(1u << channel);
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    dma_irqn_acknowledge_channel(0, channel);
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+    dma_irqn_acknowledge_channel(1, channel);
+}
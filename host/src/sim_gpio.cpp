@@ -0,0 +1,231 @@
+#include "sim_internal.h"
+
+namespace host_sim {
+
+namespace {
+
+struct Pin {
+    enum gpio_function function;
+    bool sio_out;
+    bool sio_oe;
+    bool pull_up;
+    bool pull_down;
+    bool level;
+};
+
+Pin g_pins[NUM_BANK0_GPIOS];
+host_sim_gpio_trace_fn g_trace_fn = nullptr;
+void* g_trace_context = nullptr;
+
+// GPIOs 0-3, 12-19 and 28-29 belong to UART0; the rest to UART1. Within
+// each group of four the first pin is TX.
+uint uart_index_for_pin(uint gpio) {
+    return ((gpio + 4) >> 3) & 1;
+}
+
+bool compute_level(uint gpio) {
+    const Pin& pin = g_pins[gpio];
+    bool pulled = pin.pull_up && !pin.pull_down;
+    bool level;
+
+    switch (pin.function) {
+        case GPIO_FUNC_SIO:
+            return pin.sio_oe ? pin.sio_out : pulled;
+        case GPIO_FUNC_PIO0:
+            return pio_pin_drive(0, gpio, level) ? level : pulled;
+        case GPIO_FUNC_PIO1:
+            return pio_pin_drive(1, gpio, level) ? level : pulled;
+        case GPIO_FUNC_UART:
+            if ((gpio & 3) == 0) {
+                return uart_tx_level(uart_index_for_pin(gpio));
+            }
+            return pulled;
+        case GPIO_FUNC_SPI:
+            // Third pin of each group of four is SCK, fourth is TX; the
+            // groups alternate between SPI0 and SPI1 every eight GPIOs
+            if ((gpio & 3) >= 2) {
+                return spi_pin_level((gpio >> 3) & 1, (gpio & 3) == 2);
+            }
+            return pulled;
+        default:
+            return pulled;
+    }
+}
+
+} // namespace
+
+void gpio_refresh(uint32_t mask) {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (!(mask & (1u << gpio))) {
+            continue;
+        }
+
+        bool level = compute_level(gpio);
+        if (level != g_pins[gpio].level) {
+            g_pins[gpio].level = level;
+            if (g_trace_fn != nullptr) {
+                g_trace_fn(g_trace_context, gpio, level, now());
+            }
+        }
+    }
+}
+
+uint32_t gpio_levels() {
+    uint32_t levels = 0;
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (g_pins[gpio].level) {
+            levels |= 1u << gpio;
+        }
+    }
+    return levels;
+}
+
+void gpio_set_trace(host_sim_gpio_trace_fn fn, void* context) {
+    g_trace_fn = fn;
+    g_trace_context = context;
+}
+
+void reset_gpio() {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        g_pins[gpio] = Pin{GPIO_FUNC_NULL, false, false, false, true, false};
+    }
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+namespace {
+
+constexpr uint32_t ALL_PINS = (1u << NUM_BANK0_GPIOS) - 1;
+
+void check_gpio(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) {
+        panic("Invalid GPIO %u", gpio);
+    }
+}
+
+} // namespace
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    check_gpio(gpio);
+    g_pins[gpio].function = fn;
+    gpio_refresh(1u << gpio);
+}
+
+enum gpio_function gpio_get_function(uint gpio) {
+    check_gpio(gpio);
+    return g_pins[gpio].function;
+}
+
+void gpio_init(uint gpio) {
+    check_gpio(gpio);
+    g_pins[gpio].sio_oe = false;
+    g_pins[gpio].sio_out = false;
+    gpio_set_function(gpio, GPIO_FUNC_SIO);
+}
+
+void gpio_init_mask(uint gpio_mask) {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (gpio_mask & (1u << gpio)) {
+            gpio_init(gpio);
+        }
+    }
+}
+
+void gpio_deinit(uint gpio) {
+    gpio_set_function(gpio, GPIO_FUNC_NULL);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    check_gpio(gpio);
+    g_pins[gpio].sio_oe = out;
+    gpio_refresh(1u << gpio);
+}
+
+void gpio_set_dir_out_masked(uint32_t mask) {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (mask & (1u << gpio)) {
+            g_pins[gpio].sio_oe = true;
+        }
+    }
+    gpio_refresh(mask & ALL_PINS);
+}
+
+void gpio_set_dir_in_masked(uint32_t mask) {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (mask & (1u << gpio)) {
+            g_pins[gpio].sio_oe = false;
+        }
+    }
+    gpio_refresh(mask & ALL_PINS);
+}
+
+bool gpio_is_dir_out(uint gpio) {
+    check_gpio(gpio);
+    return g_pins[gpio].sio_oe;
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (mask & (1u << gpio)) {
+            g_pins[gpio].sio_out = (value >> gpio) & 1;
+        }
+    }
+    gpio_refresh(mask & ALL_PINS);
+}
+
+void gpio_put(uint gpio, bool value) {
+    check_gpio(gpio);
+    gpio_put_masked(1u << gpio, value ? (1u << gpio) : 0);
+}
+
+void gpio_put_all(uint32_t value) {
+    gpio_put_masked(ALL_PINS, value);
+}
+
+void gpio_set_mask(uint32_t mask) {
+    gpio_put_masked(mask, mask);
+}
+
+void gpio_clr_mask(uint32_t mask) {
+    gpio_put_masked(mask, 0);
+}
+
+void gpio_xor_mask(uint32_t mask) {
+    uint32_t current = 0;
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (g_pins[gpio].sio_out) {
+            current |= 1u << gpio;
+        }
+    }
+    gpio_put_masked(mask, current ^ mask);
+}
+
+bool gpio_get(uint gpio) {
+    check_gpio(gpio);
+    return g_pins[gpio].level;
+}
+
+uint32_t gpio_get_all(void) {
+    return gpio_levels();
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+    check_gpio(gpio);
+    g_pins[gpio].pull_up = up;
+    g_pins[gpio].pull_down = down;
+    gpio_refresh(1u << gpio);
+}
+
+void gpio_pull_up(uint gpio) {
+    gpio_set_pulls(gpio, true, false);
+}
+
+void gpio_pull_down(uint gpio) {
+    gpio_set_pulls(gpio, false, true);
+}
+
+void gpio_disable_pulls(uint gpio) {
+    gpio_set_pulls(gpio, false, false);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "host_sim.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/uart.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+// Interfaces between the simulated peripherals and the scheduler in
+// sim_core.cpp. Each peripheral exposes the time of its next internal event
+// and processes every event due at a given cycle; the scheduler always
+// advances to the earliest pending event.
+
+namespace host_sim {
+
+constexpr uint64_t NO_EVENT = UINT64_MAX;
+
+// Scheduler (sim_core.cpp)
+uint64_t now();
+void run_until(uint64_t cycle);
+
+// Time base (sim_time.cpp)
+uint64_t cycles_to_us(uint64_t cycle);
+uint64_t us_to_cycles_ceil(uint64_t us);
+void reset_time();
+
+// GPIO (sim_gpio.cpp)
+void gpio_refresh(uint32_t mask);
+uint32_t gpio_levels();
+void gpio_set_trace(host_sim_gpio_trace_fn fn, void* context);
+void reset_gpio();
+
+// PIO (sim_pio.cpp)
+uint64_t pio_next_event();
+void pio_process(uint64_t cycle);
+bool pio_pin_drive(uint pio_index, uint pin, bool& level);
+bool pio_dreq_ready(uint dreq);
+bool pio_port_write(uintptr_t addr, uint32_t value);
+bool pio_port_read(uintptr_t addr, uint32_t& value);
+bool pio_irq_pending(uint pio_index, uint irq_index);
+void reset_pio();
+
+// UART (sim_uart.cpp)
+uint64_t uart_next_event();
+void uart_process(uint64_t cycle);
+bool uart_tx_level(uint uart_index);
+bool uart_dreq_ready(uint dreq);
+bool uart_port_write(uintptr_t addr, uint32_t value);
+bool uart_irq_pending(uint uart_index);
+void reset_uart();
+
+// SPI (sim_spi.cpp)
+uint64_t spi_next_event();
+void spi_process(uint64_t cycle);
+bool spi_pin_level(uint spi_index, bool sck);
+bool spi_dreq_ready(uint dreq);
+bool spi_port_write(uintptr_t addr, uint32_t value);
+void reset_spi();
+
+// Timer alarms (sim_timer.cpp)
+uint64_t timer_next_event();
+void timer_process(uint64_t cycle);
+bool timer_irq_pending(uint alarm_num);
+void reset_timer();
+
+// DMA (sim_dma.cpp)
+uint64_t dma_next_event();
+void dma_process(uint64_t cycle);
+bool dma_irq_pending(uint irq_index);
+void reset_dma();
+
+} // namespace host_sim
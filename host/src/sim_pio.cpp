@@ -0,0 +1,1018 @@
+#include "sim_internal.h"
+#include "pico/stdlib.h"
+#include <cstring>
+
+namespace host_sim {
+
+namespace {
+
+constexpr uint FIFO_DEPTH = 4;
+
+struct Fifo {
+    uint32_t data[FIFO_DEPTH * 2];
+    uint head;
+    uint count;
+    uint depth;
+
+    bool empty() const { return count == 0; }
+    bool full() const { return count >= depth; }
+
+    void push(uint32_t value) {
+        data[(head + count) % (FIFO_DEPTH * 2)] = value;
+        count++;
+    }
+
+    uint32_t pop() {
+        uint32_t value = data[head];
+        head = (head + 1) % (FIFO_DEPTH * 2);
+        count--;
+        return value;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+};
+
+enum class Block {
+    NONE,
+    TX_EMPTY,
+    RX_FULL
+};
+
+struct StateMachine {
+    pio_sm_config config;
+    bool claimed;
+    bool enabled;
+    uint8_t pc;
+    uint32_t x;
+    uint32_t y;
+    uint32_t isr;
+    uint32_t osr;
+    uint8_t isr_count;
+    uint8_t osr_count;
+    Fifo tx;
+    Fifo rx;
+    uint64_t next_tick_fp;      // Next SM clock edge, in 1/256 system cycles
+    bool stalled;               // Current instruction has not completed
+    Block blocked;              // Stalled on a FIFO; ticks suspended until it changes
+    bool irq_waiting;           // "irq wait" has raised its flag and awaits the clear
+    bool exec_pending;
+    uint16_t exec_instr;
+};
+
+struct PioBlock {
+    uint16_t instr_mem[PIO_INSTRUCTION_COUNT];
+    uint32_t used_mask;
+    StateMachine sm[NUM_PIO_STATE_MACHINES];
+    uint32_t pin_out;
+    uint32_t pin_oe;
+    uint8_t irq_flags;
+    uint32_t inte[2];
+};
+
+PioBlock g_pio[NUM_PIOS];
+
+PioBlock& block_of(PIO pio) {
+    return g_pio[pio_get_index(pio)];
+}
+
+uint threshold(uint8_t value) {
+    return value == 0 ? 32 : value;
+}
+
+uint64_t clkdiv_fp(const pio_sm_config& config) {
+    uint64_t div_int = config.clkdiv_int == 0 ? 65536 : config.clkdiv_int;
+    return div_int * 256 + config.clkdiv_frac;
+}
+
+void update_fifo_depths(StateMachine& sm) {
+    switch (sm.config.fifo_join) {
+        case PIO_FIFO_JOIN_TX:
+            sm.tx.depth = FIFO_DEPTH * 2;
+            sm.rx.depth = 0;
+            break;
+        case PIO_FIFO_JOIN_RX:
+            sm.tx.depth = 0;
+            sm.rx.depth = FIFO_DEPTH * 2;
+            break;
+        default:
+            sm.tx.depth = FIFO_DEPTH;
+            sm.rx.depth = FIFO_DEPTH;
+            break;
+    }
+}
+
+uint32_t pin_mask(uint base, uint count) {
+    uint32_t mask = 0;
+    for (uint i = 0; i < count; i++) {
+        mask |= 1u << ((base + i) & 31);
+    }
+    return mask;
+}
+
+// Write `count` consecutive pins starting at `base` (wrapping at 32) from
+// the low bits of `value`, into either the output or the direction register.
+void write_pins(PioBlock& blk, uint base, uint count, uint32_t value, bool dirs) {
+    uint32_t& reg = dirs ? blk.pin_oe : blk.pin_out;
+    uint32_t mask = pin_mask(base, count);
+    uint32_t rotated = (base & 31) ? ((value << (base & 31)) | (value >> (32 - (base & 31)))) : value;
+    reg = (reg & ~mask) | (rotated & mask);
+    gpio_refresh(mask);
+}
+
+uint32_t read_pins(uint base) {
+    uint32_t levels = gpio_levels();
+    return (base & 31) ? ((levels >> (base & 31)) | (levels << (32 - (base & 31)))) : levels;
+}
+
+void align_to_now(StateMachine& sm) {
+    uint64_t now_fp = now() * 256;
+    uint64_t div = clkdiv_fp(sm.config);
+    if (sm.next_tick_fp < now_fp) {
+        uint64_t ticks = (now_fp - sm.next_tick_fp + div - 1) / div;
+        sm.next_tick_fp += ticks * div;
+    }
+}
+
+void unblock(StateMachine& sm, Block reason) {
+    if (sm.blocked == reason) {
+        sm.blocked = Block::NONE;
+        align_to_now(sm);
+    }
+}
+
+uint resolve_irq_index(uint index, uint sm_index) {
+    uint irq = index & 7;
+    if (index & 0x10) {
+        irq = (irq & 4) | ((irq + sm_index) & 3);
+    }
+    return irq;
+}
+
+void apply_sideset(PioBlock& blk, StateMachine& sm, uint16_t instr) {
+    uint count = sm.config.sideset_count;
+    if (count == 0) {
+        return;
+    }
+
+    uint field = (instr >> 8) & 0x1f;
+    uint side = field >> (5 - count);
+    uint bits = count;
+    if (sm.config.sideset_optional) {
+        if (!((side >> (count - 1)) & 1)) {
+            return;
+        }
+        bits = count - 1;
+        side &= (1u << bits) - 1;
+    }
+
+    write_pins(blk, sm.config.sideset_base, bits, side, sm.config.sideset_pindirs);
+}
+
+uint delay_of(const StateMachine& sm, uint16_t instr) {
+    uint field = (instr >> 8) & 0x1f;
+    uint delay_bits = 5 - sm.config.sideset_count;
+    return field & ((1u << delay_bits) - 1);
+}
+
+struct ExecResult {
+    bool completed;
+    bool jumped;
+    uint8_t target;
+    Block block_reason;
+};
+
+void refill_osr(StateMachine& sm) {
+    if (sm.config.autopull && sm.osr_count >= threshold(sm.config.pull_threshold) && !sm.tx.empty()) {
+        sm.osr = sm.tx.pop();
+        sm.osr_count = 0;
+    }
+}
+
+uint32_t shift_out(StateMachine& sm, uint bit_count) {
+    uint32_t data;
+    if (bit_count == 32) {
+        data = sm.osr;
+        sm.osr = 0;
+    } else if (sm.config.out_shift_right) {
+        data = sm.osr & ((1u << bit_count) - 1);
+        sm.osr >>= bit_count;
+    } else {
+        data = sm.osr >> (32 - bit_count);
+        sm.osr <<= bit_count;
+    }
+    sm.osr_count = (uint8_t)((sm.osr_count + bit_count > 32) ? 32 : sm.osr_count + bit_count);
+    return data;
+}
+
+void shift_in(StateMachine& sm, uint32_t data, uint bit_count) {
+    if (bit_count == 32) {
+        sm.isr = data;
+    } else {
+        data &= (1u << bit_count) - 1;
+        if (sm.config.in_shift_right) {
+            sm.isr = (sm.isr >> bit_count) | (data << (32 - bit_count));
+        } else {
+            sm.isr = (sm.isr << bit_count) | data;
+        }
+    }
+    sm.isr_count = (uint8_t)((sm.isr_count + bit_count > 32) ? 32 : sm.isr_count + bit_count);
+}
+
+uint32_t mov_source(PioBlock& blk, StateMachine& sm, uint src) {
+    (void)blk;
+    switch (src) {
+        case 0: return read_pins(sm.config.in_base);
+        case 1: return sm.x;
+        case 2: return sm.y;
+        case 5: {
+            uint level = sm.config.mov_status_sel == STATUS_TX_LESSTHAN ? sm.tx.count : sm.rx.count;
+            return level < sm.config.mov_status_n ? 0xffffffffu : 0;
+        }
+        case 6: return sm.isr;
+        case 7: return sm.osr;
+        default: return 0;
+    }
+}
+
+uint32_t reverse_bits(uint32_t value) {
+    uint32_t result = 0;
+    for (uint i = 0; i < 32; i++) {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+    return result;
+}
+
+ExecResult execute(PioBlock& blk, uint sm_index, uint16_t instr) {
+    StateMachine& sm = blk.sm[sm_index];
+    ExecResult result = {true, false, 0, Block::NONE};
+    uint arg1 = (instr >> 5) & 7;
+    uint arg2 = instr & 0x1f;
+
+    switch (instr >> 13) {
+        case 0: {   // JMP
+            bool take = false;
+            switch (arg1) {
+                case 0: take = true; break;
+                case 1: take = (sm.x == 0); break;
+                case 2: take = (sm.x != 0); sm.x--; break;
+                case 3: take = (sm.y == 0); break;
+                case 4: take = (sm.y != 0); sm.y--; break;
+                case 5: take = (sm.x != sm.y); break;
+                case 6: take = (gpio_levels() >> sm.config.jmp_pin) & 1; break;
+                case 7: take = sm.osr_count < threshold(sm.config.pull_threshold); break;
+            }
+            if (take) {
+                result.jumped = true;
+                result.target = (uint8_t)arg2;
+            }
+            break;
+        }
+
+        case 1: {   // WAIT
+            bool polarity = (arg1 >> 2) & 1;
+            bool satisfied;
+            switch (arg1 & 3) {
+                case 0:
+                    satisfied = ((gpio_levels() >> arg2) & 1) == polarity;
+                    break;
+                case 1:
+                    satisfied = ((read_pins(sm.config.in_base) >> arg2) & 1) == polarity;
+                    break;
+                default: {
+                    uint irq = resolve_irq_index(arg2, sm_index);
+                    satisfied = ((blk.irq_flags >> irq) & 1) == polarity;
+                    if (satisfied && polarity) {
+                        blk.irq_flags &= ~(1u << irq);
+                    }
+                    break;
+                }
+            }
+            result.completed = satisfied;
+            break;
+        }
+
+        case 2: {   // IN
+            uint bit_count = arg2 == 0 ? 32 : arg2;
+            bool will_push = sm.config.autopush &&
+                             sm.isr_count + bit_count >= threshold(sm.config.push_threshold);
+            if (will_push && sm.rx.full()) {
+                result.completed = false;
+                result.block_reason = Block::RX_FULL;
+                break;
+            }
+
+            uint32_t data;
+            switch (arg1) {
+                case 0: data = read_pins(sm.config.in_base); break;
+                case 1: data = sm.x; break;
+                case 2: data = sm.y; break;
+                case 6: data = sm.isr; break;
+                case 7: data = sm.osr; break;
+                default: data = 0; break;
+            }
+            shift_in(sm, data, bit_count);
+
+            if (will_push) {
+                sm.rx.push(sm.isr);
+                sm.isr = 0;
+                sm.isr_count = 0;
+            }
+            break;
+        }
+
+        case 3: {   // OUT
+            uint bit_count = arg2 == 0 ? 32 : arg2;
+            if (sm.config.autopull && sm.osr_count >= threshold(sm.config.pull_threshold)) {
+                if (sm.tx.empty()) {
+                    result.completed = false;
+                    result.block_reason = Block::TX_EMPTY;
+                    break;
+                }
+                sm.osr = sm.tx.pop();
+                sm.osr_count = 0;
+            }
+
+            uint32_t data = shift_out(sm, bit_count);
+            switch (arg1) {
+                case 0: write_pins(blk, sm.config.out_base, sm.config.out_count, data, false); break;
+                case 1: sm.x = data; break;
+                case 2: sm.y = data; break;
+                case 4: write_pins(blk, sm.config.out_base, sm.config.out_count, data, true); break;
+                case 5:
+                    result.jumped = true;
+                    result.target = (uint8_t)(data & 31);
+                    break;
+                case 6:
+                    sm.isr = data;
+                    sm.isr_count = (uint8_t)bit_count;
+                    break;
+                case 7:
+                    sm.exec_pending = true;
+                    sm.exec_instr = (uint16_t)data;
+                    break;
+                default:
+                    break;
+            }
+            refill_osr(sm);
+            break;
+        }
+
+        case 4: {   // PUSH / PULL
+            bool if_flag = (instr >> 6) & 1;
+            bool block = (instr >> 5) & 1;
+            if (!(instr & 0x80)) {
+                if (if_flag && sm.isr_count < threshold(sm.config.push_threshold)) {
+                    break;
+                }
+                if (sm.rx.full()) {
+                    if (block) {
+                        result.completed = false;
+                        result.block_reason = Block::RX_FULL;
+                        break;
+                    }
+                } else {
+                    sm.rx.push(sm.isr);
+                }
+                sm.isr = 0;
+                sm.isr_count = 0;
+            } else {
+                if (if_flag && sm.osr_count < threshold(sm.config.pull_threshold)) {
+                    break;
+                }
+                if (sm.tx.empty()) {
+                    if (block) {
+                        result.completed = false;
+                        result.block_reason = Block::TX_EMPTY;
+                        break;
+                    }
+                    sm.osr = sm.x;
+                } else {
+                    sm.osr = sm.tx.pop();
+                }
+                sm.osr_count = 0;
+            }
+            break;
+        }
+
+        case 5: {   // MOV
+            uint op = (instr >> 3) & 3;
+            uint32_t data = mov_source(blk, sm, instr & 7);
+            if (op == 1) {
+                data = ~data;
+            } else if (op == 2) {
+                data = reverse_bits(data);
+            }
+            switch (arg1) {
+                case 0: write_pins(blk, sm.config.out_base, sm.config.out_count, data, false); break;
+                case 1: sm.x = data; break;
+                case 2: sm.y = data; break;
+                case 4:
+                    sm.exec_pending = true;
+                    sm.exec_instr = (uint16_t)data;
+                    break;
+                case 5:
+                    result.jumped = true;
+                    result.target = (uint8_t)(data & 31);
+                    break;
+                case 6:
+                    sm.isr = data;
+                    sm.isr_count = 0;
+                    break;
+                case 7:
+                    sm.osr = data;
+                    sm.osr_count = 0;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        }
+
+        case 6: {   // IRQ
+            bool clear = (instr >> 6) & 1;
+            bool wait = (instr >> 5) & 1;
+            uint irq = resolve_irq_index(arg2, sm_index);
+            if (clear) {
+                blk.irq_flags &= ~(1u << irq);
+            } else if (sm.irq_waiting) {
+                if ((blk.irq_flags >> irq) & 1) {
+                    result.completed = false;
+                } else {
+                    sm.irq_waiting = false;
+                }
+            } else {
+                blk.irq_flags |= 1u << irq;
+                if (wait) {
+                    sm.irq_waiting = true;
+                    result.completed = false;
+                }
+            }
+            break;
+        }
+
+        case 7: {   // SET
+            switch (arg1) {
+                case 0: write_pins(blk, sm.config.set_base, sm.config.set_count, arg2, false); break;
+                case 1: sm.x = arg2; break;
+                case 2: sm.y = arg2; break;
+                case 4: write_pins(blk, sm.config.set_base, sm.config.set_count, arg2, true); break;
+                default: break;
+            }
+            break;
+        }
+    }
+
+    return result;
+}
+
+// Execute one SM clock tick: either a fresh instruction or the retry of a
+// stalled one. Side-set takes effect on the first cycle even when stalled;
+// delay cycles only start once the instruction completes.
+void tick(PioBlock& blk, uint sm_index) {
+    StateMachine& sm = blk.sm[sm_index];
+    uint64_t div = clkdiv_fp(sm.config);
+
+    bool from_exec = sm.exec_pending;
+    uint16_t instr = from_exec ? sm.exec_instr : blk.instr_mem[sm.pc];
+    sm.exec_pending = false;
+
+    apply_sideset(blk, sm, instr);
+    ExecResult result = execute(blk, sm_index, instr);
+
+    if (!result.completed) {
+        sm.stalled = true;
+        if (from_exec) {
+            sm.exec_pending = true;
+            sm.exec_instr = instr;
+        }
+        sm.next_tick_fp += div;
+        sm.blocked = result.block_reason;
+        return;
+    }
+
+    sm.stalled = false;
+    uint delay = sm.exec_pending ? 0 : delay_of(sm, instr);
+
+    if (result.jumped) {
+        sm.pc = result.target;
+    } else if (!from_exec) {
+        sm.pc = (sm.pc == sm.config.wrap_top) ? sm.config.wrap_bottom : (uint8_t)((sm.pc + 1) & 31);
+    }
+
+    sm.next_tick_fp += div * (1 + delay);
+}
+
+uint64_t sm_event_cycle(const StateMachine& sm) {
+    if (!sm.enabled || sm.blocked != Block::NONE) {
+        return NO_EVENT;
+    }
+    return (sm.next_tick_fp + 255) / 256;
+}
+
+void restart_sm(StateMachine& sm) {
+    sm.isr = 0;
+    sm.osr = 0;
+    sm.isr_count = 0;
+    sm.osr_count = 32;
+    sm.stalled = false;
+    sm.blocked = Block::NONE;
+    sm.irq_waiting = false;
+    sm.exec_pending = false;
+}
+
+void check_sm(PIO pio, uint sm) {
+    if (pio != pio0 && pio != pio1) {
+        panic("Invalid PIO instance");
+    }
+    if (sm >= NUM_PIO_STATE_MACHINES) {
+        panic("Invalid PIO state machine %u", sm);
+    }
+}
+
+int find_offset_for_program(PioBlock& blk, const pio_program_t* program) {
+    uint32_t program_mask = (1u << program->length) - 1;
+    if (program->origin >= 0) {
+        if ((uint)program->origin + program->length > PIO_INSTRUCTION_COUNT) {
+            return -1;
+        }
+        return (blk.used_mask & (program_mask << program->origin)) ? -1 : program->origin;
+    }
+    for (int offset = PIO_INSTRUCTION_COUNT - program->length; offset >= 0; offset--) {
+        if (!(blk.used_mask & (program_mask << offset))) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+uint64_t pio_next_event() {
+    uint64_t next = NO_EVENT;
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            uint64_t cycle = sm_event_cycle(g_pio[p].sm[s]);
+            if (cycle < next) {
+                next = cycle;
+            }
+        }
+    }
+    return next;
+}
+
+void pio_process(uint64_t cycle) {
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            while (sm_event_cycle(g_pio[p].sm[s]) <= cycle) {
+                tick(g_pio[p], s);
+            }
+        }
+    }
+}
+
+bool pio_pin_drive(uint pio_index, uint pin, bool& level) {
+    const PioBlock& blk = g_pio[pio_index];
+    if (!((blk.pin_oe >> pin) & 1)) {
+        return false;
+    }
+    level = (blk.pin_out >> pin) & 1;
+    return true;
+}
+
+bool pio_dreq_ready(uint dreq) {
+    if (dreq >= 16) {
+        return false;
+    }
+    StateMachine& sm = g_pio[dreq / 8].sm[dreq % 4];
+    return (dreq & 4) ? !sm.rx.empty() : !sm.tx.full();
+}
+
+bool pio_port_write(uintptr_t addr, uint32_t value) {
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            if (addr == (uintptr_t)&host_pio_hw[p].txf[s]) {
+                pio_sm_put(&host_pio_hw[p], s, value);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool pio_port_read(uintptr_t addr, uint32_t& value) {
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            if (addr == (uintptr_t)&host_pio_hw[p].rxf[s]) {
+                value = pio_sm_get(&host_pio_hw[p], s);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool pio_irq_pending(uint pio_index, uint irq_index) {
+    const PioBlock& blk = g_pio[pio_index];
+    uint32_t raw = (uint32_t)(blk.irq_flags & 0xf) << 8;
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+        if (!blk.sm[s].rx.empty()) {
+            raw |= 1u << s;
+        }
+        if (!blk.sm[s].tx.full()) {
+            raw |= 1u << (4 + s);
+        }
+    }
+    return (raw & blk.inte[irq_index]) != 0;
+}
+
+void reset_pio() {
+    memset(g_pio, 0, sizeof(g_pio));
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            StateMachine& sm = g_pio[p].sm[s];
+            sm.config = pio_get_default_sm_config();
+            update_fifo_depths(sm);
+            restart_sm(sm);
+        }
+    }
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+pio_hw_t host_pio_hw[NUM_PIOS];
+
+// ===========================================
+// Instruction memory
+// ===========================================
+
+bool pio_can_add_program(PIO pio, const pio_program_t* program) {
+    return find_offset_for_program(block_of(pio), program) >= 0;
+}
+
+bool pio_can_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset) {
+    uint32_t program_mask = (1u << program->length) - 1;
+    if (offset + program->length > PIO_INSTRUCTION_COUNT) {
+        return false;
+    }
+    return !(block_of(pio).used_mask & (program_mask << offset));
+}
+
+void pio_add_program_at_offset(PIO pio, const pio_program_t* program, uint offset) {
+    if (!pio_can_add_program_at_offset(pio, program, offset)) {
+        panic("No program space");
+    }
+
+    PioBlock& blk = block_of(pio);
+    for (uint i = 0; i < program->length; i++) {
+        uint16_t instr = program->instructions[i];
+        // JMP targets are relative to the program and relocated on load
+        blk.instr_mem[offset + i] = ((instr & 0xe000) == pio_instr_bits_jmp) ? (uint16_t)(instr + offset) : instr;
+    }
+    blk.used_mask |= ((1u << program->length) - 1) << offset;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+    int offset = find_offset_for_program(block_of(pio), program);
+    if (offset < 0) {
+        panic("No program space");
+    }
+    pio_add_program_at_offset(pio, program, (uint)offset);
+    return (uint)offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset) {
+    block_of(pio).used_mask &= ~(((1u << program->length) - 1) << loaded_offset);
+}
+
+void pio_clear_instruction_memory(PIO pio) {
+    PioBlock& blk = block_of(pio);
+    memset(blk.instr_mem, 0, sizeof(blk.instr_mem));
+    blk.used_mask = 0;
+}
+
+// ===========================================
+// State machine claiming
+// ===========================================
+
+void pio_sm_claim(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    if (state.claimed) {
+        panic("PIO %u SM %u already claimed", pio_get_index(pio), sm);
+    }
+    state.claimed = true;
+}
+
+void pio_claim_sm_mask(PIO pio, uint sm_mask) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (sm_mask & (1u << sm)) {
+            pio_sm_claim(pio, sm);
+        }
+    }
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    block_of(pio).sm[sm].claimed = false;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (!block_of(pio).sm[sm].claimed) {
+            block_of(pio).sm[sm].claimed = true;
+            return (int)sm;
+        }
+    }
+    if (required) {
+        panic("No PIO state machines are available");
+    }
+    return -1;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].claimed;
+}
+
+// ===========================================
+// State machine control
+// ===========================================
+
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    state.config = *config;
+    update_fifo_depths(state);
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config) {
+    check_sm(pio, sm);
+    pio_sm_set_enabled(pio, sm, false);
+
+    StateMachine& state = block_of(pio).sm[sm];
+    pio_sm_set_config(pio, sm, config ? config : &state.config);
+    state.tx.clear();
+    state.rx.clear();
+    restart_sm(state);
+    state.next_tick_fp = now() * 256;
+    state.pc = (uint8_t)(initial_pc & 31);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    if (enabled && !state.enabled) {
+        state.next_tick_fp = now() * 256;
+    }
+    state.enabled = enabled;
+}
+
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (mask & (1u << sm)) {
+            pio_sm_set_enabled(pio, sm, enabled);
+        }
+    }
+}
+
+void pio_sm_restart(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    restart_sm(block_of(pio).sm[sm]);
+}
+
+void pio_restart_sm_mask(PIO pio, uint32_t mask) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (mask & (1u << sm)) {
+            pio_sm_restart(pio, sm);
+        }
+    }
+}
+
+void pio_sm_clkdiv_restart(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    block_of(pio).sm[sm].next_tick_fp = now() * 256;
+}
+
+void pio_clkdiv_restart_sm_mask(PIO pio, uint32_t mask) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (mask & (1u << sm)) {
+            pio_sm_clkdiv_restart(pio, sm);
+        }
+    }
+}
+
+void pio_enable_sm_mask_in_sync(PIO pio, uint32_t mask) {
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (mask & (1u << sm)) {
+            StateMachine& state = block_of(pio).sm[sm];
+            state.enabled = true;
+            state.next_tick_fp = now() * 256;
+        }
+    }
+}
+
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac) {
+    check_sm(pio, sm);
+    sm_config_set_clkdiv_int_frac(&block_of(pio).sm[sm].config, div_int, div_frac);
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {
+    check_sm(pio, sm);
+    sm_config_set_clkdiv(&block_of(pio).sm[sm].config, div);
+}
+
+void pio_sm_set_wrap(PIO pio, uint sm, uint wrap_target, uint wrap) {
+    check_sm(pio, sm);
+    sm_config_set_wrap(&block_of(pio).sm[sm].config, wrap_target, wrap);
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr) {
+    check_sm(pio, sm);
+    PioBlock& blk = block_of(pio);
+    StateMachine& state = blk.sm[sm];
+
+    if (state.enabled) {
+        // Runs on the next SM clock edge, ahead of the program
+        state.exec_pending = true;
+        state.exec_instr = (uint16_t)instr;
+        unblock(state, state.blocked);
+        return;
+    }
+
+    // A stopped state machine executes the instruction immediately
+    apply_sideset(blk, state, (uint16_t)instr);
+    ExecResult result = execute(blk, sm, (uint16_t)instr);
+    if (result.completed && result.jumped) {
+        state.pc = result.target;
+    }
+}
+
+void pio_sm_exec_wait_blocking(PIO pio, uint sm, uint instr) {
+    pio_sm_exec(pio, sm, instr);
+    while (pio_sm_is_exec_stalled(pio, sm)) {
+        tight_loop_contents();
+    }
+}
+
+bool pio_sm_is_exec_stalled(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    const StateMachine& state = block_of(pio).sm[sm];
+    return state.exec_pending && state.stalled;
+}
+
+uint8_t pio_sm_get_pc(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].pc;
+}
+
+// ===========================================
+// Pins
+// ===========================================
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio == pio1 ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_set_pins(PIO pio, uint sm, uint32_t pin_values) {
+    check_sm(pio, sm);
+    block_of(pio).pin_out = pin_values;
+    gpio_refresh(0xffffffffu);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask) {
+    check_sm(pio, sm);
+    PioBlock& blk = block_of(pio);
+    blk.pin_out = (blk.pin_out & ~pin_mask) | (pin_values & pin_mask);
+    gpio_refresh(pin_mask);
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) {
+    check_sm(pio, sm);
+    PioBlock& blk = block_of(pio);
+    blk.pin_oe = (blk.pin_oe & ~pin_mask) | (pin_dirs & pin_mask);
+    gpio_refresh(pin_mask);
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    uint32_t mask = pin_mask(pin_base, pin_count);
+    pio_sm_set_pindirs_with_mask(pio, sm, is_out ? mask : 0, mask);
+}
+
+// ===========================================
+// FIFOs
+// ===========================================
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    if (state.tx.full()) {
+        return;     // TXOVER: the write is lost, as on hardware
+    }
+    state.tx.push(data);
+    unblock(state, Block::TX_EMPTY);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    while (pio_sm_is_tx_fifo_full(pio, sm)) {
+        tight_loop_contents();
+    }
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    if (state.rx.empty()) {
+        return 0;   // RXUNDER
+    }
+    uint32_t value = state.rx.pop();
+    unblock(state, Block::RX_FULL);
+    return value;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) {
+        tight_loop_contents();
+    }
+    return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].tx.full();
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].tx.empty();
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].tx.count;
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].rx.full();
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].rx.empty();
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    return block_of(pio).sm[sm].rx.count;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    state.tx.clear();
+    state.rx.clear();
+    unblock(state, Block::RX_FULL);
+}
+
+void pio_sm_drain_tx_fifo(PIO pio, uint sm) {
+    check_sm(pio, sm);
+    StateMachine& state = block_of(pio).sm[sm];
+    state.tx.clear();
+    state.osr_count = 32;
+}
+
+// ===========================================
+// Interrupt flags and IRQ lines
+// ===========================================
+
+bool pio_interrupt_get(PIO pio, uint pio_interrupt_num) {
+    return (block_of(pio).irq_flags >> (pio_interrupt_num & 7)) & 1;
+}
+
+void pio_interrupt_clear(PIO pio, uint pio_interrupt_num) {
+    block_of(pio).irq_flags &= ~(1u << (pio_interrupt_num & 7));
+}
+
+void pio_set_irqn_source_enabled(PIO pio, uint irq_index, enum pio_interrupt_source source, bool enabled) {
+    uint32_t& inte = block_of(pio).inte[irq_index & 1];
+    if (enabled) {
+        inte |= 1u << source;
+    } else {
+        inte &= ~(1u << source);
+    }
+}
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled) {
+    pio_set_irqn_source_enabled(pio, 0, source, enabled);
+}
+
+void pio_set_irq1_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled) {
+    pio_set_irqn_source_enabled(pio, 1, source, enabled);
+}
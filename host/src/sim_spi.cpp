@@ -0,0 +1,263 @@
+#include "sim_internal.h"
+#include "hardware/clocks.h"
+#include "pico/stdlib.h"
+
+namespace host_sim {
+
+namespace {
+
+constexpr uint TX_FIFO_DEPTH = 8;
+
+struct Spi {
+    bool enabled;
+    uint32_t half_period;       // Half an SCK period in system cycles
+    uint32_t prescale;
+    uint32_t postdiv;
+    uint8_t data_bits;
+    bool cpol;
+    bool cpha;
+
+    uint16_t tx_fifo[TX_FIFO_DEPTH];
+    uint tx_head;
+    uint tx_count;
+
+    // Transmit shift register: each bit is two half periods, the first
+    // starting with MOSI changing
+    bool shifting;
+    uint16_t frame;
+    uint8_t phase;              // Half periods completed in this frame
+    uint64_t frame_start;
+    bool sck;
+    bool mosi;
+};
+
+Spi g_spis[NUM_SPIS];
+
+// SCK is the third and TX the fourth pin of each group of four; the groups
+// alternate between SPI0 and SPI1 every eight GPIOs
+uint32_t pin_mask(uint spi_index) {
+    uint32_t mask = 0;
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio += 4) {
+        if (((gpio >> 3) & 1) == spi_index) {
+            mask |= 3u << (gpio + 2);
+        }
+    }
+    return mask & ((1u << NUM_BANK0_GPIOS) - 1);
+}
+
+void set_lines(uint spi_index, bool sck, bool mosi) {
+    Spi& spi = g_spis[spi_index];
+    if (spi.sck != sck || spi.mosi != mosi) {
+        spi.sck = sck;
+        spi.mosi = mosi;
+        gpio_refresh(pin_mask(spi_index));
+    }
+}
+
+bool frame_bit(const Spi& spi, uint bit) {
+    return (spi.frame >> (spi.data_bits - 1 - bit)) & 1;
+}
+
+void start_frame(uint spi_index, uint64_t start) {
+    Spi& spi = g_spis[spi_index];
+    spi.frame = spi.tx_fifo[spi.tx_head];
+    spi.tx_head = (spi.tx_head + 1) % TX_FIFO_DEPTH;
+    spi.tx_count--;
+
+    spi.phase = 0;
+    spi.frame_start = start;
+    spi.shifting = true;
+    set_lines(spi_index, spi.cpha ? !spi.cpol : spi.cpol, frame_bit(spi, 0));
+}
+
+uint64_t next_edge_cycle(const Spi& spi) {
+    return spi.frame_start + (uint64_t)(spi.phase + 1) * spi.half_period;
+}
+
+uint compute_baud(Spi& spi, uint baudrate) {
+    uint32_t freq_in = clock_get_hz(clk_peri);
+    uint32_t prescale;
+    uint32_t postdiv;
+
+    // Same search as the SDK: smallest even prescale that leaves the
+    // post-divider in range, then the largest rate not above baudrate
+    for (prescale = 2; prescale <= 254; prescale += 2) {
+        if (freq_in < (prescale + 2) * 256 * (uint64_t)baudrate) {
+            break;
+        }
+    }
+    if (prescale > 254) {
+        panic("SPI baud rate %u too low", baudrate);
+    }
+    for (postdiv = 256; postdiv > 1; --postdiv) {
+        if (freq_in / (prescale * (postdiv - 1)) > baudrate) {
+            break;
+        }
+    }
+
+    spi.prescale = prescale;
+    spi.postdiv = postdiv;
+    spi.half_period = prescale * postdiv / 2;
+    return freq_in / (prescale * postdiv);
+}
+
+Spi& spi_of(const spi_inst_t* spi) {
+    return g_spis[spi_get_index(spi)];
+}
+
+} // namespace
+
+uint64_t spi_next_event() {
+    uint64_t next = NO_EVENT;
+    for (uint i = 0; i < NUM_SPIS; i++) {
+        if (g_spis[i].shifting) {
+            uint64_t cycle = next_edge_cycle(g_spis[i]);
+            if (cycle < next) {
+                next = cycle;
+            }
+        }
+    }
+    return next;
+}
+
+void spi_process(uint64_t cycle) {
+    for (uint i = 0; i < NUM_SPIS; i++) {
+        Spi& spi = g_spis[i];
+        while (spi.shifting && next_edge_cycle(spi) <= cycle) {
+            spi.phase++;
+            if (spi.phase < spi.data_bits * 2) {
+                if (spi.phase & 1) {
+                    // Middle of the bit: second SCK edge
+                    set_lines(i, spi.cpha ? spi.cpol : !spi.cpol, spi.mosi);
+                } else {
+                    set_lines(i, spi.cpha ? !spi.cpol : spi.cpol, frame_bit(spi, spi.phase / 2));
+                }
+                continue;
+            }
+
+            // Frame complete: next one follows without a gap
+            uint64_t end = spi.frame_start + (uint64_t)spi.data_bits * 2 * spi.half_period;
+            spi.shifting = false;
+            if (spi.enabled && spi.tx_count > 0) {
+                start_frame(i, end);
+            } else {
+                set_lines(i, spi.cpol, spi.mosi);
+            }
+        }
+    }
+}
+
+bool spi_pin_level(uint spi_index, bool sck) {
+    const Spi& spi = g_spis[spi_index];
+    return sck ? spi.sck : spi.mosi;
+}
+
+bool spi_dreq_ready(uint dreq) {
+    if (dreq < DREQ_SPI0_TX || dreq > DREQ_SPI1_RX) {
+        return false;
+    }
+    const Spi& spi = g_spis[(dreq - DREQ_SPI0_TX) / 2];
+    if ((dreq - DREQ_SPI0_TX) & 1) {
+        return false;   // RX is not simulated
+    }
+    return spi.enabled && spi.tx_count < TX_FIFO_DEPTH;
+}
+
+bool spi_port_write(uintptr_t addr, uint32_t value) {
+    for (uint i = 0; i < NUM_SPIS; i++) {
+        if (addr == (uintptr_t)&host_spi_hw[i].dr) {
+            Spi& spi = g_spis[i];
+            if (spi.enabled && spi.tx_count < TX_FIFO_DEPTH) {
+                uint16_t mask = (uint16_t)((1u << spi.data_bits) - 1);
+                spi.tx_fifo[(spi.tx_head + spi.tx_count) % TX_FIFO_DEPTH] = (uint16_t)value & mask;
+                spi.tx_count++;
+                if (!spi.shifting) {
+                    start_frame(i, now());
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void reset_spi() {
+    for (uint i = 0; i < NUM_SPIS; i++) {
+        g_spis[i] = Spi{};
+        g_spis[i].data_bits = 8;
+    }
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+spi_hw_t host_spi_hw[NUM_SPIS];
+
+uint spi_init(spi_inst_t* spi, uint baudrate) {
+    Spi& state = spi_of(spi);
+    state = Spi{};
+    state.enabled = true;
+    state.data_bits = 8;
+    uint actual = compute_baud(state, baudrate);
+    gpio_refresh(pin_mask(spi_get_index(spi)));
+    return actual;
+}
+
+void spi_deinit(spi_inst_t* spi) {
+    spi_of(spi).enabled = false;
+}
+
+uint spi_set_baudrate(spi_inst_t* spi, uint baudrate) {
+    return compute_baud(spi_of(spi), baudrate);
+}
+
+uint spi_get_baudrate(const spi_inst_t* spi) {
+    const Spi& state = spi_of(spi);
+    return clock_get_hz(clk_peri) / (state.prescale * state.postdiv);
+}
+
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+    if (data_bits < 4 || data_bits > 16) {
+        panic("SPI data bits %u out of range", data_bits);
+    }
+    if (order != SPI_MSB_FIRST) {
+        panic("SPI only supports MSB first");
+    }
+    Spi& state = spi_of(spi);
+    state.data_bits = (uint8_t)data_bits;
+    state.cpol = cpol == SPI_CPOL_1;
+    state.cpha = cpha == SPI_CPHA_1;
+    if (!state.shifting) {
+        set_lines(spi_get_index(spi), state.cpol, state.mosi);
+    }
+}
+
+bool spi_is_writable(const spi_inst_t* spi) {
+    return spi_of(spi).tx_count < TX_FIFO_DEPTH;
+}
+
+bool spi_is_readable(const spi_inst_t* spi) {
+    (void)spi;
+    return false;
+}
+
+bool spi_is_busy(const spi_inst_t* spi) {
+    const Spi& state = spi_of(spi);
+    return state.tx_count > 0 || state.shifting;
+}
+
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        while (!spi_is_writable(spi)) {
+            tight_loop_contents();
+        }
+        spi_port_write((uintptr_t)&spi_get_hw(spi)->dr, src[i]);
+    }
+    // As on the SDK, wait for the last frame so the caller can reuse src
+    // and deassert chip select
+    while (spi_is_busy(spi)) {
+        tight_loop_contents();
+    }
+    return (int)len;
+}
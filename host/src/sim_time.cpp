@@ -0,0 +1,128 @@
+#include "sim_internal.h"
+#include "pico/time.h"
+#include "hardware/clocks.h"
+
+namespace host_sim {
+
+namespace {
+
+uint32_t g_sys_hz = HOST_SIM_DEFAULT_SYS_CLOCK_HZ;
+
+// The microsecond timer is derived from the cycle count. When clk_sys is
+// changed the conversion is re-based at the current instant so the timer
+// stays continuous.
+uint64_t g_base_cycle = 0;
+uint64_t g_base_us = 0;
+
+} // namespace
+
+uint64_t cycles_to_us(uint64_t cycle) {
+    return g_base_us + ((cycle - g_base_cycle) * 1000000ull) / g_sys_hz;
+}
+
+uint64_t us_to_cycles_ceil(uint64_t us) {
+    if (us <= g_base_us) {
+        return g_base_cycle;
+    }
+    return g_base_cycle + ((us - g_base_us) * (uint64_t)g_sys_hz + 999999ull) / 1000000ull;
+}
+
+void reset_time() {
+    g_sys_hz = HOST_SIM_DEFAULT_SYS_CLOCK_HZ;
+    g_base_cycle = 0;
+    g_base_us = 0;
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+uint32_t host_sim_get_sys_clock_hz(void) {
+    return g_sys_hz;
+}
+
+// ===========================================
+// hardware/clocks.h
+// ===========================================
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    switch (clk_index) {
+        case clk_sys:
+        case clk_peri:
+            return g_sys_hz;
+        case clk_ref:
+            return 12000000;
+        case clk_usb:
+        case clk_adc:
+            return 48000000;
+        case clk_rtc:
+            return 46875;
+        default:
+            return 0;
+    }
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void)required;
+    uint64_t cycle = now();
+    g_base_us = cycles_to_us(cycle);
+    g_base_cycle = cycle;
+    g_sys_hz = freq_khz * 1000;
+    return true;
+}
+
+// ===========================================
+// pico/time.h
+// ===========================================
+
+absolute_time_t get_absolute_time(void) {
+    return cycles_to_us(now());
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+    return get_absolute_time() + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return get_absolute_time() + (uint64_t)ms * 1000;
+}
+
+bool time_reached(absolute_time_t t) {
+    return get_absolute_time() >= t;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)get_absolute_time();
+}
+
+uint64_t time_us_64(void) {
+    return get_absolute_time();
+}
+
+void busy_wait_until(absolute_time_t t) {
+    run_until(us_to_cycles_ceil(t));
+}
+
+void busy_wait_us(uint64_t delay_us) {
+    busy_wait_until(get_absolute_time() + delay_us);
+}
+
+void busy_wait_us_32(uint32_t delay_us) {
+    busy_wait_us(delay_us);
+}
+
+void busy_wait_ms(uint32_t delay_ms) {
+    busy_wait_us((uint64_t)delay_ms * 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+    busy_wait_until(t);
+}
+
+void sleep_us(uint64_t us) {
+    busy_wait_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    busy_wait_us((uint64_t)ms * 1000);
+}
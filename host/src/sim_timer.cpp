@@ -0,0 +1,280 @@
+#include "sim_internal.h"
+#include "hardware/timer.h"
+#include "pico/time.h"
+#include <vector>
+#include <algorithm>
+
+namespace host_sim {
+
+namespace {
+
+struct HardwareAlarm {
+    bool claimed;
+    bool armed;
+    bool pending;               // INTR bit, cleared when the IRQ is handled
+    uint64_t target_us;
+    hardware_alarm_callback_t callback;
+};
+
+HardwareAlarm g_alarms[NUM_TIMERS];
+
+// Each alarm interrupt clears its INTR bit and runs the registered callback,
+// like the SDK's shared hardware_alarm IRQ handler
+void alarm_irq(uint alarm_num) {
+    HardwareAlarm& alarm = g_alarms[alarm_num];
+    alarm.pending = false;
+    if (alarm.callback != nullptr) {
+        alarm.callback(alarm_num);
+    }
+}
+
+void alarm_irq_0() { alarm_irq(0); }
+void alarm_irq_1() { alarm_irq(1); }
+void alarm_irq_2() { alarm_irq(2); }
+void alarm_irq_3() { alarm_irq(3); }
+
+const irq_handler_t ALARM_IRQ_HANDLERS[NUM_TIMERS] = {alarm_irq_0, alarm_irq_1, alarm_irq_2, alarm_irq_3};
+
+// ===========================================
+// Default alarm pool
+// ===========================================
+
+struct PoolEntry {
+    alarm_id_t id;
+    uint64_t target_us;
+    alarm_callback_t callback;
+    void* user_data;
+};
+
+std::vector<PoolEntry> g_pool;
+alarm_id_t g_next_alarm_id = 1;
+bool g_pool_initialized = false;
+
+void pool_rearm();
+
+void pool_alarm_callback(uint alarm_num) {
+    (void)alarm_num;
+
+    // Run every entry that is due, earliest first. Callbacks may add or
+    // cancel alarms, so the list is searched again after each one.
+    for (;;) {
+        uint64_t now_us = cycles_to_us(now());
+        auto due = std::min_element(g_pool.begin(), g_pool.end(),
+                                    [](const PoolEntry& a, const PoolEntry& b) {
+                                        return a.target_us < b.target_us;
+                                    });
+        if (due == g_pool.end() || due->target_us > now_us) {
+            break;
+        }
+
+        PoolEntry entry = *due;
+        g_pool.erase(due);
+
+        int64_t repeat = entry.callback(entry.id, entry.user_data);
+        if (repeat != 0) {
+            entry.target_us = (repeat > 0) ? entry.target_us + (uint64_t)repeat
+                                           : cycles_to_us(now()) + (uint64_t)(-repeat);
+            g_pool.push_back(entry);
+        }
+    }
+
+    pool_rearm();
+}
+
+void pool_init() {
+    if (g_pool_initialized) {
+        return;
+    }
+
+    uint alarm_num = PICO_TIME_DEFAULT_ALARM_POOL_HARDWARE_ALARM_NUM;
+    hardware_alarm_claim(alarm_num);
+    hardware_alarm_set_callback(alarm_num, pool_alarm_callback);
+    g_pool_initialized = true;
+}
+
+void pool_rearm() {
+    uint alarm_num = PICO_TIME_DEFAULT_ALARM_POOL_HARDWARE_ALARM_NUM;
+    if (g_pool.empty()) {
+        hardware_alarm_cancel(alarm_num);
+        return;
+    }
+
+    uint64_t earliest = UINT64_MAX;
+    for (const PoolEntry& entry : g_pool) {
+        earliest = std::min(earliest, entry.target_us);
+    }
+    if (hardware_alarm_set_target(alarm_num, earliest)) {
+        // Already due: take the interrupt as soon as possible
+        hardware_alarm_force_irq(alarm_num);
+    }
+}
+
+} // namespace
+
+uint64_t timer_next_event() {
+    uint64_t next = NO_EVENT;
+    for (const HardwareAlarm& alarm : g_alarms) {
+        if (alarm.armed) {
+            next = std::min(next, us_to_cycles_ceil(alarm.target_us));
+        }
+    }
+    return next;
+}
+
+void timer_process(uint64_t cycle) {
+    uint64_t now_us = cycles_to_us(cycle);
+    for (HardwareAlarm& alarm : g_alarms) {
+        if (alarm.armed && now_us >= alarm.target_us) {
+            alarm.armed = false;
+            alarm.pending = true;
+        }
+    }
+}
+
+bool timer_irq_pending(uint alarm_num) {
+    return alarm_num < NUM_TIMERS && g_alarms[alarm_num].pending;
+}
+
+void reset_timer() {
+    for (HardwareAlarm& alarm : g_alarms) {
+        alarm = HardwareAlarm{};
+    }
+    g_pool.clear();
+    g_next_alarm_id = 1;
+    g_pool_initialized = false;
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+// ===========================================
+// hardware/timer.h
+// ===========================================
+
+void hardware_alarm_claim(uint alarm_num) {
+    if (alarm_num >= NUM_TIMERS || g_alarms[alarm_num].claimed) {
+        panic("hardware_alarm_claim: alarm %u is not available", alarm_num);
+    }
+    g_alarms[alarm_num].claimed = true;
+}
+
+int hardware_alarm_claim_unused(bool required) {
+    for (uint alarm_num = 0; alarm_num < NUM_TIMERS; alarm_num++) {
+        if (!g_alarms[alarm_num].claimed) {
+            g_alarms[alarm_num].claimed = true;
+            return (int)alarm_num;
+        }
+    }
+    if (required) {
+        panic("hardware_alarm_claim_unused: no alarms available");
+    }
+    return -1;
+}
+
+void hardware_alarm_unclaim(uint alarm_num) {
+    if (alarm_num < NUM_TIMERS) {
+        g_alarms[alarm_num].claimed = false;
+    }
+}
+
+bool hardware_alarm_is_claimed(uint alarm_num) {
+    return alarm_num < NUM_TIMERS && g_alarms[alarm_num].claimed;
+}
+
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback) {
+    if (alarm_num >= NUM_TIMERS) {
+        return;
+    }
+
+    g_alarms[alarm_num].callback = callback;
+    uint irq = TIMER_IRQ_0 + alarm_num;
+    if (callback != nullptr) {
+        irq_set_exclusive_handler(irq, ALARM_IRQ_HANDLERS[alarm_num]);
+        irq_set_enabled(irq, true);
+    } else {
+        irq_set_enabled(irq, false);
+        irq_remove_handler(irq, ALARM_IRQ_HANDLERS[alarm_num]);
+    }
+}
+
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+    if (alarm_num >= NUM_TIMERS) {
+        return true;
+    }
+
+    HardwareAlarm& alarm = g_alarms[alarm_num];
+    if (t <= cycles_to_us(now())) {
+        alarm.armed = false;
+        return true;
+    }
+    alarm.target_us = t;
+    alarm.armed = true;
+    return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) {
+    if (alarm_num < NUM_TIMERS) {
+        g_alarms[alarm_num].armed = false;
+    }
+}
+
+void hardware_alarm_force_irq(uint alarm_num) {
+    if (alarm_num < NUM_TIMERS) {
+        g_alarms[alarm_num].armed = false;
+        g_alarms[alarm_num].pending = true;
+    }
+}
+
+// ===========================================
+// pico/time.h alarms
+// ===========================================
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    pool_init();
+
+    alarm_id_t id = g_next_alarm_id;
+    for (;;) {
+        if (time > cycles_to_us(now())) {
+            break;
+        }
+
+        // Missed: either fire now, in the caller's context, or give up
+        if (!fire_if_past) {
+            return 0;
+        }
+        int64_t repeat = callback(id, user_data);
+        if (repeat == 0) {
+            return 0;
+        }
+        time = (repeat > 0) ? time + (uint64_t)repeat : cycles_to_us(now()) + (uint64_t)(-repeat);
+    }
+
+    if (g_pool.size() >= PICO_TIME_DEFAULT_ALARM_POOL_MAX_TIMERS) {
+        return -1;
+    }
+
+    g_next_alarm_id = (g_next_alarm_id == INT32_MAX) ? 1 : g_next_alarm_id + 1;
+    g_pool.push_back(PoolEntry{id, time, callback, user_data});
+    pool_rearm();
+    return id;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    return add_alarm_at(get_absolute_time() + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    auto it = std::find_if(g_pool.begin(), g_pool.end(),
+                           [alarm_id](const PoolEntry& entry) { return entry.id == alarm_id; });
+    if (it == g_pool.end()) {
+        return false;
+    }
+    g_pool.erase(it);
+    pool_rearm();
+    return true;
+}
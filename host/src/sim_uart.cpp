@@ -0,0 +1,337 @@
+#include "sim_internal.h"
+#include "hardware/clocks.h"
+#include "pico/stdlib.h"
+
+namespace host_sim {
+
+namespace {
+
+constexpr uint TX_FIFO_DEPTH = 32;
+
+// TX FIFO trigger levels selected by UARTIFLS.TXIFLSEL (1/8 .. 7/8 full)
+constexpr uint TX_TRIGGER_LEVELS[] = {4, 8, 16, 24, 28};
+
+struct Uart {
+    bool enabled;
+    uint32_t bit_q;             // Bit period in quarter system cycles
+    uint8_t data_bits;
+    uint8_t stop_bits;
+    uart_parity_t parity;
+    bool fifo_enabled;
+    uint8_t tx_ifls;
+    bool txim;
+    bool rxim;
+    bool tx_ris;                // Raw TX interrupt status
+    bool break_active;
+
+    uint8_t tx_fifo[TX_FIFO_DEPTH];
+    uint tx_head;
+    uint tx_count;
+
+    // Transmit shift register
+    bool shifting;
+    uint16_t frame;             // Start, data, parity and stop bits, LSB first
+    uint8_t frame_bits;
+    uint8_t bit_index;
+    uint64_t frame_start_q;     // Frame start, in quarter system cycles
+    bool line;                  // Shifter output (before break)
+};
+
+Uart g_uarts[NUM_UARTS];
+
+uint tx_trigger(const Uart& uart) {
+    return uart.fifo_enabled ? TX_TRIGGER_LEVELS[uart.tx_ifls] : 0;
+}
+
+uint tx_depth(const Uart& uart) {
+    return uart.fifo_enabled ? TX_FIFO_DEPTH : 1;
+}
+
+uint32_t tx_pin_mask(uint uart_index) {
+    uint32_t mask = 0;
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio += 4) {
+        if ((((gpio + 4) >> 3) & 1) == uart_index) {
+            mask |= 1u << gpio;
+        }
+    }
+    return mask;
+}
+
+void set_line(uint uart_index, bool level) {
+    Uart& uart = g_uarts[uart_index];
+    if (uart.line != level) {
+        uart.line = level;
+        gpio_refresh(tx_pin_mask(uart_index));
+    }
+}
+
+void start_frame(uint uart_index, uint64_t start_q) {
+    Uart& uart = g_uarts[uart_index];
+    uint8_t data = uart.tx_fifo[uart.tx_head];
+    uart.tx_head = (uart.tx_head + 1) % TX_FIFO_DEPTH;
+    uart.tx_count--;
+
+    // As on the PL011 the TX interrupt is raised by the FIFO level passing
+    // down through the trigger level, or by written data leaving the FIFO
+    // so it becomes empty - never by the level alone
+    uint trigger = tx_trigger(uart);
+    if (uart.tx_count == 0 || (uart.tx_count + 1 > trigger && uart.tx_count <= trigger)) {
+        uart.tx_ris = true;
+    }
+
+    uint16_t frame = 0;     // Start bit (0) in bit 0
+    uint bit = 1;
+    uint ones = 0;
+    for (uint i = 0; i < uart.data_bits; i++, bit++) {
+        if ((data >> i) & 1) {
+            frame |= 1u << bit;
+            ones++;
+        }
+    }
+    if (uart.parity != UART_PARITY_NONE) {
+        bool parity_bit = (uart.parity == UART_PARITY_EVEN) ? (ones & 1) : !(ones & 1);
+        if (parity_bit) {
+            frame |= 1u << bit;
+        }
+        bit++;
+    }
+    for (uint i = 0; i < uart.stop_bits; i++, bit++) {
+        frame |= 1u << bit;
+    }
+
+    uart.frame = frame;
+    uart.frame_bits = (uint8_t)bit;
+    uart.bit_index = 0;
+    uart.frame_start_q = start_q;
+    uart.shifting = true;
+    set_line(uart_index, false);
+}
+
+uint64_t next_edge_cycle(const Uart& uart) {
+    uint64_t edge_q = uart.frame_start_q + (uint64_t)(uart.bit_index + 1) * uart.bit_q;
+    return (edge_q + 3) / 4;
+}
+
+uint compute_baud(Uart& uart, uint baudrate) {
+    uint32_t clk = clock_get_hz(clk_peri);
+    uint32_t baud_rate_div = (8 * clk / baudrate) + 1;
+    uint32_t baud_ibrd = baud_rate_div >> 7;
+    uint32_t baud_fbrd;
+
+    if (baud_ibrd == 0) {
+        baud_ibrd = 1;
+        baud_fbrd = 0;
+    } else if (baud_ibrd >= 65535) {
+        baud_ibrd = 65535;
+        baud_fbrd = 0;
+    } else {
+        baud_fbrd = (baud_rate_div & 0x7f) >> 1;
+    }
+
+    uart.bit_q = 64 * baud_ibrd + baud_fbrd;
+    return (4 * clk) / (64 * baud_ibrd + baud_fbrd);
+}
+
+Uart& uart_of(uart_inst_t* uart) {
+    return g_uarts[uart_get_index(uart)];
+}
+
+} // namespace
+
+uint64_t uart_next_event() {
+    uint64_t next = NO_EVENT;
+    for (uint i = 0; i < NUM_UARTS; i++) {
+        if (g_uarts[i].shifting) {
+            uint64_t cycle = next_edge_cycle(g_uarts[i]);
+            if (cycle < next) {
+                next = cycle;
+            }
+        }
+    }
+    return next;
+}
+
+void uart_process(uint64_t cycle) {
+    for (uint i = 0; i < NUM_UARTS; i++) {
+        Uart& uart = g_uarts[i];
+        while (uart.shifting && next_edge_cycle(uart) <= cycle) {
+            uart.bit_index++;
+            if (uart.bit_index < uart.frame_bits) {
+                set_line(i, (uart.frame >> uart.bit_index) & 1);
+                continue;
+            }
+
+            // Stop bit(s) complete: next byte follows back-to-back
+            uint64_t end_q = uart.frame_start_q + (uint64_t)uart.frame_bits * uart.bit_q;
+            uart.shifting = false;
+            if (uart.enabled && uart.tx_count > 0) {
+                start_frame(i, end_q);
+            } else {
+                set_line(i, true);
+            }
+        }
+    }
+}
+
+bool uart_tx_level(uint uart_index) {
+    const Uart& uart = g_uarts[uart_index];
+    if (uart.break_active) {
+        return false;
+    }
+    return uart.line;
+}
+
+bool uart_dreq_ready(uint dreq) {
+    if (dreq < DREQ_UART0_TX || dreq > DREQ_UART1_RX) {
+        return false;
+    }
+    const Uart& uart = g_uarts[(dreq - DREQ_UART0_TX) / 2];
+    if ((dreq - DREQ_UART0_TX) & 1) {
+        return false;   // RX is not simulated
+    }
+    return uart.enabled && uart.tx_count < tx_depth(uart);
+}
+
+bool uart_port_write(uintptr_t addr, uint32_t value) {
+    for (uint i = 0; i < NUM_UARTS; i++) {
+        if (addr == (uintptr_t)&host_uart_hw[i].dr) {
+            Uart& uart = g_uarts[i];
+            if (uart.enabled && uart.tx_count < tx_depth(uart)) {
+                uart.tx_fifo[(uart.tx_head + uart.tx_count) % TX_FIFO_DEPTH] = (uint8_t)value;
+                uart.tx_count++;
+                if (uart.tx_count > tx_trigger(uart)) {
+                    uart.tx_ris = false;
+                }
+                if (!uart.shifting) {
+                    start_frame(i, now() * 4);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool uart_irq_pending(uint uart_index) {
+    const Uart& uart = g_uarts[uart_index];
+    return uart.enabled && uart.txim && uart.tx_ris;
+}
+
+void reset_uart() {
+    for (uint i = 0; i < NUM_UARTS; i++) {
+        g_uarts[i] = Uart{};
+        g_uarts[i].line = true;
+        g_uarts[i].tx_ifls = 2;
+    }
+}
+
+} // namespace host_sim
+
+using namespace host_sim;
+
+uart_hw_t host_uart_hw[NUM_UARTS];
+
+uint uart_init(uart_inst_t* uart, uint baudrate) {
+    Uart& state = uart_of(uart);
+    state = Uart{};
+    state.line = true;
+    state.enabled = true;
+    state.fifo_enabled = true;
+    state.tx_ifls = 2;
+    state.data_bits = 8;
+    state.stop_bits = 1;
+    state.parity = UART_PARITY_NONE;
+    return compute_baud(state, baudrate);
+}
+
+void uart_deinit(uart_inst_t* uart) {
+    Uart& state = uart_of(uart);
+    state.enabled = false;
+    state.txim = false;
+    state.rxim = false;
+}
+
+uint uart_set_baudrate(uart_inst_t* uart, uint baudrate) {
+    return compute_baud(uart_of(uart), baudrate);
+}
+
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits, uart_parity_t parity) {
+    Uart& state = uart_of(uart);
+    state.data_bits = (uint8_t)data_bits;
+    state.stop_bits = (uint8_t)stop_bits;
+    state.parity = parity;
+}
+
+void uart_set_hw_flow(uart_inst_t* uart, bool cts, bool rts) {
+    (void)uart;
+    (void)cts;
+    (void)rts;
+}
+
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled) {
+    uart_of(uart).fifo_enabled = enabled;
+}
+
+void uart_set_translate_crlf(uart_inst_t* uart, bool translate) {
+    (void)uart;
+    (void)translate;
+}
+
+bool uart_is_enabled(uart_inst_t* uart) {
+    return uart_of(uart).enabled;
+}
+
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data, bool tx_needs_data) {
+    Uart& state = uart_of(uart);
+    state.rxim = rx_has_data;
+    state.txim = tx_needs_data;
+    if (tx_needs_data) {
+        state.tx_ifls = 0;
+    }
+}
+
+void uart_set_break(uart_inst_t* uart, bool en) {
+    uint index = uart_get_index(uart);
+    g_uarts[index].break_active = en;
+    gpio_refresh(tx_pin_mask(index));
+}
+
+bool uart_is_writable(uart_inst_t* uart) {
+    const Uart& state = uart_of(uart);
+    return state.tx_count < tx_depth(state);
+}
+
+bool uart_is_readable(uart_inst_t* uart) {
+    (void)uart;
+    return false;
+}
+
+void uart_tx_wait_blocking(uart_inst_t* uart) {
+    const Uart& state = uart_of(uart);
+    while (state.tx_count > 0 || state.shifting) {
+        tight_loop_contents();
+    }
+}
+
+void uart_putc_raw(uart_inst_t* uart, char c) {
+    while (!uart_is_writable(uart)) {
+        tight_loop_contents();
+    }
+    uart_port_write((uintptr_t)&uart_get_hw(uart)->dr, (uint8_t)c);
+}
+
+void uart_putc(uart_inst_t* uart, char c) {
+    uart_putc_raw(uart, c);
+}
+
+void uart_puts(uart_inst_t* uart, const char* s) {
+    while (*s) {
+        uart_putc(uart, *s++);
+    }
+}
+
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uart_putc_raw(uart, (char)src[i]);
+    }
+}
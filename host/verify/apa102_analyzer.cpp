@@ -0,0 +1,157 @@
+#include "apa102_analyzer.h"
+#include <cstdio>
+
+namespace {
+
+// Check and decode the bits of one frame
+void decode_frame(const std::vector<bool>& bits, APA102Analyzer::Report& report) {
+    std::vector<uint32_t> leds;
+
+    if (bits.size() % 8 != 0) {
+        report.partial_bytes++;
+    }
+
+    auto word_at = [&](size_t pos) {
+        uint32_t word = 0;
+        for (size_t i = 0; i < 32; i++) {
+            word = (word << 1) | (bits[pos + i] ? 1 : 0);
+        }
+        return word;
+    };
+
+    size_t pos = 0;
+    if (bits.size() < 32 || word_at(0) != 0) {
+        report.start_frame_errors++;
+    } else {
+        pos = 32;
+    }
+
+    while (pos + 32 <= bits.size() && bits[pos] && bits[pos + 1] && bits[pos + 2]) {
+        leds.push_back(word_at(pos));
+        pos += 32;
+    }
+
+    // Each LED delays the data by half a clock, so the strip needs at
+    // least one extra clock per two LEDs after the last LED frame
+    size_t end_bits = bits.size() - pos;
+    bool end_zero = true;
+    for (size_t i = pos; i < bits.size(); i++) {
+        end_zero = end_zero && !bits[i];
+    }
+    if (!end_zero || end_bits < (leds.size() + 1) / 2) {
+        report.end_frame_errors++;
+    }
+
+    report.frames.push_back(leds);
+    report.frame_count++;
+}
+
+} // namespace
+
+APA102Analyzer::Report APA102Analyzer::analyze(const WaveformRecorder& recorder, uint clock_gpio,
+                                               uint data_gpio, const Spec& spec) {
+    Report report;
+    const WaveformRecorder::Trace& clock = recorder.trace(clock_gpio);
+    const WaveformRecorder::Trace& data = recorder.trace(data_gpio);
+    const uint64_t gap_cycles = recorder.usToCycles(spec.frame_gap_us);
+    const double min_period_us = 1e6 / spec.clock_max_hz;
+
+    // Data level is tracked with a cursor, as rising edges come in order
+    size_t data_index = 0;
+    bool data_level = data.initial_level;
+
+    bool in_frame = false;
+    uint64_t frame_start = 0;
+    uint64_t first_frame_start = 0;
+    uint64_t last_frame_start = 0;
+    uint64_t prev_rise = 0;
+    uint64_t total_rises = 0;
+    double total_frame_us = 0.0;
+    std::vector<bool> bits;
+
+    auto end_frame = [&]() {
+        double frame_us = recorder.cyclesToUs(prev_rise - frame_start);
+        report.frame_time.add(frame_us);
+        total_frame_us += frame_us;
+        decode_frame(bits, report);
+        bits.clear();
+        in_frame = false;
+    };
+
+    for (const WaveformRecorder::Edge& edge : clock.edges) {
+        if (!edge.level) {
+            continue;
+        }
+        uint64_t rise = edge.cycle;
+
+        while (data_index < data.edges.size() && data.edges[data_index].cycle <= rise) {
+            data_level = data.edges[data_index].level;
+            data_index++;
+        }
+
+        if (in_frame) {
+            if (rise - prev_rise >= gap_cycles) {
+                end_frame();
+            } else {
+                double period_us = recorder.cyclesToUs(rise - prev_rise);
+                report.clock_period.add(period_us);
+                if (period_us < min_period_us) {
+                    report.clock_violations++;
+                }
+            }
+        }
+
+        if (!in_frame) {
+            in_frame = true;
+            frame_start = rise;
+            if (report.frame_count == 0) {
+                first_frame_start = rise;
+            } else {
+                report.frame_period.add(recorder.cyclesToUs(rise - last_frame_start));
+            }
+            last_frame_start = rise;
+        }
+
+        bits.push_back(data_level);
+        total_rises++;
+        prev_rise = rise;
+    }
+
+    if (in_frame) {
+        end_frame();
+    }
+
+    if (report.frame_count > 1) {
+        double span_us = recorder.cyclesToUs(last_frame_start - first_frame_start);
+        report.frame_rate_hz = (report.frame_count - 1) * 1e6 / span_us;
+    }
+    if (total_frame_us > 0.0) {
+        report.clock_rate_hz = (total_rises - report.frame_count) * 1e6 / total_frame_us;
+    }
+
+    return report;
+}
+
+APA102Analyzer::Report APA102Analyzer::analyze(const WaveformRecorder& recorder, uint clock_gpio,
+                                               uint data_gpio) {
+    return analyze(recorder, clock_gpio, data_gpio, Spec());
+}
+
+void APA102Analyzer::printReport(const Report& report, const char* title) {
+    printf("%s\n", title);
+    printf("  Frames: %u", report.frame_count);
+    if (!report.frames.empty()) {
+        printf(" (%u LEDs in last frame)", (unsigned)report.frames.back().size());
+    }
+    printf("\n");
+    printf("  Frame rate: %.2f Hz\n", report.frame_rate_hz);
+    printf("  Clock rate: %.3f MHz\n", report.clock_rate_hz / 1e6);
+    report.clock_period.print("Clock period:");
+    report.frame_time.print("Frame time:");
+    report.frame_period.print("Frame period:");
+    printf("  Start frame errors: %u\n", report.start_frame_errors);
+    printf("  End frame errors: %u\n", report.end_frame_errors);
+    printf("  Partial bytes: %u\n", report.partial_bytes);
+    printf("  Clock violations: %u\n", report.clock_violations);
+    printf("  Result: %s\n", report.passed() ? "PASS" : "FAIL");
+}
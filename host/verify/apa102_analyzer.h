@@ -0,0 +1,57 @@
+#pragma once
+
+#include "waveform_recorder.h"
+#include "timing_stats.h"
+#include <vector>
+
+/**
+ * @brief Decodes and checks a recorded APA102 / SK9822 clock and data pair
+ *
+ * Data is sampled on every rising clock edge. An idle clock of at least the
+ * frame gap ends a frame, which must be a 32-bit zero start frame, LED
+ * frames with a 111 header (brightness, blue, green, red) and an end frame
+ * of zeros long enough to push the data through the whole strip.
+ */
+class APA102Analyzer {
+public:
+    struct Spec {
+        double frame_gap_us = 10.0;         // Idle clock that ends a frame
+        double clock_max_hz = 30000000.0;   // SK9822 limit (APA102 allows more)
+    };
+
+    struct Report {
+        uint32_t frame_count = 0;
+        std::vector<std::vector<uint32_t>> frames;  // LED frames, header in the top byte
+
+        TimingStats clock_period;       // Rising edge to rising edge within a frame
+        TimingStats frame_time;         // First to last rising edge
+        TimingStats frame_period;       // Start of frame to start of next frame
+
+        uint32_t start_frame_errors = 0;    // Frames not starting with 32 zero bits
+        uint32_t end_frame_errors = 0;      // End frame not zero, or too short for the strip
+        uint32_t partial_bytes = 0;         // Frames not a whole number of bytes
+        uint32_t clock_violations = 0;      // Clock faster than the spec
+
+        double frame_rate_hz = 0.0;
+        double clock_rate_hz = 0.0;     // Average while a frame is on the wire
+
+        bool passed() const {
+            return start_frame_errors == 0 && end_frame_errors == 0 && partial_bytes == 0 &&
+                   clock_violations == 0;
+        }
+    };
+
+    static Report analyze(const WaveformRecorder& recorder, uint clock_gpio, uint data_gpio,
+                          const Spec& spec);
+    static Report analyze(const WaveformRecorder& recorder, uint clock_gpio, uint data_gpio);
+
+    /**
+     * @brief Split an LED frame into its fields
+     */
+    static uint8_t brightness(uint32_t frame) { return (frame >> 24) & 0x1F; }
+    static uint8_t blue(uint32_t frame) { return (frame >> 16) & 0xFF; }
+    static uint8_t green(uint32_t frame) { return (frame >> 8) & 0xFF; }
+    static uint8_t red(uint32_t frame) { return frame & 0xFF; }
+
+    static void printReport(const Report& report, const char* title);
+};
@@ -0,0 +1,132 @@
+#include "dmx512_analyzer.h"
+#include <cstdio>
+
+DMX512Analyzer::Report DMX512Analyzer::analyze(const WaveformRecorder& recorder, uint gpio, const Spec& spec) {
+    Report report;
+
+    UartDecoder::Format format = {spec.baud_rate, 8, 2, false, false};
+    UartDecoder::Result decoded = UartDecoder::decode(recorder, gpio, format);
+    const std::vector<UartDecoder::Character>& slots = decoded.characters;
+    const std::vector<UartDecoder::Break>& breaks = decoded.breaks;
+
+    size_t slot = 0;
+    while (slot < slots.size() && (breaks.empty() || slots[slot].start_cycle < breaks[0].start_cycle)) {
+        report.stray_slots++;
+        slot++;
+    }
+
+    uint64_t total_slots = 0;
+    double total_slot_us = 0.0;
+
+    for (size_t b = 0; b < breaks.size(); b++) {
+        const UartDecoder::Break& brk = breaks[b];
+        const bool has_next = (b + 1 < breaks.size());
+        const uint64_t next_break = has_next ? breaks[b + 1].start_cycle : UINT64_MAX;
+
+        double break_us = recorder.cyclesToUs(brk.end_cycle - brk.start_cycle);
+        report.break_time.add(break_us);
+        if (break_us < spec.break_min_us || break_us > spec.break_max_us) {
+            report.timing_violations++;
+        }
+
+        std::vector<uint8_t> frame;
+        const size_t first_slot = slot;
+        while (slot < slots.size() && slots[slot].start_cycle < next_break) {
+            const UartDecoder::Character& c = slots[slot];
+            frame.push_back(c.value);
+
+            if (c.framing_error) {
+                report.framing_errors++;
+            }
+            if (c.max_edge_error_us > report.max_bit_error_us) {
+                report.max_bit_error_us = c.max_edge_error_us;
+            }
+            if (c.max_edge_error_us > spec.bit_error_max_us) {
+                report.timing_violations++;
+            }
+
+            if (slot == first_slot) {
+                double mab_us = recorder.cyclesToUs(c.start_cycle - brk.end_cycle);
+                report.mab.add(mab_us);
+                if (mab_us < spec.mab_min_us || mab_us > spec.mab_max_us) {
+                    report.timing_violations++;
+                }
+            } else {
+                double mtbs_us = recorder.cyclesToUs(UartDecoder::idleCycles(slots[slot - 1], c));
+                report.mtbs.add(mtbs_us);
+                if (mtbs_us > spec.mtbs_max_us) {
+                    report.timing_violations++;
+                }
+            }
+            slot++;
+        }
+
+        if (!frame.empty()) {
+            const UartDecoder::Character& last = slots[slot - 1];
+            report.frame_time.add(recorder.cyclesToUs(last.end_cycle - brk.start_cycle));
+            total_slot_us += recorder.cyclesToUs(last.end_cycle - slots[first_slot].start_cycle);
+            total_slots += frame.size();
+
+            if (has_next) {
+                double mbb_us = recorder.cyclesToUs(next_break - last.end_cycle);
+                report.mbb.add(mbb_us);
+                if (mbb_us > spec.mbb_max_us) {
+                    report.timing_violations++;
+                }
+            }
+        }
+
+        if (frame.size() > spec.max_slots) {
+            report.timing_violations++;
+        }
+
+        if (has_next) {
+            double period_us = recorder.cyclesToUs(next_break - brk.start_cycle);
+            report.frame_period.add(period_us);
+            if (period_us < spec.packet_period_min_us) {
+                report.timing_violations++;
+            }
+        }
+
+        if (report.frame_count == 0 || frame.size() < report.min_slots) {
+            report.min_slots = frame.size();
+        }
+        if (frame.size() > report.max_slots) {
+            report.max_slots = frame.size();
+        }
+        report.frames.push_back(frame);
+        report.frame_count++;
+    }
+
+    if (breaks.size() > 1) {
+        double span_us = recorder.cyclesToUs(breaks.back().start_cycle - breaks.front().start_cycle);
+        report.frame_rate_hz = (breaks.size() - 1) * 1e6 / span_us;
+    }
+    if (total_slot_us > 0.0) {
+        report.slot_rate = total_slots * 1e6 / total_slot_us;
+    }
+
+    return report;
+}
+
+DMX512Analyzer::Report DMX512Analyzer::analyze(const WaveformRecorder& recorder, uint gpio) {
+    return analyze(recorder, gpio, Spec());
+}
+
+void DMX512Analyzer::printReport(const Report& report, const char* title) {
+    printf("%s\n", title);
+    printf("  Packets: %u (%u-%u slots)\n", report.frame_count, report.min_slots, report.max_slots);
+    printf("  Frame rate: %.2f Hz\n", report.frame_rate_hz);
+    printf("  Slot rate: %.0f slots/s\n", report.slot_rate);
+    report.break_time.print("Break:");
+    report.mab.print("Mark after break:");
+    report.mtbs.print("Inter-slot gap:");
+    report.mbb.print("Mark before break:");
+    report.frame_time.print("Packet time:");
+    report.frame_period.print("Packet period:");
+    printf("  Max bit edge error: %.3f us\n", report.max_bit_error_us);
+    printf("  Framing errors: %u\n", report.framing_errors);
+    printf("  Stray slots: %u\n", report.stray_slots);
+    printf("  Timing violations: %u\n", report.timing_violations);
+    printf("  Result: %s\n", report.passed() ? "PASS" : "FAIL");
+}
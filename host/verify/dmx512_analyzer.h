@@ -0,0 +1,63 @@
+#pragma once
+
+#include "waveform_recorder.h"
+#include "timing_stats.h"
+#include "uart_decoder.h"
+#include "../../src/config/picoled_config.h"
+#include <vector>
+
+/**
+ * @brief Decodes and checks a recorded DMX512 line
+ *
+ * Splits the waveform into packets at each break and decodes the slots
+ * (start code + channels) that follow.
+ */
+class DMX512Analyzer {
+public:
+    /**
+     * @brief Transmitter timing limits (ANSI E1.11)
+     */
+    struct Spec {
+        uint32_t baud_rate = 250000;
+        double break_min_us = 92.0;
+        double break_max_us = 1000000.0;
+        double mab_min_us = 12.0;
+        double mab_max_us = 1000000.0;
+        double mtbs_max_us = 1000000.0;         // Mark time between slots
+        double mbb_max_us = 1000000.0;          // Mark before break
+        double packet_period_min_us = 1204.0;   // Break to break
+        double bit_error_max_us = 0.08;         // 4 us +/- 2%
+        uint max_slots = DMX_UNIVERSE_SIZE + 1;
+    };
+
+    struct Report {
+        uint32_t frame_count = 0;
+        std::vector<std::vector<uint8_t>> frames;   // Slots per packet, start code first
+
+        TimingStats break_time;
+        TimingStats mab;
+        TimingStats mtbs;               // Idle time between consecutive slots
+        TimingStats mbb;                // Idle time after the last slot
+        TimingStats frame_time;         // Break start to end of last slot
+        TimingStats frame_period;       // Break start to next break start
+        uint32_t min_slots = 0;
+        uint32_t max_slots = 0;
+
+        uint32_t framing_errors = 0;    // Slots without two stop bits
+        uint32_t stray_slots = 0;       // Slots before the first break
+        uint32_t timing_violations = 0; // Break, MAB, MTBS, MBB, period or bit timing
+        double max_bit_error_us = 0.0;
+
+        double frame_rate_hz = 0.0;
+        double slot_rate = 0.0;         // Slots per second while a packet is sent
+
+        bool passed() const {
+            return framing_errors == 0 && stray_slots == 0 && timing_violations == 0;
+        }
+    };
+
+    static Report analyze(const WaveformRecorder& recorder, uint gpio, const Spec& spec);
+    static Report analyze(const WaveformRecorder& recorder, uint gpio);
+
+    static void printReport(const Report& report, const char* title);
+};
@@ -0,0 +1,155 @@
+#include "rs485_analyzer.h"
+#include <cstdio>
+
+namespace {
+
+struct Window {
+    uint64_t on_cycle;
+    uint64_t off_cycle;
+    bool closed;        // DE was released within the recording
+};
+
+} // namespace
+
+RS485Analyzer::Report RS485Analyzer::analyze(const WaveformRecorder& recorder, uint data_gpio, uint enable_gpio,
+                                             const Spec& spec) {
+    Report report;
+    const uint64_t start_cycle = recorder.startCycle();
+    const uint64_t stop_cycle = recorder.stopCycle();
+
+    // Collect the DE-high windows
+    std::vector<Window> windows;
+    if (enable_gpio >= NUM_BANK0_GPIOS) {
+        windows.push_back({start_cycle, stop_cycle, false});
+    } else {
+        const WaveformRecorder::Trace& de = recorder.trace(enable_gpio);
+        bool level = de.initial_level;
+        uint64_t on_cycle = start_cycle;
+        for (const WaveformRecorder::Edge& edge : de.edges) {
+            if (edge.level && !level) {
+                on_cycle = edge.cycle;
+            } else if (!edge.level && level) {
+                windows.push_back({on_cycle, edge.cycle, true});
+            }
+            level = edge.level;
+        }
+        if (level) {
+            windows.push_back({on_cycle, stop_cycle, false});
+        }
+    }
+
+    UartDecoder::Result decoded = UartDecoder::decode(recorder, data_gpio, spec.format);
+    const std::vector<UartDecoder::Character>& chars = decoded.characters;
+
+    const double bit_us = 1e6 / spec.format.baud_rate;
+    const double bit_error_max_us = (spec.bit_error_max_us > 0.0) ? spec.bit_error_max_us : bit_us * 0.02;
+
+    size_t c = 0;
+    double total_window_us = 0.0;
+    double total_char_us = 0.0;
+    uint64_t total_bytes = 0;
+
+    for (size_t w = 0; w < windows.size(); w++) {
+        const Window& window = windows[w];
+        std::vector<uint8_t> frame;
+
+        // Characters that start before DE is asserted are not on the bus
+        while (c < chars.size() && chars[c].start_cycle < window.on_cycle) {
+            report.bytes_outside_de++;
+            c++;
+        }
+
+        const size_t first = c;
+        while (c < chars.size() && chars[c].start_cycle < window.off_cycle) {
+            const UartDecoder::Character& ch = chars[c];
+            frame.push_back(ch.value);
+
+            if (window.closed && ch.end_cycle > window.off_cycle) {
+                report.bytes_outside_de++;
+            }
+            if (ch.framing_error) {
+                report.framing_errors++;
+            }
+            if (ch.parity_error) {
+                report.parity_errors++;
+            }
+            if (ch.max_edge_error_us > report.max_bit_error_us) {
+                report.max_bit_error_us = ch.max_edge_error_us;
+            }
+            if (ch.max_edge_error_us > bit_error_max_us) {
+                report.timing_violations++;
+            }
+            if (c > first) {
+                report.inter_byte_gap.add(recorder.cyclesToUs(UartDecoder::idleCycles(chars[c - 1], ch)));
+            }
+            total_char_us += recorder.cyclesToUs(ch.end_cycle - ch.start_cycle);
+            c++;
+        }
+
+        if (!frame.empty()) {
+            double setup_us = recorder.cyclesToUs(chars[first].start_cycle - window.on_cycle);
+            report.de_setup.add(setup_us);
+            if (setup_us < spec.de_setup_min_us) {
+                report.timing_violations++;
+            }
+
+            const UartDecoder::Character& last = chars[c - 1];
+            if (window.closed && window.off_cycle >= last.end_cycle) {
+                double hold_us = recorder.cyclesToUs(window.off_cycle - last.end_cycle);
+                report.de_hold.add(hold_us);
+                if (hold_us < spec.de_hold_min_us) {
+                    report.timing_violations++;
+                }
+            }
+        }
+
+        if (w + 1 < windows.size()) {
+            report.dead_time.add(recorder.cyclesToUs(windows[w + 1].on_cycle - window.off_cycle));
+        }
+
+        double window_us = recorder.cyclesToUs(window.off_cycle - window.on_cycle);
+        report.frame_time.add(window_us);
+        total_window_us += window_us;
+        total_bytes += frame.size();
+
+        report.frames.push_back(frame);
+        report.frame_count++;
+    }
+
+    // Anything after the last window was sent with the driver disabled
+    report.bytes_outside_de += chars.size() - c;
+
+    if (windows.size() > 1) {
+        double span_us = recorder.cyclesToUs(windows.back().on_cycle - windows.front().on_cycle);
+        report.frame_rate_hz = (windows.size() - 1) * 1e6 / span_us;
+    }
+    if (total_window_us > 0.0) {
+        report.throughput_bps = total_bytes * 1e6 / total_window_us;
+        report.line_efficiency = total_char_us / total_window_us;
+    }
+
+    return report;
+}
+
+RS485Analyzer::Report RS485Analyzer::analyze(const WaveformRecorder& recorder, uint data_gpio, uint enable_gpio) {
+    return analyze(recorder, data_gpio, enable_gpio, Spec());
+}
+
+void RS485Analyzer::printReport(const Report& report, const char* title) {
+    printf("%s\n", title);
+    printf("  Frames (DE windows): %u\n", report.frame_count);
+    printf("  Frame rate: %.2f Hz\n", report.frame_rate_hz);
+    printf("  Throughput: %.0f bytes/s (%.1f%% line efficiency)\n",
+           report.throughput_bps, report.line_efficiency * 100.0);
+    report.de_setup.print("DE setup:");
+    report.de_hold.print("DE hold:");
+    report.dead_time.print("DE dead time:");
+    report.frame_time.print("DE window:");
+    report.inter_byte_gap.print("Inter-byte gap:");
+    printf("  Max bit edge error: %.3f us\n", report.max_bit_error_us);
+    printf("  Bytes outside DE: %u\n", report.bytes_outside_de);
+    printf("  Framing errors: %u\n", report.framing_errors);
+    printf("  Parity errors: %u\n", report.parity_errors);
+    printf("  Timing violations: %u\n", report.timing_violations);
+    printf("  Result: %s\n", report.passed() ? "PASS" : "FAIL");
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "waveform_recorder.h"
+#include "timing_stats.h"
+#include "uart_decoder.h"
+#include <vector>
+
+/**
+ * @brief Decodes and checks a recorded RS485 data line and its driver
+ *        enable (DE) pin
+ *
+ * Each DE-high window is one frame. Characters must start after DE is
+ * asserted and finish before it is released, otherwise the transceiver
+ * truncates them on the bus.
+ */
+class RS485Analyzer {
+public:
+    struct Spec {
+        UartDecoder::Format format = {115200, 8, 1, false, false};
+        double de_setup_min_us = 0.0;   // DE assert to first start bit
+        double de_hold_min_us = 0.0;    // Last stop bit to DE release
+        double bit_error_max_us = 0.0;  // 0 = 2% of the bit time
+    };
+
+    struct Report {
+        uint32_t frame_count = 0;
+        std::vector<std::vector<uint8_t>> frames;   // Bytes sent per DE window
+
+        TimingStats de_setup;           // DE assert to first start bit
+        TimingStats de_hold;            // End of last stop bit to DE release
+        TimingStats dead_time;          // DE release to next DE assert
+        TimingStats frame_time;         // DE window length
+        TimingStats inter_byte_gap;     // Idle time between characters in a window
+
+        uint32_t bytes_outside_de = 0;  // Characters (partly) sent with DE low
+        uint32_t framing_errors = 0;
+        uint32_t parity_errors = 0;
+        uint32_t timing_violations = 0;
+        double max_bit_error_us = 0.0;
+
+        double frame_rate_hz = 0.0;
+        double throughput_bps = 0.0;    // Payload bytes/s over the DE windows
+        double line_efficiency = 0.0;   // Character time / DE window time
+
+        bool passed() const {
+            return bytes_outside_de == 0 && framing_errors == 0 && parity_errors == 0 &&
+                   timing_violations == 0;
+        }
+    };
+
+    /**
+     * @brief Analyze a recorded RS485 transmitter
+     * @param enable_gpio DE pin, or NUM_BANK0_GPIOS when the transceiver
+     *        has no direction control (the whole recording is one window)
+     */
+    static Report analyze(const WaveformRecorder& recorder, uint data_gpio, uint enable_gpio,
+                          const Spec& spec);
+    static Report analyze(const WaveformRecorder& recorder, uint data_gpio, uint enable_gpio);
+
+    static void printReport(const Report& report, const char* title);
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+
+/**
+ * @brief Running min / max / average of a measured duration
+ */
+struct TimingStats {
+    uint32_t count = 0;
+    double min_us = 0.0;
+    double max_us = 0.0;
+    double total_us = 0.0;
+
+    void add(double us) {
+        if (count == 0 || us < min_us) {
+            min_us = us;
+        }
+        if (count == 0 || us > max_us) {
+            max_us = us;
+        }
+        total_us += us;
+        count++;
+    }
+
+    double avg() const { return count > 0 ? total_us / count : 0.0; }
+
+    /**
+     * @brief Print one report line ("  label: min / avg / max us (n)")
+     */
+    void print(const char* label) const {
+        if (count == 0) {
+            printf("  %-22s -\n", label);
+            return;
+        }
+        printf("  %-22s min %.3f / avg %.3f / max %.3f us (%u)\n",
+               label, min_us, avg(), max_us, count);
+    }
+};
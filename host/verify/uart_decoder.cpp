@@ -0,0 +1,87 @@
+#include "uart_decoder.h"
+#include <cmath>
+
+uint UartDecoder::bitsPerCharacter(const Format& format) {
+    return 1 + format.data_bits + (format.parity_enable ? 1 : 0) + format.stop_bits;
+}
+
+UartDecoder::Result UartDecoder::decode(const WaveformRecorder& recorder, uint gpio, const Format& format) {
+    Result result;
+    const std::vector<WaveformRecorder::Edge>& edges = recorder.trace(gpio).edges;
+    const size_t edge_count = edges.size();
+    const uint64_t stop_cycle = recorder.stopCycle();
+
+    const double bit_cycles = (double)recorder.sysClockHz() / format.baud_rate;
+    const uint char_bits = bitsPerCharacter(format);
+    const uint low_bits_max = char_bits - format.stop_bits;   // Start, data and parity bits
+
+    size_t index = 0;
+    while (index < edge_count) {
+        if (edges[index].level) {
+            index++;
+            continue;
+        }
+
+        // Falling edge: either a start bit or the beginning of a break
+        const uint64_t start = edges[index].cycle;
+        const uint64_t low_end = (index + 1 < edge_count) ? edges[index + 1].cycle : stop_cycle;
+
+        if ((double)(low_end - start) > (low_bits_max + 0.5) * bit_cycles) {
+            result.breaks.push_back({start, low_end});
+            index++;
+            continue;
+        }
+
+        // Sample every bit in the middle of its period. Sample points only
+        // move forward, so the edge cursor never has to rewind.
+        size_t cursor = index;
+        auto sample = [&](uint bit) {
+            uint64_t cycle = start + (uint64_t)((bit + 0.5) * bit_cycles);
+            while (cursor + 1 < edge_count && edges[cursor + 1].cycle <= cycle) {
+                cursor++;
+            }
+            return edges[cursor].level;
+        };
+
+        Character character = {};
+        character.start_cycle = start;
+        character.end_cycle = start + (uint64_t)(char_bits * bit_cycles + 0.5);
+
+        uint bit = 1;
+        uint ones = 0;
+        for (uint i = 0; i < format.data_bits; i++, bit++) {
+            if (sample(bit)) {
+                character.value |= 1u << i;
+                ones++;
+            }
+        }
+        if (format.parity_enable) {
+            bool parity = sample(bit++);
+            bool expected = format.parity_even ? (ones & 1) : !(ones & 1);
+            character.parity_error = (parity != expected);
+        }
+        for (uint i = 0; i < format.stop_bits; i++, bit++) {
+            if (!sample(bit)) {
+                character.framing_error = true;
+            }
+        }
+
+        // Every edge inside the character should sit on a bit boundary
+        const double last_boundary = (char_bits - 0.5) * bit_cycles;
+        size_t next = index + 1;
+        while (next < edge_count && (double)(edges[next].cycle - start) < last_boundary) {
+            double offset = (double)(edges[next].cycle - start);
+            double error = std::fabs(offset - std::round(offset / bit_cycles) * bit_cycles);
+            double error_us = recorder.cyclesToUs((uint64_t)(error + 0.5));
+            if (error_us > character.max_edge_error_us) {
+                character.max_edge_error_us = error_us;
+            }
+            next++;
+        }
+
+        result.characters.push_back(character);
+        index = next;
+    }
+
+    return result;
+}
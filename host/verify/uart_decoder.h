@@ -0,0 +1,60 @@
+#pragma once
+
+#include "waveform_recorder.h"
+#include <vector>
+
+/**
+ * @brief Asynchronous serial decoder for recorded TX waveforms
+ *
+ * Shared by the DMX512 and RS485 analyzers. A low period longer than one
+ * whole character is reported as a break instead of a character.
+ */
+class UartDecoder {
+public:
+    struct Format {
+        uint32_t baud_rate;
+        uint8_t data_bits;
+        uint8_t stop_bits;
+        bool parity_enable;
+        bool parity_even;
+    };
+
+    struct Character {
+        uint64_t start_cycle;       // Falling edge of the start bit
+        uint64_t end_cycle;         // Nominal end of the last stop bit
+        uint8_t value;
+        bool framing_error;         // A stop bit was sampled low
+        bool parity_error;
+        double max_edge_error_us;   // Worst edge distance from the nominal bit grid
+    };
+
+    struct Break {
+        uint64_t start_cycle;
+        uint64_t end_cycle;
+    };
+
+    struct Result {
+        std::vector<Character> characters;
+        std::vector<Break> breaks;
+    };
+
+    /**
+     * @brief Decode the recorded waveform of a TX pin
+     */
+    static Result decode(const WaveformRecorder& recorder, uint gpio, const Format& format);
+
+    /**
+     * @brief Number of bit periods in one character, start and stop bits included
+     */
+    static uint bitsPerCharacter(const Format& format);
+
+    /**
+     * @brief Idle time between two characters
+     *
+     * end_cycle is rounded from the nominal bit time, so back-to-back
+     * characters can appear to overlap by a cycle; that counts as no gap.
+     */
+    static uint64_t idleCycles(const Character& previous, const Character& next) {
+        return next.start_cycle > previous.end_cycle ? next.start_cycle - previous.end_cycle : 0;
+    }
+};
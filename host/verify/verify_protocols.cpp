@@ -0,0 +1,2190 @@
+#include "ws2812_driver.h"
+#include "ws2812_parallel_driver.h"
+#include "ws2812_group.h"
+#include "apa102_driver.h"
+#include "dmx512_transmitter.h"
+#include "dmx512_universe_manager.h"
+#include "rs485_serial.h"
+#include "irq_dispatcher.h"
+#include "host_sim.h"
+#include "waveform_recorder.h"
+#include "ws2812_analyzer.h"
+#include "apa102_analyzer.h"
+#include "dmx512_analyzer.h"
+#include "rs485_analyzer.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+/**
+ * @brief Protocol waveform verifier
+ *
+ * Runs each driver on the host simulation, records its output pins and
+ * decodes the waveform back into pixels, DMX slots and UART bytes. The
+ * decoded data is compared with what the driver was asked to send and the
+ * timing is checked against the protocol specs. Exits non-zero if any
+ * scenario fails.
+ *
+ * Usage: verify_protocols [ws2812|ws2812_rgbw|ws2812_buffered|ws2812_output|ws2812_dither|ws2812_dirty|ws2812_packed|ws2812_stream|ws2812_map|ws2812_math|ws2812_parallel|ws2812_timing|ws2812_group|apa102|dmx|dmx_commit|dmx_universes|rs485|coexist]...
+ */
+
+static const uint LED_PIN = DEFAULT_LED_PIN;
+static const uint LED_COUNT = 64;
+static const uint PARALLEL_BASE_PIN = 10;
+static const uint APA102_CLOCK_PIN = DEFAULT_APA102_CLOCK_PIN;
+static const uint APA102_DATA_PIN = DEFAULT_APA102_DATA_PIN;
+static const uint DMX_PIN = DEFAULT_DMX_PIN;
+static const uint RS485_DATA_PIN = DEFAULT_RS485_DATA_PIN;
+static const uint RS485_ENABLE_PIN = DEFAULT_RS485_ENABLE_PIN;
+
+static bool check(bool ok, const char* what) {
+    printf("  Check %-40s %s\n", what, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ===========================================
+// WS2812
+// ===========================================
+
+static void ws2812_test_color(uint index, uint8_t& r, uint8_t& g, uint8_t& b) {
+    r = (uint8_t)(index * 3);
+    g = (uint8_t)(255 - index);
+    b = (uint8_t)(index * 7 + 1);
+}
+
+static bool verify_ws2812(bool use_dma) {
+    const uint frames = 3;
+
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, use_dma, 1};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    host_sim_reset_irq_stats();
+    recorder.start();
+    for (uint frame = 0; frame < frames; frame++) {
+        // Unchanged frames are skipped; send the whole strip every time
+        driver.markDirty(0, LED_COUNT);
+        driver.update(true);
+    }
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, use_dma ? "WS2812 (DMA):" : "WS2812 (PIO FIFO):");
+
+    // DMA completion plus the latch alarm
+    uint64_t irq_cycles = host_sim_get_irq_stats(DMA_IRQ_0).cycles + host_sim_get_irq_stats(TIMER_IRQ_3).cycles;
+    double irq_us_per_frame = recorder.cyclesToUs(irq_cycles) / frames;
+    printf("  IRQ time per frame: %.3f us\n", irq_us_per_frame);
+
+    bool ok = check(report.frame_count == frames, "frame count");
+    ok &= check(irq_us_per_frame < 5.0, "IRQ time per frame below 5 us");
+
+    bool data_ok = true;
+    for (const std::vector<uint32_t>& pixels : report.frames) {
+        if (pixels.size() != LED_COUNT) {
+            data_ok = false;
+            break;
+        }
+        for (uint i = 0; i < LED_COUNT; i++) {
+            uint8_t r, g, b;
+            ws2812_test_color(i, r, g, b);
+            if (pixels[i] != (((uint32_t)g << 16) | ((uint32_t)r << 8) | b)) {
+                data_ok = false;
+            }
+        }
+    }
+    ok &= check(data_ok, "decoded pixels match buffer");
+    ok &= check(report.passed(), "timing within spec");
+
+    // Raw data comes back in GRB order
+    uint8_t raw[LED_COUNT * 3];
+    bool raw_ok = driver.getPixelData(raw, LED_COUNT);
+    for (uint i = 0; raw_ok && i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        raw_ok = (raw[i * 3] == g && raw[i * 3 + 1] == r && raw[i * 3 + 2] == b);
+    }
+    ok &= check(raw_ok, "raw pixel data read back");
+
+    driver.end();
+    return ok;
+}
+
+/**
+ * @brief Send RGBW pixels, half with white set and half from RGB data with
+ *        the white extracted, and check all 32 bits of each on the wire
+ */
+static bool verify_ws2812_rgbw(bool use_dma) {
+    const uint half = LED_COUNT / 2;
+
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::RGBW, use_dma, 1,
+                                   false, 0, true};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    uint8_t rgb[LED_COUNT * 3];
+    uint8_t expected[LED_COUNT][4];
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        if (i < half) {
+            driver.setPixelColor(i, r, g, b, (uint8_t)(i + 1));
+            expected[i][0] = r;
+            expected[i][1] = g;
+            expected[i][2] = b;
+            expected[i][3] = (uint8_t)(i + 1);
+        } else {
+            rgb[i * 3] = r;
+            rgb[i * 3 + 1] = g;
+            rgb[i * 3 + 2] = b;
+            uint8_t w = (r < g) ? r : g;
+            w = (b < w) ? b : w;
+            expected[i][0] = r - w;
+            expected[i][1] = g - w;
+            expected[i][2] = b - w;
+            expected[i][3] = w;
+        }
+    }
+    driver.setPixelDataRGB(rgb + half * 3, LED_COUNT - half, half);
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    // Full frame, then dimmed through the output stage
+    driver.update(true);
+    driver.setBrightness(128);
+    driver.update(true);
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN, 32);
+    WS2812Analyzer::printReport(report, use_dma ? "WS2812 RGBW (DMA):" : "WS2812 RGBW (PIO FIFO):");
+    bool ok = check(report.frame_count == 2, "frame count");
+
+    bool data_ok = report.frame_count == 2 && report.frames[0].size() == LED_COUNT &&
+                   report.frames[1].size() == LED_COUNT;
+    const uint8_t* table = driver.getOutputTable();
+    for (uint i = 0; data_ok && i < LED_COUNT; i++) {
+        const uint8_t* c = expected[i];
+        uint32_t full = ((uint32_t)c[1] << 24) | ((uint32_t)c[0] << 16) | ((uint32_t)c[2] << 8) | c[3];
+        uint32_t dimmed = ((uint32_t)table[c[1]] << 24) | ((uint32_t)table[c[0]] << 16) |
+                          ((uint32_t)table[c[2]] << 8) | table[c[3]];
+        data_ok = report.frames[0][i] == full && report.frames[1][i] == dimmed;
+    }
+    ok &= check(data_ok, "decoded G, R, B, W match buffer");
+    ok &= check(report.passed(), "timing within spec");
+
+    // Raw data comes back as R, G, B, W
+    uint8_t raw[LED_COUNT * 4];
+    bool raw_ok = driver.getPixelData(raw, LED_COUNT);
+    for (uint i = 0; raw_ok && i < LED_COUNT; i++) {
+        raw_ok = memcmp(raw + i * 4, expected[i], 4) == 0;
+    }
+    ok &= check(raw_ok, "raw pixel data read back");
+
+    driver.end();
+    return ok;
+}
+
+/**
+ * @brief Present frames faster than they can be sent and check that every
+ *        frame on the wire is one complete presented frame
+ */
+static bool verify_ws2812_buffered(uint num_buffers) {
+    const uint frames = 6;
+
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, num_buffers};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    // Frame f shows test colors shifted by f * 11
+    bool accepted = true;
+    for (uint frame = 0; frame < frames; frame++) {
+        for (uint i = 0; i < LED_COUNT; i++) {
+            uint8_t r, g, b;
+            ws2812_test_color(i + frame * 11, r, g, b);
+            driver.setPixelColor(i, r, g, b);
+        }
+        if (num_buffers >= 3) {
+            accepted &= driver.present(false);
+        } else {
+            while (!driver.present(false)) {
+                tight_loop_contents();
+            }
+        }
+    }
+    accepted &= driver.waitForCompletion(100);
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, num_buffers >= 3 ? "WS2812 (triple buffered):" : "WS2812 (double buffered):");
+
+    // Decode which presented frame each transmitted frame is, -1 if torn
+    std::vector<int> shown;
+    for (const std::vector<uint32_t>& pixels : report.frames) {
+        int match = -1;
+        for (uint frame = 0; frame < frames && match < 0 && pixels.size() == LED_COUNT; frame++) {
+            bool same = true;
+            for (uint i = 0; i < LED_COUNT && same; i++) {
+                uint8_t r, g, b;
+                ws2812_test_color(i + frame * 11, r, g, b);
+                same = (pixels[i] == (((uint32_t)g << 16) | ((uint32_t)r << 8) | b));
+            }
+            if (same) {
+                match = (int)frame;
+            }
+        }
+        shown.push_back(match);
+    }
+
+    bool complete = !shown.empty();
+    bool ordered = true;
+    for (size_t i = 0; i < shown.size(); i++) {
+        complete &= (shown[i] >= 0);
+        ordered &= (i == 0 || shown[i] > shown[i - 1]);
+    }
+
+    bool ok = check(accepted, "presents accepted");
+    ok &= check(complete, "every frame is a whole presented frame");
+    ok &= check(ordered, "frames in presentation order");
+    ok &= check(!shown.empty() && shown.back() == (int)frames - 1, "last presented frame shown");
+    if (num_buffers < 3) {
+        ok &= check(shown.size() == frames, "no frame dropped");
+    }
+
+    driver.end();
+    return ok;
+}
+
+// ===========================================
+// WS2812 parallel
+// ===========================================
+
+/**
+ * @brief Compare the transposition kernel with a bit-by-bit reference
+ */
+/**
+ * @brief Check that brightness and gamma are applied on the wire only and
+ *        leave the pixel buffer unchanged
+ */
+static bool verify_ws2812_output_stage() {
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 1};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    // Dimmed and gamma corrected, then back to the identity
+    bool ok = check(driver.setBrightness(128) && driver.setGamma(2.2f), "brightness and gamma set");
+    driver.update(true);
+    driver.setBrightness(255);
+    driver.setGamma(1.0f);
+    driver.update(true);
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, "WS2812 (brightness 128, gamma 2.2):");
+    ok &= check(report.frame_count == 2, "frame count");
+
+    // Reference curve: brightness scales the gamma-corrected value
+    bool dimmed_ok = report.frame_count == 2 && report.frames[0].size() == LED_COUNT;
+    bool identity_ok = report.frame_count == 2 && report.frames[1].size() == LED_COUNT;
+    bool buffer_ok = true;
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b, w;
+        ws2812_test_color(i, r, g, b);
+        uint32_t expected = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
+
+        uint8_t out[3] = {g, r, b};
+        uint32_t dimmed = 0;
+        for (uint8_t value : out) {
+            uint32_t corrected = (uint32_t)(powf(value / 255.0f, 2.2f) * 65280.0f + 0.5f);
+            dimmed = (dimmed << 8) | (((corrected * 128 / 255) + 128) >> 8);
+        }
+
+        if (dimmed_ok && report.frames[0][i] != dimmed) {
+            dimmed_ok = false;
+        }
+        if (identity_ok && report.frames[1][i] != expected) {
+            identity_ok = false;
+        }
+
+        uint8_t r2, g2, b2;
+        driver.getPixelColor(i, r2, g2, b2, w);
+        buffer_ok &= (r2 == r && g2 == g && b2 == b);
+    }
+    ok &= check(dimmed_ok, "dimmed frame matches curve");
+    ok &= check(identity_ok, "identity frame matches buffer");
+    ok &= check(buffer_ok, "pixel buffer unchanged");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+/**
+ * @brief Run continuous refresh with temporal dithering at low brightness
+ *        and check that the frame average recovers the fractional levels
+ */
+static bool verify_ws2812_dither() {
+    const uint frames = WS2812_DITHER_PHASES * 2;
+    const uint8_t brightness = 20;
+
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 2};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+    driver.present();
+    driver.waitForCompletion();
+    driver.setBrightness(brightness);
+    driver.setDithering(true);
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    bool ok = check(driver.startContinuousRefresh(), "continuous refresh started");
+    uint32_t updates, errors;
+    driver.getStatistics(updates, errors);
+    uint32_t target = updates + frames;
+    while (updates < target) {
+        host_sim_run_us(100);
+        driver.getStatistics(updates, errors);
+    }
+    driver.stopContinuousRefresh();
+    driver.waitForCompletion();
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, "WS2812 (continuous refresh, dithered):");
+    ok &= check(report.frame_count >= frames, "refresh loop kept sending");
+    ok &= check(!driver.isBusy(), "refresh loop stopped");
+
+    // Back to back frames: the gap is only the FIFO drain estimate and the
+    // reset time
+    double frame_time_us = LED_COUNT * 24 * 1.25;
+    double expected_period_us = frame_time_us + WS2812_RESET_TIME_US + 5;
+    printf("  Frame period: %.1f us (line limit %.1f us)\n", report.frame_period.avg(), expected_period_us);
+    ok &= check(report.frame_period.max_us <= expected_period_us, "frames sent back to back");
+
+    // Over one full cycle every channel averages to its 8.8 table value
+    // within one dither step, using only the two nearest output values
+    const uint16_t* table = driver.getOutputTable16();
+    bool levels_ok = report.frame_count >= WS2812_DITHER_PHASES;
+    bool average_ok = levels_ok;
+    uint dithered_channels = 0;
+    for (uint i = 0; levels_ok && i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        uint8_t channels[3] = {g, r, b};
+        for (uint c = 0; c < 3; c++) {
+            uint32_t level = table[channels[c]];
+            uint32_t sum = 0;
+            bool varied = false;
+            for (uint f = 0; f < WS2812_DITHER_PHASES; f++) {
+                const std::vector<uint32_t>& pixels = report.frames[f];
+                if (pixels.size() != LED_COUNT) {
+                    levels_ok = false;
+                    break;
+                }
+                uint32_t value = (pixels[i] >> (16 - c * 8)) & 0xFF;
+                if (value != (level >> 8) && value != (level >> 8) + 1) {
+                    levels_ok = false;
+                }
+                varied |= (value != ((report.frames[0][i] >> (16 - c * 8)) & 0xFF));
+                sum += value;
+            }
+            dithered_channels += varied ? 1 : 0;
+            int32_t error = (int32_t)(sum * 256 / WS2812_DITHER_PHASES) - (int32_t)level;
+            if (error < -32 || error > 32) {
+                average_ok = false;
+            }
+        }
+    }
+    printf("  Dithered channels: %u of %u\n", dithered_channels, LED_COUNT * 3);
+    ok &= check(levels_ok, "only the two nearest levels are sent");
+    ok &= check(average_ok, "cycle average matches 8.8 level");
+    ok &= check(dithered_channels > 0, "fractional levels are dithered");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+/**
+ * @brief Check that only the prefix up to the last changed pixel is sent,
+ *        and that unchanged frames are skipped
+ */
+static bool verify_ws2812_dirty(uint num_buffers) {
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, num_buffers};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    // Full first frame, pixel 9 changed, nothing changed, pixel 9 set to
+    // the same color again, last pixel changed
+    std::vector<uint> expected = {LED_COUNT, 10, LED_COUNT};
+    driver.update(true);
+    driver.setPixelColor(9, 1, 2, 3);
+    driver.update(true);
+    driver.update(true);
+    driver.setPixelColor(9, 1, 2, 3);
+    driver.update(true);
+    driver.setPixelColor(LED_COUNT - 1, 4, 5, 6);
+    driver.update(true);
+
+    if (num_buffers == 3) {
+        // A frame changing pixels up to 40 is replaced while it waits by
+        // one changing pixel 4: the pixels of both have to be sent
+        driver.setPixelColor(0, 7, 8, 9);
+        driver.present();
+        driver.setPixelColor(39, 10, 11, 12);
+        driver.present();
+        driver.setPixelColor(4, 13, 14, 15);
+        driver.present();
+        driver.waitForCompletion();
+        expected.push_back(1);
+        expected.push_back(40);
+    }
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    char title[64];
+    snprintf(title, sizeof(title), "WS2812 dirty tracking (%u buffer%s):", num_buffers, num_buffers > 1 ? "s" : "");
+    WS2812Analyzer::printReport(report, title);
+
+    bool ok = check(report.frame_count == expected.size(), "frame count");
+    bool lengths_ok = report.frame_count == expected.size();
+    for (uint f = 0; lengths_ok && f < expected.size(); f++) {
+        printf("  Frame %u: %u pixels\n", f, (unsigned)report.frames[f].size());
+        lengths_ok &= (report.frames[f].size() == expected[f]);
+    }
+    ok &= check(lengths_ok, "frames cut after last changed pixel");
+
+    // The last frame carries the new colors of the replaced frame too
+    if (num_buffers == 3 && lengths_ok) {
+        const std::vector<uint32_t>& last = report.frames.back();
+        ok &= check(last[39] == ((11u << 16) | (10u << 8) | 12u) && last[4] == ((14u << 16) | (13u << 8) | 15u),
+                    "replaced frame's changes sent");
+    }
+    ok &= check(driver.getDirtyLength() == 0, "nothing left to send");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+/**
+ * @brief Send packed 3-byte pixels through 8-bit autopull and check the
+ *        decoded frames, including a dirty prefix and a dimmed frame
+ */
+static bool verify_ws2812_packed(bool use_dma) {
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, use_dma, 1, true};
+    WS2812Driver driver(config);
+    if (WS2812_CHANNEL_BITS != 8) {
+        return check(!driver.begin(), "16-bit pixels cannot be packed");
+    }
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+    bool ok = check(driver.isPacked() && driver.getPixelBuffer() == nullptr, "pixels stored packed");
+
+    // GRB data is already in the packed layout
+    uint8_t data[LED_COUNT * 3];
+    for (uint i = 0; i < LED_COUNT; i++) {
+        ws2812_test_color(i, data[i * 3 + 1], data[i * 3], data[i * 3 + 2]);
+    }
+    driver.setPixelData(data, LED_COUNT);
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    // Full frame, pixel 9 changed, then the whole strip dimmed
+    driver.update(true);
+    driver.setPixelColor(9, 1, 2, 3);
+    driver.update(true);
+    driver.setBrightness(128);
+    driver.update(true);
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, use_dma ? "WS2812 packed (DMA):" : "WS2812 packed (PIO FIFO):");
+    ok &= check(report.frame_count == 3, "frame count");
+
+    bool data_ok = report.frame_count == 3 && report.frames[0].size() == LED_COUNT &&
+                   report.frames[1].size() == 10 && report.frames[2].size() == LED_COUNT;
+    const uint8_t* table = driver.getOutputTable();
+    for (uint i = 0; data_ok && i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        uint32_t expected = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
+        if (report.frames[0][i] != expected || (i < 9 && report.frames[1][i] != expected)) {
+            data_ok = false;
+        }
+        if (i == 9) {
+            g = 2;
+            r = 1;
+            b = 3;
+        }
+        uint32_t dimmed = ((uint32_t)table[g] << 16) | ((uint32_t)table[r] << 8) | table[b];
+        if (report.frames[2][i] != dimmed) {
+            data_ok = false;
+        }
+    }
+    ok &= check(data_ok && report.frames[1][9] == ((2u << 16) | (1u << 8) | 3u), "decoded pixels match buffer");
+
+    uint8_t r, g, b, w;
+    ok &= check(driver.getPixelColor(9, r, g, b, w) && r == 1 && g == 2 && b == 3, "pixel read back");
+
+    const uint8_t rgb[3] = {4, 5, 6};
+    ok &= check(driver.setPixelDataRGB(rgb, 1, 20) && driver.getPixelColor(20, r, g, b, w) && r == 4 && g == 5 &&
+                    b == 6,
+                "RGB data stored packed");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+static void stream_test_producer(uint first_pixel, uint count, uint32_t* out, void* user_data) {
+    WS2812Driver* driver = static_cast<WS2812Driver*>(user_data);
+    for (uint i = 0; i < count; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(first_pixel + i, r, g, b);
+        out[i] = driver->colorToNative(r, g, b);
+    }
+}
+
+/**
+ * @brief Stream a strip longer than MAX_LED_COUNT through the chunk ring
+ *        and check that the chunks join into one gapless frame
+ */
+static bool verify_ws2812_stream() {
+    const uint stream_pixels = MAX_LED_COUNT + 476;
+    const uint chunk_pixels = 48;
+
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, stream_pixels, WS2812Driver::ColorFormat::GRB, true, 1, false,
+                                   chunk_pixels};
+    WS2812Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+    printf("  Chunk ring: %u bytes for %u pixels\n",
+           (unsigned)(WS2812_STREAM_CHUNKS * chunk_pixels * sizeof(uint32_t)), stream_pixels);
+    bool ok = check(driver.isStreaming() && !driver.update(), "no frame buffer");
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    host_sim_reset_irq_stats();
+    recorder.start();
+
+    // As drawn, then dimmed by the output stage
+    ok &= check(driver.streamFrame(stream_test_producer, &driver, true), "first frame streamed");
+    driver.setBrightness(128);
+    ok &= check(driver.streamFrame(stream_test_producer, &driver, true), "dimmed frame streamed");
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, "WS2812 streaming:");
+
+    uint chunks = (stream_pixels + chunk_pixels - 1) / chunk_pixels;
+    uint64_t irq_cycles = host_sim_get_irq_stats(DMA_IRQ_0).cycles;
+    printf("  DMA IRQ time per chunk: %.3f us\n", recorder.cyclesToUs(irq_cycles) / (chunks * 2));
+
+    ok &= check(report.frame_count == 2, "frame count");
+    bool data_ok = report.frame_count == 2 && report.frames[0].size() == stream_pixels &&
+                   report.frames[1].size() == stream_pixels;
+    const uint8_t* table = driver.getOutputTable();
+    for (uint i = 0; data_ok && i < stream_pixels; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        uint32_t expected = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
+        uint32_t dimmed = ((uint32_t)table[g] << 16) | ((uint32_t)table[r] << 8) | table[b];
+        data_ok = (report.frames[0][i] == expected && report.frames[1][i] == dimmed);
+    }
+    ok &= check(data_ok, "decoded pixels match producer");
+
+    uint32_t updates, errors;
+    driver.getStatistics(updates, errors);
+    ok &= check(updates == 2 && errors == 0, "no late chunks");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+// 16 x 4 display of two 8 x 4 serpentine modules
+static constexpr PixelLayout MAP_TEST_LAYOUT = {16, 4, 8, 4, 0, false, true, false};
+static_assert(PixelMap::isValid(MAP_TEST_LAYOUT), "invalid test layout");
+static constexpr PixelMap::Table<LED_COUNT> MAP_TEST_TABLE = PixelMap::make<LED_COUNT>(MAP_TEST_LAYOUT);
+
+// Wiring of a few pixels worked out by hand
+static_assert(PixelMap::wireIndex(MAP_TEST_LAYOUT, 0, 1) == 15, "serpentine row");
+static_assert(PixelMap::wireIndex(MAP_TEST_LAYOUT, 8, 0) == 32, "second module");
+static_assert(PixelMap::wireIndex({16, 4, 0, 0, 2, false, false, false}, 0, 0) == 63, "rotated panel");
+static_assert(PixelMap::wireIndex({4, 16, 0, 0, 1, false, false, false}, 0, 0) == 15, "quarter turn");
+
+/**
+ * @brief Draw in XY space on a tiled serpentine panel and check that the
+ *        frame on the wire is in wiring order
+ */
+static bool verify_ws2812_map(bool packed) {
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 1, packed};
+    WS2812Driver driver(config);
+    if (WS2812_CHANNEL_BITS != 8 && packed) {
+        return check(!driver.begin(), "16-bit pixels cannot be packed");
+    }
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    // The runtime build matches the compiled table
+    uint16_t runtime_table[LED_COUNT];
+    bool ok = check(PixelMap::build(MAP_TEST_LAYOUT, runtime_table, LED_COUNT) &&
+                    memcmp(runtime_table, MAP_TEST_TABLE.index, sizeof(runtime_table)) == 0,
+                    "runtime table matches constexpr");
+    ok &= check(driver.setPixelMap(MAP_TEST_TABLE.index), "pixel map set");
+
+    for (uint y = 0; y < MAP_TEST_LAYOUT.height; y++) {
+        for (uint x = 0; x < MAP_TEST_LAYOUT.width; x++) {
+            uint8_t r, g, b;
+            ws2812_test_color(y * MAP_TEST_LAYOUT.width + x, r, g, b);
+            driver.setPixelColorXY(x, y, r, g, b, 0, MAP_TEST_LAYOUT.width);
+        }
+    }
+    if (!packed) {
+        driver.setBrightness(128);
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+
+    // A single changed pixel still sends the whole frame
+    driver.update(true);
+    driver.setPixelColorXY(0, 0, 1, 2, 3, 0, MAP_TEST_LAYOUT.width);
+    driver.update(true);
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, packed ? "WS2812 pixel map (packed):" : "WS2812 pixel map (dimmed):");
+    ok &= check(report.frame_count == 2, "frame count");
+
+    bool data_ok = report.frame_count == 2 && report.frames[0].size() == LED_COUNT &&
+                   report.frames[1].size() == LED_COUNT;
+    const uint8_t* table = driver.getOutputTable();
+    for (uint i = 0; data_ok && i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(MAP_TEST_TABLE.index[i], r, g, b);
+        uint32_t expected = ((uint32_t)table[g] << 16) | ((uint32_t)table[r] << 8) | table[b];
+        data_ok = report.frames[0][i] == expected;
+    }
+    ok &= check(data_ok, "frame sent in wiring order");
+    ok &= check(report.frame_count == 2 && report.frames[1].size() == LED_COUNT &&
+                report.frames[1][0] == (((uint32_t)table[2] << 16) | ((uint32_t)table[1] << 8) | table[3]),
+                "changed frame sent in full");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+/**
+ * @brief Compare the SWAR kernels with per-channel arithmetic
+ *
+ * Every pair of 8-bit channel values is tried in every lane of a word, and
+ * a sample of 16-bit values in 64-bit words.
+ */
+static bool verify_pixel_math_kernels() {
+    static const uint8_t factors[] = {0, 1, 64, 127, 128, 200, 254, 255};
+    bool ok = true;
+
+    for (uint a = 0; a < 256; a++) {
+        for (uint b = 0; b < 256; b++) {
+            uint32_t word_a = (a << 24) | (b << 16) | ((a ^ 0x5A) << 8) | (b ^ 0xA5);
+            uint32_t word_b = (b << 24) | (a << 16) | ((b ^ 0x5A) << 8) | (a ^ 0xA5);
+            uint32_t sum = PixelMath::addSaturate(word_a, word_b);
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint x = (word_a >> shift) & 0xFF;
+                uint y = (word_b >> shift) & 0xFF;
+                ok &= ((sum >> shift) & 0xFF) == (x + y > 255 ? 255 : x + y);
+            }
+            for (uint8_t factor : factors) {
+                uint weight = factor + (factor >> 7);
+                uint32_t scaled = PixelMath::scale8(word_a, factor);
+                uint32_t blended = PixelMath::lerp8(word_a, word_b, factor);
+                for (int shift = 0; shift < 32; shift += 8) {
+                    uint x = (word_a >> shift) & 0xFF;
+                    uint y = (word_b >> shift) & 0xFF;
+                    ok &= ((scaled >> shift) & 0xFF) == (x * (factor + 1u)) >> 8;
+                    ok &= ((blended >> shift) & 0xFF) == (x * (256 - weight) + y * weight) >> 8;
+                }
+            }
+        }
+    }
+
+    uint32_t seed = 0x12345678;
+    for (uint i = 0; i < 4096; i++) {
+        uint64_t words[2];
+        for (uint64_t& word : words) {
+            seed = seed * 1664525 + 1013904223;
+            word = (uint64_t)seed << 32;
+            seed = seed * 1664525 + 1013904223;
+            word |= seed;
+        }
+        uint8_t factor = (uint8_t)(seed >> 24);
+        uint weight = factor + (factor >> 7);
+        uint64_t scaled = PixelMath::scale8(words[0], factor);
+        uint64_t sum = PixelMath::addSaturate(words[0], words[1]);
+        uint64_t blended = PixelMath::lerp8(words[0], words[1], factor);
+        for (int shift = 0; shift < 64; shift += 16) {
+            uint32_t x = (words[0] >> shift) & 0xFFFF;
+            uint32_t y = (words[1] >> shift) & 0xFFFF;
+            ok &= ((scaled >> shift) & 0xFFFF) == (x * (factor + 1u)) >> 8;
+            ok &= ((sum >> shift) & 0xFFFF) == (x + y > 0xFFFF ? 0xFFFF : x + y);
+            ok &= ((blended >> shift) & 0xFFFF) == (x * (256 - weight) + y * weight) >> 8;
+        }
+    }
+
+    printf("Pixel math kernels:\n");
+    return check(ok, "match per-channel arithmetic");
+}
+
+#if WS2812_CHANNEL_BITS == 16
+typedef uint16_t TestChannel;
+static const uint32_t TEST_CHANNEL_MAX = 0xFFFF;
+static const uint32_t TEST_CHANNEL_WIDEN = 257;
+#else
+typedef uint8_t TestChannel;
+static const uint32_t TEST_CHANNEL_MAX = 0xFF;
+static const uint32_t TEST_CHANNEL_WIDEN = 1;
+#endif
+
+static void read_test_pixels(WS2812Driver& driver, TestChannel (*pixels)[3]) {
+    for (uint i = 0; i < LED_COUNT; i++) {
+        TestChannel w;
+#if WS2812_CHANNEL_BITS == 16
+        driver.getPixelColor16(i, pixels[i][0], pixels[i][1], pixels[i][2], w);
+#else
+        driver.getPixelColor(i, pixels[i][0], pixels[i][1], pixels[i][2], w);
+#endif
+    }
+}
+
+/**
+ * @brief Scale, fade, add and blend the pixel buffer and check the channels
+ *        and what goes on the wire
+ */
+static bool verify_ws2812_pixel_ops(bool packed) {
+    host_sim_reset();
+    WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 1, packed};
+    WS2812Driver driver(config);
+    if (packed && WS2812_CHANNEL_BITS != 8) {
+        return check(!driver.begin(), "16-bit pixels cannot be packed");
+    }
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.start();
+    driver.update(true);
+
+    // Scaling by 255 changes nothing, so nothing is sent
+    driver.scalePixels(255);
+    driver.update(true);
+
+    static TestChannel before[LED_COUNT][3];
+    static TestChannel after[LED_COUNT][3];
+    const uint32_t color[3] = {10 * TEST_CHANNEL_WIDEN, 200 * TEST_CHANNEL_WIDEN, 30 * TEST_CHANNEL_WIDEN};
+    const uint32_t added[3] = {40 * TEST_CHANNEL_WIDEN, 0, 250 * TEST_CHANNEL_WIDEN};
+    bool fade_ok = true;
+    bool add_ok = true;
+    bool blend_ok = true;
+
+    read_test_pixels(driver, before);
+    driver.fadeToBlackBy(100);
+    read_test_pixels(driver, after);
+    for (uint i = 0; i < LED_COUNT; i++) {
+        for (uint c = 0; c < 3; c++) {
+            fade_ok &= after[i][c] == (before[i][c] * 156u) >> 8;
+        }
+    }
+
+    memcpy(before, after, sizeof(before));
+    driver.addColor(40, 0, 250);
+    read_test_pixels(driver, after);
+    for (uint i = 0; i < LED_COUNT; i++) {
+        for (uint c = 0; c < 3; c++) {
+            uint32_t sum = before[i][c] + added[c];
+            add_ok &= after[i][c] == (sum > TEST_CHANNEL_MAX ? TEST_CHANNEL_MAX : sum);
+        }
+    }
+
+    memcpy(before, after, sizeof(before));
+    driver.blendColor(77, 10, 200, 30);
+    read_test_pixels(driver, after);
+    for (uint i = 0; i < LED_COUNT; i++) {
+        for (uint c = 0; c < 3; c++) {
+            blend_ok &= after[i][c] == (before[i][c] * 179u + color[c] * 77u) >> 8;
+        }
+    }
+    driver.update(true);
+
+    driver.fill(1, 2, 3);
+    uint8_t r, g, b, w;
+    bool fill_ok = true;
+    for (uint i = 0; i < LED_COUNT; i++) {
+        fill_ok &= driver.getPixelColor(i, r, g, b, w) && r == 1 && g == 2 && b == 3;
+    }
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    WS2812Analyzer::printReport(report, packed ? "WS2812 pixel math (packed):" : "WS2812 pixel math:");
+    bool ok = check(report.frame_count == 2, "frame count");
+    ok &= check(fade_ok, "fade to black");
+    ok &= check(add_ok, "saturating add");
+    ok &= check(blend_ok, "blend");
+    ok &= check(fill_ok, "fill");
+
+    bool data_ok = report.frame_count == 2 && report.frames[1].size() == LED_COUNT;
+    for (uint i = 0; data_ok && i < LED_COUNT; i++) {
+        uint32_t shown[3];
+        for (uint c = 0; c < 3; c++) {
+            shown[c] = (after[i][c] * 255u + TEST_CHANNEL_MAX / 2) / TEST_CHANNEL_MAX;
+        }
+        data_ok = report.frames[1][i] == ((shown[1] << 16) | (shown[0] << 8) | shown[2]);
+    }
+    ok &= check(data_ok, "decoded pixels match buffer");
+    ok &= check(report.passed(), "timing within spec");
+
+    driver.end();
+    return ok;
+}
+
+static bool verify_transpose_kernel() {
+    const uint pixels_per_strip = 37;
+    bool ok = true;
+
+    uint32_t pixels[WS2812_PARALLEL_MAX_STRIPS * pixels_per_strip];
+    uint32_t seed = 0x12345678;
+    for (uint32_t& pixel : pixels) {
+        seed = seed * 1664525 + 1013904223;
+        pixel = seed;
+    }
+
+    for (uint bytes_per_pixel = 3; bytes_per_pixel <= 4; bytes_per_pixel++) {
+        for (uint num_strips = 1; num_strips <= WS2812_PARALLEL_MAX_STRIPS; num_strips++) {
+            std::vector<uint32_t> out(pixels_per_strip * 2 * bytes_per_pixel);
+            WS2812ParallelDriver::transpose(pixels, num_strips, pixels_per_strip, bytes_per_pixel, out.data());
+
+            // Plane p of a pixel is byte (3 - p % 4) of word p / 4
+            for (uint i = 0; i < pixels_per_strip; i++) {
+                for (uint plane = 0; plane < bytes_per_pixel * 8; plane++) {
+                    uint32_t word = out[i * 2 * bytes_per_pixel + plane / 4];
+                    uint8_t actual = (uint8_t)(word >> (24 - 8 * (plane % 4)));
+                    uint8_t expected = 0;
+                    for (uint strip = 0; strip < num_strips; strip++) {
+                        uint32_t color = pixels[strip * pixels_per_strip + i];
+                        expected |= ((color >> (31 - plane)) & 1) << strip;
+                    }
+                    ok &= (actual == expected);
+                }
+            }
+        }
+    }
+
+    printf("WS2812 parallel transpose kernel:\n");
+    return check(ok, "matches reference transposition");
+}
+
+static bool verify_ws2812_parallel(bool use_dma) {
+    const uint frames = 3;
+    const uint strips = WS2812_PARALLEL_MAX_STRIPS;
+
+    host_sim_reset();
+    WS2812ParallelDriver::Config config = {pio0, 0, PARALLEL_BASE_PIN, strips, LED_COUNT,
+                                           WS2812Driver::ColorFormat::GRB, use_dma};
+    WS2812ParallelDriver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    // A second driver cannot take a state machine that is in use
+    WS2812ParallelDriver second(config);
+    if (!check(!second.begin(), "claimed state machine refused")) {
+        return false;
+    }
+
+    for (uint strip = 0; strip < strips; strip++) {
+        for (uint i = 0; i < LED_COUNT; i++) {
+            uint8_t r, g, b;
+            ws2812_test_color(i + strip * 37, r, g, b);
+            driver.setPixelColor(strip, i, r, g, b);
+        }
+    }
+
+    WaveformRecorder recorder;
+    for (uint strip = 0; strip < strips; strip++) {
+        recorder.watch(PARALLEL_BASE_PIN + strip);
+    }
+    recorder.start();
+    for (uint frame = 0; frame < frames; frame++) {
+        driver.update(true);
+    }
+    host_sim_run_us(1000);
+    recorder.stop();
+
+    bool ok = true;
+    bool data_ok = true;
+    bool timing_ok = true;
+    bool aligned = true;
+    uint64_t first_rise = recorder.trace(PARALLEL_BASE_PIN).edges.empty() ? 0 :
+                          recorder.trace(PARALLEL_BASE_PIN).edges.front().cycle;
+
+    for (uint strip = 0; strip < strips; strip++) {
+        uint gpio = PARALLEL_BASE_PIN + strip;
+        WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, gpio);
+        if (strip == 0) {
+            WS2812Analyzer::printReport(report, use_dma ? "WS2812 parallel (DMA), strip 0:" :
+                                                          "WS2812 parallel (PIO FIFO), strip 0:");
+        }
+
+        ok &= (report.frame_count == frames);
+        timing_ok &= report.passed();
+
+        // Every bit period starts on all pins in the same cycle
+        const WaveformRecorder::Trace& trace = recorder.trace(gpio);
+        aligned &= !trace.edges.empty() && trace.edges.front().cycle == first_rise;
+
+        for (const std::vector<uint32_t>& pixels : report.frames) {
+            if (pixels.size() != LED_COUNT) {
+                data_ok = false;
+                break;
+            }
+            for (uint i = 0; i < LED_COUNT; i++) {
+                uint8_t r, g, b;
+                ws2812_test_color(i + strip * 37, r, g, b);
+                if (pixels[i] != (((uint32_t)g << 16) | ((uint32_t)r << 8) | b)) {
+                    data_ok = false;
+                }
+            }
+        }
+    }
+
+    ok = check(ok, "frame count on every strip");
+    ok &= check(aligned, "strips start in the same cycle");
+    ok &= check(data_ok, "decoded pixels match every strip");
+    ok &= check(timing_ok, "timing within spec on every strip");
+
+    driver.end();
+    return ok;
+}
+
+// ===========================================
+// LED timing profiles
+// ===========================================
+
+// Analyzer limits of 50 ns around the nominal timing of a profile
+static WS2812Analyzer::Spec timing_spec(const LEDTiming& timing) {
+    WS2812Analyzer::Spec spec;
+    spec.t0h_min_us = (timing.t0h_ns - 50) / 1000.0;
+    spec.t0h_max_us = (timing.t0h_ns + 50) / 1000.0;
+    spec.t1h_min_us = (timing.t1h_ns - 50) / 1000.0;
+    spec.t1h_max_us = (timing.t1h_ns + 50) / 1000.0;
+    spec.bit_period_min_us = (timing.bit_ns - 50) / 1000.0;
+    spec.bit_period_max_us = (timing.bit_ns + 50) / 1000.0;
+    spec.reset_min_us = timing.reset_us;
+    return spec;
+}
+
+static bool check_timing_frames(const WS2812Analyzer::Report& report, uint frames, uint strip_offset) {
+    bool ok = report.frame_count == frames && report.passed();
+    for (const std::vector<uint32_t>& pixels : report.frames) {
+        ok &= pixels.size() == LED_COUNT;
+        for (uint i = 0; ok && i < LED_COUNT; i++) {
+            uint8_t r, g, b;
+            ws2812_test_color(i + strip_offset, r, g, b);
+            ok = pixels[i] == (((uint32_t)g << 16) | ((uint32_t)r << 8) | b);
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Send frames with every built-in timing profile and check the bit
+ *        timing on the wire against the profile, then switch the timing of
+ *        a running driver and run the parallel driver with another profile
+ */
+static bool verify_ws2812_timing() {
+    const uint frames = 2;
+    bool ok = true;
+
+    printf("LED timing profiles (%u pixels):\n", LED_COUNT);
+    for (const LEDTiming* timing : LEDTimings::PROFILES) {
+        host_sim_reset();
+        WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 1};
+        config.timing = timing;
+        WS2812Driver driver(config);
+        if (!driver.begin()) {
+            ok &= check(false, timing->name);
+            continue;
+        }
+        for (uint i = 0; i < LED_COUNT; i++) {
+            uint8_t r, g, b;
+            ws2812_test_color(i, r, g, b);
+            driver.setPixelColor(i, r, g, b);
+        }
+
+        WaveformRecorder recorder;
+        recorder.watch(LED_PIN);
+        recorder.start();
+        for (uint frame = 0; frame < frames; frame++) {
+            driver.markDirty(0, LED_COUNT);
+            driver.update(true);
+        }
+        host_sim_run_us(timing->reset_us + 100);
+        recorder.stop();
+
+        WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN, 24, timing_spec(*timing));
+        const LEDBitCycles& cycles = driver.getBitCycles();
+        printf("  %-12s %2u cycles, div %3u + %3u/256: T0H %.3f / T1H %.3f / bit %.3f us, frame %.1f us\n",
+               timing->name, cycles.cyclesPerBit(), cycles.div_int, cycles.div_frac, report.t0h.avg(),
+               report.t1h.avg(), report.bit_period.avg(), report.frame_time.avg());
+        ok &= check(check_timing_frames(report, frames, 0), timing->name);
+        driver.end();
+    }
+
+    // Runtime switch without recompiling or restarting the driver
+    {
+        host_sim_reset();
+        WS2812Driver::Config config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 1};
+        WS2812Driver driver(config);
+        ok &= check(driver.begin(), "driver initialized");
+        for (uint i = 0; i < LED_COUNT; i++) {
+            uint8_t r, g, b;
+            ws2812_test_color(i, r, g, b);
+            driver.setPixelColor(i, r, g, b);
+        }
+        driver.update(true);
+
+        const LEDTiming* slow = LEDTimings::find("WS2811");
+        ok &= check(slow != nullptr && driver.setTiming(*slow), "setTiming(find(\"WS2811\"))");
+        LEDTiming broken = {"broken", 900, 600, 1250, 50};
+        ok &= check(!driver.setTiming(broken) && strcmp(driver.getTiming().name, "WS2811") == 0,
+                    "impossible timing rejected");
+
+        WaveformRecorder recorder;
+        recorder.watch(LED_PIN);
+        recorder.start();
+        driver.markDirty(0, LED_COUNT);
+        driver.update(true);
+        host_sim_run_us(500);
+        recorder.stop();
+        WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN, 24,
+                                                                timing_spec(LEDTimings::WS2811));
+        ok &= check(check_timing_frames(report, 1, 0), "frame after switching to WS2811");
+        driver.end();
+    }
+
+    // Parallel driver with the same profiles
+    {
+        host_sim_reset();
+        WS2812ParallelDriver::Config config = {pio0, 0, PARALLEL_BASE_PIN, 2, LED_COUNT,
+                                               WS2812Driver::ColorFormat::GRB, true, &LEDTimings::SK6812};
+        WS2812ParallelDriver driver(config);
+        ok &= check(driver.begin(), "parallel driver initialized");
+        for (uint strip = 0; strip < 2; strip++) {
+            for (uint i = 0; i < LED_COUNT; i++) {
+                uint8_t r, g, b;
+                ws2812_test_color(i + strip * 37, r, g, b);
+                driver.setPixelColor(strip, i, r, g, b);
+            }
+        }
+
+        WaveformRecorder recorder;
+        recorder.watch(PARALLEL_BASE_PIN);
+        recorder.watch(PARALLEL_BASE_PIN + 1);
+        recorder.start();
+        driver.update(true);
+        host_sim_run_us(500);
+        recorder.stop();
+        bool parallel_ok = true;
+        for (uint strip = 0; strip < 2; strip++) {
+            WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, PARALLEL_BASE_PIN + strip, 24,
+                                                                    timing_spec(LEDTimings::SK6812));
+            parallel_ok &= check_timing_frames(report, 1, strip * 37);
+        }
+        ok &= check(parallel_ok, "parallel strips with SK6812 timing");
+        driver.end();
+    }
+
+    return ok;
+}
+
+// ===========================================
+// WS2812 driver group
+// ===========================================
+
+static const uint GROUP_STRIP_OFFSET = 11;     // Test color offset between strips
+static const uint64_t GROUP_PIO_SKEW_CYCLES = 4;  // pio1 enable store after pio0's
+
+// One driver per state machine: pio0 SM0-3, then pio1 SM0-3
+static WS2812Driver::Config group_config(uint output) {
+    WS2812Driver::Config config = {(output < 4) ? pio0 : pio1, output % 4, LED_PIN + output, LED_COUNT,
+                                   WS2812Driver::ColorFormat::GRB, true, (output == 7) ? 2u : 1u};
+    return config;
+}
+
+static void fill_group_strip(WS2812Driver& driver, uint output) {
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i + output * GROUP_STRIP_OFFSET, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+}
+
+/**
+ * @brief Run a WS2812Driver on every state machine of both PIOs, updated
+ *        one by one and as a WS2812Group, and check that the group starts
+ *        all strips together and scales the pixel rate with the outputs
+ */
+static bool verify_ws2812_group() {
+    const uint outputs = WS2812_MAX_INSTANCES;
+
+    host_sim_reset();
+    std::vector<std::unique_ptr<WS2812Driver>> drivers;
+    bool begun = true;
+    for (uint output = 0; output < outputs; output++) {
+        drivers.emplace_back(new WS2812Driver(group_config(output)));
+        begun &= drivers[output]->begin() && drivers[output]->isDMAEnabled();
+        fill_group_strip(*drivers[output], output);
+    }
+    bool ok = check(begun, "8 drivers initialized with DMA");
+
+    WS2812Driver duplicate(group_config(0));
+    ok &= check(!duplicate.begin(), "state machine in use rejected");
+
+    WaveformRecorder recorder;
+    for (uint output = 0; output < outputs; output++) {
+        recorder.watch(LED_PIN + output);
+    }
+
+    // Independent updates: every driver completes from the shared interrupt
+    recorder.start();
+    for (uint output = 0; output < outputs; output++) {
+        drivers[output]->update(false);
+    }
+    for (uint output = 0; output < outputs; output++) {
+        drivers[output]->waitForCompletion();
+    }
+    host_sim_run_us(100);
+    recorder.stop();
+
+    bool independent_ok = true;
+    for (uint output = 0; output < outputs; output++) {
+        WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN + output);
+        independent_ok &= check_timing_frames(report, 1, output * GROUP_STRIP_OFFSET);
+    }
+    ok &= check(independent_ok, "independent updates on every output");
+
+    // Group update
+    WS2812Group group;
+    bool added = true;
+    for (uint output = 0; output < outputs; output++) {
+        added &= group.add(drivers[output].get());
+    }
+    ok &= check(added && !group.add(drivers[0].get()), "drivers added to the group");
+
+    for (uint output = 0; output < outputs; output++) {
+        drivers[output]->markDirty(0, LED_COUNT);
+    }
+    recorder.start();
+    ok &= check(group.update(true), "group update");
+    host_sim_run_us(100);
+    recorder.stop();
+
+    bool group_ok = true;
+    // First and last bit of the frame on each output; the last bit ends
+    // with the data, so its rising edge marks the end of the frame
+    uint64_t first_start = UINT64_MAX;
+    uint64_t last_start = 0;
+    uint64_t first_end = UINT64_MAX;
+    uint64_t last_end = 0;
+    uint64_t pio_start[NUM_PIOS] = {};
+    uint64_t pio_end[NUM_PIOS] = {};
+    bool pio_aligned = true;
+    for (uint output = 0; output < outputs; output++) {
+        WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, LED_PIN + output);
+        group_ok &= check_timing_frames(report, 1, output * GROUP_STRIP_OFFSET);
+
+        const std::vector<WaveformRecorder::Edge>& edges = recorder.trace(LED_PIN + output).edges;
+        if (edges.empty()) {
+            group_ok = false;
+            continue;
+        }
+        uint64_t last_bit = edges.back().level ? edges.back().cycle : edges[edges.size() - 2].cycle;
+        uint pio = pio_get_index(group_config(output).pio_instance);
+        if (output % 4 == 0) {
+            pio_start[pio] = edges.front().cycle;
+            pio_end[pio] = last_bit;
+        }
+        pio_aligned &= edges.front().cycle == pio_start[pio] && last_bit == pio_end[pio];
+        first_start = std::min(first_start, edges.front().cycle);
+        last_start = std::max(last_start, edges.front().cycle);
+        first_end = std::min(first_end, last_bit);
+        last_end = std::max(last_end, last_bit);
+    }
+    ok &= check(group_ok, "group frames on every output");
+    printf("  Start skew %llu cycles, end skew %llu cycles\n", (unsigned long long)(last_start - first_start),
+           (unsigned long long)(last_end - first_end));
+    ok &= check(group_ok && pio_aligned, "outputs on one PIO start and latch in the same cycle");
+    ok &= check(group_ok && last_start - first_start <= GROUP_PIO_SKEW_CYCLES &&
+                    last_end - first_end <= GROUP_PIO_SKEW_CYCLES,
+                "pio1 outputs within a few cycles of pio0");
+
+    // Pixel rate against the number of outputs
+    printf("  Outputs  Frame time  Pixels/s\n");
+    double single_rate = 0.0;
+    double rate = 0.0;
+    for (uint count = 1; count <= outputs; count *= 2) {
+        group.clear();
+        for (uint output = 0; output < count; output++) {
+            group.add(drivers[output].get());
+            drivers[output]->markDirty(0, LED_COUNT);
+        }
+        uint64_t start = time_us_64();
+        group.update(true);
+        uint64_t elapsed = time_us_64() - start;
+        rate = count * LED_COUNT * 1e6 / elapsed;
+        if (count == 1) {
+            single_rate = rate;
+        }
+        printf("  %7u  %7llu us  %8.0f\n", count, (unsigned long long)elapsed, rate);
+    }
+    ok &= check(rate >= single_rate * outputs * 0.99, "pixel rate scales with the outputs");
+
+    for (std::unique_ptr<WS2812Driver>& driver : drivers) {
+        driver->end();
+    }
+    return ok;
+}
+
+// ===========================================
+// APA102
+// ===========================================
+
+/**
+ * @brief Send a full and a dimmed frame to APA102 LEDs and check every LED
+ *        frame on the wire, the start and end frames and the clock
+ */
+static bool verify_apa102(bool use_dma, bool hd) {
+    const uint8_t dim = 40;
+
+    host_sim_reset();
+    APA102Driver::Config config = {APA102_SPI, APA102_CLOCK_PIN, APA102_DATA_PIN, LED_COUNT};
+    config.use_dma = use_dma;
+    config.hd_brightness = hd;
+    APA102Driver driver(config);
+    if (!check(driver.begin(), "driver initialized")) {
+        return false;
+    }
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        driver.setPixelColor(i, r, g, b);
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(APA102_CLOCK_PIN);
+    recorder.watch(APA102_DATA_PIN);
+    recorder.start();
+    driver.update(true);
+    host_sim_run_us(50);
+    driver.setBrightness(dim);
+    driver.update(true);
+    host_sim_run_us(50);
+    recorder.stop();
+
+    APA102Analyzer::Report report = APA102Analyzer::analyze(recorder, APA102_CLOCK_PIN, APA102_DATA_PIN);
+    char title[48];
+    snprintf(title, sizeof(title), "APA102 (%s, %s brightness):", use_dma ? "DMA" : "blocking",
+             hd ? "HD" : "8-bit");
+    APA102Analyzer::printReport(report, title);
+
+    // Same strip on WS2812: 24 bits of 1.25 us per pixel plus the reset time
+    double ws2812_us = LED_COUNT * 24 * 1.25 + WS2812_RESET_TIME_US;
+    double frame_us = report.frame_time.max_us;
+    printf("  Frame time %.1f us vs %.1f us on WS2812 (%.1fx)\n", frame_us, ws2812_us, ws2812_us / frame_us);
+
+    bool ok = check(report.frame_count == 2, "frame count");
+    ok &= check(driver.getBaudrate() == APA102_DEFAULT_BAUD, "SPI clock");
+
+    // Light output of every channel against the exact value. Without HD
+    // brightness the channels are scaled at level 31; with it every pixel
+    // may use a lower level, even at full brightness.
+    bool data_ok = report.frame_count == 2 && report.frames[0].size() == LED_COUNT &&
+                   report.frames[1].size() == LED_COUNT;
+    double max_error[2] = {0.0, 0.0};
+    for (uint i = 0; data_ok && i < LED_COUNT; i++) {
+        uint8_t c[3];
+        ws2812_test_color(i, c[0], c[1], c[2]);
+        for (uint f = 0; f < 2; f++) {
+            uint32_t frame = report.frames[f][i];
+            uint8_t scale = (f == 0) ? 255 : dim;
+            uint8_t level = APA102Analyzer::brightness(frame);
+            uint8_t out[3] = {APA102Analyzer::red(frame), APA102Analyzer::green(frame),
+                              APA102Analyzer::blue(frame)};
+            for (uint ch = 0; ch < 3; ch++) {
+                double error = std::fabs(out[ch] * level / 31.0 - c[ch] * scale / 255.0);
+                max_error[f] = std::max(max_error[f], error);
+                if (!hd) {
+                    data_ok &= level == 31 && out[ch] == PixelMath::scale8((uint32_t)c[ch], scale);
+                }
+            }
+        }
+    }
+    printf("  Max error: %.3f full, %.3f dimmed (of 255)\n", max_error[0], max_error[1]);
+    ok &= check(data_ok, "decoded LED frames match buffer");
+    ok &= check(max_error[0] <= 0.5 && max_error[1] <= (hd ? 0.5 : 1.0), "colors within rounding");
+    ok &= check(report.passed(), "framing and clock within spec");
+    ok &= check(frame_us * 5 < ws2812_us, "frame time below 1/5 of WS2812");
+
+    if (hd) {
+        // A gray ramp at brightness 8 keeps nearly every step, where
+        // scaling the channels alone leaves 9 of them
+        uint32_t ramp[256];
+        uint32_t frames[256];
+        for (uint i = 0; i < 256; i++) {
+            ramp[i] = APA102Driver::packColor((uint8_t)i, (uint8_t)i, (uint8_t)i);
+        }
+        auto distinct = [&](bool use_hd) {
+            APA102Driver::encodePixels(ramp, 256, 8, use_hd, frames);
+            uint count = 0;
+            uint32_t last = UINT32_MAX;
+            for (uint i = 0; i < 256; i++) {
+                // Light output of red, in 1/31 steps of the channel value
+                uint32_t light = (frames[i] >> 24) * (frames[i] & 0x1F);
+                count += (light != last) ? 1 : 0;
+                last = light;
+            }
+            return count;
+        };
+        uint hd_steps = distinct(true);
+        uint plain_steps = distinct(false);
+        printf("  Gray ramp at brightness 8: %u steps (%u without HD)\n", hd_steps, plain_steps);
+        ok &= check(hd_steps > 200 && plain_steps <= 9, "HD brightness keeps dim steps");
+    }
+
+    driver.end();
+    return ok;
+}
+
+// ===========================================
+// DMX512
+// ===========================================
+
+static bool dmx_frame_matches(const std::vector<uint8_t>& frame) {
+    if (frame.size() != DMX_UNIVERSE_SIZE + 1 || frame[0] != DMX_START_CODE) {
+        return false;
+    }
+    for (uint channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+        if (frame[channel] != (uint8_t)(channel * 5)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool verify_dmx512(bool continuous, bool use_dma) {
+    host_sim_reset();
+    DMX512Transmitter dmx(DMX_PIN, uart1, use_dma);
+    if (!check(dmx.begin() == DMX512Transmitter::ReturnCode::SUCCESS && dmx.isDMAEnabled() == use_dma,
+               "transmitter initialized")) {
+        return false;
+    }
+
+    dmx.beginUpdate();
+    for (uint channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+        dmx.setChannel(channel, (uint8_t)(channel * 5));
+    }
+    dmx.commitUpdate();
+
+    WaveformRecorder recorder;
+    recorder.watch(DMX_PIN);
+    recorder.start();
+    host_sim_reset_irq_stats();
+
+    uint expected_frames = 2;
+    uint64_t transmit_us = 0;
+    if (continuous) {
+        dmx.setContinuousMode(true);
+        host_sim_run_us(250000);
+        dmx.setContinuousMode(false);
+        dmx.waitForCompletion(100);
+
+        uint32_t frame_count, error_count;
+        dmx.getStatistics(frame_count, error_count);
+        expected_frames = frame_count;
+    } else {
+        for (uint frame = 0; frame < expected_frames; frame++) {
+            // The second packet is started while the first is still leaving
+            // the UART
+            absolute_time_t start = get_absolute_time();
+            dmx.transmit();
+            transmit_us = std::max<uint64_t>(transmit_us, absolute_time_diff_us(start, get_absolute_time()));
+            while (dmx.isBusy()) {
+                tight_loop_contents();
+            }
+        }
+        dmx.waitForCompletion(100);
+    }
+    host_sim_run_us(2000);
+    recorder.stop();
+
+    DMX512Analyzer::Report report = DMX512Analyzer::analyze(recorder, DMX_PIN);
+    const char* title = continuous ? (use_dma ? "DMX512 (continuous, DMA):" : "DMX512 (continuous, interrupt):")
+                                   : (use_dma ? "DMX512 (single frames, DMA):" : "DMX512 (single frames, interrupt):");
+    DMX512Analyzer::printReport(report, title);
+
+    // Interrupts per packet: DMA completions or UART TX FIFO refills, and
+    // the alarms that time the break and mark after break
+    host_sim_irq_stats_t uart_irq = host_sim_get_irq_stats(UART1_IRQ);
+    host_sim_irq_stats_t dma_irq = host_sim_get_irq_stats(DMA_IRQ_0);
+    host_sim_irq_stats_t dma_irq1 = host_sim_get_irq_stats(DMA_IRQ_1);
+    host_sim_irq_stats_t timer_irq = host_sim_get_irq_stats(TIMER_IRQ_0 + PICO_TIME_DEFAULT_ALARM_POOL_HARDWARE_ALARM_NUM);
+    uint32_t data_irq_count = uart_irq.dispatch_count + dma_irq.dispatch_count + dma_irq1.dispatch_count;
+    uint64_t irq_cycles = uart_irq.cycles + dma_irq.cycles + dma_irq1.cycles + timer_irq.cycles;
+    double irq_us_per_packet = 0;
+    if (expected_frames > 0) {
+        irq_us_per_packet = irq_cycles / (clock_get_hz(clk_sys) / 1e6) / expected_frames;
+        printf("  Interrupts per packet: %.1f data + %.1f timer (%.1f us)\n",
+               (double)data_irq_count / expected_frames, (double)timer_irq.dispatch_count / expected_frames,
+               irq_us_per_packet);
+    }
+    if (!continuous) {
+        printf("  transmit() returned after %llu us\n", (unsigned long long)transmit_us);
+    }
+
+    bool ok = check(expected_frames > 0 && report.frame_count == expected_frames, "packet count");
+    if (use_dma) {
+        ok &= check(uart_irq.dispatch_count == 0 && data_irq_count <= expected_frames, "one interrupt per packet");
+    }
+    // Break and mark after break are timed by alarms: no interrupt waits
+    // for the line and transmit() does not wait for the break
+    ok &= check(irq_us_per_packet < 20, "no waiting in interrupts");
+    if (!continuous) {
+        ok &= check(transmit_us < 5, "transmit() returns at once");
+    }
+
+    bool data_ok = true;
+    for (const std::vector<uint8_t>& frame : report.frames) {
+        data_ok &= dmx_frame_matches(frame);
+    }
+    ok &= check(data_ok, "decoded slots match universe");
+    ok &= check(report.passed(), "timing within spec");
+
+    dmx.end();
+    return ok;
+}
+
+static bool verify_dmx512_pio(bool continuous) {
+    static const uint32_t refresh_rate_hz = 30;
+
+    host_sim_reset();
+    DMX512Transmitter dmx(DMX_PIN, pio1);
+    dmx.setRefreshRate(refresh_rate_hz);
+    if (!check(dmx.begin() == DMX512Transmitter::ReturnCode::SUCCESS &&
+               dmx.getBackend() == DMX512Transmitter::Backend::PIO, "transmitter initialized")) {
+        return false;
+    }
+
+    // Both UARTs stay free (GPIO 0 is UART0 TX, GPIO 8 UART1 TX)
+    DMX512Transmitter uart0_dmx(0, uart0);
+    DMX512Transmitter uart1_dmx(8, uart1);
+    bool uart_free = uart0_dmx.begin() == DMX512Transmitter::ReturnCode::SUCCESS &&
+                     uart1_dmx.begin() == DMX512Transmitter::ReturnCode::SUCCESS;
+    uart0_dmx.end();
+    uart1_dmx.end();
+
+    dmx.beginUpdate();
+    for (uint channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+        dmx.setChannel(channel, (uint8_t)(channel * 5));
+    }
+    dmx.commitUpdate();
+
+    WaveformRecorder recorder;
+    recorder.watch(DMX_PIN);
+    recorder.start();
+    host_sim_reset_irq_stats();
+
+    uint expected_frames = 2;
+    uint64_t transmit_us = 0;
+    bool counts_ok = true;
+    bool stopped_count_ok = true;
+    if (continuous) {
+        // Long enough for the packet count to wrap the re-arm ring a few
+        // times; it must step by one packet at a time
+        dmx.setContinuousMode(true);
+        uint32_t last_count = 0;
+        for (uint ms = 0; ms < 1000; ms++) {
+            host_sim_run_us(1000);
+            uint32_t frame_count, error_count;
+            dmx.getStatistics(frame_count, error_count);
+            counts_ok &= frame_count == last_count || frame_count == last_count + 1;
+            last_count = frame_count;
+        }
+        dmx.setContinuousMode(false);
+        dmx.waitForCompletion(100);
+
+        uint32_t frame_count, error_count;
+        dmx.getStatistics(frame_count, error_count);
+        expected_frames = frame_count;
+
+        // Stopped, the count stays put however long the engine idles
+        host_sim_run_us(1000000);
+        dmx.getStatistics(frame_count, error_count);
+        stopped_count_ok = frame_count == expected_frames;
+    } else {
+        for (uint frame = 0; frame < expected_frames; frame++) {
+            absolute_time_t start = get_absolute_time();
+            dmx.transmit();
+            transmit_us = std::max<uint64_t>(transmit_us, absolute_time_diff_us(start, get_absolute_time()));
+            while (dmx.isBusy()) {
+                tight_loop_contents();
+            }
+        }
+        dmx.waitForCompletion(100);
+    }
+    host_sim_run_us(2000);
+    recorder.stop();
+
+    DMX512Analyzer::Report report = DMX512Analyzer::analyze(recorder, DMX_PIN);
+    DMX512Analyzer::printReport(report, continuous ? "DMX512 (continuous, PIO):" : "DMX512 (single frames, PIO):");
+
+    uint32_t irq_count = 0;
+    for (uint irq = 0; irq < NUM_IRQS; irq++) {
+        irq_count += host_sim_get_irq_stats(irq).dispatch_count;
+    }
+    printf("  Interrupts: %u\n", irq_count);
+    if (!continuous) {
+        printf("  transmit() returned after %llu us\n", (unsigned long long)transmit_us);
+    }
+
+    bool ok = check(uart_free, "no UART used");
+    ok &= check(expected_frames > 0 && report.frame_count == expected_frames, "packet count");
+    ok &= check(irq_count == 0, "no interrupts");
+    if (continuous) {
+        ok &= check(counts_ok, "packets counted one by one while running");
+        ok &= check(stopped_count_ok, "packet count unchanged once stopped");
+        double period_us = 1e6 / refresh_rate_hz;
+        ok &= check(report.frame_period.count > 0 && report.frame_period.min_us >= period_us - 1 &&
+                    report.frame_period.max_us <= period_us + 1, "packets at the refresh rate");
+    } else {
+        ok &= check(transmit_us < 5, "transmit() returns at once");
+    }
+
+    bool data_ok = true;
+    for (const std::vector<uint8_t>& frame : report.frames) {
+        data_ok &= dmx_frame_matches(frame);
+    }
+    ok &= check(data_ok, "decoded slots match universe");
+    ok &= check(report.passed(), "timing within spec");
+
+    dmx.end();
+    return ok;
+}
+
+/**
+ * @brief Commit whole-universe updates every millisecond or so, never
+ * waiting for the packet being sent, and check that no packet mixes two
+ * updates and none is lost
+ */
+static bool verify_dmx512_commit(bool pio, bool use_dma) {
+    host_sim_reset();
+    DMX512Transmitter* dmx = pio ? new DMX512Transmitter(DMX_PIN, pio1)
+                                 : new DMX512Transmitter(DMX_PIN, uart1, use_dma);
+    if (!check(dmx->begin() == DMX512Transmitter::ReturnCode::SUCCESS, "transmitter initialized")) {
+        delete dmx;
+        return false;
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(DMX_PIN);
+    recorder.start();
+
+    dmx->setContinuousMode(true);
+    uint commits = 0;
+    uint8_t value = 0;
+    absolute_time_t end_time = delayed_by_us(get_absolute_time(), 150000);
+    while (absolute_time_diff_us(get_absolute_time(), end_time) > 0) {
+        value++;
+        dmx->beginUpdate();
+        for (uint channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+            dmx->setChannel(channel, value);
+        }
+        dmx->commitUpdate();
+        commits++;
+        // Irregular intervals, so commits fall on every part of a packet
+        host_sim_run_us(600 + (commits % 7) * 97);
+    }
+
+    // Two more packets: the last commit must be sent
+    host_sim_run_us(2 * 1000000 / DMX_REFRESH_RATE_HZ);
+    dmx->setContinuousMode(false);
+    dmx->waitForCompletion(100);
+    host_sim_run_us(2000);
+    recorder.stop();
+
+    uint32_t frame_count, error_count;
+    dmx->getStatistics(frame_count, error_count);
+
+    DMX512Analyzer::Report report = DMX512Analyzer::analyze(recorder, DMX_PIN);
+    DMX512Analyzer::printReport(report, pio ? "DMX512 (committed updates, PIO):"
+                                            : (use_dma ? "DMX512 (committed updates, DMA):"
+                                                       : "DMX512 (committed updates, interrupt):"));
+    printf("  Commits: %u (values 1-%u)\n", commits, value);
+
+    // Every packet sent while updates are committed carries a newer one;
+    // those after the last commit repeat it
+    bool whole = true;
+    bool in_order = true;
+    bool fresh = true;
+    uint8_t previous = 0;
+    for (const std::vector<uint8_t>& frame : report.frames) {
+        if (frame.size() != DMX_UNIVERSE_SIZE + 1 || frame[0] != DMX_START_CODE) {
+            whole = false;
+            continue;
+        }
+        for (uint channel = 2; channel <= DMX_UNIVERSE_SIZE; channel++) {
+            whole &= frame[channel] == frame[1];
+        }
+        in_order &= frame[1] >= previous;
+        fresh &= frame[1] != previous || frame[1] == value || &frame == &report.frames[0];
+        previous = frame[1];
+    }
+
+    bool ok = check(commits < 256, "values do not wrap");
+    ok &= check(frame_count > 0 && report.frame_count == frame_count, "packet count");
+    ok &= check(whole, "every packet holds one commit");
+    ok &= check(in_order, "commits sent in order");
+    ok &= check(fresh, "a new commit in every packet");
+    ok &= check(previous == value, "last commit sent");
+    ok &= check(report.passed(), "timing within spec");
+
+    dmx->end();
+    delete dmx;
+    return ok;
+}
+
+static const uint UNIVERSE_PIO_PINS[] = {10, 11, 12, 13, 14, 15};
+
+/**
+ * @brief Refresh 8 universes at 44 Hz: 6 on PIO (4 on pio0, 2 on pio1),
+ * which take all DMA channels, and one on each UART, which fall back to
+ * interrupts
+ */
+static bool verify_dmx512_universes(DMX512UniverseManager::StartMode mode) {
+    const uint pio_universes = sizeof(UNIVERSE_PIO_PINS) / sizeof(UNIVERSE_PIO_PINS[0]);
+    const uint uart_pins[] = {0, DMX_PIN};      // UART0 and UART1 TX
+
+    host_sim_reset();
+    DMX512UniverseManager manager;
+    bool added = true;
+    for (uint i = 0; i < pio_universes; i++) {
+        added &= manager.addPIOUniverse(UNIVERSE_PIO_PINS[i], i < 4 ? pio0 : pio1);
+    }
+    // The PIO universes hold all 12 DMA channels, so a UART universe that
+    // asks for one is refused and the UARTs run from their interrupts
+    bool refused = !manager.addUARTUniverse(uart_pins[0], uart0) && manager.getUniverseCount() == pio_universes;
+    added &= manager.addUARTUniverse(uart_pins[0], uart0, false);
+    added &= manager.addUARTUniverse(uart_pins[1], uart1, false);
+    if (!check(refused, "UART universe without DMA refused") ||
+        !check(added && manager.getUniverseCount() == DMX_MAX_UNIVERSES, "8 universes initialized")) {
+        return false;
+    }
+
+    uint pins[DMX_MAX_UNIVERSES];
+    WaveformRecorder recorder;
+    manager.beginUpdate();
+    for (uint universe = 0; universe < DMX_MAX_UNIVERSES; universe++) {
+        pins[universe] = manager.getTransmitter(universe)->getGpioPin();
+        recorder.watch(pins[universe]);
+        for (uint channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+            manager.setChannel(universe, channel, (uint8_t)(channel * 5 + universe));
+        }
+    }
+    manager.commitUpdate();
+
+    manager.setStartMode(mode);
+    recorder.start();
+    manager.start();
+    host_sim_run_us(250000);
+    manager.stop();
+    bool stopped = manager.waitForCompletion(100);
+    host_sim_run_us(2000);
+    recorder.stop();
+
+    printf("DMX512 (8 universes, %s):\n", mode == DMX512UniverseManager::StartMode::ALIGNED ? "aligned" : "staggered");
+
+    uint32_t total_frames = 0;
+    bool rate_ok = true;
+    bool data_ok = true;
+    bool timing_ok = true;
+    uint64_t first_break[DMX_MAX_UNIVERSES] = {};
+    for (uint universe = 0; universe < DMX_MAX_UNIVERSES; universe++) {
+        DMX512Analyzer::Report report = DMX512Analyzer::analyze(recorder, pins[universe]);
+        printf("  Universe %u (GPIO %u, %s): %u packets at %.2f Hz, period %.3f-%.3f us, %s\n", universe,
+               pins[universe], universe < pio_universes ? "PIO" : "UART", report.frame_count,
+               report.frame_rate_hz, report.frame_period.min_us, report.frame_period.max_us,
+               report.passed() ? "PASS" : "FAIL");
+
+        total_frames += report.frame_count;
+        rate_ok &= report.frame_period.count > 0 && report.frame_period.max_us < 1e6 / DMX_REFRESH_RATE_HZ + 2;
+        timing_ok &= report.passed();
+        for (const std::vector<uint8_t>& frame : report.frames) {
+            bool match = frame.size() == DMX_UNIVERSE_SIZE + 1 && frame[0] == DMX_START_CODE;
+            for (uint channel = 1; match && channel <= DMX_UNIVERSE_SIZE; channel++) {
+                match = frame[channel] == (uint8_t)(channel * 5 + universe);
+            }
+            data_ok &= match;
+        }
+
+        const std::vector<WaveformRecorder::Edge>& edges = recorder.trace(pins[universe]).edges;
+        first_break[universe] = edges.empty() ? 0 : edges.front().cycle;
+    }
+
+    // First breaks: together, or a refresh period divided by the number
+    // of universes apart
+    double cycles_per_us = clock_get_hz(clk_sys) / 1e6;
+    double interval_us = 1e6 / DMX_REFRESH_RATE_HZ / DMX_MAX_UNIVERSES;
+    double max_offset_error_us = 0;
+    for (uint universe = 0; universe < DMX_MAX_UNIVERSES; universe++) {
+        double offset_us = ((double)first_break[universe] - (double)first_break[0]) / cycles_per_us;
+        double expected_us = (mode == DMX512UniverseManager::StartMode::ALIGNED) ? 0 : universe * interval_us;
+        max_offset_error_us = std::max(max_offset_error_us, std::fabs(offset_us - expected_us));
+    }
+    printf("  First break offsets within %.2f us of %s\n", max_offset_error_us,
+           mode == DMX512UniverseManager::StartMode::ALIGNED ? "each other" : "their slots");
+
+    uint32_t frame_count, error_count;
+    manager.getStatistics(frame_count, error_count);
+
+    bool ok = check(stopped, "all universes stopped");
+    ok &= check(total_frames > 0 && frame_count == total_frames && error_count == 0, "packet count");
+    ok &= check(rate_ok, "every universe at 44 Hz");
+    ok &= check(max_offset_error_us < 20, "packet starts placed");
+    ok &= check(data_ok, "decoded slots match universes");
+    ok &= check(timing_ok, "timing within spec");
+
+    if (mode == DMX512UniverseManager::StartMode::STAGGERED) {
+        // A universe sending a packet of its own when its start is due is
+        // left out, not waited for in the start alarm
+        manager.resetStatistics();
+        host_sim_reset_irq_stats();
+        manager.start();
+        manager.getTransmitter(1)->transmit();
+        host_sim_run_us(50000);
+        manager.stop();
+        manager.waitForCompletion(100);
+
+        uint32_t busy_frames, busy_errors;
+        manager.getTransmitter(1)->getStatistics(busy_frames, busy_errors);
+        manager.getStatistics(frame_count, error_count);
+        host_sim_irq_stats_t timer_irq =
+            host_sim_get_irq_stats(TIMER_IRQ_0 + PICO_TIME_DEFAULT_ALARM_POOL_HARDWARE_ALARM_NUM);
+        double timer_us = timer_irq.cycles / cycles_per_us;
+        printf("  Busy universe: %u packets, %u errors, %.1f us in the start alarm\n", busy_frames, error_count,
+               timer_us);
+        ok &= check(busy_frames == 1 && error_count == 1, "busy universe left out");
+        ok &= check(timer_us < 100, "start alarm does not wait");
+    }
+
+    manager.end();
+    return ok;
+}
+
+// ===========================================
+// RS485
+// ===========================================
+
+static bool verify_rs485(bool use_dma) {
+    static const char message[] = "PicoLED RS485 verifier frame";
+    const uint frames = 3;
+
+    host_sim_reset();
+    RS485Serial::Config config = {RS485_DATA_PIN, RS485_ENABLE_PIN, uart1, RS485_DEFAULT_BAUD,
+                                  8, 1, false, false, use_dma};
+    RS485Serial rs485(config);
+    if (!check(rs485.begin() == RS485Serial::ReturnCode::SUCCESS, "serial initialized")) {
+        return false;
+    }
+
+    WaveformRecorder recorder;
+    recorder.watch(RS485_DATA_PIN);
+    recorder.watch(RS485_ENABLE_PIN);
+    recorder.start();
+    for (uint frame = 0; frame < frames; frame++) {
+        rs485.sendString(message, true);
+    }
+    host_sim_run_us(2000);
+    recorder.stop();
+
+    RS485Analyzer::Spec spec;
+    spec.format = {RS485_DEFAULT_BAUD, 8, 1, false, false};
+    RS485Analyzer::Report report = RS485Analyzer::analyze(recorder, RS485_DATA_PIN, RS485_ENABLE_PIN, spec);
+    RS485Analyzer::printReport(report, use_dma ? "RS485 (DMA):" : "RS485 (interrupt):");
+
+    bool ok = check(report.frame_count == frames, "frame count");
+
+    bool data_ok = true;
+    for (const std::vector<uint8_t>& frame : report.frames) {
+        data_ok &= (frame.size() == strlen(message) && memcmp(frame.data(), message, frame.size()) == 0);
+    }
+    ok &= check(data_ok, "decoded bytes match frame");
+    ok &= check(report.passed(), "timing within spec");
+
+    rs485.end();
+    return ok;
+}
+
+// ===========================================
+// Main
+// ===========================================
+
+// ===========================================
+// Drivers sharing the DMA and UART interrupts
+// ===========================================
+
+static const uint COEXIST_DMX_PIN = 0;         // UART0 TX
+
+static void foreign_irq_handler() {
+}
+
+static void ignore_dma_completion(uint channel, void* context) {
+    (void)channel;
+    (void)context;
+}
+
+/**
+ * @brief Check that IRQDispatcher refuses a line another handler owns
+ *        instead of taking it over
+ */
+static bool verify_foreign_irq_line() {
+    irq_set_exclusive_handler(DMA_IRQ_0, foreign_irq_handler);
+    irq_set_exclusive_handler(DMA_IRQ_1, foreign_irq_handler);
+    uint channel = (uint)dma_claim_unused_channel(true);
+    bool refused = !IRQDispatcher::addDMAHandler(channel, ignore_dma_completion, nullptr, 1);
+
+    // With both lines taken, a driver falls back to sending without DMA
+    RS485Serial::Config config = {RS485_DATA_PIN, RS485_ENABLE_PIN, uart1, RS485_DEFAULT_BAUD,
+                                  8, 1, false, false, true};
+    RS485Serial rs485(config);
+    bool fallback = rs485.begin() == RS485Serial::ReturnCode::SUCCESS && !rs485.isDMAEnabled();
+    for (uint other = 0; other < NUM_DMA_CHANNELS; other++) {
+        fallback &= other == channel || !dma_channel_is_claimed(other);
+    }
+    rs485.end();
+
+    // With one line free, the channel goes there
+    irq_remove_handler(DMA_IRQ_0, foreign_irq_handler);
+    bool other_line = IRQDispatcher::addDMAHandler(channel, ignore_dma_completion, nullptr) &&
+                      IRQDispatcher::getDMAChannelCount(0) == 1 && IRQDispatcher::getDMAChannelCount(1) == 0;
+    bool kept = irq_get_exclusive_handler(DMA_IRQ_1) == foreign_irq_handler;
+
+    IRQDispatcher::removeDMAHandler(channel);
+    dma_channel_unclaim(channel);
+    irq_remove_handler(DMA_IRQ_1, foreign_irq_handler);
+    return refused && fallback && other_line && kept;
+}
+
+/**
+ * @brief Run WS2812, parallel WS2812, RS485 (DMA) and DMX512 at the same
+ *        time, all completing through IRQDispatcher
+ */
+static bool verify_coexistence() {
+    static const char message[] = "PicoLED RS485 next to LEDs and DMX";
+
+    host_sim_reset();
+    WS2812Driver::Config led_config = {pio0, 0, LED_PIN, LED_COUNT, WS2812Driver::ColorFormat::GRB, true, 1};
+    WS2812Driver leds(led_config);
+    WS2812ParallelDriver::Config parallel_config = {pio1, 0, PARALLEL_BASE_PIN, 2, LED_COUNT,
+                                                    WS2812Driver::ColorFormat::GRB, true};
+    WS2812ParallelDriver parallel(parallel_config);
+    RS485Serial::Config rs485_config = {RS485_DATA_PIN, RS485_ENABLE_PIN, uart1, RS485_DEFAULT_BAUD,
+                                        8, 1, false, false, true};
+    RS485Serial rs485(rs485_config);
+    DMX512Transmitter dmx(COEXIST_DMX_PIN, uart0);
+    DMX512Transmitter dmx_same_uart(DMX_PIN, uart1);
+
+    bool ok = check(verify_foreign_irq_line(), "DMA line of another handler refused");
+    ok &= check(leds.begin() && leds.isDMAEnabled(), "WS2812 initialized with DMA");
+    ok &= check(parallel.begin(), "parallel WS2812 initialized");
+    ok &= check(rs485.begin() == RS485Serial::ReturnCode::SUCCESS && rs485.isDMAEnabled(),
+                "RS485 initialized with DMA");
+    ok &= check(dmx.begin() == DMX512Transmitter::ReturnCode::SUCCESS, "DMX512 initialized on uart0");
+    ok &= check(dmx_same_uart.begin() == DMX512Transmitter::ReturnCode::ERROR_UART_INIT_FAILED,
+                "second driver on uart1 rejected");
+    if (!ok) {
+        return false;
+    }
+
+    uint line0 = IRQDispatcher::getDMAChannelCount(0);
+    uint line1 = IRQDispatcher::getDMAChannelCount(1);
+    printf("  DMA channels on DMA_IRQ_0: %u, on DMA_IRQ_1: %u\n", line0, line1);
+    ok &= check(line0 + line1 == 4 && line0 == line1, "channels spread over both DMA lines");
+
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint8_t r, g, b;
+        ws2812_test_color(i, r, g, b);
+        leds.setPixelColor(i, r, g, b);
+        for (uint strip = 0; strip < 2; strip++) {
+            ws2812_test_color(i + strip * 37, r, g, b);
+            parallel.setPixelColor(strip, i, r, g, b);
+        }
+    }
+    dmx.beginUpdate();
+    for (uint channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+        dmx.setChannel(channel, (uint8_t)(channel * 5));
+    }
+    dmx.commitUpdate();
+
+    WaveformRecorder recorder;
+    recorder.watch(LED_PIN);
+    recorder.watch(PARALLEL_BASE_PIN);
+    recorder.watch(PARALLEL_BASE_PIN + 1);
+    recorder.watch(RS485_DATA_PIN);
+    recorder.watch(RS485_ENABLE_PIN);
+    recorder.watch(COEXIST_DMX_PIN);
+    recorder.start();
+
+    // Everything in flight at once
+    host_sim_reset_irq_stats();
+    dmx.transmit();
+    leds.update(false);
+    parallel.update(false);
+    rs485.sendString(message);
+    leds.waitForCompletion(100);
+    parallel.waitForCompletion(100);
+    rs485.waitForCompletion(100);
+    dmx.waitForCompletion(100);
+    host_sim_run_us(2000);
+    recorder.stop();
+
+    WS2812Analyzer::Report led_report = WS2812Analyzer::analyze(recorder, LED_PIN);
+    ok &= check(check_timing_frames(led_report, 1, 0), "WS2812 frame");
+
+    bool parallel_ok = true;
+    for (uint strip = 0; strip < 2; strip++) {
+        WS2812Analyzer::Report report = WS2812Analyzer::analyze(recorder, PARALLEL_BASE_PIN + strip);
+        parallel_ok &= check_timing_frames(report, 1, strip * 37);
+    }
+    ok &= check(parallel_ok, "parallel WS2812 frames");
+
+    RS485Analyzer::Spec rs485_spec;
+    rs485_spec.format = {RS485_DEFAULT_BAUD, 8, 1, false, false};
+    RS485Analyzer::Report rs485_report = RS485Analyzer::analyze(recorder, RS485_DATA_PIN, RS485_ENABLE_PIN,
+                                                                rs485_spec);
+    ok &= check(rs485_report.frame_count == 1 && rs485_report.passed() &&
+                rs485_report.frames[0].size() == strlen(message) &&
+                memcmp(rs485_report.frames[0].data(), message, strlen(message)) == 0, "RS485 frame");
+
+    DMX512Analyzer::Report dmx_report = DMX512Analyzer::analyze(recorder, COEXIST_DMX_PIN);
+    ok &= check(dmx_report.frame_count == 1 && dmx_report.passed() && dmx_frame_matches(dmx_report.frames[0]),
+                "DMX512 packet");
+
+    printf("  Interrupts: DMA_IRQ_0 %lu, DMA_IRQ_1 %lu, UART0 %lu\n",
+           (unsigned long)host_sim_get_irq_stats(DMA_IRQ_0).dispatch_count,
+           (unsigned long)host_sim_get_irq_stats(DMA_IRQ_1).dispatch_count,
+           (unsigned long)host_sim_get_irq_stats(UART0_IRQ).dispatch_count);
+
+    dmx.end();
+    rs485.end();
+    parallel.end();
+    leds.end();
+    return ok;
+}
+
+static bool selected(int argc, char** argv, const char* name) {
+    if (argc < 2) {
+        return true;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    uint failures = 0;
+    uint scenarios = 0;
+
+    auto run = [&](bool ok) {
+        scenarios++;
+        if (!ok) {
+            failures++;
+        }
+        printf("\n");
+    };
+
+    if (selected(argc, argv, "ws2812")) {
+        run(verify_ws2812(true));
+        run(verify_ws2812(false));
+    }
+    if (selected(argc, argv, "ws2812_rgbw")) {
+        run(verify_ws2812_rgbw(true));
+        run(verify_ws2812_rgbw(false));
+    }
+    if (selected(argc, argv, "ws2812_buffered")) {
+        run(verify_ws2812_buffered(2));
+        run(verify_ws2812_buffered(3));
+    }
+    if (selected(argc, argv, "ws2812_output")) {
+        run(verify_ws2812_output_stage());
+    }
+    if (selected(argc, argv, "ws2812_dither")) {
+        run(verify_ws2812_dither());
+    }
+    if (selected(argc, argv, "ws2812_dirty")) {
+        run(verify_ws2812_dirty(1));
+        run(verify_ws2812_dirty(3));
+    }
+    if (selected(argc, argv, "ws2812_packed")) {
+        run(verify_ws2812_packed(true));
+        run(verify_ws2812_packed(false));
+    }
+    if (selected(argc, argv, "ws2812_stream")) {
+        run(verify_ws2812_stream());
+    }
+    if (selected(argc, argv, "ws2812_map")) {
+        run(verify_ws2812_map(false));
+        run(verify_ws2812_map(true));
+    }
+    if (selected(argc, argv, "ws2812_math")) {
+        run(verify_pixel_math_kernels());
+        run(verify_ws2812_pixel_ops(false));
+        run(verify_ws2812_pixel_ops(true));
+    }
+    if (selected(argc, argv, "ws2812_parallel")) {
+        run(verify_transpose_kernel());
+        run(verify_ws2812_parallel(true));
+        run(verify_ws2812_parallel(false));
+    }
+    if (selected(argc, argv, "ws2812_timing")) {
+        run(verify_ws2812_timing());
+    }
+    if (selected(argc, argv, "ws2812_group")) {
+        run(verify_ws2812_group());
+    }
+    if (selected(argc, argv, "apa102")) {
+        run(verify_apa102(true, true));
+        run(verify_apa102(false, true));
+        run(verify_apa102(true, false));
+    }
+    if (selected(argc, argv, "dmx")) {
+        run(verify_dmx512(false, true));
+        run(verify_dmx512(true, true));
+        run(verify_dmx512(false, false));
+        run(verify_dmx512(true, false));
+        run(verify_dmx512_pio(false));
+        run(verify_dmx512_pio(true));
+    }
+    if (selected(argc, argv, "dmx_commit")) {
+        run(verify_dmx512_commit(false, true));
+        run(verify_dmx512_commit(false, false));
+        run(verify_dmx512_commit(true, false));
+    }
+    if (selected(argc, argv, "dmx_universes")) {
+        run(verify_dmx512_universes(DMX512UniverseManager::StartMode::ALIGNED));
+        run(verify_dmx512_universes(DMX512UniverseManager::StartMode::STAGGERED));
+    }
+    if (selected(argc, argv, "rs485")) {
+        run(verify_rs485(true));
+        run(verify_rs485(false));
+    }
+    if (selected(argc, argv, "coexist")) {
+        run(verify_coexistence());
+    }
+
+    printf("%u of %u scenarios passed\n", scenarios - failures, scenarios);
+    return failures == 0 ? 0 : 1;
+}
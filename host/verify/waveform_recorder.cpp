@@ -0,0 +1,83 @@
+#include "waveform_recorder.h"
+
+WaveformRecorder::WaveformRecorder()
+    : _recording(false),
+      _start_cycle(0),
+      _stop_cycle(0),
+      _sys_clock_hz(HOST_SIM_DEFAULT_SYS_CLOCK_HZ) {
+
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        _traces[gpio].watched = false;
+        _traces[gpio].initial_level = false;
+    }
+}
+
+WaveformRecorder::~WaveformRecorder() {
+    if (_recording) {
+        stop();
+    }
+}
+
+void WaveformRecorder::watch(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        _traces[gpio].watched = true;
+    }
+}
+
+void WaveformRecorder::start() {
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        _traces[gpio].edges.clear();
+        _traces[gpio].initial_level = gpio_get(gpio);
+    }
+
+    _start_cycle = host_sim_get_cycles();
+    _stop_cycle = _start_cycle;
+    _sys_clock_hz = host_sim_get_sys_clock_hz();
+    _recording = true;
+
+    host_sim_set_gpio_trace(trace_callback, this);
+}
+
+void WaveformRecorder::stop() {
+    if (!_recording) {
+        return;
+    }
+
+    host_sim_set_gpio_trace(nullptr, nullptr);
+    _stop_cycle = host_sim_get_cycles();
+    _recording = false;
+}
+
+uint64_t WaveformRecorder::stopCycle() const {
+    return _recording ? host_sim_get_cycles() : _stop_cycle;
+}
+
+bool WaveformRecorder::levelAt(uint gpio, uint64_t cycle) const {
+    const Trace& trace = _traces[gpio];
+    bool level = trace.initial_level;
+
+    // Edges are appended in time order
+    for (const Edge& edge : trace.edges) {
+        if (edge.cycle > cycle) {
+            break;
+        }
+        level = edge.level;
+    }
+    return level;
+}
+
+double WaveformRecorder::cyclesToUs(uint64_t cycles) const {
+    return (double)cycles * 1e6 / (double)_sys_clock_hz;
+}
+
+uint64_t WaveformRecorder::usToCycles(double us) const {
+    return (uint64_t)(us * (double)_sys_clock_hz / 1e6 + 0.5);
+}
+
+void WaveformRecorder::trace_callback(void* context, uint gpio, bool level, uint64_t cycle) {
+    WaveformRecorder* recorder = static_cast<WaveformRecorder*>(context);
+    Trace& trace = recorder->_traces[gpio];
+    if (trace.watched) {
+        trace.edges.push_back({cycle, level});
+    }
+}
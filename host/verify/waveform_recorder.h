@@ -0,0 +1,83 @@
+#pragma once
+
+#include "host_sim.h"
+#include "hardware/gpio.h"
+#include <vector>
+
+/**
+ * @brief GPIO waveform recorder for the host simulation
+ *
+ * Captures every level change on a set of watched pins with system clock
+ * cycle resolution. The analyzers decode the captured waveforms back into
+ * protocol data and measure their timing.
+ */
+class WaveformRecorder {
+public:
+    struct Edge {
+        uint64_t cycle;
+        bool level;         // Level after the edge
+    };
+
+    struct Trace {
+        bool watched;
+        bool initial_level; // Level when recording started
+        std::vector<Edge> edges;
+    };
+
+private:
+    Trace _traces[NUM_BANK0_GPIOS];
+    bool _recording;
+    uint64_t _start_cycle;
+    uint64_t _stop_cycle;
+    uint32_t _sys_clock_hz;
+
+    static void trace_callback(void* context, uint gpio, bool level, uint64_t cycle);
+
+public:
+    WaveformRecorder();
+    ~WaveformRecorder();
+
+    /**
+     * @brief Add a pin to the set of recorded pins
+     */
+    void watch(uint gpio);
+
+    /**
+     * @brief Start recording (discards anything recorded before)
+     */
+    void start();
+
+    /**
+     * @brief Stop recording
+     */
+    void stop();
+
+    bool isRecording() const { return _recording; }
+
+    /**
+     * @brief Captured waveform of a pin
+     */
+    const Trace& trace(uint gpio) const { return _traces[gpio]; }
+
+    /**
+     * @brief Level of a pin at a given cycle within the recording
+     */
+    bool levelAt(uint gpio, uint64_t cycle) const;
+
+    /**
+     * @brief Recording window (stop cycle is the current cycle while recording)
+     */
+    uint64_t startCycle() const { return _start_cycle; }
+    uint64_t stopCycle() const;
+
+    /**
+     * @brief Simulated clk_sys frequency at the start of the recording
+     */
+    uint32_t sysClockHz() const { return _sys_clock_hz; }
+
+    /**
+     * @brief Convert a cycle count to microseconds
+     */
+    double cyclesToUs(uint64_t cycles) const;
+    uint64_t usToCycles(double us) const;
+};
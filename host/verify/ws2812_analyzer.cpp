@@ -0,0 +1,147 @@
+#include "ws2812_analyzer.h"
+#include <cstdio>
+
+WS2812Analyzer::Report WS2812Analyzer::analyze(const WaveformRecorder& recorder, uint gpio,
+                                               uint bits_per_pixel, const Spec& spec) {
+    Report report;
+    const std::vector<WaveformRecorder::Edge>& edges = recorder.trace(gpio).edges;
+    const uint64_t stop_cycle = recorder.stopCycle();
+
+    // A pulse is long enough to be a 1 when it is past the midpoint
+    // between the longest valid 0 and the shortest valid 1
+    const double one_threshold_us = (spec.t0h_max_us + spec.t1h_min_us) / 2;
+
+    bool in_frame = false;
+    uint64_t frame_start = 0;
+    uint64_t first_frame_start = 0;
+    uint64_t last_frame_start = 0;
+    uint64_t prev_rise = 0;
+    uint64_t prev_fall = 0;
+    uint64_t total_bits = 0;
+    double total_frame_us = 0.0;
+
+    std::vector<uint32_t> pixels;
+    uint32_t word = 0;
+    uint word_bits = 0;
+
+    auto end_frame = [&](uint64_t next_rise) {
+        double frame_us = recorder.cyclesToUs(prev_fall - frame_start);
+        report.frame_time.add(frame_us);
+        total_frame_us += frame_us;
+
+        double gap_us = recorder.cyclesToUs(next_rise - prev_fall);
+        report.reset_gap.add(gap_us);
+        if (gap_us < spec.reset_min_us) {
+            report.short_resets++;
+        }
+
+        if (word_bits != 0) {
+            report.partial_pixels++;
+        }
+        report.frames.push_back(pixels);
+        report.frame_count++;
+
+        pixels.clear();
+        word = 0;
+        word_bits = 0;
+        in_frame = false;
+    };
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        if (!edges[i].level) {
+            continue;
+        }
+
+        uint64_t rise = edges[i].cycle;
+        uint64_t fall = (i + 1 < edges.size()) ? edges[i + 1].cycle : stop_cycle;
+
+        if (in_frame) {
+            double gap_us = recorder.cyclesToUs(rise - prev_fall);
+            if (gap_us >= spec.latch_threshold_us) {
+                end_frame(rise);
+            } else {
+                double period_us = recorder.cyclesToUs(rise - prev_rise);
+                report.bit_period.add(period_us);
+                if (period_us < spec.bit_period_min_us || period_us > spec.bit_period_max_us) {
+                    report.bit_violations++;
+                }
+            }
+        }
+
+        if (!in_frame) {
+            in_frame = true;
+            frame_start = rise;
+            if (report.frame_count == 0) {
+                first_frame_start = rise;
+            } else {
+                report.frame_period.add(recorder.cyclesToUs(rise - last_frame_start));
+            }
+            last_frame_start = rise;
+        }
+
+        double high_us = recorder.cyclesToUs(fall - rise);
+        bool bit = high_us >= one_threshold_us;
+        if (bit) {
+            report.t1h.add(high_us);
+            if (high_us < spec.t1h_min_us || high_us > spec.t1h_max_us) {
+                report.bit_violations++;
+            }
+        } else {
+            report.t0h.add(high_us);
+            if (high_us < spec.t0h_min_us || high_us > spec.t0h_max_us) {
+                report.bit_violations++;
+            }
+        }
+
+        word = (word << 1) | (bit ? 1 : 0);
+        if (++word_bits == bits_per_pixel) {
+            pixels.push_back(word);
+            word = 0;
+            word_bits = 0;
+        }
+        total_bits++;
+
+        prev_rise = rise;
+        prev_fall = fall;
+    }
+
+    // The trailing low period after the last frame is its reset gap
+    if (in_frame) {
+        end_frame(stop_cycle);
+    }
+
+    if (report.frame_count > 1) {
+        double span_us = recorder.cyclesToUs(last_frame_start - first_frame_start);
+        report.frame_rate_hz = (report.frame_count - 1) * 1e6 / span_us;
+    }
+    if (total_frame_us > 0.0) {
+        report.bit_rate_bps = total_bits * 1e6 / total_frame_us;
+    }
+
+    return report;
+}
+
+WS2812Analyzer::Report WS2812Analyzer::analyze(const WaveformRecorder& recorder, uint gpio, uint bits_per_pixel) {
+    return analyze(recorder, gpio, bits_per_pixel, Spec());
+}
+
+void WS2812Analyzer::printReport(const Report& report, const char* title) {
+    printf("%s\n", title);
+    printf("  Frames: %u", report.frame_count);
+    if (!report.frames.empty()) {
+        printf(" (%u pixels in last frame)", (unsigned)report.frames.back().size());
+    }
+    printf("\n");
+    printf("  Frame rate: %.2f Hz\n", report.frame_rate_hz);
+    printf("  Bit rate: %.1f kbit/s\n", report.bit_rate_bps / 1000.0);
+    report.t0h.print("T0H:");
+    report.t1h.print("T1H:");
+    report.bit_period.print("Bit period:");
+    report.frame_time.print("Frame time:");
+    report.frame_period.print("Frame period:");
+    report.reset_gap.print("Reset gap:");
+    printf("  Bit timing violations: %u\n", report.bit_violations);
+    printf("  Short resets: %u\n", report.short_resets);
+    printf("  Partial pixels: %u\n", report.partial_pixels);
+    printf("  Result: %s\n", report.passed() ? "PASS" : "FAIL");
+}
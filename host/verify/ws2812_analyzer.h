@@ -0,0 +1,63 @@
+#pragma once
+
+#include "waveform_recorder.h"
+#include "timing_stats.h"
+#include "../../src/config/picoled_config.h"
+#include <vector>
+
+/**
+ * @brief Decodes and checks a recorded WS2812 data line
+ *
+ * Every high pulse is one bit (long = 1, short = 0). A low period of at
+ * least the latch threshold ends a frame; the LEDs only latch reliably when
+ * that gap also meets the reset time.
+ */
+class WS2812Analyzer {
+public:
+    /**
+     * @brief Timing limits (WS2812B-V5 datasheet, matching WS2812_RESET_TIME_US)
+     */
+    struct Spec {
+        double t0h_min_us = 0.22;
+        double t0h_max_us = 0.38;
+        double t1h_min_us = 0.58;
+        double t1h_max_us = 1.0;
+        double bit_period_min_us = 0.80;        // Shortest high + shortest low
+        double bit_period_max_us = 2.0;
+        double latch_threshold_us = 6.0;        // Gap that may already latch
+        double reset_min_us = WS2812_RESET_TIME_US;
+    };
+
+    struct Report {
+        uint32_t frame_count = 0;
+        std::vector<std::vector<uint32_t>> frames;  // Decoded pixels, first bit in the MSB
+
+        TimingStats t0h;
+        TimingStats t1h;
+        TimingStats bit_period;
+        TimingStats frame_time;         // First rising edge to last falling edge
+        TimingStats frame_period;       // Start of frame to start of next frame
+        TimingStats reset_gap;          // Low time between frames
+
+        uint32_t bit_violations = 0;    // Pulse width or bit period out of spec
+        uint32_t short_resets = 0;      // Frame gaps below the reset time
+        uint32_t partial_pixels = 0;    // Frames not ending on a pixel boundary
+
+        double frame_rate_hz = 0.0;
+        double bit_rate_bps = 0.0;      // Average while a frame is on the wire
+
+        bool passed() const {
+            return bit_violations == 0 && short_resets == 0 && partial_pixels == 0;
+        }
+    };
+
+    /**
+     * @brief Analyze the waveform recorded on a pin
+     * @param bits_per_pixel 24 for RGB/GRB strips, 32 for RGBW
+     */
+    static Report analyze(const WaveformRecorder& recorder, uint gpio,
+                          uint bits_per_pixel, const Spec& spec);
+    static Report analyze(const WaveformRecorder& recorder, uint gpio, uint bits_per_pixel = 24);
+
+    static void printReport(const Report& report, const char* title);
+};
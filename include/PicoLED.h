@@ -43,6 +43,9 @@ public:
         uint grid_height;
         PIO pio_instance;
         uint pio_sm;
+        WS2812Driver::ColorFormat format = WS2812Driver::ColorFormat::GRB;  // RGBW for SK6812
+        bool extract_white = false;     // RGBW: drive the white LED from RGB colors
+        const LEDTiming* timing = nullptr;  // LED chip timing (nullptr = LEDTimings::WS2812)
     };
 
 private:
@@ -57,8 +60,8 @@ private:
     bool _initialized;
 
     // Data buffers
-    uint32_t* _led_buffer;
     uint8_t _dmx_universe[DMX_UNIVERSE_SIZE];
+    uint16_t* _led_map;     // Wiring order table built by setLEDLayout()
     
     // Internal helper methods
     void init_hardware();
@@ -102,6 +105,17 @@ public:
      */
     void setLEDColorXY(uint x, uint y, uint8_t r, uint8_t g, uint8_t b);
 
+    /**
+     * @brief Describe how the panel is wired
+     *
+     * Builds a pixel map so setLEDColorXY() draws in display coordinates on
+     * serpentine, rotated or tiled panels. The grid size becomes the layout
+     * size. Call after begin().
+     *
+     * @return false if the layout is invalid or larger than the panel
+     */
+    bool setLEDLayout(const PixelLayout& layout);
+
     /**
      * @brief Set all LEDs to same color
      */
@@ -119,6 +133,10 @@ public:
 
     /**
      * @brief Convert DMX data to LED array
+     *
+     * Three channels (R, G, B) per LED. RGBW panels with extract_white set
+     * get the white channel extracted.
+     *
      * @param dmx_data Source DMX channel data
      * @param start_channel Starting DMX channel (1-based)
      * @param num_leds Number of LEDs to update
@@ -131,6 +149,9 @@ public:
 
     /**
      * @brief Set DMX channel value (1-512)
+     *
+     * Commits the whole frame unless an update is open, so set many
+     * channels between beginDMXUpdate() and commitDMXUpdate().
      */
     bool setDMXChannel(uint16_t channel, uint8_t value);
 
@@ -160,6 +181,19 @@ public:
      */
     void clearDMXUniverse();
 
+    /**
+     * @brief Start collecting DMX channel changes into one update
+     *
+     * Changes are held back until commitDMXUpdate(), so no packet is sent
+     * with only some of them.
+     */
+    void beginDMXUpdate();
+
+    /**
+     * @brief Send the collected DMX channel changes from the next packet on
+     */
+    void commitDMXUpdate();
+
     /**
      * @brief Transmit DMX512 universe (exactly 512 channels)
      */
@@ -218,8 +252,12 @@ public:
 
     /**
      * @brief Get LED buffer for direct access
+     *
+     * The back buffer of the LED driver, which changes with every present()
+     * when frame buffering is used. The whole panel is sent on the next
+     * update (see WS2812Driver::getPixelBuffer).
      */
-    uint32_t* getLEDBuffer() { return _led_buffer; }
+    WS2812Driver::Pixel* getLEDBuffer() { return _led_driver ? _led_driver->getPixelBuffer() : nullptr; }
 
     /**
      * @brief Get DMX universe buffer for direct access
@@ -9,7 +9,7 @@ PicoLED::PicoLED(const PinConfig& pins, const LEDConfig& led_config)
       _pins(pins),
       _led_config(led_config),
       _initialized(false),
-      _led_buffer(nullptr) {
+      _led_map(nullptr) {
     
     // Initialize DMX universe to all zeros
     memset(_dmx_universe, 0, sizeof(_dmx_universe));
@@ -35,8 +35,11 @@ bool PicoLED::begin() {
         .pio_sm = _led_config.pio_sm,
         .gpio_pin = _pins.led_panel_pin,
         .num_pixels = _led_config.num_pixels,
-        .format = WS2812Driver::ColorFormat::GRB,  // WS2812 native format
-        .use_dma = USE_DMA_FOR_LED_UPDATE
+        .format = _led_config.format,
+        .use_dma = USE_DMA_FOR_LED_UPDATE,
+        .num_buffers = 1,
+        .extract_white = _led_config.extract_white,
+        .timing = _led_config.timing
     };
 
     _led_driver = new WS2812Driver(led_config);
@@ -71,9 +74,6 @@ bool PicoLED::begin() {
         return false;
     }
 
-    // Allocate LED buffer
-    _led_buffer = _led_driver->getPixelBuffer();
-
     _initialized = true;
     return true;
 }
@@ -98,6 +98,8 @@ void PicoLED::cleanup_resources() {
         delete _led_driver;
         _led_driver = nullptr;
     }
+    free(_led_map);
+    _led_map = nullptr;
 
     if (_dmx_transmitter) {
         _dmx_transmitter->end();
@@ -110,8 +112,6 @@ void PicoLED::cleanup_resources() {
         delete _rs485_serial;
         _rs485_serial = nullptr;
     }
-
-    _led_buffer = nullptr;
 }
 
 // ===========================================
@@ -131,6 +131,25 @@ void PicoLED::setLEDColorXY(uint x, uint y, uint8_t r, uint8_t g, uint8_t b) {
     }
 }
 
+bool PicoLED::setLEDLayout(const PixelLayout& layout) {
+    if (!_led_driver) {
+        return false;
+    }
+
+    uint16_t* map = (uint16_t*)malloc(_led_config.num_pixels * sizeof(uint16_t));
+    if (map == nullptr || !PixelMap::build(layout, map, _led_config.num_pixels) ||
+        !_led_driver->setPixelMap(map)) {
+        free(map);
+        return false;
+    }
+
+    free(_led_map);
+    _led_map = map;
+    _led_config.grid_width = layout.width;
+    _led_config.grid_height = layout.height;
+    return true;
+}
+
 void PicoLED::setAllLEDs(uint8_t r, uint8_t g, uint8_t b) {
     if (_led_driver) {
         _led_driver->fill(r, g, b);
@@ -159,19 +178,16 @@ void PicoLED::dmxToLEDs(const uint8_t* dmx_data, uint16_t start_channel, uint nu
         leds_to_update = _led_config.num_pixels;
     }
 
-    // Convert DMX data to LED colors (3 channels per LED: R, G, B)
-    for (uint i = 0; i < leds_to_update; i++) {
-        uint16_t dmx_offset = (start_channel - 1) + (i * 3);
-        
-        // Ensure we don't exceed DMX universe bounds
-        if (dmx_offset + 2 < DMX_UNIVERSE_SIZE) {
-            uint8_t r = dmx_data[dmx_offset];
-            uint8_t g = dmx_data[dmx_offset + 1];
-            uint8_t b = dmx_data[dmx_offset + 2];
-            
-            _led_driver->setPixelColor(i, r, g, b);
-        }
+    // 3 channels per LED: R, G, B. LEDs whose channels do not all fit in
+    // the universe are left as they are.
+    if (start_channel == 0 || start_channel > DMX_UNIVERSE_SIZE) {
+        return;
     }
+    uint available = (DMX_UNIVERSE_SIZE - (start_channel - 1)) / 3;
+    if (leds_to_update > available) {
+        leds_to_update = available;
+    }
+    _led_driver->setPixelDataRGB(dmx_data + (start_channel - 1), leds_to_update);
 }
 
 // ===========================================
@@ -225,11 +241,16 @@ void PicoLED::ledsToDMX(uint16_t start_channel) {
         return;
     }
 
-    uint32_t* led_buffer = _led_driver->getPixelBuffer();
-    if (!led_buffer) {
+    if (!_led_driver->isInitialized()) {
         return;
     }
 
+    // Commit all channels at once, unless the caller has an update open
+    bool own_update = !_dmx_transmitter->isUpdateOpen();
+    if (own_update) {
+        _dmx_transmitter->beginUpdate();
+    }
+
     // Convert LED data to DMX (3 channels per LED: R, G, B)
     uint num_pixels = _led_config.num_pixels;
     for (uint i = 0; i < num_pixels; i++) {
@@ -240,9 +261,15 @@ void PicoLED::ledsToDMX(uint16_t start_channel) {
             break;
         }
 
-        // Extract RGB from LED buffer
+        // Extract RGB from LED buffer, with the white of RGBW LEDs folded
+        // back in
         uint8_t r, g, b, w;
-        _led_driver->nativeToColor(led_buffer[i], r, g, b, w);
+        _led_driver->getPixelColor(i, r, g, b, w);
+        if (w > 0) {
+            r = (r + w > 255) ? 255 : r + w;
+            g = (g + w > 255) ? 255 : g + w;
+            b = (b + w > 255) ? 255 : b + w;
+        }
         
         // Set DMX channels
         _dmx_transmitter->setChannel(dmx_channel, r);
@@ -254,6 +281,10 @@ void PicoLED::ledsToDMX(uint16_t start_channel) {
         _dmx_universe[dmx_channel] = g;
         _dmx_universe[dmx_channel + 1] = b;
     }
+
+    if (own_update) {
+        _dmx_transmitter->commitUpdate();
+    }
 }
 
 void PicoLED::clearDMXUniverse() {
@@ -263,6 +294,18 @@ void PicoLED::clearDMXUniverse() {
     }
 }
 
+void PicoLED::beginDMXUpdate() {
+    if (_dmx_transmitter) {
+        _dmx_transmitter->beginUpdate();
+    }
+}
+
+void PicoLED::commitDMXUpdate() {
+    if (_dmx_transmitter) {
+        _dmx_transmitter->commitUpdate();
+    }
+}
+
 bool PicoLED::transmitDMX() {
     if (_dmx_transmitter) {
         return _dmx_transmitter->transmit();
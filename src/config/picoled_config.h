@@ -9,6 +9,7 @@
 #define DMX_START_CODE              0x00    // Standard DMX512 start code
 #define DMX_BREAK_TIME_US           100     // Break time in microseconds
 #define DMX_MARK_TIME_US            12      // Mark after break time in microseconds
+#define DMX_MAX_UNIVERSES           8       // Universes per DMX512UniverseManager (6 PIO + 2 UART)
 
 // WS2812 LED Configuration
 #define DEFAULT_LED_COUNT           256     // Default number of LEDs
@@ -16,6 +17,18 @@
 #define DEFAULT_GRID_HEIGHT         16      // Default grid height
 #define WS2812_PIO                  pio0    // Default PIO instance
 #define WS2812_SM                   0       // Default state machine
+#define WS2812_PARALLEL_MAX_STRIPS  8       // Strips per parallel output state machine
+#define WS2812_MAX_INSTANCES        8       // WS2812Driver instances per WS2812Group (one per state machine)
+#define WS2812_MAX_FRAME_BUFFERS    3       // Triple buffering
+#define WS2812_DITHER_PHASES        8       // Temporal dithering cycle (3 extra bits)
+#define WS2812_STREAM_CHUNKS        3       // Chunk buffers in streaming mode (at least 2)
+#ifndef WS2812_CHANNEL_BITS
+#define WS2812_CHANNEL_BITS         8       // Pixel buffer precision: 8 or 16 bits per channel
+#endif
+
+// APA102 / SK9822 LED Configuration
+#define APA102_SPI                  spi0    // Default SPI instance
+#define APA102_DEFAULT_BAUD         12500000 // SPI clock (SK9822 max 30 MHz)
 
 // RS485 Serial Configuration
 #define RS485_DEFAULT_BAUD          115200  // Default baud rate
@@ -26,6 +39,8 @@
 // Pin Defaults (can be overridden in constructor)
 #define DEFAULT_LED_PIN             2       // Default WS2812 data pin
 #define DEFAULT_DMX_PIN             4       // Default DMX output pin
+#define DEFAULT_APA102_CLOCK_PIN    18      // Default APA102 clock pin (SPI0 SCK)
+#define DEFAULT_APA102_DATA_PIN     19      // Default APA102 data pin (SPI0 TX)
 #define DEFAULT_RS485_DATA_PIN      8       // Default RS485 data pin
 #define DEFAULT_RS485_ENABLE_PIN    9       // Default RS485 enable pin
 
@@ -57,7 +72,7 @@
 #define USE_MULTICORE              0       // Enable multicore processing (experimental)
 
 // Safety limits
-#define MAX_LED_COUNT               1024    // Maximum number of LEDs supported
+#define MAX_LED_COUNT               1024    // Maximum number of LEDs with frame buffers
 #define MAX_BRIGHTNESS              255     // Maximum brightness value
 #define MIN_UPDATE_INTERVAL_MS      1       // Minimum update interval
 
@@ -0,0 +1,337 @@
+#include "apa102_driver.h"
+#include <cstring>
+#include <cstdio>
+
+static const uint APA102_START_FRAME_BYTES = 4;
+static const uint32_t APA102_HEADER = 0xE0;        // Top 3 bits of every LED frame
+static const uint APA102_MAX_LEVEL = 31;           // Global brightness field
+
+// Global brightness level and channel rescaling for encodePixels(). A
+// channel c at brightness B has the intensity s = c * B (out of 255 * 255).
+// level[s >> 8] is the lowest level that can show every s in that range at
+// 8 bits, and channel = s * recip[level] >> 24 rescales s to that level.
+struct APA102Levels {
+    uint8_t level[256];
+    uint32_t recip[APA102_MAX_LEVEL + 1];
+
+    constexpr APA102Levels() : level(), recip() {
+        for (uint i = 0; i < 256; i++) {
+            // The top range ends at 255 * 255, not 255 * 256
+            uint32_t max_s = (i < 254) ? i * 256 + 255 : 255 * 255;
+            level[i] = (uint8_t)((max_s * APA102_MAX_LEVEL + 255 * 255 - 1) / (255 * 255));
+        }
+        for (uint l = 1; l <= APA102_MAX_LEVEL; l++) {
+            recip[l] = (uint32_t)(((1ull << 24) * APA102_MAX_LEVEL + 255 * l / 2) / (255 * l));
+        }
+    }
+};
+
+static constexpr APA102Levels APA102_LEVELS;
+
+APA102Driver::APA102Driver(const Config& config)
+    : _config(config),
+      _actual_baudrate(0),
+      _pixel_buffer(nullptr),
+      _wire_buffer(nullptr),
+      _wire_length(0),
+      _status(Status::IDLE),
+      _initialized(false),
+      _brightness(255),
+      _dma_channel(-1),
+      _dma_available(false),
+      _update_count(0),
+      _error_count(0) {
+}
+
+APA102Driver::~APA102Driver() {
+    if (_initialized) {
+        end();
+    }
+}
+
+bool APA102Driver::begin() {
+    if (_initialized) {
+        return true;
+    }
+
+    // Validate configuration
+    if (_config.spi_instance == nullptr || _config.num_pixels == 0 || _config.num_pixels > MAX_LED_COUNT) {
+        return false;
+    }
+
+    // SCK and TX are fixed pins of each SPI: the third and fourth of a group
+    // of four, with the groups alternating between SPI0 and SPI1
+    uint index = spi_get_index(_config.spi_instance);
+    if ((_config.clock_pin & 3) != 2 || ((_config.clock_pin >> 3) & 1) != index ||
+        (_config.data_pin & 3) != 3 || ((_config.data_pin >> 3) & 1) != index) {
+        return false;
+    }
+
+    _pixel_buffer = (uint32_t*)malloc(_config.num_pixels * sizeof(uint32_t));
+    _wire_length = APA102_START_FRAME_BYTES + _config.num_pixels * 4 + end_frame_bytes();
+    _wire_buffer = (uint8_t*)malloc(_wire_length);
+    if (_pixel_buffer == nullptr || _wire_buffer == nullptr) {
+        free(_pixel_buffer);
+        free(_wire_buffer);
+        _pixel_buffer = nullptr;
+        _wire_buffer = nullptr;
+        return false;
+    }
+
+    // Start and end frames never change
+    memset(_pixel_buffer, 0, _config.num_pixels * sizeof(uint32_t));
+    memset(_wire_buffer, 0, _wire_length);
+
+    if (!init_spi()) {
+        free(_pixel_buffer);
+        free(_wire_buffer);
+        _pixel_buffer = nullptr;
+        _wire_buffer = nullptr;
+        return false;
+    }
+
+    // Initialize DMA if requested and available
+    if (_config.use_dma) {
+        _dma_available = init_dma();
+    }
+
+    _initialized = true;
+    _status = Status::IDLE;
+
+    return true;
+}
+
+void APA102Driver::end() {
+    if (!_initialized) {
+        return;
+    }
+
+    // Wait for any ongoing updates
+    waitForCompletion(1000);
+
+    // Cleanup resources
+    cleanup_dma();
+    cleanup_spi();
+
+    free(_pixel_buffer);
+    free(_wire_buffer);
+    _pixel_buffer = nullptr;
+    _wire_buffer = nullptr;
+
+    _initialized = false;
+    _status = Status::IDLE;
+}
+
+uint APA102Driver::end_frame_bytes() const {
+    // Every LED delays the data by half a clock, so n / 2 more clocks are
+    // needed after the last LED frame; SK9822 latches on a 32-bit zero
+    // frame as well, so send both
+    return 4 + (_config.num_pixels + 15) / 16;
+}
+
+bool APA102Driver::init_spi() {
+    _actual_baudrate = spi_init(_config.spi_instance, _config.baudrate);
+
+    // Mode 3: data changes on the falling edge and the LEDs sample it on
+    // the rising edge. With CPHA 1 the SPI sends frames back to back.
+    spi_set_format(_config.spi_instance, 8, SPI_CPOL_1, SPI_CPHA_1, SPI_MSB_FIRST);
+
+    gpio_set_function(_config.clock_pin, GPIO_FUNC_SPI);
+    gpio_set_function(_config.data_pin, GPIO_FUNC_SPI);
+
+    return true;
+}
+
+void APA102Driver::cleanup_spi() {
+    spi_deinit(_config.spi_instance);
+    gpio_set_function(_config.clock_pin, GPIO_FUNC_NULL);
+    gpio_set_function(_config.data_pin, GPIO_FUNC_NULL);
+}
+
+bool APA102Driver::init_dma() {
+    // Try to claim a DMA channel
+    _dma_channel = dma_claim_unused_channel(false);
+    if (_dma_channel < 0) {
+        return false;  // No DMA channels available
+    }
+
+    // Completion is polled (see isBusy()), so no interrupt is used
+    dma_channel_config config = dma_channel_get_default_config(_dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, spi_get_dreq(_config.spi_instance, true));
+
+    dma_channel_configure(_dma_channel, &config,
+                         &spi_get_hw(_config.spi_instance)->dr,
+                         _wire_buffer,
+                         _wire_length,
+                         false);  // Don't start yet
+
+    return true;
+}
+
+void APA102Driver::cleanup_dma() {
+    if (_dma_channel >= 0) {
+        dma_channel_abort(_dma_channel);
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+    }
+    _dma_available = false;
+}
+
+bool APA102Driver::setPixelColor(uint index, uint8_t r, uint8_t g, uint8_t b) {
+    if (!_initialized || index >= _config.num_pixels) {
+        return false;
+    }
+
+    _pixel_buffer[index] = packColor(r, g, b);
+    return true;
+}
+
+bool APA102Driver::getPixelColor(uint index, uint8_t& r, uint8_t& g, uint8_t& b) const {
+    if (!_initialized || index >= _config.num_pixels) {
+        return false;
+    }
+
+    uint32_t pixel = _pixel_buffer[index];
+    r = (pixel >> 24) & 0xFF;
+    g = (pixel >> 16) & 0xFF;
+    b = (pixel >> 8) & 0xFF;
+    return true;
+}
+
+void APA102Driver::fill(uint8_t r, uint8_t g, uint8_t b) {
+    if (!_initialized) {
+        return;
+    }
+
+    uint32_t color = packColor(r, g, b);
+    for (uint i = 0; i < _config.num_pixels; i++) {
+        _pixel_buffer[i] = color;
+    }
+}
+
+void APA102Driver::clear() {
+    fill(0, 0, 0);
+}
+
+bool APA102Driver::setPixelColorXY(uint x, uint y, uint8_t r, uint8_t g, uint8_t b, uint grid_width) {
+    uint index = xyToIndex(x, y, grid_width);
+    return setPixelColor(index, r, g, b);
+}
+
+bool APA102Driver::update(bool blocking) {
+    if (!_initialized) {
+        return false;
+    }
+    if (isBusy()) {
+        _error_count++;
+        return false;
+    }
+
+    encodePixels(_pixel_buffer, _config.num_pixels, _brightness, _config.hd_brightness,
+                 (uint32_t*)(_wire_buffer + APA102_START_FRAME_BYTES));
+
+    _status = Status::UPDATING;
+    _update_count++;
+
+    if (_dma_available) {
+        dma_channel_transfer_from_buffer_now(_dma_channel, _wire_buffer, _wire_length);
+        if (blocking) {
+            waitForCompletion();
+        }
+    } else {
+        spi_write_blocking(_config.spi_instance, _wire_buffer, _wire_length);
+        _status = Status::IDLE;
+    }
+
+    return true;
+}
+
+bool APA102Driver::isBusy() const {
+    if (_status != Status::UPDATING) {
+        return false;
+    }
+    // The DMA channel finishes when the last bytes enter the SPI FIFO
+    return (_dma_available && dma_channel_is_busy(_dma_channel)) || spi_is_busy(_config.spi_instance);
+}
+
+bool APA102Driver::waitForCompletion(uint32_t timeout_ms) {
+    absolute_time_t start_time = get_absolute_time();
+
+    while (isBusy()) {
+        if (timeout_ms > 0) {
+            if (absolute_time_diff_us(start_time, get_absolute_time()) > (timeout_ms * 1000)) {
+                return false;  // Timeout
+            }
+        }
+        tight_loop_contents();
+    }
+
+    if (_status == Status::UPDATING) {
+        _status = Status::IDLE;
+    }
+    return true;
+}
+
+void APA102Driver::encodePixels(const uint32_t* pixels, uint count, uint8_t brightness, bool hd, uint32_t* out) {
+    if (!hd) {
+        for (uint i = 0; i < count; i++) {
+            out[i] = PixelMath::scale8(pixels[i], brightness) | APA102_HEADER | APA102_MAX_LEVEL;
+        }
+        return;
+    }
+
+    for (uint i = 0; i < count; i++) {
+        uint32_t pixel = pixels[i];
+        uint32_t r = pixel >> 24;
+        uint32_t g = (pixel >> 16) & 0xFF;
+        uint32_t b = (pixel >> 8) & 0xFF;
+        uint32_t max_c = (r > g) ? r : g;
+        max_c = (b > max_c) ? b : max_c;
+
+        uint32_t max_s = max_c * brightness;
+        if (max_s == 0) {
+            out[i] = APA102_HEADER;
+            continue;
+        }
+
+        uint level = APA102_LEVELS.level[max_s >> 8];
+        // 16.16 factor for the channel values; the 24-bit reciprocal keeps
+        // it exact enough that the brightest channel never rounds past 255
+        uint32_t factor = (APA102_LEVELS.recip[level] * brightness + 128) >> 8;
+        uint32_t r_out = (r * factor + 32768) >> 16;
+        uint32_t g_out = (g * factor + 32768) >> 16;
+        uint32_t b_out = (b * factor + 32768) >> 16;
+
+        out[i] = (r_out << 24) | (g_out << 16) | (b_out << 8) | APA102_HEADER | level;
+    }
+}
+
+void APA102Driver::getStatistics(uint32_t& update_count, uint32_t& error_count) const {
+    update_count = _update_count;
+    error_count = _error_count;
+}
+
+void APA102Driver::resetStatistics() {
+    _update_count = 0;
+    _error_count = 0;
+}
+
+void APA102Driver::printStatus() const {
+    printf("APA102 Driver Status:\n");
+    printf("  Initialized: %s\n", _initialized ? "Yes" : "No");
+    printf("  SPI: spi%u\n", spi_get_index(_config.spi_instance));
+    printf("  Clock Pin: %u\n", _config.clock_pin);
+    printf("  Data Pin: %u\n", _config.data_pin);
+    printf("  Pixels: %u\n", _config.num_pixels);
+    printf("  Clock: %u Hz\n", _actual_baudrate);
+    printf("  Frame Bytes: %u\n", _wire_length);
+    printf("  DMA Enabled: %s\n", _dma_available ? "Yes" : "No");
+    printf("  Brightness: %u\n", _brightness);
+    printf("  HD Brightness: %s\n", _config.hd_brightness ? "Yes" : "No");
+    printf("  Status: %s\n", isBusy() ? "UPDATING" : (_status == Status::ERROR ? "ERROR" : "IDLE"));
+    printf("  Updates: %lu\n", _update_count);
+    printf("  Errors: %lu\n", _error_count);
+}
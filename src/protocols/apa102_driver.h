@@ -0,0 +1,246 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "../config/picoled_config.h"
+#include "pixel_math.h"
+
+/**
+ * @brief APA102 / SK9822 LED Driver using hardware SPI
+ *
+ * Clocked LEDs take data at SPI speed and have no timing constraints, so a
+ * frame is sent in a fraction of the WS2812 time. Each frame is a 32-bit
+ * zero start frame, one 32-bit LED frame per pixel (111 + 5-bit global
+ * brightness, blue, green, red) and an end frame of zeros that clocks the
+ * data through the chain. Frames are sent by DMA from a wire buffer.
+ */
+class APA102Driver {
+public:
+    enum class Status {
+        IDLE,
+        UPDATING,   // Frame is being sent
+        ERROR
+    };
+
+    struct Config {
+        spi_inst_t* spi_instance;
+        uint clock_pin;
+        uint data_pin;
+        uint num_pixels;
+        uint baudrate = APA102_DEFAULT_BAUD;
+        bool use_dma = true;
+        bool hd_brightness = true;     // Use the 5-bit global brightness field for dimming (see encodePixels)
+    };
+
+private:
+    // Hardware configuration
+    Config _config;
+    uint _actual_baudrate;
+
+    // Pixel buffer, one 0xRRGGBB00 word per pixel. In little-endian memory
+    // that is the byte order of an LED frame after its header byte.
+    uint32_t* _pixel_buffer;
+
+    // Wire buffer: start frame, LED frames and end frame
+    uint8_t* _wire_buffer;
+    uint _wire_length;
+
+    volatile Status _status;
+    bool _initialized;
+    uint8_t _brightness;
+
+    // DMA configuration
+    int _dma_channel;
+    bool _dma_available;
+
+    // Statistics
+    uint32_t _update_count;
+    uint32_t _error_count;
+
+    // Internal methods
+    bool init_spi();
+    bool init_dma();
+    void cleanup_spi();
+    void cleanup_dma();
+    uint end_frame_bytes() const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param config Driver configuration
+     */
+    APA102Driver(const Config& config);
+
+    /**
+     * @brief Destructor
+     */
+    ~APA102Driver();
+
+    /**
+     * @brief Initialize the APA102 driver
+     * @return true if initialization successful
+     */
+    bool begin();
+
+    /**
+     * @brief Shutdown the driver
+     */
+    void end();
+
+    /**
+     * @brief Set color for specific pixel
+     * @param index Pixel index (0-based)
+     * @param r Red value (0-255)
+     * @param g Green value (0-255)
+     * @param b Blue value (0-255)
+     * @return true if successful
+     */
+    bool setPixelColor(uint index, uint8_t r, uint8_t g, uint8_t b);
+
+    /**
+     * @brief Get color of specific pixel
+     * @return true if successful
+     */
+    bool getPixelColor(uint index, uint8_t& r, uint8_t& g, uint8_t& b) const;
+
+    /**
+     * @brief Set all pixels to the same color
+     */
+    void fill(uint8_t r, uint8_t g, uint8_t b);
+
+    /**
+     * @brief Clear all pixels (set to black)
+     */
+    void clear();
+
+    /**
+     * @brief Send the pixel buffer to the LEDs
+     *
+     * The frame is encoded into the wire buffer first, so the pixel buffer
+     * may be changed as soon as this returns.
+     *
+     * @param blocking If true, wait for the frame to be sent
+     * @return false if a frame is still being sent
+     */
+    bool update(bool blocking = false);
+
+    /**
+     * @brief Check if a frame is being sent
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Wait for current update to complete
+     * @param timeout_ms Maximum time to wait (0 = infinite)
+     * @return true if completed within timeout
+     */
+    bool waitForCompletion(uint32_t timeout_ms = 0);
+
+    /**
+     * @brief Set the global output brightness (0-255)
+     *
+     * Applied while frames are encoded, so the pixel buffer keeps the colors
+     * as drawn.
+     */
+    void setBrightness(uint8_t brightness) { _brightness = brightness; }
+
+    /**
+     * @brief Get the global output brightness
+     */
+    uint8_t getBrightness() const { return _brightness; }
+
+    /**
+     * @brief Get direct access to pixel buffer (0xRRGGBB00 per pixel)
+     */
+    uint32_t* getPixelBuffer() { return _pixel_buffer; }
+
+    /**
+     * @brief Get number of pixels
+     */
+    uint getPixelCount() const { return _config.num_pixels; }
+
+    /**
+     * @brief Get the SPI clock actually used
+     */
+    uint getBaudrate() const { return _actual_baudrate; }
+
+    /**
+     * @brief Get the number of bytes sent per frame
+     */
+    uint getFrameBytes() const { return _wire_length; }
+
+    /**
+     * @brief Check if driver is initialized
+     */
+    bool isInitialized() const { return _initialized; }
+
+    /**
+     * @brief Get current status
+     */
+    Status getStatus() const { return (_status == Status::UPDATING && !isBusy()) ? Status::IDLE : _status; }
+
+    /**
+     * @brief Get driver configuration
+     */
+    const Config& getConfig() const { return _config; }
+
+    /**
+     * @brief Get statistics
+     */
+    void getStatistics(uint32_t& update_count, uint32_t& error_count) const;
+
+    /**
+     * @brief Reset statistics
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Pixel buffer word of an RGB color
+     */
+    static constexpr uint32_t packColor(uint8_t r, uint8_t g, uint8_t b) {
+        return ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8);
+    }
+
+    /**
+     * @brief Encode pixels into LED frames
+     *
+     * With hd set, each pixel gets the lowest global brightness level that
+     * can still show its brightest channel, and the channels are rescaled
+     * to fill the 8-bit range at that level. Dim colors then keep up to 5
+     * more bits of resolution than scaling the channels alone, which is
+     * what hd off does (level 31, see PixelMath::scale8).
+     *
+     * @param pixels Pixel buffer words (see packColor)
+     * @param count Number of pixels
+     * @param brightness Global brightness (255 = full)
+     * @param hd Use the global brightness field for dimming
+     * @param out LED frames as stored in memory, may be the same as pixels
+     */
+    static void encodePixels(const uint32_t* pixels, uint count, uint8_t brightness, bool hd, uint32_t* out);
+
+    // Debug methods
+    void printStatus() const;
+
+    // Grid/matrix helper methods (for LED panels arranged in grids)
+    /**
+     * @brief Set pixel color using X,Y coordinates
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param r Red value
+     * @param g Green value
+     * @param b Blue value
+     * @param grid_width Width of the LED grid
+     * @return true if successful
+     */
+    bool setPixelColorXY(uint x, uint y, uint8_t r, uint8_t g, uint8_t b, uint grid_width = DEFAULT_GRID_WIDTH);
+
+    /**
+     * @brief Convert X,Y coordinates to linear index
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param grid_width Width of the LED grid
+     * @return Linear pixel index
+     */
+    static uint xyToIndex(uint x, uint y, uint grid_width) { return y * grid_width + x; }
+};
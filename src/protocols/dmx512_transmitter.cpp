@@ -1,36 +1,82 @@
 #include "dmx512_transmitter.h"
+#include "irq_dispatcher.h"
+#include "hardware/sync.h"
 #include <cstring>
 #include <cstdio>
 
-// Static instance for interrupt handling
-DMX512Transmitter* DMX512Transmitter::_instance = nullptr;
+static const uint DMX_SLOT_BITS = 11;          // Start bit, 8 data bits, 2 stop bits
+static const uint DMX_TX_IRQ_LEVEL = 4;        // TX FIFO level the UART interrupt refills at (1/8 full)
 
-DMX512Transmitter::DMX512Transmitter(uint gpio_pin, uart_inst_t* uart_instance) 
-    : _gpio_pin(gpio_pin), 
+// PIO engine: state machine cycles per bit, and the header words before
+// the slots of a packet (each a loop count, see init_pio_engine()). The
+// mark before break word follows the slots.
+static const uint DMX_PIO_CYCLES_PER_BIT = 4;
+static const uint DMX_PIO_HEADER_BREAK = 0;
+static const uint DMX_PIO_HEADER_MAB = 1;
+static const uint DMX_PIO_HEADER_SLOTS = 2;
+
+uint DMX512Transmitter::_pio_program_users[NUM_PIOS] = {};
+uint DMX512Transmitter::_pio_program_offsets[NUM_PIOS] = {};
+
+DMX512Transmitter::DMX512Transmitter(uint gpio_pin, uart_inst_t* uart_instance, bool use_dma) 
+    : _backend(Backend::UART),
+      _gpio_pin(gpio_pin), 
       _uart_instance(uart_instance),
-      _uart_irq(uart_instance == uart0 ? UART0_IRQ : UART1_IRQ),
+      _pio_instance(nullptr),
+      _dmx_frame(frame_of(1)),
+      _staging_buffer(1),
+      _committed_buffer(0),
+      _sending_buffer(0),
+      _tx_frame(frame_of(0)),
+      _update_open(false),
       _status(Status::IDLE),
       _current_byte_index(0),
       _initialized(false),
       _continuous_mode(false),
+      _use_dma(use_dma),
+      _dma_channel(-1),
+      _dma_available(false),
+      _timing_alarm(0),
+      _slot_time_us(0),
+      _line_idle_time(0),
+      _break_active(false),
+      _refresh_rate_hz(DMX_REFRESH_RATE_HZ),
+      _pio_sm(-1),
+      _pio_program_offset(0),
+      _program{_program_instructions, 0, -1},
+      _rearm_dma_channel(-1),
+      _packet_addrs{},
+      _pio_clock_hz(0),
+      _pio_div256(0),
+      _packet_cycles(0),
+      _run_period_cycles(0),
+      _run_start_time(0),
+      _run_stop_time(0),
+      _run_started(false),
+      _run_stopped(false),
       _frame_count(0),
       _error_count(0) {
     
-    // Initialize DMX frame with start code and all channels to 0
-    memset(_dmx_frame, 0, sizeof(_dmx_frame));
-    _dmx_frame[0] = DMX_START_CODE;
-    
-    // Set static instance for interrupt handling
-    _instance = this;
+    // Initialize DMX frames with start code and all channels to 0
+    memset(_packets, 0, sizeof(_packets));
+    for (uint buffer = 0; buffer < FRAME_BUFFERS; buffer++) {
+        frame_of(buffer)[0] = DMX_START_CODE;
+    }
+    for (uint i = 0; i < REARM_RING_WORDS; i++) {
+        _packet_addrs[i] = (uint32_t)(uintptr_t)_packets[0];
+    }
+}
+
+DMX512Transmitter::DMX512Transmitter(uint gpio_pin, PIO pio_instance)
+    : DMX512Transmitter(gpio_pin, nullptr, true) {
+    _backend = Backend::PIO;
+    _pio_instance = pio_instance;
 }
 
 DMX512Transmitter::~DMX512Transmitter() {
     if (_initialized) {
         end();
     }
-    if (_instance == this) {
-        _instance = nullptr;
-    }
 }
 
 DMX512Transmitter::ReturnCode DMX512Transmitter::begin(uint32_t baud_rate) {
@@ -43,21 +89,40 @@ DMX512Transmitter::ReturnCode DMX512Transmitter::begin(uint32_t baud_rate) {
         return ReturnCode::ERROR_INVALID_PIN;
     }
 
+    if (_backend == Backend::PIO) {
+        if (!init_pio_engine(baud_rate)) {
+            return ReturnCode::ERROR_PIO_INIT_FAILED;
+        }
+        _initialized = true;
+        _status = Status::IDLE;
+        return ReturnCode::SUCCESS;
+    }
+
+    // Route the UART interrupt to this transmitter; another driver may
+    // already use the UART
+    if (!IRQDispatcher::addUARTHandler(_uart_instance, uart_irq_callback, this)) {
+        return ReturnCode::ERROR_UART_INIT_FAILED;
+    }
+
     // Initialize UART
     uint actual_baud = uart_init(_uart_instance, baud_rate);
     if (actual_baud == 0) {
+        IRQDispatcher::removeUARTHandler(_uart_instance);
         return ReturnCode::ERROR_UART_INIT_FAILED;
     }
+    _slot_time_us = (DMX_SLOT_BITS * 1000000 + actual_baud - 1) / actual_baud;
+    _line_idle_time = get_absolute_time();
 
     // Configure UART for DMX512
     configure_uart();
 
     // Set up GPIO for UART TX
     gpio_set_function(_gpio_pin, GPIO_FUNC_UART);
-    
-    // Set up interrupt handler
-    irq_set_exclusive_handler(_uart_irq, uart_irq_handler);
-    irq_set_enabled(_uart_irq, true);
+
+    // Initialize DMA if requested and available
+    if (_use_dma) {
+        _dma_available = init_dma();
+    }
 
     _initialized = true;
     _status = Status::IDLE;
@@ -72,8 +137,340 @@ void DMX512Transmitter::configure_uart() {
     // Configure hardware flow control (disabled for DMX)
     uart_set_hw_flow(_uart_instance, false, false);
     
-    // Enable TX interrupt
-    uart_set_irq_enables(_uart_instance, false, true);  // RX disabled, TX enabled
+    // The TX interrupt is enabled per packet when DMA is not used
+    uart_set_irq_enables(_uart_instance, false, false);
+}
+
+bool DMX512Transmitter::init_dma() {
+    // Try to claim a DMA channel
+    _dma_channel = dma_claim_unused_channel(false);
+    if (_dma_channel < 0) {
+        return false;  // No DMA channels available
+    }
+
+    // One slot per transfer, paced by the UART TX FIFO
+    dma_channel_config config = dma_channel_get_default_config(_dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, uart_get_dreq(_uart_instance, true));
+
+    dma_channel_configure(_dma_channel, &config,
+                         &uart_get_hw(_uart_instance)->dr,
+                         _tx_frame,
+                         DMX_UNIVERSE_SIZE + 1,
+                         false);  // Don't start yet
+
+    if (!IRQDispatcher::addDMAHandler(_dma_channel, dma_complete_callback, this)) {
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+        return false;  // Both DMA lines taken by other handlers
+    }
+
+    // Without the FIFO the DMA writes one slot at a time, so it completes
+    // within two slots of the end of the packet instead of 32, and the
+    // break that follows in continuous mode has little left to wait for
+    uart_set_fifo_enabled(_uart_instance, false);
+    return true;
+}
+
+void DMX512Transmitter::cleanup_dma() {
+    if (_dma_channel >= 0) {
+        dma_channel_abort(_dma_channel);
+        IRQDispatcher::removeDMAHandler(_dma_channel);
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+    }
+    _dma_available = false;
+}
+
+bool DMX512Transmitter::init_pio_engine(uint32_t baud_rate) {
+    // Clock divider for DMX_PIO_CYCLES_PER_BIT cycles per bit, in 1/256 steps
+    uint32_t clk_sys_hz = clock_get_hz(clk_sys);
+    uint64_t cycle_hz = (uint64_t)baud_rate * DMX_PIO_CYCLES_PER_BIT;
+    uint64_t div256 = ((uint64_t)clk_sys_hz * 256 + cycle_hz / 2) / cycle_hz;
+    if (div256 < 256 || div256 >= (65536ull << 8)) {
+        return false;
+    }
+    _pio_div256 = (uint32_t)div256;
+    _pio_clock_hz = (uint32_t)(((uint64_t)clk_sys_hz * 256 + div256 / 2) / div256);
+
+    // Packet program. The header words are loop counts: the line is low
+    // for BREAK + 3 and high for MAB + 3 cycles, and after the stop bits of
+    // the last slot high for MBB + 3 more cycles (4 with the pad out) before
+    // the next break. The mark before break comes last, so a packet's break
+    // starts as soon as it is started.
+    //    0  out x, 32                ; break
+    //    1  set pins, 0
+    //    2  jmp x--, 2
+    //    3  out x, 32                ; mark after break
+    //    4  set pins, 1
+    //    5  jmp x--, 5
+    //    6  out y, 32                ; slots - 1
+    //    7  set pins, 0      [2]     ; start bit
+    //    8  set x, 7
+    //    9  out pins, 1      [2]     ; data bits, LSB first
+    //   10  jmp x--, 9
+    //   11  set pins, 1      [6]     ; two stop bits
+    //   12  jmp y--, 7
+    //   13  out null, n              ; rest of the last slot word, if any
+    //   14  out x, 32                ; mark before break
+    //   15  jmp x--, 15
+    _program_instructions[0] = (uint16_t)pio_encode_out(pio_x, 32);
+    _program_instructions[1] = (uint16_t)pio_encode_set(pio_pins, 0);
+    _program_instructions[2] = (uint16_t)pio_encode_jmp_x_dec(2);
+    _program_instructions[3] = (uint16_t)pio_encode_out(pio_x, 32);
+    _program_instructions[4] = (uint16_t)pio_encode_set(pio_pins, 1);
+    _program_instructions[5] = (uint16_t)pio_encode_jmp_x_dec(5);
+    _program_instructions[6] = (uint16_t)pio_encode_out(pio_y, 32);
+    _program_instructions[7] = (uint16_t)(pio_encode_set(pio_pins, 0) | pio_encode_delay(2));
+    _program_instructions[8] = (uint16_t)pio_encode_set(pio_x, 7);
+    _program_instructions[9] = (uint16_t)(pio_encode_out(pio_pins, 1) | pio_encode_delay(2));
+    _program_instructions[10] = (uint16_t)pio_encode_jmp_x_dec(9);
+    _program_instructions[11] = (uint16_t)(pio_encode_set(pio_pins, 1) | pio_encode_delay(6));
+    _program_instructions[12] = (uint16_t)pio_encode_jmp_y_dec(7);
+    _program.length = 13;
+    uint pad_bits = ((4 - (DMX_UNIVERSE_SIZE + 1) % 4) % 4) * 8;
+    if (pad_bits > 0) {
+        _program_instructions[_program.length++] = (uint16_t)pio_encode_out(pio_null, pad_bits);
+    }
+    uint mbb_loop = _program.length + 1;
+    _program_instructions[_program.length++] = (uint16_t)pio_encode_out(pio_x, 32);
+    _program_instructions[_program.length++] = (uint16_t)pio_encode_jmp_x_dec(mbb_loop);
+
+    uint64_t break_cycles = ((uint64_t)DMX_BREAK_TIME_US * _pio_clock_hz + 999999) / 1000000;
+    uint64_t mab_cycles = ((uint64_t)DMX_MARK_TIME_US * _pio_clock_hz + 999999) / 1000000;
+    uint32_t break_count = (uint32_t)(break_cycles > 3 ? break_cycles - 3 : 0);
+    uint32_t mab_count = (uint32_t)(mab_cycles > 3 ? mab_cycles - 3 : 0);
+    for (uint buffer = 0; buffer < FRAME_BUFFERS; buffer++) {
+        _packets[buffer][DMX_PIO_HEADER_BREAK] = break_count;
+        _packets[buffer][DMX_PIO_HEADER_MAB] = mab_count;
+        _packets[buffer][DMX_PIO_HEADER_SLOTS] = DMX_UNIVERSE_SIZE;
+    }
+
+    // Cycles of one pass of the program with a mark before break count of
+    // 0: instructions 0, 1, 3, 4, 6 and 14 take a cycle each, the break,
+    // mark after break and mark before break loops run once more than their
+    // counts, each slot takes DMX_SLOT_BITS bits, and the pad out takes one
+    // cycle if there is one
+    static const uint PACKET_SINGLE_CYCLES = 6;
+    static const uint PACKET_LOOPS = 3;
+    _packet_cycles = PACKET_SINGLE_CYCLES + PACKET_LOOPS + (pad_bits > 0 ? 1 : 0) + break_count + mab_count +
+                     (DMX_UNIVERSE_SIZE + 1) * DMX_SLOT_BITS * DMX_PIO_CYCLES_PER_BIT;
+
+    int sm = pio_claim_unused_sm(_pio_instance, false);
+    if (sm < 0) {
+        return false;
+    }
+    uint pio_index = pio_get_index(_pio_instance);
+    if (_pio_program_users[pio_index] == 0) {
+        if (!pio_can_add_program(_pio_instance, &_program)) {
+            pio_sm_unclaim(_pio_instance, sm);
+            return false;
+        }
+        _pio_program_offsets[pio_index] = pio_add_program(_pio_instance, &_program);
+    }
+    _pio_program_users[pio_index]++;
+    _pio_sm = sm;
+    _pio_program_offset = _pio_program_offsets[pio_index];
+
+    // Two DMA channels: one feeds the packet to the state machine, the
+    // other points it at the committed packet and restarts it
+    _dma_channel = dma_claim_unused_channel(false);
+    _rearm_dma_channel = dma_claim_unused_channel(false);
+    if (_dma_channel < 0 || _rearm_dma_channel < 0) {
+        cleanup_pio_engine();
+        return false;
+    }
+
+    pio_sm_config config = pio_get_default_sm_config();
+    sm_config_set_wrap(&config, _pio_program_offset, _pio_program_offset + _program.length - 1);
+    sm_config_set_set_pins(&config, _gpio_pin, 1);
+    sm_config_set_out_pins(&config, _gpio_pin, 1);
+    sm_config_set_out_shift(&config, true, true, 32);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv_int_frac(&config, (uint16_t)(div256 >> 8), (uint8_t)(div256 & 0xFF));
+
+    // The line idles at mark
+    pio_sm_set_pins_with_mask(_pio_instance, sm, 1u << _gpio_pin, 1u << _gpio_pin);
+    pio_sm_set_consecutive_pindirs(_pio_instance, sm, _gpio_pin, 1, true);
+    pio_gpio_init(_pio_instance, _gpio_pin);
+
+    pio_sm_init(_pio_instance, sm, _pio_program_offset, &config);
+    pio_sm_set_enabled(_pio_instance, sm, true);
+
+    // No interrupts: packets are counted by the re-arm channel (see
+    // engine_frames_sent())
+    dma_channel_config data_config = dma_channel_get_default_config(_dma_channel);
+    channel_config_set_transfer_data_size(&data_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&data_config, true);
+    channel_config_set_write_increment(&data_config, false);
+    channel_config_set_dreq(&data_config, pio_get_dreq(_pio_instance, sm, true));
+    channel_config_set_irq_quiet(&data_config, true);
+    dma_channel_configure(_dma_channel, &data_config,
+                         &_pio_instance->txf[sm],
+                         _packets[_committed_buffer],
+                         PIO_PACKET_WORDS,
+                         false);  // Don't start yet
+
+    // Writing the read address through its trigger alias restarts the
+    // data channel with its last transfer count. Every re-arm moves the
+    // read address one word on through the ring of packet addresses.
+    dma_channel_config rearm_config = dma_channel_get_default_config(_rearm_dma_channel);
+    channel_config_set_transfer_data_size(&rearm_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&rearm_config, true);
+    channel_config_set_write_increment(&rearm_config, false);
+    channel_config_set_ring(&rearm_config, false, REARM_RING_BITS);
+    channel_config_set_irq_quiet(&rearm_config, true);
+    dma_channel_configure(_rearm_dma_channel, &rearm_config,
+                         &dma_hw->ch[_dma_channel].al3_read_addr_trig,
+                         _packet_addrs,
+                         1,
+                         false);
+
+    _dma_available = true;
+    return true;
+}
+
+void DMX512Transmitter::cleanup_pio_engine() {
+    // The counts are read from the channels
+    _frame_count += engine_frames_sent();
+    _run_started = false;
+
+    if (_dma_channel >= 0) {
+        // Break the chain first so neither channel restarts the other
+        dma_channel_config config = dma_get_channel_config(_dma_channel);
+        channel_config_set_chain_to(&config, _dma_channel);
+        dma_channel_set_config(_dma_channel, &config, false);
+        dma_channel_abort(_dma_channel);
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+    }
+    if (_rearm_dma_channel >= 0) {
+        dma_channel_abort(_rearm_dma_channel);
+        dma_channel_unclaim(_rearm_dma_channel);
+        _rearm_dma_channel = -1;
+    }
+    _dma_available = false;
+
+    if (_pio_sm >= 0) {
+        pio_sm_set_enabled(_pio_instance, _pio_sm, false);
+        if (--_pio_program_users[pio_get_index(_pio_instance)] == 0) {
+            pio_remove_program(_pio_instance, &_program, _pio_program_offset);
+        }
+        pio_sm_unclaim(_pio_instance, _pio_sm);
+        _pio_sm = -1;
+    }
+
+    _continuous_mode = false;
+}
+
+void DMX512Transmitter::start_engine(bool continuous) {
+    // The previous run has finished
+    _frame_count += engine_frames_sent();
+
+    // The mark before break pads continuous packets to the refresh period
+    uint32_t mbb = 0;
+    if (continuous) {
+        uint64_t period_cycles = _pio_clock_hz / _refresh_rate_hz;
+        if (period_cycles > _packet_cycles) {
+            mbb = (uint32_t)(period_cycles - _packet_cycles);
+        }
+    }
+    for (uint buffer = 0; buffer < FRAME_BUFFERS; buffer++) {
+        _packets[buffer][PIO_PACKET_WORDS - 1] = mbb;
+    }
+    _run_period_cycles = continuous ? (uint64_t)_packet_cycles + mbb : 0;
+
+    dma_channel_config config = dma_get_channel_config(_dma_channel);
+    channel_config_set_chain_to(&config, continuous ? _rearm_dma_channel : _dma_channel);
+    dma_channel_set_config(_dma_channel, &config, false);
+
+    // The re-arm count starts over at the start of the ring
+    dma_channel_set_read_addr(_rearm_dma_channel, _packet_addrs, false);
+
+    _run_started = true;
+    _run_stopped = false;
+    _status = Status::TRANSMITTING_DATA;
+    _run_start_time = get_absolute_time();
+    dma_channel_transfer_from_buffer_now(_dma_channel, _packets[_committed_buffer], PIO_PACKET_WORDS);
+}
+
+void DMX512Transmitter::stop_engine_refresh() {
+    dma_channel_config config = dma_get_channel_config(_dma_channel);
+    channel_config_set_chain_to(&config, _dma_channel);
+    dma_channel_set_config(_dma_channel, &config, false);
+
+    // A re-arm already under way still starts its packet, which is counted
+    // once the data channel has loaded it. No re-arm follows, so the run
+    // stops growing here (see engine_frames_sent()).
+    if (_run_started && !_run_stopped) {
+        _run_stop_time = get_absolute_time();
+        _run_stopped = true;
+    }
+}
+
+uint DMX512Transmitter::engine_sending_buffer() const {
+    // An idle data channel reads nothing more until it is re-armed or
+    // started, which loads the committed packet
+    if (_dma_channel < 0 || !dma_channel_is_busy(_dma_channel)) {
+        return FRAME_BUFFERS;
+    }
+
+    uint32_t read_addr = dma_channel_hw_addr(_dma_channel)->read_addr;
+    for (uint buffer = 0; buffer < FRAME_BUFFERS; buffer++) {
+        uint32_t start = (uint32_t)(uintptr_t)_packets[buffer];
+        if (read_addr >= start && read_addr < start + sizeof(_packets[buffer])) {
+            return buffer;
+        }
+    }
+    return FRAME_BUFFERS;
+}
+
+bool DMX512Transmitter::is_engine_busy() const {
+    // Idle once the state machine waits for the next header with nothing
+    // left to send
+    return dma_channel_is_busy(_dma_channel) || dma_channel_is_busy(_rearm_dma_channel) ||
+           !pio_sm_is_tx_fifo_empty(_pio_instance, _pio_sm) ||
+           pio_sm_get_pc(_pio_instance, _pio_sm) != _pio_program_offset;
+}
+
+uint32_t DMX512Transmitter::engine_frames_sent() const {
+    if (!_run_started) {
+        return 0;
+    }
+
+    // A packet counts once the data channel has loaded all of it, as the
+    // UART backend counts a packet once all of it is queued. Every packet
+    // but the last of a run is followed by a re-arm, and every re-arm moves
+    // the re-arm channel's read address one word on through its ring.
+    uint32_t ring_base = (uint32_t)(uintptr_t)_packet_addrs;
+    uint32_t ring_index = (dma_channel_hw_addr(_rearm_dma_channel)->read_addr - ring_base) / 4 % REARM_RING_WORDS;
+    uint32_t rearms = ring_index;
+
+    if (_run_period_cycles > 0) {
+        // The ring gives the count modulo its size. Packets follow each other
+        // exactly, so the time since the start of the run gives it to within
+        // a packet, which picks the right multiple. Elapsed clk_sys cycles
+        // times 256 over the 16.8 divider are state machine cycles. Once
+        // the refresh is stopped the ring stays put, and so does the time.
+        absolute_time_t now = _run_stopped ? _run_stop_time : get_absolute_time();
+        uint64_t elapsed_us = (uint64_t)absolute_time_diff_us(_run_start_time, now);
+        uint64_t clk_sys_hz = clock_get_hz(clk_sys);
+        uint64_t scaled_cycles = elapsed_us / 1000000 * clk_sys_hz * 256 +
+                                 elapsed_us % 1000000 * clk_sys_hz * 256 / 1000000;
+        uint32_t estimate = (uint32_t)(scaled_cycles / (_pio_div256 * _run_period_cycles));
+
+        int32_t offset = (int32_t)((ring_index - estimate) % REARM_RING_WORDS);
+        if (offset >= (int32_t)REARM_RING_WORDS / 2) {
+            offset -= REARM_RING_WORDS;
+        }
+        rearms = (offset < 0 && estimate < (uint32_t)-offset) ? ring_index : estimate + offset;
+    }
+
+    // The last packet once it is loaded and no re-arm follows it
+    bool last_loaded = !dma_channel_is_busy(_dma_channel) && !dma_channel_is_busy(_rearm_dma_channel);
+    return rearms + (last_loaded ? 1 : 0);
 }
 
 void DMX512Transmitter::end() {
@@ -81,11 +478,33 @@ void DMX512Transmitter::end() {
         return;
     }
 
+    // The PIO engine only stops refreshing when told to
+    if (_backend == Backend::PIO) {
+        setContinuousMode(false);
+    }
+
     // Wait for any ongoing transmission to complete
     waitForCompletion(1000);  // 1 second timeout
 
-    // Disable interrupt
-    irq_set_enabled(_uart_irq, false);
+    if (_backend == Backend::PIO) {
+        cleanup_pio_engine();
+        _initialized = false;
+        _status = Status::IDLE;
+        return;
+    }
+
+    // Disable interrupts
+    if (_timing_alarm > 0) {
+        cancel_alarm(_timing_alarm);
+        _timing_alarm = 0;
+    }
+    if (_break_active) {
+        uart_set_break(_uart_instance, false);
+        _break_active = false;
+    }
+    cleanup_dma();
+    uart_set_irq_enables(_uart_instance, false, false);
+    IRQDispatcher::removeUARTHandler(_uart_instance);
     
     // Deinitialize UART
     uart_deinit(_uart_instance);
@@ -101,6 +520,9 @@ bool DMX512Transmitter::setChannel(uint16_t channel, uint8_t value) {
     
     // Channels are 1-based, array is 0-based (index 0 is start code)
     _dmx_frame[channel] = value;
+    if (!_update_open) {
+        commit_frame();
+    }
     return true;
 }
 
@@ -119,6 +541,9 @@ bool DMX512Transmitter::setChannelRange(uint16_t start_channel, const uint8_t* d
     }
     
     memcpy(&_dmx_frame[start_channel], data, length);
+    if (!_update_open) {
+        commit_frame();
+    }
     return true;
 }
 
@@ -129,11 +554,57 @@ void DMX512Transmitter::setUniverse(const uint8_t* data) {
     
     // Copy exactly 512 channels (preserve start code at index 0)
     memcpy(&_dmx_frame[1], data, DMX_UNIVERSE_SIZE);
+    if (!_update_open) {
+        commit_frame();
+    }
 }
 
 void DMX512Transmitter::clearUniverse() {
     // Clear all channels to 0 (preserve start code)
     memset(&_dmx_frame[1], 0, DMX_UNIVERSE_SIZE);
+    if (!_update_open) {
+        commit_frame();
+    }
+}
+
+void DMX512Transmitter::setStartCode(uint8_t start_code) {
+    _dmx_frame[0] = start_code;
+    if (!_update_open) {
+        commit_frame();
+    }
+}
+
+void DMX512Transmitter::commitUpdate() {
+    _update_open = false;
+    commit_frame();
+}
+
+void DMX512Transmitter::commit_frame() {
+    uint8_t previous = _committed_buffer;
+    uint8_t committed = _staging_buffer;
+
+    // The next packet is sent from the staging frame. Its old buffer is
+    // free unless a packet is being sent from it, in which case the third
+    // buffer is (the frame before it has been sent in full). A re-arm
+    // under way may load the previous packet address as well as the new
+    // one, so then the third buffer is taken too.
+    uint32_t irq_status = save_and_disable_interrupts();
+    _committed_buffer = committed;
+    for (uint i = 0; i < REARM_RING_WORDS; i++) {
+        _packet_addrs[i] = (uint32_t)(uintptr_t)_packets[committed];
+    }
+    bool rearming = false;
+    uint sending = _sending_buffer;
+    if (_backend == Backend::PIO) {
+        rearming = _rearm_dma_channel >= 0 && dma_channel_is_busy(_rearm_dma_channel);
+        sending = engine_sending_buffer();
+    }
+    restore_interrupts(irq_status);
+
+    bool previous_in_use = rearming || sending == previous;
+    _staging_buffer = previous_in_use ? (uint8_t)(3 - previous - committed) : previous;
+    _dmx_frame = frame_of(_staging_buffer);
+    memcpy(_dmx_frame, frame_of(committed), DMX_UNIVERSE_SIZE + 1);
 }
 
 bool DMX512Transmitter::transmit() {
@@ -141,16 +612,35 @@ bool DMX512Transmitter::transmit() {
         return false;
     }
 
-    if (_status != Status::IDLE) {
+    if (isBusy()) {
         return false;  // Transmission already in progress
     }
 
+    if (_backend == Backend::PIO) {
+        start_engine(false);
+        return true;
+    }
+
     // Start DMX transmission sequence
     start_break();
     return true;
 }
 
 void DMX512Transmitter::setContinuousMode(bool enable) {
+    if (_backend == Backend::PIO) {
+        if (_initialized && enable != _continuous_mode) {
+            if (enable) {
+                // A packet from transmit() finishes first
+                waitForCompletion();
+                start_engine(true);
+            } else {
+                stop_engine_refresh();
+            }
+        }
+        _continuous_mode = enable;
+        return;
+    }
+
     _continuous_mode = enable;
     
     if (enable && _status == Status::IDLE) {
@@ -158,85 +648,163 @@ void DMX512Transmitter::setContinuousMode(bool enable) {
     }
 }
 
+bool DMX512Transmitter::setRefreshRate(uint32_t rate_hz) {
+    if (rate_hz == 0) {
+        return false;
+    }
+    _refresh_rate_hz = rate_hz;
+    return true;
+}
+
+bool DMX512Transmitter::isBusy() const {
+    if (_backend == Backend::PIO) {
+        return _status != Status::IDLE && is_engine_busy();
+    }
+    return _status != Status::IDLE;
+}
+
 void DMX512Transmitter::start_break() {
     _status = Status::TRANSMITTING_BREAK;
-    
-    // Configure GPIO as output for break
-    gpio_init(_gpio_pin);
-    gpio_set_dir(_gpio_pin, GPIO_OUT);
-    gpio_put(_gpio_pin, 0);  // Pull low for break
-    
+
+    // A break would cut off the last slots of the previous packet, so it
+    // waits until they have left the UART
+    if (!time_reached(_line_idle_time)) {
+        schedule_step(_line_idle_time);
+        return;
+    }
+    begin_break();
+}
+
+void DMX512Transmitter::begin_break() {
+    // The UART holds TX low until the break is released, so the pin stays
+    // with the UART throughout
+    uart_set_break(_uart_instance, true);
+    _break_active = true;
+
     _break_start_time = get_absolute_time();
-    
-    // Set up timer for break duration
-    busy_wait_us(DMX_BREAK_TIME_US);
-    
-    start_mab();
+    schedule_step(delayed_by_us(_break_start_time, DMX_BREAK_TIME_US));
 }
 
 void DMX512Transmitter::start_mab() {
     _status = Status::TRANSMITTING_MAB;
-    
-    // Pull high for Mark After Break
-    gpio_put(_gpio_pin, 1);
-    
+
+    // Releasing the break returns TX to the idle (mark) level
+    uart_set_break(_uart_instance, false);
+    _break_active = false;
+
     _mab_start_time = get_absolute_time();
-    
-    // Wait for MAB duration
-    busy_wait_us(DMX_MARK_TIME_US);
-    
-    start_data_transmission();
+    schedule_step(delayed_by_us(_mab_start_time, DMX_MARK_TIME_US));
+}
+
+void DMX512Transmitter::schedule_step(absolute_time_t time) {
+    alarm_id_t alarm = add_alarm_at(time, timing_alarm_callback, this, true);
+    if (alarm > 0) {
+        _timing_alarm = alarm;
+    } else if (alarm < 0) {
+        // No alarm slot free: wait here as a fallback
+        _error_count++;
+        busy_wait_until(time);
+        timing_step();
+    }
+}
+
+void DMX512Transmitter::timing_step() {
+    switch (_status) {
+        case Status::TRANSMITTING_BREAK:
+            if (_break_active) {
+                start_mab();
+            } else {
+                begin_break();
+            }
+            break;
+        case Status::TRANSMITTING_MAB:
+            start_data_transmission();
+            break;
+        default:
+            break;
+    }
+}
+
+int64_t DMX512Transmitter::timing_alarm_callback(alarm_id_t id, void* user_data) {
+    (void)id;
+    DMX512Transmitter* transmitter = static_cast<DMX512Transmitter*>(user_data);
+    transmitter->_timing_alarm = 0;
+    transmitter->timing_step();
+    return 0;
 }
 
 void DMX512Transmitter::start_data_transmission() {
     _status = Status::TRANSMITTING_DATA;
     _current_byte_index = 0;
-    
-    // Reconfigure pin for UART
-    gpio_set_function(_gpio_pin, GPIO_FUNC_UART);
-    
-    // Enable UART TX interrupt
-    uart_set_irq_enables(_uart_instance, false, true);
-    
-    // Send first byte (start code)
-    uart_putc_raw(_uart_instance, _dmx_frame[0]);
-    _current_byte_index = 1;
+
+    // Packet boundary: take the last committed frame
+    _sending_buffer = _committed_buffer;
+    _tx_frame = frame_of(_sending_buffer);
+
+    if (_dma_available) {
+        // Start code and all 512 slots in one transfer
+        dma_channel_transfer_from_buffer_now(_dma_channel, _tx_frame, DMX_UNIVERSE_SIZE + 1);
+        return;
+    }
+
+    // Fill the TX FIFO; the TX interrupt refills it
+    handle_uart_interrupt();
+    if (_status == Status::TRANSMITTING_DATA) {
+        uart_set_irq_enables(_uart_instance, false, true);
+    }
 }
 
-void DMX512Transmitter::uart_irq_handler() {
-    if (_instance != nullptr) {
-        _instance->handle_uart_interrupt();
+void DMX512Transmitter::frame_complete(uint pending_slots) {
+    // Every slot is in the UART and the last pending_slots of them leave
+    // within as many slot times; the next break waits for that
+    _line_idle_time = delayed_by_us(get_absolute_time(), pending_slots * _slot_time_us);
+    if (_continuous_mode) {
+        // Packets start at most at the refresh rate
+        absolute_time_t next_packet = delayed_by_us(_break_start_time, 1000000 / _refresh_rate_hz);
+        if (absolute_time_diff_us(_line_idle_time, next_packet) > 0) {
+            _line_idle_time = next_packet;
+        }
+    }
+    _status = Status::IDLE;
+    _frame_count++;
+
+    if (_continuous_mode) {
+        start_break();
     }
 }
 
+void DMX512Transmitter::uart_irq_callback(void* user_data) {
+    static_cast<DMX512Transmitter*>(user_data)->handle_uart_interrupt();
+}
+
+void DMX512Transmitter::dma_complete_callback(uint channel, void* user_data) {
+    (void)channel;
+    // Without the FIFO the last slot is in the holding register and the
+    // one before it in the shifter
+    static_cast<DMX512Transmitter*>(user_data)->frame_complete(2);
+}
+
 void DMX512Transmitter::handle_uart_interrupt() {
-    // Check if TX FIFO has space and we have more data to send
-    if (uart_is_writable(_uart_instance) && _current_byte_index <= DMX_UNIVERSE_SIZE) {
-        if (_current_byte_index <= DMX_UNIVERSE_SIZE) {
-            // Send next byte
-            uart_putc_raw(_uart_instance, _dmx_frame[_current_byte_index]);
-            _current_byte_index++;
-        } else {
-            // Transmission complete
-            uart_set_irq_enables(_uart_instance, false, false);  // Disable TX interrupt
-            
-            _status = Status::IDLE;
-            _frame_count++;
-            
-            // If continuous mode is enabled, start next frame after a short delay
-            if (_continuous_mode) {
-                // Add small delay between frames to maintain proper DMX timing
-                busy_wait_us(1000);  // 1ms delay
-                start_break();
-            }
-        }
+    uint queued = 0;
+    while (_current_byte_index <= DMX_UNIVERSE_SIZE && uart_is_writable(_uart_instance)) {
+        uart_putc_raw(_uart_instance, _tx_frame[_current_byte_index]);
+        _current_byte_index++;
+        queued++;
+    }
+
+    if (_current_byte_index > DMX_UNIVERSE_SIZE) {
+        // Last slot queued: no more TX interrupts for this packet. The FIFO
+        // held at most DMX_TX_IRQ_LEVEL slots before these, plus one in the
+        // shifter.
+        uart_set_irq_enables(_uart_instance, false, false);
+        frame_complete(DMX_TX_IRQ_LEVEL + queued + 1);
     }
 }
 
 bool DMX512Transmitter::waitForCompletion(uint32_t timeout_ms) {
     absolute_time_t start_time = get_absolute_time();
     
-    while (_status != Status::IDLE) {
+    while (isBusy()) {
         if (timeout_ms > 0) {
             if (absolute_time_diff_us(start_time, get_absolute_time()) > (timeout_ms * 1000)) {
                 return false;  // Timeout
@@ -244,17 +812,26 @@ bool DMX512Transmitter::waitForCompletion(uint32_t timeout_ms) {
         }
         tight_loop_contents();
     }
-    
+
+    if (_backend == Backend::PIO) {
+        _status = Status::IDLE;
+        return true;
+    }
+
+    // The last slots may still be in the TX FIFO
+    uart_tx_wait_blocking(_uart_instance);
     return true;
 }
 
 void DMX512Transmitter::getStatistics(uint32_t& frame_count, uint32_t& error_count) const {
-    frame_count = _frame_count;
+    frame_count = _frame_count + engine_frames_sent();
     error_count = _error_count;
 }
 
 void DMX512Transmitter::resetStatistics() {
-    _frame_count = 0;
+    // Offset by the packets the PIO engine has sent in this run, which
+    // getStatistics() adds back
+    _frame_count = 0 - engine_frames_sent();
     _error_count = 0;
 }
 
@@ -268,10 +845,6 @@ bool DMX512Transmitter::validateFrame() const {
     return true;
 }
 
-void DMX512Transmitter::delay_microseconds(uint32_t us) {
-    busy_wait_us(us);
-}
-
 bool DMX512Transmitter::is_break_complete() const {
     return absolute_time_diff_us(_break_start_time, get_absolute_time()) >= DMX_BREAK_TIME_US;
 }
@@ -284,9 +857,14 @@ void DMX512Transmitter::printStatus() const {
     printf("DMX512 Transmitter Status:\n");
     printf("  Initialized: %s\n", _initialized ? "Yes" : "No");
     printf("  GPIO Pin: %u\n", _gpio_pin);
+    if (_backend == Backend::PIO) {
+        printf("  Backend: PIO (pio%u SM %d)\n", pio_get_index(_pio_instance), _pio_sm);
+    } else {
+        printf("  Backend: UART (uart%u)\n", uart_get_index(_uart_instance));
+    }
     printf("  Status: ");
     
-    switch (_status) {
+    switch (getStatus()) {
         case Status::IDLE:
             printf("IDLE\n");
             break;
@@ -297,14 +875,22 @@ void DMX512Transmitter::printStatus() const {
             printf("TRANSMITTING_MAB\n");
             break;
         case Status::TRANSMITTING_DATA:
-            printf("TRANSMITTING_DATA (byte %u/%u)\n", _current_byte_index, DMX_UNIVERSE_SIZE + 1);
+            if (_backend == Backend::PIO) {
+                printf("TRANSMITTING_DATA (PIO)\n");
+            } else if (_dma_available) {
+                printf("TRANSMITTING_DATA (DMA)\n");
+            } else {
+                printf("TRANSMITTING_DATA (byte %u/%u)\n", _current_byte_index, DMX_UNIVERSE_SIZE + 1);
+            }
             break;
         case Status::ERROR:
             printf("ERROR\n");
             break;
     }
     
+    printf("  DMA Enabled: %s\n", _dma_available ? "Yes" : "No");
     printf("  Continuous Mode: %s\n", _continuous_mode ? "Enabled" : "Disabled");
+    printf("  Refresh Rate: %lu Hz\n", _refresh_rate_hz);
     printf("  Frames Transmitted: %lu\n", _frame_count);
     printf("  Errors: %lu\n", _error_count);
     printf("  Start Code: 0x%02X\n", _dmx_frame[0]);
@@ -4,6 +4,9 @@
 #include "hardware/uart.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
 #include "../config/picoled_config.h"
 
 /**
@@ -11,6 +14,22 @@
  * 
  * Implements DMX512-A standard with exactly 512 channels
  * Designed for RS485 output with proper timing and frame structure
+ *
+ * The slots of a packet are sent by a DMA channel paced by the UART TX
+ * DREQ, so a packet costs one completion interrupt. Without a free DMA
+ * channel the slots are written to the TX FIFO from the UART interrupt.
+ *
+ * The break is a UART break condition and timer alarms end it and the
+ * mark after break, so transmit() returns at once and no interrupt waits
+ * for the line.
+ *
+ * Constructed with a PIO instead of a UART, a state machine produces the
+ * whole packet - break, mark after break, start code, 512 slots with their
+ * start and stop bits and mark before break - from the slot buffer and the
+ * loop counts around it that a DMA channel feeds it. The state machines of
+ * a PIO share one copy of the program. A second DMA channel re-arms the
+ * first after every packet, so continuous mode refreshes the universe at
+ * the set rate without the CPU and no UART is used.
  */
 class DMX512Transmitter {
 public:
@@ -28,42 +47,121 @@ public:
         ERROR_UART_INIT_FAILED,
         ERROR_INVALID_CHANNEL,
         ERROR_TRANSMISSION_IN_PROGRESS,
-        ERROR_NOT_INITIALIZED
+        ERROR_NOT_INITIALIZED,
+        ERROR_PIO_INIT_FAILED
+    };
+
+    enum class Backend {
+        UART,       // UART, with DMA or interrupt-fed slots and alarm-timed break
+        PIO         // Autonomous PIO state machine fed by self-re-arming DMA
     };
 
 private:
+    // Words before the slots in the PIO packet: break and mark after break
+    // lengths, slot count. The mark before break length follows the slots.
+    static const uint PIO_HEADER_WORDS = 3;
+    static const uint PIO_PACKET_WORDS = PIO_HEADER_WORDS + (DMX_UNIVERSE_SIZE + 1 + 3) / 4 + 1;
+
+    // Staging, last committed and sending frames
+    static const uint FRAME_BUFFERS = 3;
+
+    // The re-arm channel reads the packet address from a ring of this many
+    // bytes, so its read address counts re-arms (see engine_frames_sent())
+    static const uint REARM_RING_BITS = 5;
+    static const uint REARM_RING_WORDS = (1u << REARM_RING_BITS) / 4;
+
     // Hardware configuration
+    Backend _backend;
     uint _gpio_pin;
     uart_inst_t* _uart_instance;
-    uint _uart_irq;
+    PIO _pio_instance;
     
-    // DMX512 data buffer (513 bytes: start code + 512 channels)
-    uint8_t _dmx_frame[DMX_UNIVERSE_SIZE + 1];
+    // Packets as the PIO engine reads them: header words, the DMX512 data
+    // (513 bytes: start code + 512 channels) and the mark before break
+    // word. Channels are written to the staging frame that _dmx_frame
+    // points to; a commit makes it the frame the next packet is sent from,
+    // while the packet on the wire keeps its own buffer.
+    uint32_t _packets[FRAME_BUFFERS][PIO_PACKET_WORDS];
+    uint8_t* _dmx_frame;
+    uint8_t _staging_buffer;
+    volatile uint8_t _committed_buffer;
+    volatile uint8_t _sending_buffer;   // UART backend: frame of the packet being sent
+    const uint8_t* _tx_frame;           // Its slots
+    bool _update_open;
     
     // Transmission state
     volatile Status _status;
     volatile uint16_t _current_byte_index;
     bool _initialized;
     bool _continuous_mode;
+
+    // DMA configuration
+    bool _use_dma;
+    int _dma_channel;
+    bool _dma_available;
     
     // Timing control
+    volatile alarm_id_t _timing_alarm;
+    uint32_t _slot_time_us;             // One slot (start, 8 data and 2 stop bits) on the wire
+    absolute_time_t _line_idle_time;    // The previous packet has left the UART by then
+    bool _break_active;
     absolute_time_t _break_start_time;
     absolute_time_t _mab_start_time;
     
+    uint32_t _refresh_rate_hz;
+
+    // PIO engine
+    int _pio_sm;
+    uint _pio_program_offset;
+    uint16_t _program_instructions[16];
+    struct pio_program _program;
+    int _rearm_dma_channel;
+    // Address of the committed packet in every word, read by the re-arm channel
+    alignas(1u << REARM_RING_BITS) volatile uint32_t _packet_addrs[REARM_RING_WORDS];
+    uint32_t _pio_clock_hz;
+    uint32_t _pio_div256;               // Its divider from clk_sys, 16.8 fixed point
+    uint32_t _packet_cycles;            // State machine cycles of a packet with a mark before break count of 0
+    uint64_t _run_period_cycles;        // Packet period of the current run, 0 for a single packet
+    absolute_time_t _run_start_time;
+    absolute_time_t _run_stop_time;     // When continuous refresh was stopped, if _run_stopped
+    bool _run_started;
+    bool _run_stopped;
+
+    // The engine program only depends on the universe size, so the state
+    // machines of a PIO share one copy
+    static uint _pio_program_users[NUM_PIOS];
+    static uint _pio_program_offsets[NUM_PIOS];
+    
     // Statistics
     uint32_t _frame_count;
     uint32_t _error_count;
     
     // Internal methods
     void configure_uart();
+    bool init_dma();
+    void cleanup_dma();
+    bool init_pio_engine(uint32_t baud_rate);
+    void cleanup_pio_engine();
+    void start_engine(bool continuous);
+    uint engine_sending_buffer() const;
+    void commit_frame();
+    uint8_t* frame_of(uint buffer) { return (uint8_t*)&_packets[buffer][PIO_HEADER_WORDS]; }
+    void stop_engine_refresh();
+    bool is_engine_busy() const;
+    uint32_t engine_frames_sent() const;
     void start_break();
+    void begin_break();
     void start_mab();
     void start_data_transmission();
+    void frame_complete(uint pending_slots);
     void handle_uart_interrupt();
-    static void uart_irq_handler();
+    static void uart_irq_callback(void* user_data);
+    static void dma_complete_callback(uint channel, void* user_data);
     
     // Timing helpers
-    void delay_microseconds(uint32_t us);
+    void schedule_step(absolute_time_t time);
+    void timing_step();
+    static int64_t timing_alarm_callback(alarm_id_t id, void* user_data);
     bool is_break_complete() const;
     bool is_mab_complete() const;
     
@@ -72,8 +170,20 @@ public:
      * @brief Constructor
      * @param gpio_pin GPIO pin for DMX output (connected to RS485 driver)
      * @param uart_instance UART instance to use (uart0 or uart1)
+     * @param use_dma Send the slots by DMA if a channel is free
      */
-    DMX512Transmitter(uint gpio_pin, uart_inst_t* uart_instance = uart1);
+    DMX512Transmitter(uint gpio_pin, uart_inst_t* uart_instance = uart1, bool use_dma = true);
+
+    /**
+     * @brief Constructor for the PIO backend
+     *
+     * Uses a free state machine of pio_instance and two DMA channels, and
+     * no UART or interrupt.
+     *
+     * @param gpio_pin GPIO pin for DMX output (connected to RS485 driver)
+     * @param pio_instance PIO instance to use (pio0 or pio1)
+     */
+    DMX512Transmitter(uint gpio_pin, PIO pio_instance);
 
     /**
      * @brief Destructor
@@ -92,8 +202,39 @@ public:
      */
     void end();
 
+    /**
+     * @brief Start staging channel changes
+     *
+     * Until commitUpdate(), channel writes only change the staging frame
+     * and packets keep being sent from the last committed frame. Outside an
+     * update every write is committed on its own (see setChannel() for the
+     * cost).
+     */
+    void beginUpdate() { _update_open = true; }
+
+    /**
+     * @brief Commit the staged channels as one frame
+     *
+     * The frame is swapped in at the next packet boundary, so no packet
+     * mixes channels from before and after the commit. Never waits for the
+     * packet being sent, so updates can be committed at any rate; frames
+     * committed within one packet only send the last.
+     */
+    void commitUpdate();
+
+    /**
+     * @brief Check if an update is open (see beginUpdate())
+     */
+    bool isUpdateOpen() const { return _update_open; }
+
     /**
      * @brief Set DMX channel value (1-512)
+     *
+     * Outside an update each write is a commit: interrupts go off while the
+     * packet addresses are rewritten, and the 513-byte frame is copied to
+     * the next staging buffer. Setting many channels this way copies the
+     * frame once per channel, so wrap them in beginUpdate()/commitUpdate().
+     *
      * @param channel Channel number (1-512)
      * @param value Channel value (0-255)
      * @return true if successful
@@ -129,23 +270,51 @@ public:
 
     /**
      * @brief Transmit current DMX frame (exactly 512 channels + start code)
+     *
+     * Returns at once: the break, mark after break and slots follow from
+     * timer and DMA (or UART) interrupts. The break waits for the previous
+     * packet to leave the UART.
+     *
      * @return true if transmission started successfully
      */
     bool transmit();
 
     /**
      * @brief Enable/disable continuous transmission mode
+     *
+     * Disabling it lets the packet being sent finish.
+     *
      * @param enable If true, automatically retransmit at DMX refresh rate
      */
     void setContinuousMode(bool enable);
 
+    /**
+     * @brief Set the continuous mode packet rate
+     *
+     * Packets start no more often than this; a rate above what a full
+     * packet allows (about 44 Hz) sends them back to back. Takes effect
+     * when continuous mode is next enabled.
+     *
+     * @param rate_hz Packets per second
+     * @return false if rate_hz is 0
+     */
+    bool setRefreshRate(uint32_t rate_hz);
+
+    /**
+     * @brief Get the continuous mode packet rate
+     */
+    uint32_t getRefreshRate() const { return _refresh_rate_hz; }
+
     /**
      * @brief Check if transmission is currently in progress
      */
-    bool isBusy() const { return _status != Status::IDLE; }
+    bool isBusy() const;
 
     /**
      * @brief Wait for current transmission to complete
+     *
+     * Returns once the last slot has left the UART.
+     *
      * @param timeout_ms Maximum time to wait in milliseconds (0 = infinite)
      * @return true if completed within timeout
      */
@@ -154,13 +323,23 @@ public:
     /**
      * @brief Get current transmission status
      */
-    Status getStatus() const { return _status; }
+    Status getStatus() const { return isBusy() ? _status : Status::IDLE; }
 
     /**
      * @brief Check if transmitter is initialized
      */
     bool isInitialized() const { return _initialized; }
 
+    /**
+     * @brief Check if the slots are sent by DMA
+     */
+    bool isDMAEnabled() const { return _dma_available; }
+
+    /**
+     * @brief Get the backend producing the signal
+     */
+    Backend getBackend() const { return _backend; }
+
     /**
      * @brief Get GPIO pin number
      */
@@ -179,7 +358,12 @@ public:
     void resetStatistics();
 
     /**
-     * @brief Get direct access to DMX frame buffer
+     * @brief Get direct access to the staging frame
+     *
+     * Changes made through the pointer are sent after the next commit
+     * (commitUpdate() or a channel write outside an update). The pointer
+     * changes with every commit.
+     *
      * @return Pointer to 513-byte buffer (start code + 512 channels)
      */
     uint8_t* getFrameBuffer() { return _dmx_frame; }
@@ -194,7 +378,7 @@ public:
      * @brief Set custom start code (default is 0x00 for dimmer data)
      * @param start_code Start code value
      */
-    void setStartCode(uint8_t start_code) { _dmx_frame[0] = start_code; }
+    void setStartCode(uint8_t start_code);
 
     /**
      * @brief Get current start code
@@ -204,7 +388,4 @@ public:
     // Debug and diagnostic methods
     void printStatus() const;
     void printFrame(uint16_t start_channel = 1, uint16_t count = 16) const;
-    
-    // Static instance for interrupt handling
-    static DMX512Transmitter* _instance;
 };
\ No newline at end of file
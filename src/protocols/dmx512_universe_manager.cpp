@@ -0,0 +1,284 @@
+#include "dmx512_universe_manager.h"
+#include <cstdio>
+
+DMX512UniverseManager::DMX512UniverseManager()
+    : _universes{},
+      _count(0),
+      _refresh_rate_hz(DMX_REFRESH_RATE_HZ),
+      _start_mode(StartMode::ALIGNED),
+      _running(false),
+      _start_alarm(0),
+      _next_start(0),
+      _start_continuous(false),
+      _start_interval_us(0),
+      _error_count(0) {
+}
+
+DMX512UniverseManager::~DMX512UniverseManager() {
+    end();
+}
+
+bool DMX512UniverseManager::addPIOUniverse(uint gpio_pin, PIO pio_instance) {
+    if (_count >= DMX_MAX_UNIVERSES || _running) {
+        return false;
+    }
+    return add(new DMX512Transmitter(gpio_pin, pio_instance), true);
+}
+
+bool DMX512UniverseManager::addUARTUniverse(uint gpio_pin, uart_inst_t* uart_instance, bool use_dma) {
+    if (_count >= DMX_MAX_UNIVERSES || _running) {
+        return false;
+    }
+    return add(new DMX512Transmitter(gpio_pin, uart_instance, use_dma), use_dma);
+}
+
+bool DMX512UniverseManager::add(DMX512Transmitter* transmitter, bool require_dma) {
+    transmitter->setRefreshRate(_refresh_rate_hz);
+    if (transmitter->begin() != DMX512Transmitter::ReturnCode::SUCCESS) {
+        delete transmitter;
+        return false;
+    }
+
+    // A UART universe without a DMA channel would fall back to the UART
+    // interrupt; that is left to the caller to ask for
+    if (require_dma && !transmitter->isDMAEnabled()) {
+        transmitter->end();
+        delete transmitter;
+        return false;
+    }
+
+    _universes[_count++] = transmitter;
+    return true;
+}
+
+void DMX512UniverseManager::end() {
+    stop();
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->end();
+        delete _universes[i];
+        _universes[i] = nullptr;
+    }
+    _count = 0;
+}
+
+bool DMX512UniverseManager::setChannel(uint universe, uint16_t channel, uint8_t value) {
+    if (universe >= _count) {
+        return false;
+    }
+    return _universes[universe]->setChannel(channel, value);
+}
+
+uint8_t DMX512UniverseManager::getChannel(uint universe, uint16_t channel) const {
+    if (universe >= _count) {
+        return 0;
+    }
+    return _universes[universe]->getChannel(channel);
+}
+
+bool DMX512UniverseManager::setChannelRange(uint universe, uint16_t start_channel, const uint8_t* data,
+                                            uint16_t length) {
+    if (universe >= _count) {
+        return false;
+    }
+    return _universes[universe]->setChannelRange(start_channel, data, length);
+}
+
+bool DMX512UniverseManager::setUniverse(uint universe, const uint8_t* data) {
+    if (universe >= _count || data == nullptr) {
+        return false;
+    }
+    _universes[universe]->setUniverse(data);
+    return true;
+}
+
+void DMX512UniverseManager::clearUniverse(uint universe) {
+    if (universe < _count) {
+        _universes[universe]->clearUniverse();
+    }
+}
+
+void DMX512UniverseManager::beginUpdate() {
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->beginUpdate();
+    }
+}
+
+void DMX512UniverseManager::commitUpdate() {
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->commitUpdate();
+    }
+}
+
+bool DMX512UniverseManager::transmit() {
+    if (_count == 0 || _running || isBusy()) {
+        _error_count++;
+        return false;
+    }
+
+    start_universes(false);
+    return true;
+}
+
+bool DMX512UniverseManager::start() {
+    if (_count == 0 || _running || isBusy()) {
+        _error_count++;
+        return false;
+    }
+
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->setRefreshRate(_refresh_rate_hz);
+    }
+    _running = true;
+    start_universes(true);
+    return true;
+}
+
+void DMX512UniverseManager::stop() {
+    cancel_starts();
+    if (!_running) {
+        return;
+    }
+
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->setContinuousMode(false);
+    }
+    _running = false;
+}
+
+void DMX512UniverseManager::start_universes(bool continuous) {
+    _start_continuous = continuous;
+
+    if (_start_mode == StartMode::ALIGNED || _count == 1) {
+        // Every backend starts its break as soon as it is started, so the
+        // universes start within a few microseconds of each other
+        for (uint i = 0; i < _count; i++) {
+            start_universe(i);
+        }
+        return;
+    }
+
+    // Universes refresh at the same rate, so once started a period apart
+    // divided by their number, they stay that far apart
+    _start_interval_us = 1000000 / (_refresh_rate_hz * _count);
+    absolute_time_t first_start = get_absolute_time();
+    start_universe(0);
+    _next_start = 1;
+
+    alarm_id_t alarm = add_alarm_at(delayed_by_us(first_start, _start_interval_us), start_alarm_callback, this, true);
+    if (alarm > 0) {
+        _start_alarm = alarm;
+    } else if (alarm < 0) {
+        // No alarm slot free: wait here as a fallback
+        _error_count++;
+        while (_next_start < _count) {
+            busy_wait_until(delayed_by_us(first_start, _next_start * _start_interval_us));
+            start_universe(_next_start++);
+        }
+    }
+}
+
+void DMX512UniverseManager::start_universe(uint universe) {
+    // Runs in the start alarm for staggered starts, so it must not wait:
+    // a universe still sending a packet of its own is left out (a PIO
+    // universe would wait for the packet to start continuous mode)
+    DMX512Transmitter* transmitter = _universes[universe];
+    if (transmitter->isBusy()) {
+        _error_count++;
+    } else if (_start_continuous) {
+        transmitter->setContinuousMode(true);
+    } else if (!transmitter->transmit()) {
+        _error_count++;
+    }
+}
+
+void DMX512UniverseManager::cancel_starts() {
+    if (_start_alarm > 0) {
+        cancel_alarm(_start_alarm);
+        _start_alarm = 0;
+    }
+}
+
+int64_t DMX512UniverseManager::start_alarm_callback(alarm_id_t id, void* user_data) {
+    (void)id;
+    DMX512UniverseManager* manager = static_cast<DMX512UniverseManager*>(user_data);
+    manager->start_universe(manager->_next_start++);
+    if (manager->_next_start < manager->_count) {
+        // From the time this start was due, so the intervals do not drift
+        return manager->_start_interval_us;
+    }
+    manager->_start_alarm = 0;
+    return 0;
+}
+
+bool DMX512UniverseManager::isBusy() const {
+    if (_start_alarm > 0) {
+        return true;
+    }
+    for (uint i = 0; i < _count; i++) {
+        if (_universes[i]->isBusy()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DMX512UniverseManager::waitForCompletion(uint32_t timeout_ms) {
+    absolute_time_t start_time = get_absolute_time();
+
+    while (isBusy()) {
+        if (timeout_ms > 0) {
+            if (absolute_time_diff_us(start_time, get_absolute_time()) > (timeout_ms * 1000)) {
+                return false;  // Timeout
+            }
+        }
+        tight_loop_contents();
+    }
+
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->waitForCompletion(timeout_ms);
+    }
+    return true;
+}
+
+bool DMX512UniverseManager::setRefreshRate(uint32_t rate_hz) {
+    if (rate_hz == 0) {
+        return false;
+    }
+    _refresh_rate_hz = rate_hz;
+    return true;
+}
+
+void DMX512UniverseManager::getStatistics(uint32_t& frame_count, uint32_t& error_count) const {
+    frame_count = 0;
+    error_count = _error_count;
+    for (uint i = 0; i < _count; i++) {
+        uint32_t universe_frames, universe_errors;
+        _universes[i]->getStatistics(universe_frames, universe_errors);
+        frame_count += universe_frames;
+        error_count += universe_errors;
+    }
+}
+
+void DMX512UniverseManager::resetStatistics() {
+    _error_count = 0;
+    for (uint i = 0; i < _count; i++) {
+        _universes[i]->resetStatistics();
+    }
+}
+
+void DMX512UniverseManager::printStatus() const {
+    printf("DMX512 Universe Manager Status:\n");
+    printf("  Universes: %u\n", _count);
+    printf("  Refresh Rate: %lu Hz\n", _refresh_rate_hz);
+    printf("  Start Mode: %s\n", _start_mode == StartMode::ALIGNED ? "ALIGNED" : "STAGGERED");
+    printf("  Running: %s\n", _running ? "Yes" : "No");
+    for (uint i = 0; i < _count; i++) {
+        const DMX512Transmitter* transmitter = _universes[i];
+        uint32_t frame_count, error_count;
+        transmitter->getStatistics(frame_count, error_count);
+        printf("  Universe %u: GPIO %u, %s%s, %lu frames, %lu errors\n", i, transmitter->getGpioPin(),
+               transmitter->getBackend() == DMX512Transmitter::Backend::PIO ? "PIO" : "UART",
+               transmitter->isDMAEnabled() ? " + DMA" : "", frame_count, error_count);
+    }
+    printf("  Errors: %lu\n", _error_count);
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/uart.h"
+#include "dmx512_transmitter.h"
+#include "../config/picoled_config.h"
+
+/**
+ * @brief Drives several DMX512 universes from one board
+ *
+ * The manager owns up to DMX_MAX_UNIVERSES transmitters, each on its own
+ * pin. Universes are numbered from 0 in the order they are added, and
+ * channels are addressed as (universe, channel). What each backend takes:
+ *
+ * - PIO: one state machine and two DMA channels, no interrupts. The 12
+ *   DMA channels allow at most 6 PIO universes, fewer with other DMA users
+ *   (each WS2812 or RS485 driver takes one or two).
+ * - UART: one of the two UARTs, plus one DMA channel unless it is added
+ *   with use_dma = false, in which case the UART interrupt feeds it.
+ *
+ * So 8 universes are 6 on PIO and 2 on the UARTs without DMA. A universe
+ * that cannot get its DMA channels is not added.
+ *
+ * start() refreshes every universe continuously at the refresh rate and
+ * transmit() sends one packet on each. With StartMode::ALIGNED the breaks
+ * of all universes start together. StartMode::STAGGERED spreads the starts
+ * evenly over one refresh period, so the universes' DMA transfers, UART
+ * interrupts and packet boundaries do not all fall at the same time.
+ */
+class DMX512UniverseManager {
+public:
+    enum class StartMode {
+        ALIGNED,    // Packets of all universes start together
+        STAGGERED   // Starts spread over one refresh period
+    };
+
+private:
+    DMX512Transmitter* _universes[DMX_MAX_UNIVERSES];
+    uint _count;
+
+    uint32_t _refresh_rate_hz;
+    StartMode _start_mode;
+    bool _running;
+
+    // Staggered starts: an alarm starts the universes after the first one
+    // at intervals of _start_interval_us
+    volatile alarm_id_t _start_alarm;
+    uint _next_start;
+    bool _start_continuous;
+    uint32_t _start_interval_us;
+
+    // Statistics
+    uint32_t _error_count;
+
+    // Internal methods
+    bool add(DMX512Transmitter* transmitter, bool require_dma);
+    void start_universes(bool continuous);
+    void start_universe(uint universe);
+    void cancel_starts();
+    static int64_t start_alarm_callback(alarm_id_t id, void* user_data);
+
+public:
+    /**
+     * @brief Constructor
+     */
+    DMX512UniverseManager();
+
+    /**
+     * @brief Destructor
+     */
+    ~DMX512UniverseManager();
+
+    /**
+     * @brief Add a universe sent by a PIO state machine
+     * @param gpio_pin GPIO pin for DMX output
+     * @param pio_instance PIO instance to claim a state machine on
+     * @return false if the manager is full or the transmitter cannot start,
+     *         which includes no state machine or two DMA channels being free
+     */
+    bool addPIOUniverse(uint gpio_pin, PIO pio_instance);
+
+    /**
+     * @brief Add a universe sent by a UART
+     * @param gpio_pin GPIO pin for DMX output (a TX pin of the UART)
+     * @param uart_instance UART instance to use
+     * @param use_dma Send the slots by DMA; false to send them from the
+     *                UART interrupt
+     * @return false if the manager is full, the transmitter cannot start,
+     *         or use_dma is set and no DMA channel is free
+     */
+    bool addUARTUniverse(uint gpio_pin, uart_inst_t* uart_instance, bool use_dma = true);
+
+    /**
+     * @brief Stop all universes and release their hardware
+     */
+    void end();
+
+    /**
+     * @brief Set single channel value
+     *
+     * Commits the whole frame unless an update is open, so set many
+     * channels between beginUpdate() and commitUpdate().
+     *
+     * @param universe Universe index (0-based)
+     * @param channel Channel number (1-512)
+     * @param value Channel value (0-255)
+     * @return true if successful
+     */
+    bool setChannel(uint universe, uint16_t channel, uint8_t value);
+
+    /**
+     * @brief Get single channel value
+     * @return Channel value, 0 if the universe or channel does not exist
+     */
+    uint8_t getChannel(uint universe, uint16_t channel) const;
+
+    /**
+     * @brief Set multiple consecutive channels of a universe
+     * @return true if successful
+     */
+    bool setChannelRange(uint universe, uint16_t start_channel, const uint8_t* data, uint16_t length);
+
+    /**
+     * @brief Set all 512 channels of a universe
+     * @return false if the universe does not exist
+     */
+    bool setUniverse(uint universe, const uint8_t* data);
+
+    /**
+     * @brief Set all channels of a universe to 0
+     */
+    void clearUniverse(uint universe);
+
+    /**
+     * @brief Start an update of every universe (see DMX512Transmitter::beginUpdate)
+     */
+    void beginUpdate();
+
+    /**
+     * @brief Commit the update of every universe
+     *
+     * Each universe swaps in its new frame at its own next packet boundary.
+     */
+    void commitUpdate();
+
+    /**
+     * @brief Send one packet on every universe
+     * @return false if a universe is still sending or the manager is running
+     */
+    bool transmit();
+
+    /**
+     * @brief Refresh every universe continuously at the refresh rate
+     *
+     * With staggered starts, a universe that is sending a packet of its
+     * own (through its transmitter) when its start is due is not started
+     * and counts as an error.
+     *
+     * @return false if a universe is still sending or there are none
+     */
+    bool start();
+
+    /**
+     * @brief Stop continuous refresh; packets being sent are finished
+     */
+    void stop();
+
+    /**
+     * @brief Check if the universes are refreshed continuously
+     */
+    bool isRunning() const { return _running; }
+
+    /**
+     * @brief Check if any universe is sending or waiting for its start
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Wait for the packets of every universe to be sent
+     * @param timeout_ms Maximum time to wait (0 = infinite)
+     * @return true if completed within timeout
+     */
+    bool waitForCompletion(uint32_t timeout_ms = 0);
+
+    /**
+     * @brief Set the refresh rate of every universe (default 44 Hz)
+     *
+     * Takes effect at the next start().
+     *
+     * @return false for 0
+     */
+    bool setRefreshRate(uint32_t rate_hz);
+
+    /**
+     * @brief Get the refresh rate
+     */
+    uint32_t getRefreshRate() const { return _refresh_rate_hz; }
+
+    /**
+     * @brief Set how the universes' packets are placed against each other
+     *
+     * Takes effect at the next transmit() or start().
+     */
+    void setStartMode(StartMode mode) { _start_mode = mode; }
+
+    /**
+     * @brief Get the start mode
+     */
+    StartMode getStartMode() const { return _start_mode; }
+
+    /**
+     * @brief Get number of universes
+     */
+    uint getUniverseCount() const { return _count; }
+
+    /**
+     * @brief Get the transmitter of a universe
+     */
+    DMX512Transmitter* getTransmitter(uint universe) const {
+        return universe < _count ? _universes[universe] : nullptr;
+    }
+
+    /**
+     * @brief Get statistics summed over all universes
+     */
+    void getStatistics(uint32_t& frame_count, uint32_t& error_count) const;
+
+    /**
+     * @brief Reset statistics of the manager and all universes
+     */
+    void resetStatistics();
+
+    // Debug methods
+    void printStatus() const;
+};
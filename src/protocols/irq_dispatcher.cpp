@@ -0,0 +1,130 @@
+#include "irq_dispatcher.h"
+#include "hardware/sync.h"
+
+IRQDispatcher::DMAEntry IRQDispatcher::_dma_entries[NUM_DMA_CHANNELS] = {};
+uint32_t IRQDispatcher::_dma_channel_masks[2] = {0, 0};
+IRQDispatcher::UARTEntry IRQDispatcher::_uart_entries[NUM_UARTS] = {};
+
+bool IRQDispatcher::addDMAHandler(uint channel, DMAHandler handler, void* context, int irq_index) {
+    if (channel >= NUM_DMA_CHANNELS || handler == nullptr || _dma_entries[channel].handler != nullptr ||
+        irq_index < DMA_IRQ_ANY || irq_index > 1) {
+        return false;
+    }
+
+    if (irq_index == DMA_IRQ_ANY) {
+        irq_index = (getDMAChannelCount(1) < getDMAChannelCount(0)) ? 1 : 0;
+        // Unless another handler owns that line
+        if (!line_available(DMA_IRQ_0 + irq_index, irq_index ? dma_irq1_handler : dma_irq0_handler)) {
+            irq_index ^= 1;
+        }
+    }
+
+    // The SDK asserts when another handler already owns the line, so that
+    // is refused here; installing our own handler again changes nothing
+    uint irq = DMA_IRQ_0 + irq_index;
+    irq_handler_t line_handler = irq_index ? dma_irq1_handler : dma_irq0_handler;
+    if (!line_available(irq, line_handler)) {
+        return false;
+    }
+
+    uint32_t irq_status = save_and_disable_interrupts();
+    _dma_entries[channel] = {handler, context, (uint8_t)irq_index};
+    _dma_channel_masks[irq_index] |= 1u << channel;
+    restore_interrupts(irq_status);
+
+    irq_set_exclusive_handler(irq, line_handler);
+    dma_irqn_set_channel_enabled(irq_index, channel, true);
+    irq_set_enabled(irq, true);
+    return true;
+}
+
+void IRQDispatcher::removeDMAHandler(uint channel) {
+    if (channel >= NUM_DMA_CHANNELS || _dma_entries[channel].handler == nullptr) {
+        return;
+    }
+
+    uint irq_index = _dma_entries[channel].irq_index;
+    dma_irqn_set_channel_enabled(irq_index, channel, false);
+    dma_irqn_acknowledge_channel(irq_index, channel);
+
+    uint32_t irq_status = save_and_disable_interrupts();
+    _dma_entries[channel] = {nullptr, nullptr, 0};
+    _dma_channel_masks[irq_index] &= ~(1u << channel);
+    restore_interrupts(irq_status);
+
+    if (_dma_channel_masks[irq_index] == 0) {
+        irq_set_enabled(DMA_IRQ_0 + irq_index, false);
+    }
+}
+
+bool IRQDispatcher::line_available(uint irq, irq_handler_t handler) {
+    irq_handler_t installed = irq_get_exclusive_handler(irq);
+    return (installed == nullptr || installed == handler) && !irq_has_shared_handler(irq);
+}
+
+uint IRQDispatcher::getDMAChannelCount(uint irq_index) {
+    return irq_index < 2 ? __builtin_popcount(_dma_channel_masks[irq_index]) : 0;
+}
+
+void IRQDispatcher::dispatch_dma(uint irq_index) {
+    // Only the channels routed to this line can have raised it
+    uint32_t channels = _dma_channel_masks[irq_index];
+    while (channels != 0) {
+        uint channel = __builtin_ctz(channels);
+        channels &= channels - 1;
+
+        if (dma_irqn_get_channel_status(irq_index, channel)) {
+            dma_irqn_acknowledge_channel(irq_index, channel);
+            const DMAEntry& entry = _dma_entries[channel];
+            entry.handler(channel, entry.context);
+        }
+    }
+}
+
+void IRQDispatcher::dma_irq0_handler() {
+    dispatch_dma(0);
+}
+
+void IRQDispatcher::dma_irq1_handler() {
+    dispatch_dma(1);
+}
+
+bool IRQDispatcher::addUARTHandler(uart_inst_t* uart, UARTHandler handler, void* context) {
+    uint index = uart_get_index(uart);
+    uint irq = index ? UART1_IRQ : UART0_IRQ;
+    irq_handler_t line_handler = index ? uart1_irq_handler : uart0_irq_handler;
+    if (handler == nullptr || _uart_entries[index].handler != nullptr || !line_available(irq, line_handler)) {
+        return false;
+    }
+
+    uint32_t irq_status = save_and_disable_interrupts();
+    _uart_entries[index] = {handler, context};
+    restore_interrupts(irq_status);
+
+    irq_set_exclusive_handler(irq, line_handler);
+    irq_set_enabled(irq, true);
+    return true;
+}
+
+void IRQDispatcher::removeUARTHandler(uart_inst_t* uart) {
+    uint index = uart_get_index(uart);
+    irq_set_enabled(index ? UART1_IRQ : UART0_IRQ, false);
+
+    uint32_t irq_status = save_and_disable_interrupts();
+    _uart_entries[index] = {nullptr, nullptr};
+    restore_interrupts(irq_status);
+}
+
+void IRQDispatcher::uart0_irq_handler() {
+    const UARTEntry& entry = _uart_entries[0];
+    if (entry.handler != nullptr) {
+        entry.handler(entry.context);
+    }
+}
+
+void IRQDispatcher::uart1_irq_handler() {
+    const UARTEntry& entry = _uart_entries[1];
+    if (entry.handler != nullptr) {
+        entry.handler(entry.context);
+    }
+}
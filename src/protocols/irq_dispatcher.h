@@ -0,0 +1,113 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/uart.h"
+
+/**
+ * @brief Owner of the DMA and UART interrupts shared by the drivers
+ *
+ * The RP2040 has two DMA interrupt lines for all 12 channels and one
+ * interrupt per UART. Drivers register a handler per DMA channel (or per
+ * UART) here instead of installing exclusive IRQ handlers, so any number
+ * of drivers can use DMA at the same time. The dispatcher installs its own
+ * handlers on DMA_IRQ_0, DMA_IRQ_1 and the UART IRQs and calls the handler
+ * of each completed channel from a channel-indexed table.
+ *
+ * Channels are spread over the two DMA lines (the one with fewer channels
+ * unless a line is asked for), so two busy drivers do not share a handler
+ * invocation.
+ */
+class IRQDispatcher {
+public:
+    /**
+     * @brief DMA completion handler
+     *
+     * Called from the DMA interrupt after the channel's interrupt has been
+     * acknowledged.
+     */
+    typedef void (*DMAHandler)(uint channel, void* context);
+
+    /**
+     * @brief UART interrupt handler
+     */
+    typedef void (*UARTHandler)(void* context);
+
+    static const int DMA_IRQ_ANY = -1;
+
+private:
+    struct DMAEntry {
+        DMAHandler handler;
+        void* context;
+        uint8_t irq_index;      // 0 or 1 (no handler: not registered)
+    };
+
+    struct UARTEntry {
+        UARTHandler handler;
+        void* context;
+    };
+
+    static DMAEntry _dma_entries[NUM_DMA_CHANNELS];
+    static uint32_t _dma_channel_masks[2];     // Channels routed to each DMA line
+    static UARTEntry _uart_entries[NUM_UARTS];
+
+    static void dispatch_dma(uint irq_index);
+    static void dma_irq0_handler();
+    static void dma_irq1_handler();
+    static void uart0_irq_handler();
+    static void uart1_irq_handler();
+
+    // True unless a handler other than ours is installed on the IRQ
+    static bool line_available(uint irq, irq_handler_t handler);
+
+public:
+    /**
+     * @brief Route a DMA channel's completion interrupt to a handler
+     *
+     * Enables the channel's interrupt on the chosen line and the line
+     * itself.
+     *
+     * @param channel Claimed DMA channel
+     * @param handler Called for each completion of the channel
+     * @param context Passed to the handler
+     * @param irq_index 0 or 1 for DMA_IRQ_0 or DMA_IRQ_1, DMA_IRQ_ANY for the less used free one
+     * @return false if the channel already has a handler, or if another
+     *         handler is installed on the line
+     */
+    static bool addDMAHandler(uint channel, DMAHandler handler, void* context, int irq_index = DMA_IRQ_ANY);
+
+    /**
+     * @brief Stop routing a DMA channel's interrupt and disable it
+     */
+    static void removeDMAHandler(uint channel);
+
+    /**
+     * @brief DMA line a channel is routed to (-1 if none)
+     */
+    static int getDMAIrqIndex(uint channel) {
+        return (channel < NUM_DMA_CHANNELS && _dma_entries[channel].handler != nullptr)
+                   ? _dma_entries[channel].irq_index : -1;
+    }
+
+    /**
+     * @brief Number of channels routed to a DMA line
+     */
+    static uint getDMAChannelCount(uint irq_index);
+
+    /**
+     * @brief Route a UART's interrupt to a handler
+     *
+     * Enables the UART's IRQ; the driver still chooses which UART
+     * interrupts are raised with uart_set_irq_enables().
+     *
+     * @return false if the UART already has a handler, or if another
+     *         handler is installed on its IRQ
+     */
+    static bool addUARTHandler(uart_inst_t* uart, UARTHandler handler, void* context);
+
+    /**
+     * @brief Stop routing a UART's interrupt and disable its IRQ
+     */
+    static void removeUARTHandler(uart_inst_t* uart);
+};
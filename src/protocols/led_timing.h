@@ -0,0 +1,153 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include <cstring>
+#include <algorithm>
+
+/**
+ * @brief Bit timing of a one-wire LED chip
+ *
+ * Every bit starts high. A 0 bit stays high for t0h_ns and a 1 bit for
+ * t1h_ns; the line is low for the rest of the bit period. A low period of
+ * reset_us latches the data.
+ */
+struct LEDTiming {
+    const char* name;
+    uint16_t t0h_ns;            // High time of a 0 bit
+    uint16_t t1h_ns;            // High time of a 1 bit
+    uint16_t bit_ns;            // Bit period
+    uint16_t reset_us;          // Low time that latches the data
+};
+
+/**
+ * @brief State machine cycles and clock divider for an LEDTiming
+ *
+ * The bit programs drive the line high for t1 cycles, then the data bit for
+ * t2 cycles, then low for t3 cycles.
+ */
+struct LEDBitCycles {
+    uint8_t t1;
+    uint8_t t2;
+    uint8_t t3;
+    uint16_t div_int;           // Clock divider, 16.8 fixed point
+    uint8_t div_frac;
+
+    // Timing actually produced at the clk_sys it was made for
+    uint32_t t0h_ns;
+    uint32_t t1h_ns;
+    uint32_t bit_ns;
+
+    uint cyclesPerBit() const { return t1 + t2 + t3; }
+};
+
+/**
+ * @brief LED timing profiles
+ *
+ * Drivers take a profile in their Config (or setTiming()) and build their
+ * PIO program and clock divider from it with synthesize() for the clk_sys
+ * they run at, so a chip with other timing needs no new program. Profiles
+ * can be picked by name at runtime with find(), or defined by the
+ * application.
+ */
+class LEDTimings {
+public:
+    // WS2812 / WS2812B at 800 kHz (the timing of the original fixed program)
+    static constexpr LEDTiming WS2812 = {"WS2812", 250, 875, 1250, 280};
+
+    // WS2812B clocked at 1 MHz: within the V5 datasheet high and low times,
+    // 20% shorter frames on chips that accept it
+    static constexpr LEDTiming WS2812_FAST = {"WS2812_FAST", 250, 625, 1000, 280};
+
+    // WS2811 in its 400 kHz (low speed) mode
+    static constexpr LEDTiming WS2811 = {"WS2811", 500, 1200, 2500, 280};
+
+    static constexpr LEDTiming WS2813 = {"WS2813", 375, 875, 1250, 300};
+    static constexpr LEDTiming WS2815 = {"WS2815", 300, 900, 1250, 280};
+    static constexpr LEDTiming SK6812 = {"SK6812", 300, 600, 1250, 80};
+    static constexpr LEDTiming TM1814 = {"TM1814", 360, 720, 1250, 200};
+    static constexpr LEDTiming UCS1903 = {"UCS1903", 250, 1000, 1250, 50};
+
+    static constexpr const LEDTiming* PROFILES[] = {
+        &WS2812, &WS2812_FAST, &WS2811, &WS2813, &WS2815, &SK6812, &TM1814, &UCS1903
+    };
+    static constexpr uint PROFILE_COUNT = sizeof(PROFILES) / sizeof(PROFILES[0]);
+
+    /**
+     * @brief Look up a built-in profile by name
+     * @return nullptr if there is none
+     */
+    static const LEDTiming* find(const char* name) {
+        for (const LEDTiming* timing : PROFILES) {
+            if (strcmp(timing->name, name) == 0) {
+                return timing;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Work out state machine cycles and a clock divider for a timing
+     *
+     * Tries every cycle count per bit the program delays allow and keeps
+     * the one with the smallest worst error on T0H, T1H and the bit period
+     * (the fewest cycles on a tie), taking the 1/256 divider steps into
+     * account.
+     *
+     * @param timing Bit timing
+     * @param clk_sys_hz System clock the state machine runs from
+     * @param max_cycles Most cycles any of t1, t2 and t3 can take
+     * @param min_t3 Fewest cycles t3 can take
+     * @param out Result
+     * @return false if the timing cannot be produced
+     */
+    static bool synthesize(const LEDTiming& timing, uint32_t clk_sys_hz, uint max_cycles, uint min_t3,
+                           LEDBitCycles& out) {
+        if (timing.t0h_ns == 0 || timing.t1h_ns <= timing.t0h_ns || timing.bit_ns <= timing.t1h_ns) {
+            return false;
+        }
+
+        bool found = false;
+        uint64_t best_error = UINT64_MAX;
+        for (uint n = 3; n <= max_cycles * 3; n++) {
+            // Divider for n cycles per bit, in 1/256 steps
+            uint64_t div256 = ((uint64_t)clk_sys_hz * timing.bit_ns * 256 + n * 500000000ull) / (n * 1000000000ull);
+            if (div256 < 256 || div256 >= (65536ull << 8)) {
+                continue;
+            }
+            auto cycles_for = [&](uint32_t ns) {
+                return (uint)(((uint64_t)ns * clk_sys_hz * 256 + div256 * 500000000ull) / (div256 * 1000000000ull));
+            };
+            auto ns_for = [&](uint cycles) {
+                return (uint32_t)((cycles * div256 * 1000000000ull + clk_sys_hz * 128ull) / (clk_sys_hz * 256ull));
+            };
+
+            uint t1 = cycles_for(timing.t0h_ns);
+            uint t12 = cycles_for(timing.t1h_ns);
+            if (t1 < 1 || t1 > max_cycles || t12 <= t1 || t12 - t1 > max_cycles || n < t12 + min_t3 ||
+                n - t12 > max_cycles) {
+                continue;
+            }
+
+            uint32_t t0h = ns_for(t1);
+            uint32_t t1h = ns_for(t12);
+            uint32_t bit = ns_for(n);
+            uint64_t error = 0;
+            error = std::max<uint64_t>(error, t0h > timing.t0h_ns ? t0h - timing.t0h_ns : timing.t0h_ns - t0h);
+            error = std::max<uint64_t>(error, t1h > timing.t1h_ns ? t1h - timing.t1h_ns : timing.t1h_ns - t1h);
+            error = std::max<uint64_t>(error, bit > timing.bit_ns ? bit - timing.bit_ns : timing.bit_ns - bit);
+            if (error < best_error) {
+                best_error = error;
+                found = true;
+                out.t1 = (uint8_t)t1;
+                out.t2 = (uint8_t)(t12 - t1);
+                out.t3 = (uint8_t)(n - t12);
+                out.div_int = (uint16_t)(div256 >> 8);
+                out.div_frac = (uint8_t)(div256 & 0xFF);
+                out.t0h_ns = t0h;
+                out.t1h_ns = t1h;
+                out.bit_ns = bit;
+            }
+        }
+        return found;
+    }
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+/**
+ * @brief Wiring of an LED panel
+ *
+ * Describes how the pixels of a width x height display are chained. The
+ * display can be built from several identical modules, which are chained
+ * row by row starting at the top left module. Within a module the pixels
+ * run along rows (or columns) starting at its top left pixel.
+ */
+struct PixelLayout {
+    uint16_t width;             // Display width in pixels
+    uint16_t height;            // Display height in pixels
+    uint16_t tile_width;        // Module width in pixels (0 = one module)
+    uint16_t tile_height;       // Module height in pixels (0 = one module)
+    uint8_t rotation;           // Quarter turns clockwise of the panel (0-3)
+    bool column_major;          // Pixels run down columns instead of along rows
+    bool serpentine;            // Every other row (or column) runs backwards
+    bool tile_serpentine;       // Every other row of modules runs backwards
+};
+
+/**
+ * @brief Pixel mapping tables
+ *
+ * Compiles a PixelLayout into a table that the output stage uses to send
+ * pixels in wiring order (see WS2812Driver::setPixelMap()). For each pixel
+ * on the wire the table holds the index of the pixel it shows in row-major
+ * display order, so code can draw in XY space with y * width + x and the
+ * mapping costs nothing per pixel drawn.
+ *
+ * Fixed layouts are compiled into a constant table:
+ *
+ *     constexpr PixelLayout layout = {32, 8, 8, 8, 0, false, true, false};
+ *     static_assert(PixelMap::isValid(layout), "bad layout");
+ *     static constexpr auto map = PixelMap::make<32 * 8>(layout);
+ *     driver.setPixelMap(map.index);
+ *
+ * build() fills a table at runtime for layouts only known then.
+ */
+class PixelMap {
+public:
+    template <uint N>
+    struct Table {
+        uint16_t index[N];
+    };
+
+    /**
+     * @brief Check that the modules tile the display exactly
+     */
+    static constexpr bool isValid(const PixelLayout& layout) {
+        uint panel_width = (layout.rotation & 1) ? layout.height : layout.width;
+        uint panel_height = (layout.rotation & 1) ? layout.width : layout.height;
+        uint tile_width = layout.tile_width ? layout.tile_width : panel_width;
+        uint tile_height = layout.tile_height ? layout.tile_height : panel_height;
+        return layout.width > 0 && layout.height > 0 && layout.rotation < 4 &&
+               (uint)layout.width * layout.height <= 0x10000 &&
+               panel_width % tile_width == 0 && panel_height % tile_height == 0;
+    }
+
+    /**
+     * @brief Position on the wire of a display pixel
+     * @param layout Valid layout
+     * @param x Column, from the left
+     * @param y Row, from the top
+     */
+    static constexpr uint wireIndex(const PixelLayout& layout, uint x, uint y) {
+        // Display coordinates to panel coordinates
+        uint panel_width = (layout.rotation & 1) ? layout.height : layout.width;
+        uint panel_height = (layout.rotation & 1) ? layout.width : layout.height;
+        uint px = x;
+        uint py = y;
+        switch (layout.rotation) {
+            case 1:
+                px = layout.height - 1 - y;
+                py = x;
+                break;
+            case 2:
+                px = layout.width - 1 - x;
+                py = layout.height - 1 - y;
+                break;
+            case 3:
+                px = y;
+                py = layout.width - 1 - x;
+                break;
+            default:
+                break;
+        }
+
+        // Module and position within it
+        uint tile_width = layout.tile_width ? layout.tile_width : panel_width;
+        uint tile_height = layout.tile_height ? layout.tile_height : panel_height;
+        uint tiles_x = panel_width / tile_width;
+        uint tile_x = px / tile_width;
+        uint tile_y = py / tile_height;
+        if (layout.tile_serpentine && (tile_y & 1)) {
+            tile_x = tiles_x - 1 - tile_x;
+        }
+        uint tile = tile_y * tiles_x + tile_x;
+
+        uint local_x = px % tile_width;
+        uint local_y = py % tile_height;
+        uint line = layout.column_major ? local_x : local_y;
+        uint offset = layout.column_major ? local_y : local_x;
+        uint line_length = layout.column_major ? tile_height : tile_width;
+        if (layout.serpentine && (line & 1)) {
+            offset = line_length - 1 - offset;
+        }
+
+        return tile * tile_width * tile_height + line * line_length + offset;
+    }
+
+    /**
+     * @brief Compile a layout into a constant table
+     *
+     * Entries past the display pass straight through.
+     *
+     * @tparam N Table size, at least width * height
+     * @param layout Valid layout (check with isValid())
+     */
+    template <uint N>
+    static constexpr Table<N> make(const PixelLayout& layout) {
+        Table<N> table{};
+        for (uint i = 0; i < N; i++) {
+            table.index[i] = (uint16_t)i;
+        }
+        for (uint y = 0; y < layout.height; y++) {
+            for (uint x = 0; x < layout.width; x++) {
+                uint wire = wireIndex(layout, x, y);
+                if (wire < N) {
+                    table.index[wire] = (uint16_t)(y * layout.width + x);
+                }
+            }
+        }
+        return table;
+    }
+
+    /**
+     * @brief Build a table at runtime
+     *
+     * Entries past the display pass straight through.
+     *
+     * @param layout Panel layout
+     * @param table Output, count entries
+     * @param count Table size, at least width * height
+     * @return false if the layout is invalid or does not fit the table
+     */
+    static bool build(const PixelLayout& layout, uint16_t* table, uint count) {
+        if (table == nullptr || !isValid(layout) || count > 0x10000 ||
+            (uint)layout.width * layout.height > count) {
+            return false;
+        }
+        for (uint i = 0; i < count; i++) {
+            table[i] = (uint16_t)i;
+        }
+        for (uint y = 0; y < layout.height; y++) {
+            for (uint x = 0; x < layout.width; x++) {
+                table[wireIndex(layout, x, y)] = (uint16_t)(y * layout.width + x);
+            }
+        }
+        return true;
+    }
+};
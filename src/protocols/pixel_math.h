@@ -0,0 +1,147 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Pixel math on whole packed pixel words
+ *
+ * The Cortex-M0+ has no SIMD instructions, but a 32-bit word holds four
+ * 8-bit channels and its single-cycle multiplier can scale two of them at
+ * once when they are spread into 16-bit lanes (mask 0x00FF00FF). The
+ * functions below work that way on native color values, so a pixel costs
+ * two multiplies and no divides or table lookups, whatever its format.
+ *
+ * They also take 64-bit words holding four 16-bit channels (16-bit pixel
+ * mode), with 32-bit lanes. Channels never carry into each other, so unused
+ * channel bits stay 0 and the byte order within a word does not matter.
+ */
+class PixelMath {
+public:
+    /**
+     * @brief Scale every channel by scale / 256 (nscale8)
+     *
+     * Uses scale + 1, so 255 leaves the color unchanged and 0 makes it black.
+     *
+     * @param color Native color value
+     * @param scale Scale factor (255 = unchanged)
+     */
+    template <typename T>
+    static constexpr T scale8(T color, uint8_t scale) {
+        constexpr uint bits = channel_bits<T>();
+        constexpr T lanes = lane_mask<T>();
+        T factor = (T)scale + 1;
+        T even = ((color & lanes) * factor >> 8) & lanes;
+        T odd = (((color >> bits) & lanes) * factor << (bits - 8)) & (lanes << bits);
+        return even | odd;
+    }
+
+    /**
+     * @brief Fade every channel towards black
+     * @param color Native color value
+     * @param amount Fraction removed (0 = unchanged, 255 = black)
+     */
+    template <typename T>
+    static constexpr T fadeToBlack(T color, uint8_t amount) {
+        return scale8(color, (uint8_t)(255 - amount));
+    }
+
+    /**
+     * @brief Add two colors, clamping every channel at its maximum (qadd8)
+     */
+    template <typename T>
+    static constexpr T addSaturate(T a, T b) {
+        constexpr uint bits = channel_bits<T>();
+        constexpr T high = high_mask<T>();
+
+        // Add without the top bit of each channel so nothing carries into
+        // the next one, then work out the top bit and its carry
+        T sum = (a & ~high) + (b & ~high);
+        T carry = ((a & b) | ((a | b) & sum)) & high;
+        sum ^= (a ^ b) & high;
+
+        // Saturate channels that carried: 0x80 - 0x01 | 0x80 = 0xFF
+        return sum | (carry - (carry >> (bits - 1))) | carry;
+    }
+
+    /**
+     * @brief Blend two colors (lerp8)
+     * @param a Color at amount 0
+     * @param b Color at amount 255
+     * @param amount Blend position
+     */
+    template <typename T>
+    static constexpr T lerp8(T a, T b, uint8_t amount) {
+        constexpr uint bits = channel_bits<T>();
+        constexpr T lanes = lane_mask<T>();
+
+        // Weights out of 256 so both ends are exact
+        T weight_b = (T)amount + (amount >> 7);
+        T weight_a = 256 - weight_b;
+        T even = (((a & lanes) * weight_a + (b & lanes) * weight_b) >> 8) & lanes;
+        T odd = ((((a >> bits) & lanes) * weight_a + ((b >> bits) & lanes) * weight_b) << (bits - 8)) &
+                (lanes << bits);
+        return even | odd;
+    }
+
+    /**
+     * @brief Scale a run of words
+     *
+     * The brightness kernel of the output stage.
+     *
+     * @param words Native color values
+     * @param count Number of words
+     * @param scale Scale factor (255 = unchanged)
+     * @param out Scaled values, may be the same as words
+     */
+    static void scaleWords(const uint32_t* words, uint count, uint8_t scale, uint32_t* out) {
+        for (uint i = 0; i < count; i++) {
+            out[i] = scale8(words[i], scale);
+        }
+    }
+
+    /**
+     * @brief Scale a run of channel bytes a word at a time
+     *
+     * For packed pixels, where words do not line up with pixels. Scaling
+     * treats every channel alike, so that does not matter.
+     *
+     * @param bytes Channel values, word aligned
+     * @param length Number of bytes
+     * @param scale Scale factor (255 = unchanged)
+     * @param out Scaled values, word aligned, may be the same as bytes
+     */
+    static void scaleBytes(const uint8_t* bytes, uint length, uint8_t scale, uint8_t* out) {
+        uint words = length / 4;
+        scaleWords((const uint32_t*)bytes, words, scale, (uint32_t*)out);
+
+        uint tail = length - words * 4;
+        if (tail > 0) {
+            uint32_t word = 0;
+            memcpy(&word, bytes + words * 4, tail);
+            word = scale8(word, scale);
+            memcpy(out + words * 4, &word, tail);
+        }
+    }
+
+private:
+    template <typename T>
+    static constexpr uint channel_bits() {
+        static_assert(std::is_same<T, uint32_t>::value || std::is_same<T, uint64_t>::value,
+                      "PixelMath works on uint32_t or uint64_t words");
+        return sizeof(T) * 2;
+    }
+
+    // Every other channel: 0x00FF00FF or 0x0000FFFF0000FFFF
+    template <typename T>
+    static constexpr T lane_mask() {
+        return (T)~(T)0 / (((T)1 << (channel_bits<T>() * 2)) - 1) * (((T)1 << channel_bits<T>()) - 1);
+    }
+
+    // Top bit of every channel: 0x80808080 or 0x8000800080008000
+    template <typename T>
+    static constexpr T high_mask() {
+        return (T)~(T)0 / (((T)1 << channel_bits<T>()) - 1) << (channel_bits<T>() - 1);
+    }
+};
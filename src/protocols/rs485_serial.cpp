@@ -1,14 +1,11 @@
 #include "rs485_serial.h"
+#include "irq_dispatcher.h"
 #include <cstring>
 #include <cstdio>
 #include <cstdarg>
 
-// Static instance for interrupt handling
-RS485Serial* RS485Serial::_instance = nullptr;
-
 RS485Serial::RS485Serial(const Config& config) 
     : _config(config),
-      _uart_irq(config.uart_instance == uart0 ? UART0_IRQ : UART1_IRQ),
       _initialized(false),
       _tx_buffer(nullptr),
       _tx_buffer_size(RS485_MAX_FRAME_SIZE),
@@ -27,8 +24,7 @@ RS485Serial::RS485Serial(const Config& config)
       _pre_transmission_delay_us(RS485_TURNAROUND_TIME_US),
       _post_transmission_delay_us(RS485_TURNAROUND_TIME_US),
       _auto_direction_control(true) {
-    
-    _instance = this;
+
     memset(_preamble_data, 0, sizeof(_preamble_data));
     memset(_postamble_data, 0, sizeof(_postamble_data));
 }
@@ -37,10 +33,6 @@ RS485Serial::~RS485Serial() {
     if (_initialized) {
         end();
     }
-    
-    if (_instance == this) {
-        _instance = nullptr;
-    }
 }
 
 RS485Serial::ReturnCode RS485Serial::begin() {
@@ -53,15 +45,23 @@ RS485Serial::ReturnCode RS485Serial::begin() {
         return ReturnCode::ERROR_INVALID_PIN;
     }
 
+    // The UART interrupt is routed to this driver; another driver may
+    // already use the UART
+    if (!IRQDispatcher::addUARTHandler(_config.uart_instance, uart_irq_callback, this)) {
+        return ReturnCode::ERROR_UART_INIT_FAILED;
+    }
+
     // Allocate transmission buffer
     _tx_buffer = (uint8_t*)malloc(_tx_buffer_size);
     if (_tx_buffer == nullptr) {
+        IRQDispatcher::removeUARTHandler(_config.uart_instance);
         return ReturnCode::ERROR_INVALID_PARAMETERS;
     }
 
     // Initialize UART
     uint actual_baud = uart_init(_config.uart_instance, _config.baud_rate);
     if (actual_baud == 0) {
+        IRQDispatcher::removeUARTHandler(_config.uart_instance);
         free(_tx_buffer);
         _tx_buffer = nullptr;
         return ReturnCode::ERROR_UART_INIT_FAILED;
@@ -69,6 +69,7 @@ RS485Serial::ReturnCode RS485Serial::begin() {
 
     // Configure UART
     if (!configure_uart()) {
+        IRQDispatcher::removeUARTHandler(_config.uart_instance);
         uart_deinit(_config.uart_instance);
         free(_tx_buffer);
         _tx_buffer = nullptr;
@@ -90,10 +91,7 @@ RS485Serial::ReturnCode RS485Serial::begin() {
         _dma_available = init_dma();
     }
 
-    // Set up UART interrupt
-    irq_set_exclusive_handler(_uart_irq, uart_irq_handler);
-    irq_set_enabled(_uart_irq, true);
-    uart_set_irq_enables(_config.uart_instance, false, true);  // TX interrupt only
+    uart_set_irq_enables(_config.uart_instance, false, false);  // TX interrupt is enabled per frame when DMA is not used
 
     _initialized = true;
     _status = Status::IDLE;
@@ -113,8 +111,8 @@ void RS485Serial::end() {
     cleanup_dma();
     
     // Disable interrupts
-    irq_set_enabled(_uart_irq, false);
     uart_set_irq_enables(_config.uart_instance, false, false);
+    IRQDispatcher::removeUARTHandler(_config.uart_instance);
 
     // Deinitialize UART
     uart_deinit(_config.uart_instance);
@@ -157,11 +155,14 @@ bool RS485Serial::init_dma() {
     channel_config_set_read_increment(&config, true);
     channel_config_set_write_increment(&config, false);
     channel_config_set_dreq(&config, uart_get_dreq(_config.uart_instance, true));
+    dma_channel_set_config(_dma_channel, &config, false);
 
     // Set up DMA interrupt
-    dma_channel_set_irq0_enabled(_dma_channel, true);
-    irq_set_exclusive_handler(DMA_IRQ_0, dma_irq_handler);
-    irq_set_enabled(DMA_IRQ_0, true);
+    if (!IRQDispatcher::addDMAHandler(_dma_channel, dma_complete_callback, this)) {
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+        return false;
+    }
 
     return true;
 }
@@ -169,7 +170,7 @@ bool RS485Serial::init_dma() {
 void RS485Serial::cleanup_dma() {
     if (_dma_channel >= 0) {
         dma_channel_abort(_dma_channel);
-        dma_channel_set_irq0_enabled(_dma_channel, false);
+        IRQDispatcher::removeDMAHandler(_dma_channel);
         dma_channel_unclaim(_dma_channel);
         _dma_channel = -1;
     }
@@ -248,9 +249,10 @@ RS485Serial::ReturnCode RS485Serial::sendFrame(const uint8_t* data, uint16_t len
 
     if (_dma_available) {
         // Use DMA for transmission
+        dma_channel_config config = dma_get_channel_config(_dma_channel);
         dma_channel_configure(_dma_channel,
-                             dma_channel_get_default_config(_dma_channel),
-                             &_config.uart_instance->dr,
+                             &config,
+                             &uart_get_hw(_config.uart_instance)->dr,
                              _tx_buffer,
                              total_length,
                              true);  // Start transfer
@@ -446,10 +448,8 @@ void RS485Serial::setFrameFormat(const uint8_t* preamble_data, uint8_t preamble_
     _custom_frame_format = (_preamble_length > 0 || _postamble_length > 0);
 }
 
-void RS485Serial::uart_irq_handler() {
-    if (_instance != nullptr) {
-        _instance->handle_uart_interrupt();
-    }
+void RS485Serial::uart_irq_callback(void* user_data) {
+    static_cast<RS485Serial*>(user_data)->handle_uart_interrupt();
 }
 
 void RS485Serial::handle_uart_interrupt() {
@@ -462,9 +462,7 @@ void RS485Serial::handle_uart_interrupt() {
             uart_set_irq_enables(_config.uart_instance, false, false);
             
             // Wait for UART to finish transmitting
-            while (!uart_is_writable(_config.uart_instance)) {
-                tight_loop_contents();
-            }
+            uart_tx_wait_blocking(_config.uart_instance);
 
             // Disable transmitter
             if (_auto_direction_control) {
@@ -479,32 +477,25 @@ void RS485Serial::handle_uart_interrupt() {
     }
 }
 
-void RS485Serial::dma_irq_handler() {
-    if (_instance != nullptr) {
-        _instance->handle_dma_complete();
-    }
+void RS485Serial::dma_complete_callback(uint channel, void* user_data) {
+    (void)channel;
+    static_cast<RS485Serial*>(user_data)->handle_dma_complete();
 }
 
 void RS485Serial::handle_dma_complete() {
-    if (dma_channel_get_irq0_status(_dma_channel)) {
-        dma_channel_acknowledge_irq0(_dma_channel);
-        
-        // Wait for UART to finish transmitting last byte
-        while (!uart_is_writable(_config.uart_instance)) {
-            tight_loop_contents();
-        }
-
-        // Disable transmitter
-        if (_auto_direction_control) {
-            disable_transmitter();
-        }
+    // Wait for UART to finish transmitting last byte
+    uart_tx_wait_blocking(_config.uart_instance);
 
-        _status = Status::IDLE;
-        _frames_sent++;
-        _bytes_sent += _tx_bytes_remaining;  // DMA transmitted all bytes
-        _tx_bytes_remaining = 0;
-        _last_transmission_time_us = absolute_time_diff_us(_transmission_start, get_absolute_time());
+    // Disable transmitter
+    if (_auto_direction_control) {
+        disable_transmitter();
     }
+
+    _status = Status::IDLE;
+    _frames_sent++;
+    _bytes_sent += _tx_bytes_remaining;  // DMA transmitted all bytes
+    _tx_bytes_remaining = 0;
+    _last_transmission_time_us = absolute_time_diff_us(_transmission_start, get_absolute_time());
 }
 
 void RS485Serial::printStatus() const {
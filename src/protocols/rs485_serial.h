@@ -46,7 +46,6 @@ public:
 private:
     // Configuration
     Config _config;
-    uint _uart_irq;
     bool _initialized;
     
     // Transmission buffer and state
@@ -79,10 +78,9 @@ private:
     void handle_dma_complete();
     void calculate_transmission_time(uint16_t data_length);
     
-    // Static interrupt handlers
-    static void uart_irq_handler();
-    static void dma_irq_handler();
-    static RS485Serial* _instance;
+    // Interrupt handlers (see IRQDispatcher)
+    static void uart_irq_callback(void* user_data);
+    static void dma_complete_callback(uint channel, void* user_data);
 
 public:
     /**
@@ -137,6 +135,11 @@ public:
      */
     bool isBusy() const { return _status == Status::TRANSMITTING; }
 
+    /**
+     * @brief Check if frames are sent by DMA
+     */
+    bool isDMAEnabled() const { return _dma_available; }
+
     /**
      * @brief Wait for current transmission to complete
      * @param timeout_ms Maximum time to wait in milliseconds (0 = infinite)
@@ -1,47 +1,101 @@
 #include "ws2812_driver.h"
+#include "irq_dispatcher.h"
+#include "hardware/sync.h"
 #include <cstring>
 #include <cstdio>
 #include <cmath>
 
-// Static instance for DMA interrupt handling
-WS2812Driver* WS2812Driver::_instance = nullptr;
+// Each bit program delay is at most 15 cycles next to the side-set bit
+static const uint WS2812_MAX_PHASE_CYCLES = 16;
+static const uint WS2812_BITS_PER_WORD = 24;       // Autopull threshold
+static const uint WS2812_BITS_PER_RGBW_WORD = 32;  // Autopull threshold for RGBW
+static const uint WS2812_BITS_PER_BYTE = 8;        // Autopull threshold with packed pixels
+static const uint WS2812_MAP_BLOCK = 32;           // Pixels gathered per block through a pixel map
 
-// WS2812 PIO program (optimized for RP2040)
-const uint16_t WS2812Driver::ws2812_program_instructions[] = {
-    0x6221, // out    x, 1            side 0 [2] 
-    0x1123, // jmp    !x, 3           side 1 [1] 
-    0x1400, // jmp    0               side 1 [4] 
-    0xa442, // nop                    side 0 [4] 
+// Dither thresholds added to the 8-bit fraction, in bit-reversed order so
+// that any run of consecutive frames spreads evenly over the cycle. They
+// are centered in their 1/8 steps, so the average rounds to nearest.
+static const uint16_t WS2812_DITHER_THRESHOLDS[WS2812_DITHER_PHASES] = {
+    16, 144, 80, 208, 48, 176, 112, 240
 };
 
-const struct pio_program WS2812Driver::ws2812_program = {
-    .instructions = ws2812_program_instructions,
-    .length = 4,
-    .origin = -1
-};
+#if WS2812_CHANNEL_BITS != 8 && WS2812_CHANNEL_BITS != 16
+#error "WS2812_CHANNEL_BITS must be 8 or 16"
+#endif
+
+// 16-bit channel value as an 8.8 level: x - x / 256 maps 0xFFFF to 0xFF00
+// and an 8-bit value v stored as v * 257 exactly to v << 8
+static inline uint32_t channel_level(uint32_t value) {
+    return value - (value >> 8);
+}
+
+static inline uint8_t narrow_channel(uint16_t value) {
+    return (uint8_t)((channel_level(value) + 128) >> 8);
+}
+
+static inline uint16_t widen_channel(uint8_t value) {
+    return (uint16_t)(value * 257);
+}
 
 WS2812Driver::WS2812Driver(const Config& config) 
     : _config(config),
       _pio_program_offset(0),
+      _timing(config.timing != nullptr ? *config.timing : LEDTimings::WS2812),
+      _bit_cycles{},
+      _program_instructions{},
+      _program{_program_instructions, 4, -1},
       _pixel_buffer(nullptr),
+      _buffers{},
+      _num_buffers(0),
+      _back_index(0),
+      _front_index(-1),
+      _pending_index(-1),
+      _dirty_end(0),
+      _frame_length{},
       _status(Status::IDLE),
       _initialized(false),
+      _packed(false),
+      _extract_white(false),
+      _brightness(255),
+      _gamma(1.0f),
+      _output_identity(WS2812_CHANNEL_BITS == 8),
+      _output_linear(WS2812_CHANNEL_BITS == 8),
+      _pixel_map(nullptr),
+      _dithering(false),
+      _dither_frame(0),
+      _encoded_block(nullptr),
+      _wire_buffers{},
+      _continuous(false),
+      _refresh_block(nullptr),
+      _refresh_index(0),
+      _stream_block(nullptr),
+      _stream_chunk_pixels(0),
+      _stream_chunks(0),
+      _stream_sent(0),
+      _stream_producer(nullptr),
+      _stream_user_data(nullptr),
+      _stream_encode(false),
+      _stream_dither_frame(0),
       _dma_channel(-1),
+      _stream_dma_channel(-1),
       _dma_available(false),
+      _latch_alarm(0),
       _update_count(0),
-      _error_count(0) {
-    
-    _instance = this;
+      _error_count(0),
+      _hold_start(false),
+      _armed(false) {
+
+    for (uint i = 0; i < 256; i++) {
+        _gamma_table[i] = (uint16_t)(i << 8);
+        _output_table[i] = (uint8_t)i;
+        _output_table16[i] = (uint16_t)(i << 8);
+    }
 }
 
 WS2812Driver::~WS2812Driver() {
     if (_initialized) {
         end();
     }
-    
-    if (_instance == this) {
-        _instance = nullptr;
-    }
 }
 
 bool WS2812Driver::begin() {
@@ -50,23 +104,66 @@ bool WS2812Driver::begin() {
     }
 
     // Validate configuration
-    if (_config.num_pixels == 0 || _config.num_pixels > MAX_LED_COUNT) {
+    if (_config.num_pixels == 0) {
         return false;
     }
+    _extract_white = _config.extract_white && _config.format == ColorFormat::RGBW;
 
-    // Allocate pixel buffer
-    size_t buffer_size = _config.num_pixels * sizeof(uint32_t);
-    _pixel_buffer = (uint32_t*)malloc(buffer_size);
-    if (_pixel_buffer == nullptr) {
+    // Streaming mode keeps no frame buffers, so the strip length is not
+    // limited by RAM
+    if (_config.stream_chunk_pixels > 0) {
+        return init_stream();
+    }
+
+    if (_config.num_pixels > MAX_LED_COUNT) {
         return false;
     }
 
-    // Initialize buffer to all black
-    memset(_pixel_buffer, 0, buffer_size);
+    _num_buffers = (_config.num_buffers == 0) ? 1 : _config.num_buffers;
+    if (_num_buffers > WS2812_MAX_FRAME_BUFFERS) {
+        return false;
+    }
+
+    // Packed pixels are the bytes sent on the wire, so 16-bit channels
+    // cannot be packed. RGBW keeps 4 bytes per pixel.
+    if (_config.packed_pixels && WS2812_CHANNEL_BITS != 8) {
+        return false;
+    }
+    _packed = _config.packed_pixels && _config.format != ColorFormat::RGBW;
+
+    // Allocate all frame buffers in one block
+    size_t buffer_size = _config.num_pixels * pixel_bytes();
+    uint8_t* block = (uint8_t*)malloc(buffer_size * _num_buffers);
+    if (block == nullptr) {
+        return false;
+    }
+    for (uint i = 0; i < _num_buffers; i++) {
+        _buffers[i] = (Pixel*)(block + i * buffer_size);
+    }
+    // Initialize buffers to all black
+    memset(_buffers[0], 0, buffer_size * _num_buffers);
+
+    // 16-bit pixels, or brightness, gamma or a pixel map set before begin()
+    if ((!_output_identity || _pixel_map != nullptr) && !alloc_encoded_block()) {
+        free(_buffers[0]);
+        memset(_buffers, 0, sizeof(_buffers));
+        return false;
+    }
+
+    _back_index = 0;
+    _front_index = -1;
+    _pending_index = -1;
+    _pixel_buffer = _buffers[0];
+
+    // The LEDs may show anything, so the first frame is sent in full
+    _dirty_end = _config.num_pixels;
 
     // Initialize PIO
     if (!init_pio()) {
-        free(_pixel_buffer);
+        free(_buffers[0]);
+        free(_encoded_block);
+        memset(_buffers, 0, sizeof(_buffers));
+        _encoded_block = nullptr;
         _pixel_buffer = nullptr;
         return false;
     }
@@ -88,42 +185,77 @@ void WS2812Driver::end() {
     }
 
     // Wait for any ongoing updates
+    _continuous = false;
     waitForCompletion(1000);
+    if (_latch_alarm > 0) {
+        cancel_alarm(_latch_alarm);
+        _latch_alarm = 0;
+    }
 
     // Cleanup resources
     cleanup_dma();
     cleanup_pio();
 
-    if (_pixel_buffer != nullptr) {
-        free(_pixel_buffer);
+    if (_buffers[0] != nullptr) {
+        free(_buffers[0]);
+        memset(_buffers, 0, sizeof(_buffers));
         _pixel_buffer = nullptr;
     }
+    free(_encoded_block);
+    free(_refresh_block);
+    free(_stream_block);
+    _encoded_block = nullptr;
+    _refresh_block = nullptr;
+    _stream_block = nullptr;
+    memset(_wire_buffers, 0, sizeof(_wire_buffers));
 
     _initialized = false;
     _status = Status::IDLE;
 }
 
 bool WS2812Driver::init_pio() {
-    // Load PIO program
-    _pio_program_offset = pio_add_program(_config.pio_instance, &ws2812_program);
-    
-    // Get state machine
+    // Build the program for the bit timing at the current clk_sys:
+    //   out x, 1   side 0 [T3 - 1]   ; low for T3, shifting in the next bit
+    //   jmp !x, 3  side 1 [T1 - 1]   ; high for T1
+    //   jmp 0      side 1 [T2 - 1]   ; 1: high for T2
+    //   nop        side 0 [T2 - 1]   ; 0: low for T2
+    if (!LEDTimings::synthesize(_timing, clock_get_hz(clk_sys), WS2812_MAX_PHASE_CYCLES, 1, _bit_cycles)) {
+        return false;
+    }
+    _program_instructions[0] = (uint16_t)(pio_encode_out(pio_x, 1) | pio_encode_sideset(1, 0) |
+                                          pio_encode_delay(_bit_cycles.t3 - 1));
+    _program_instructions[1] = (uint16_t)(pio_encode_jmp_not_x(3) | pio_encode_sideset(1, 1) |
+                                          pio_encode_delay(_bit_cycles.t1 - 1));
+    _program_instructions[2] = (uint16_t)(pio_encode_jmp(0) | pio_encode_sideset(1, 1) |
+                                          pio_encode_delay(_bit_cycles.t2 - 1));
+    _program_instructions[3] = (uint16_t)(pio_encode_nop() | pio_encode_sideset(1, 0) |
+                                          pio_encode_delay(_bit_cycles.t2 - 1));
+
+    // Each driver needs a state machine of its own, and its program has to
+    // fit next to those of the other drivers on the same PIO
     uint sm = _config.pio_sm;
-    if (!pio_sm_is_claimed(_config.pio_instance, sm)) {
-        pio_sm_claim(_config.pio_instance, sm);
+    if (pio_sm_is_claimed(_config.pio_instance, sm) || !pio_can_add_program(_config.pio_instance, &_program)) {
+        return false;
     }
+    pio_sm_claim(_config.pio_instance, sm);
+
+    // Load PIO program
+    _pio_program_offset = pio_add_program(_config.pio_instance, &_program);
 
     // Configure state machine
     pio_sm_config config = pio_get_default_sm_config();
-    sm_config_set_wrap(&config, _pio_program_offset, _pio_program_offset + ws2812_program.length - 1);
+    sm_config_set_wrap(&config, _pio_program_offset, _pio_program_offset + _program.length - 1);
+    sm_config_set_sideset(&config, 1, false, false);
     sm_config_set_sideset_pins(&config, _config.gpio_pin);
     
-    // Set output shift direction and auto-pull
-    sm_config_set_out_shift(&config, false, true, 24);  // 24-bit color data
+    // Set output shift direction and auto-pull: 24-bit color data (32-bit
+    // for RGBW), or one byte per FIFO entry with packed pixels. Byte writes
+    // to the FIFO are replicated across the word, so the byte is in the top
+    // bits either way.
+    sm_config_set_out_shift(&config, false, true, bits_per_entry());
     
-    // Set clock divider for WS2812 timing (800 kHz)
-    float div = (float)clock_get_hz(clk_sys) / (800000 * 4);  // 4 cycles per bit
-    sm_config_set_clkdiv(&config, div);
+    // Set clock divider for the bit timing
+    sm_config_set_clkdiv_int_frac(&config, _bit_cycles.div_int, _bit_cycles.div_frac);
 
     // Configure GPIO
     pio_gpio_init(_config.pio_instance, _config.gpio_pin);
@@ -146,7 +278,7 @@ void WS2812Driver::cleanup_pio() {
     pio_sm_unclaim(_config.pio_instance, sm);
     
     // Remove program
-    pio_remove_program(_config.pio_instance, &ws2812_program, _pio_program_offset);
+    pio_remove_program(_config.pio_instance, &_program, _pio_program_offset);
 }
 
 bool WS2812Driver::init_dma() {
@@ -158,19 +290,21 @@ bool WS2812Driver::init_dma() {
 
     // Configure DMA channel
     dma_channel_config config = dma_channel_get_default_config(_dma_channel);
-    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_transfer_data_size(&config, _packed ? DMA_SIZE_8 : DMA_SIZE_32);
     channel_config_set_read_increment(&config, true);
     channel_config_set_write_increment(&config, false);
     channel_config_set_dreq(&config, pio_get_dreq(_config.pio_instance, _config.pio_sm, true));
 
-    // Configure interrupt
-    dma_channel_set_irq0_enabled(_dma_channel, true);
-    irq_set_exclusive_handler(DMA_IRQ_0, dma_irq_handler);
-    irq_set_enabled(DMA_IRQ_0, true);
+    // Completion interrupt, on whichever DMA line has fewer channels
+    if (!IRQDispatcher::addDMAHandler(_dma_channel, dma_complete_callback, this)) {
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+        return false;  // Both DMA lines taken by other handlers
+    }
 
     dma_channel_configure(_dma_channel, &config, 
                          &_config.pio_instance->txf[_config.pio_sm],
-                         _pixel_buffer,
+                         nullptr,
                          _config.num_pixels,
                          false);  // Don't start yet
 
@@ -180,40 +314,177 @@ bool WS2812Driver::init_dma() {
 void WS2812Driver::cleanup_dma() {
     if (_dma_channel >= 0) {
         dma_channel_abort(_dma_channel);
-        dma_channel_set_irq0_enabled(_dma_channel, false);
+        IRQDispatcher::removeDMAHandler(_dma_channel);
         dma_channel_unclaim(_dma_channel);
         _dma_channel = -1;
     }
+    if (_stream_dma_channel >= 0) {
+        dma_channel_abort(_stream_dma_channel);
+        IRQDispatcher::removeDMAHandler(_stream_dma_channel);
+        dma_channel_unclaim(_stream_dma_channel);
+        _stream_dma_channel = -1;
+    }
     _dma_available = false;
 }
 
+bool WS2812Driver::init_stream() {
+    // Chunks are sent from DMA only, as native 32-bit colors
+    if (!_config.use_dma || _config.packed_pixels) {
+        return false;
+    }
+
+    _stream_chunk_pixels = (_config.stream_chunk_pixels < _config.num_pixels) ? _config.stream_chunk_pixels
+                                                                             : _config.num_pixels;
+    _stream_block = (uint32_t*)malloc(_stream_chunk_pixels * sizeof(uint32_t) * WS2812_STREAM_CHUNKS);
+    if (_stream_block == nullptr) {
+        return false;
+    }
+
+    if (!init_pio()) {
+        free(_stream_block);
+        _stream_block = nullptr;
+        return false;
+    }
+
+    _dma_available = init_dma();
+    if (_dma_available) {
+        _stream_dma_channel = dma_claim_unused_channel(false);
+    }
+    if (_stream_dma_channel >= 0 &&
+        !IRQDispatcher::addDMAHandler(_stream_dma_channel, dma_complete_callback, this,
+                                      IRQDispatcher::getDMAIrqIndex(_dma_channel))) {
+        dma_channel_unclaim(_stream_dma_channel);
+        _stream_dma_channel = -1;
+    }
+    if (_stream_dma_channel < 0) {
+        cleanup_dma();
+        cleanup_pio();
+        free(_stream_block);
+        _stream_block = nullptr;
+        return false;
+    }
+
+    _initialized = true;
+    _status = Status::IDLE;
+
+    return true;
+}
+
 bool WS2812Driver::setPixelColor(uint index, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
-    if (!_initialized || index >= _config.num_pixels) {
+    if (!_initialized || _pixel_buffer == nullptr || index >= _config.num_pixels) {
         return false;
     }
 
-    _pixel_buffer[index] = convert_color(r, g, b, w);
+    Pixel color = to_pixel(r, g, b, w);
+    if (read_pixel(index) != color) {
+        write_pixel(index, color);
+        mark_dirty(index + 1);
+    }
     return true;
 }
 
 bool WS2812Driver::getPixelColor(uint index, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) {
-    if (!_initialized || index >= _config.num_pixels) {
+    if (!_initialized || _pixel_buffer == nullptr || index >= _config.num_pixels) {
         return false;
     }
 
-    nativeToColor(_pixel_buffer[index], r, g, b, w);
+    pixel_to_color(read_pixel(index), r, g, b, w);
     return true;
 }
 
-void WS2812Driver::fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
-    if (!_initialized) {
+bool WS2812Driver::setPixelColor16(uint index, uint16_t r, uint16_t g, uint16_t b, uint16_t w) {
+    if (!_initialized || _pixel_buffer == nullptr || index >= _config.num_pixels) {
+        return false;
+    }
+
+#if WS2812_CHANNEL_BITS == 16
+    Pixel color = (_extract_white && w == 0) ? extractWhite16(r, g, b) : packColor16(_config.format, r, g, b, w);
+#else
+    Pixel color = to_pixel(narrow_channel(r), narrow_channel(g), narrow_channel(b), narrow_channel(w));
+#endif
+    if (read_pixel(index) != color) {
+        write_pixel(index, color);
+        mark_dirty(index + 1);
+    }
+    return true;
+}
+
+bool WS2812Driver::getPixelColor16(uint index, uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& w) {
+    if (!_initialized || _pixel_buffer == nullptr || index >= _config.num_pixels) {
+        return false;
+    }
+
+#if WS2812_CHANNEL_BITS == 16
+    unpackColor16(_config.format, _pixel_buffer[index], r, g, b, w);
+#else
+    uint8_t r8, g8, b8, w8;
+    nativeToColor(read_pixel(index), r8, g8, b8, w8);
+    r = widen_channel(r8);
+    g = widen_channel(g8);
+    b = widen_channel(b8);
+    w = widen_channel(w8);
+#endif
+    return true;
+}
+
+template <typename Op>
+void WS2812Driver::apply_pixels(Pixel color, Op op) {
+    if (!_initialized || _pixel_buffer == nullptr) {
         return;
     }
 
-    uint32_t color = convert_color(r, g, b, w);
-    for (uint i = 0; i < _config.num_pixels; i++) {
-        _pixel_buffer[i] = color;
+    // Only the pixels up to the last one that changed go on the wire
+    uint end = 0;
+    if (_packed) {
+        // Whole words of packed pixels, against the color repeated over
+        // three words (four pixels)
+        uint8_t pattern_bytes[12];
+        for (uint i = 0; i < 12; i += 3) {
+            pattern_bytes[i] = (uint8_t)(color >> 24);
+            pattern_bytes[i + 1] = (uint8_t)(color >> 16);
+            pattern_bytes[i + 2] = (uint8_t)(color >> 8);
+        }
+        uint32_t pattern[3];
+        memcpy(pattern, pattern_bytes, sizeof(pattern));
+
+        uint length = _config.num_pixels * 3;
+        uint words = length / 4;
+        uint32_t* data = (uint32_t*)_pixel_buffer;
+        uint changed = 0;
+        for (uint i = 0, phase = 0; i < words; i++) {
+            uint32_t value = op(data[i], pattern[phase]);
+            if (value != data[i]) {
+                data[i] = value;
+                changed = (i + 1) * 4;
+            }
+            phase = (phase == 2) ? 0 : phase + 1;
+        }
+
+        uint tail = length - words * 4;
+        if (tail > 0) {
+            uint32_t word = 0;
+            memcpy(&word, data + words, tail);
+            uint32_t value = op(word, pattern[words % 3]);
+            if (memcmp(&value, &word, tail) != 0) {
+                memcpy(data + words, &value, tail);
+                changed = length;
+            }
+        }
+        end = (changed + 2) / 3;
+    } else {
+        for (uint i = 0; i < _config.num_pixels; i++) {
+            Pixel value = op(_pixel_buffer[i], color);
+            if (value != _pixel_buffer[i]) {
+                _pixel_buffer[i] = value;
+                end = i + 1;
+            }
+        }
     }
+    mark_dirty(end);
+}
+
+void WS2812Driver::fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    apply_pixels(to_pixel(r, g, b, w), [](auto, auto color) { return color; });
 }
 
 void WS2812Driver::clear() {
@@ -221,43 +492,446 @@ void WS2812Driver::clear() {
         return;
     }
 
-    memset(_pixel_buffer, 0, _config.num_pixels * sizeof(uint32_t));
+    uint end = _config.num_pixels;
+    while (end > 0 && read_pixel(end - 1) == 0) {
+        end--;
+    }
+    memset(_pixel_buffer, 0, end * pixel_bytes());
+    mark_dirty(end);
+}
+
+void WS2812Driver::scalePixels(uint8_t scale) {
+    apply_pixels(0, [scale](auto value, auto) { return PixelMath::scale8(value, scale); });
+}
+
+void WS2812Driver::addColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    apply_pixels(to_pixel(r, g, b, w),
+                 [](auto value, auto color) { return PixelMath::addSaturate(value, color); });
+}
+
+void WS2812Driver::blendColor(uint8_t amount, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    apply_pixels(to_pixel(r, g, b, w),
+                 [amount](auto value, auto color) { return PixelMath::lerp8(value, color, amount); });
+}
+
+void WS2812Driver::markDirty(uint start_index, uint count) {
+    if (start_index >= _config.num_pixels) {
+        return;
+    }
+    uint end = (count > _config.num_pixels - start_index) ? _config.num_pixels : start_index + count;
+    mark_dirty(end);
+}
+
+uint WS2812Driver::dirty_length() const {
+    // Dithered frames differ everywhere from one frame to the next
+    if (_dithering && !_output_identity) {
+        return _config.num_pixels;
+    }
+    // Through a pixel map a change can land anywhere on the wire
+    if (_pixel_map != nullptr && _dirty_end > 0) {
+        return _config.num_pixels;
+    }
+    return _dirty_end;
 }
 
 bool WS2812Driver::update(bool blocking) {
-    if (!_initialized || _status == Status::UPDATING) {
+    if (!_initialized || _pixel_buffer == nullptr) {
+        return false;
+    }
+
+    if (_continuous) {
+        // The refresh loop picks the new content up by itself. The frame
+        // prepared before this call still has the old content, so the new
+        // one is on the wire from the second frame on.
+        if (_num_buffers > 1) {
+            present();
+        }
+        if (blocking) {
+            uint32_t target = _update_count + 2;
+            while (_continuous && (int32_t)(_update_count - target) < 0) {
+                tight_loop_contents();
+            }
+        }
+        return true;
+    }
+
+    if (_num_buffers > 1) {
+        if (!present()) {
+            return false;
+        }
+        if (blocking) {
+            waitForCompletion();
+        }
+        return true;
+    }
+
+    if (isBusy()) {
         return false;
     }
 
+    // Nothing to send if no pixel changed since the previous frame
+    uint length = dirty_length();
+    if (length == 0) {
+        return true;
+    }
+    _dirty_end = 0;
+
+    void* frame = encode_frame(_back_index, length);
+    _frame_length[_back_index] = length;
     _status = Status::UPDATING;
+    _front_index = _back_index;
 
     if (_dma_available) {
         // Use DMA for non-blocking transfer
-        dma_channel_set_read_addr(_dma_channel, _pixel_buffer, true);
+        start_transfer(frame, length);
         
         if (blocking) {
             waitForCompletion();
         }
     } else {
         // Use PIO directly (blocking)
-        for (uint i = 0; i < _config.num_pixels; i++) {
-            pio_sm_put_blocking(_config.pio_instance, _config.pio_sm, _pixel_buffer[i] << 8);
+        transmit_blocking(frame, length);
+    }
+
+    return true;
+}
+
+bool WS2812Driver::present(bool preserve_contents) {
+    if (!_initialized || _pixel_buffer == nullptr) {
+        return false;
+    }
+
+    if (_num_buffers < 2) {
+        return update(false);
+    }
+
+    if (_continuous) {
+        // No frame is queued: the refresh loop encodes from the front
+        // buffer, so presenting only makes the back buffer the front one
+        uint32_t irq_status = save_and_disable_interrupts();
+        uint next = (_back_index + 1) % _num_buffers;
+        _front_index = _back_index;
+        _pending_index = -1;
+        restore_interrupts(irq_status);
+
+        if (preserve_contents) {
+            memcpy(_buffers[next], _buffers[_back_index], _config.num_pixels * pixel_bytes());
+        }
+        _back_index = next;
+        _pixel_buffer = _buffers[next];
+        return true;
+    }
+
+    uint length = dirty_length();
+    if (length == 0) {
+        return true;
+    }
+
+    // A waiting frame may be replaced by this one, so its pixels have to be
+    // sent too. The latch interrupt only ever starts the waiting frame, so
+    // reading it here can only overestimate.
+    int waiting = _pending_index;
+    if (waiting >= 0 && _frame_length[waiting] > length) {
+        length = _frame_length[waiting];
+    }
+
+    // The back buffer is neither on the wire nor waiting, so its encoded
+    // copy is free to overwrite
+    encode_frame(_back_index, length);
+    _frame_length[_back_index] = length;
+
+    uint32_t irq_status = save_and_disable_interrupts();
+
+    // Any buffer that is not on the wire, waiting or being presented
+    int next = -1;
+    for (uint i = 0; i < _num_buffers; i++) {
+        if ((int)i != _front_index && (int)i != _pending_index && i != _back_index) {
+            next = i;
+            break;
+        }
+    }
+
+    bool start = !isBusy();
+    if (start) {
+        // Line is idle: the back buffer goes out right away
+        _front_index = _back_index;
+        if (next < 0) {
+            next = (_back_index + 1) % _num_buffers;
+        }
+    } else {
+        if (next < 0) {
+            if (_pending_index < 0) {
+                // Double buffering with a frame on the wire
+                restore_interrupts(irq_status);
+                return false;
+            }
+            // Triple buffering: the older waiting frame is dropped
+            next = _pending_index;
+        }
+        _pending_index = _back_index;
+    }
+
+    if (preserve_contents) {
+        memcpy(_buffers[next], _buffers[_back_index], _config.num_pixels * pixel_bytes());
+    }
+    _back_index = next;
+    _pixel_buffer = _buffers[next];
+
+    // Without the copy the new back buffer holds an older frame
+    _dirty_end = preserve_contents ? 0 : _config.num_pixels;
+
+    void* frame = nullptr;
+    if (start) {
+        _status = Status::UPDATING;
+        frame = _wire_buffers[_front_index];
+    }
+    restore_interrupts(irq_status);
+
+    if (frame != nullptr) {
+        if (_dma_available) {
+            start_transfer(frame, length);
+        } else {
+            transmit_blocking(frame, length);
         }
-        
-        // Wait for WS2812 reset time
-        busy_wait_us(WS2812_RESET_TIME_US);
-        
-        _status = Status::IDLE;
-        _update_count++;
     }
 
     return true;
 }
 
+void WS2812Driver::start_transfer(const void* frame, uint length) {
+    // One DMA transfer per byte with packed pixels
+    uint count = _packed ? length * 3 : length;
+    if (_hold_start) {
+        dma_channel_set_read_addr(_dma_channel, frame, false);
+        dma_channel_set_trans_count(_dma_channel, count, false);
+        _armed = true;
+        return;
+    }
+    dma_channel_transfer_from_buffer_now(_dma_channel, frame, count);
+}
+
+void WS2812Driver::transmit_blocking(const void* buffer, uint length) {
+    // Frames presented while this one is sent are sent straight after it
+    while (buffer != nullptr) {
+        if (_packed) {
+            const uint8_t* bytes = (const uint8_t*)buffer;
+            for (uint i = 0; i < length * 3; i++) {
+                pio_sm_put_blocking(_config.pio_instance, _config.pio_sm, (uint32_t)bytes[i] << 24);
+            }
+        } else {
+            const uint32_t* words = (const uint32_t*)buffer;
+            for (uint i = 0; i < length; i++) {
+                pio_sm_put_blocking(_config.pio_instance, _config.pio_sm, words[i]);
+            }
+        }
+
+        // Wait for the FIFO to drain and the WS2812 reset time
+        _status = Status::LATCHING;
+        busy_wait_us(latch_delay_us());
+
+        buffer = next_frame(length);
+    }
+}
+
+bool WS2812Driver::startContinuousRefresh() {
+    if (!_initialized || _pixel_buffer == nullptr || !_dma_available) {
+        return false;
+    }
+    if (_continuous) {
+        return true;
+    }
+
+    if (_refresh_block == nullptr) {
+        _refresh_block = (uint8_t*)malloc(_config.num_pixels * wire_bytes() * 2);
+        if (_refresh_block == nullptr) {
+            return false;
+        }
+    }
+
+    // Let a one-shot frame finish, then prepare both halves before the
+    // first one goes out
+    waitForCompletion();
+    uint8_t* second = _refresh_block + _config.num_pixels * wire_bytes();
+    encode_into(content_buffer(), _config.num_pixels, _refresh_block);
+    encode_into(content_buffer(), _config.num_pixels, second);
+    _refresh_index = 1;
+
+    _continuous = true;
+    _status = Status::UPDATING;
+    start_transfer(_refresh_block, _config.num_pixels);
+
+    return true;
+}
+
+void WS2812Driver::stopContinuousRefresh() {
+    _continuous = false;
+
+    // The refresh loop sent whole frames, so the content is on the LEDs
+    _dirty_end = 0;
+}
+
+bool WS2812Driver::streamFrame(StreamCallback producer, void* user_data, bool blocking) {
+    if (!_initialized || _stream_block == nullptr || producer == nullptr || isBusy()) {
+        return false;
+    }
+
+    _stream_producer = producer;
+    _stream_user_data = user_data;
+    _stream_chunks = (_config.num_pixels + _stream_chunk_pixels - 1) / _stream_chunk_pixels;
+    _stream_sent = 0;
+    _stream_encode = (_brightness != 255 || _gamma != 1.0f);
+    if (_dithering) {
+        _stream_dither_frame = _dither_frame++;
+    }
+
+    // Fill the ring before the first chunk goes out
+    for (uint chunk = 0; chunk < _stream_chunks && chunk < WS2812_STREAM_CHUNKS; chunk++) {
+        render_chunk(chunk);
+    }
+
+    _status = Status::UPDATING;
+    if (_stream_chunks > 1) {
+        arm_chunk(1, false);
+    }
+    arm_chunk(0, true);
+
+    if (blocking) {
+        waitForCompletion();
+    }
+    return true;
+}
+
+uint32_t* WS2812Driver::stream_chunk(uint chunk) const {
+    return _stream_block + (chunk % WS2812_STREAM_CHUNKS) * _stream_chunk_pixels;
+}
+
+uint WS2812Driver::stream_channel(uint chunk) const {
+    return (chunk & 1) ? _stream_dma_channel : _dma_channel;
+}
+
+void WS2812Driver::render_chunk(uint chunk) {
+    uint first = chunk * _stream_chunk_pixels;
+    uint count = (_config.num_pixels - first < _stream_chunk_pixels) ? _config.num_pixels - first
+                                                                     : _stream_chunk_pixels;
+    uint32_t* out = stream_chunk(chunk);
+    _stream_producer(first, count, out, _stream_user_data);
+
+    // The dither phase follows the pixel index across chunks
+    if (_stream_encode) {
+        if (_dithering) {
+            ditherPixels(out, count, _output_table16, _stream_dither_frame + first, out);
+        } else if (_output_linear) {
+            PixelMath::scaleWords(out, count, _brightness, out);
+        } else {
+            encodePixels(out, count, _output_table, out);
+        }
+    }
+}
+
+void WS2812Driver::arm_chunk(uint chunk, bool trigger) {
+    uint first = chunk * _stream_chunk_pixels;
+    uint count = (_config.num_pixels - first < _stream_chunk_pixels) ? _config.num_pixels - first
+                                                                     : _stream_chunk_pixels;
+    uint channel = stream_channel(chunk);
+
+    dma_channel_config config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(_config.pio_instance, _config.pio_sm, true));
+
+    // Start the next chunk when this one is done. The last chunk chains to
+    // itself, which ends the frame.
+    channel_config_set_chain_to(&config, (chunk + 1 < _stream_chunks) ? stream_channel(chunk + 1) : channel);
+
+    dma_channel_configure(channel, &config,
+                         &_config.pio_instance->txf[_config.pio_sm],
+                         stream_chunk(chunk),
+                         count,
+                         trigger);
+}
+
+void WS2812Driver::stream_chunk_complete() {
+    uint chunk = _stream_sent++;
+    if (_stream_sent == _stream_chunks) {
+        start_latch();
+        return;
+    }
+
+    // The other channel is sending the next chunk and restarts this one
+    // when it is done, so point it at the chunk after that. If it has
+    // restarted already, the producer fell behind and it is sending stale
+    // data: the frame ends here.
+    uint channel = stream_channel(chunk);
+    if (dma_channel_is_busy(channel)) {
+        _error_count++;
+        dma_channel_abort(channel);
+        dma_channel_abort(stream_channel(chunk + 1));
+        uint irq_index = IRQDispatcher::getDMAIrqIndex(_dma_channel);
+        dma_irqn_acknowledge_channel(irq_index, _dma_channel);
+        dma_irqn_acknowledge_channel(irq_index, _stream_dma_channel);
+        _stream_sent = _stream_chunks;
+        start_latch();
+        return;
+    }
+    if (chunk + 2 < _stream_chunks) {
+        arm_chunk(chunk + 2, false);
+    }
+
+    // Refill the buffer that was just sent
+    if (chunk + WS2812_STREAM_CHUNKS < _stream_chunks) {
+        render_chunk(chunk + WS2812_STREAM_CHUNKS);
+
+        // With two buffers that is the chunk just armed, which must not
+        // have started yet
+        if (WS2812_STREAM_CHUNKS == 2 && dma_channel_is_busy(channel)) {
+            _error_count++;
+        }
+    }
+}
+
+const WS2812Driver::Pixel* WS2812Driver::content_buffer() const {
+    if (_num_buffers > 1 && _front_index >= 0) {
+        return _buffers[_front_index];
+    }
+    return _pixel_buffer;
+}
+
+void WS2812Driver::refresh_next() {
+    // Send the prepared half, then prepare the other one while it is on
+    // the wire
+    uint frame_bytes = _config.num_pixels * wire_bytes();
+    _update_count++;
+    _status = Status::UPDATING;
+    start_transfer(_refresh_block + _refresh_index * frame_bytes, _config.num_pixels);
+
+    _refresh_index ^= 1;
+    encode_into(content_buffer(), _config.num_pixels, _refresh_block + _refresh_index * frame_bytes);
+}
+
+void* WS2812Driver::next_frame(uint& length) {
+    void* next = nullptr;
+    uint32_t irq_status = save_and_disable_interrupts();
+
+    _update_count++;
+    if (_pending_index >= 0) {
+        _front_index = _pending_index;
+        _pending_index = -1;
+        next = _wire_buffers[_front_index];
+        length = _frame_length[_front_index];
+        _status = Status::UPDATING;
+    } else {
+        _status = Status::IDLE;
+    }
+
+    restore_interrupts(irq_status);
+    return next;
+}
+
 bool WS2812Driver::waitForCompletion(uint32_t timeout_ms) {
     absolute_time_t start_time = get_absolute_time();
 
-    while (_status == Status::UPDATING) {
+    while (isBusy()) {
         if (timeout_ms > 0) {
             if (absolute_time_diff_us(start_time, get_absolute_time()) > (timeout_ms * 1000)) {
                 return false;  // Timeout
@@ -270,7 +944,7 @@ bool WS2812Driver::waitForCompletion(uint32_t timeout_ms) {
 }
 
 bool WS2812Driver::setPixelData(const uint8_t* data, uint length, uint start_index) {
-    if (!_initialized || data == nullptr || start_index >= _config.num_pixels) {
+    if (!_initialized || _pixel_buffer == nullptr || data == nullptr || start_index >= _config.num_pixels) {
         return false;
     }
 
@@ -279,119 +953,536 @@ bool WS2812Driver::setPixelData(const uint8_t* data, uint length, uint start_ind
         length = max_pixels;
     }
 
-    // Convert based on color format
-    uint bytes_per_pixel = (_config.format == ColorFormat::RGBW) ? 4 : 3;
-    
-    for (uint i = 0; i < length; i++) {
-        uint data_offset = i * bytes_per_pixel;
-        uint8_t r, g, b, w = 0;
-        
-        switch (_config.format) {
-            case ColorFormat::RGB:
-                r = data[data_offset];
-                g = data[data_offset + 1];
-                b = data[data_offset + 2];
-                break;
-            case ColorFormat::GRB:
-                g = data[data_offset];
-                r = data[data_offset + 1];
-                b = data[data_offset + 2];
-                break;
-            case ColorFormat::RGBW:
-                r = data[data_offset];
-                g = data[data_offset + 1];
-                b = data[data_offset + 2];
-                w = data[data_offset + 3];
-                break;
+    if (_packed) {
+        // The data is in the packed layout already (G, R, B for GRB)
+        uint8_t* packed = (uint8_t*)_pixel_buffer + start_index * 3;
+        uint end = length;
+        while (end > 0 && memcmp(packed + (end - 1) * 3, data + (end - 1) * 3, 3) == 0) {
+            end--;
         }
-        
-        _pixel_buffer[start_index + i] = convert_color(r, g, b, w);
+        memcpy(packed, data, end * 3);
+        mark_dirty(end > 0 ? start_index + end : 0);
+        return true;
+    }
+
+    // Dispatch on the color format once for the whole run of pixels
+    uint last_changed = 0;
+    switch (_config.format) {
+        case ColorFormat::RGB:
+            last_changed = set_pixel_data<ColorFormat::RGB>(data, length, start_index);
+            break;
+        case ColorFormat::GRB:
+            last_changed = set_pixel_data<ColorFormat::GRB>(data, length, start_index);
+            break;
+        case ColorFormat::RGBW:
+            last_changed = set_pixel_data<ColorFormat::RGBW>(data, length, start_index);
+            break;
     }
+    mark_dirty(last_changed);
 
     return true;
 }
 
-uint32_t WS2812Driver::convert_color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+bool WS2812Driver::setPixelDataRGB(const uint8_t* data, uint length, uint start_index) {
+    // RGB data is the raw data of the RGB format
+    if (_config.format == ColorFormat::RGB) {
+        return setPixelData(data, length, start_index);
+    }
+
+    if (!_initialized || _pixel_buffer == nullptr || data == nullptr || start_index >= _config.num_pixels) {
+        return false;
+    }
+
+    uint max_pixels = _config.num_pixels - start_index;
+    if (length > max_pixels) {
+        length = max_pixels;
+    }
+
+    if (_packed) {
+        // Packed GRB: the first two bytes of each pixel swap places
+        uint8_t* packed = (uint8_t*)_pixel_buffer + start_index * 3;
+        uint last_changed = 0;
+        for (uint i = 0; i < length; i++) {
+            const uint8_t* rgb = data + i * 3;
+            uint8_t* pixel = packed + i * 3;
+            if (pixel[0] != rgb[1] || pixel[1] != rgb[0] || pixel[2] != rgb[2]) {
+                pixel[0] = rgb[1];
+                pixel[1] = rgb[0];
+                pixel[2] = rgb[2];
+                last_changed = start_index + i + 1;
+            }
+        }
+        mark_dirty(last_changed);
+    } else if (_config.format == ColorFormat::GRB) {
+        mark_dirty(set_pixel_rgb<ColorFormat::GRB>(data, length, start_index));
+    } else {
+        mark_dirty(set_pixel_rgb<ColorFormat::RGBW>(data, length, start_index));
+    }
+
+    return true;
+}
+
+bool WS2812Driver::getPixelData(uint8_t* data, uint length, uint start_index) const {
+    if (!_initialized || _pixel_buffer == nullptr || data == nullptr || start_index >= _config.num_pixels) {
+        return false;
+    }
+
+    uint max_pixels = _config.num_pixels - start_index;
+    if (length > max_pixels) {
+        length = max_pixels;
+    }
+
+    if (_packed) {
+        memcpy(data, (const uint8_t*)_pixel_buffer + start_index * 3, length * 3);
+        return true;
+    }
+
     switch (_config.format) {
         case ColorFormat::RGB:
-            return (r << 16) | (g << 8) | b;
+            get_pixel_data<ColorFormat::RGB>(data, length, start_index);
+            break;
         case ColorFormat::GRB:
-            return (g << 16) | (r << 8) | b;  // WS2812 native format
+            get_pixel_data<ColorFormat::GRB>(data, length, start_index);
+            break;
         case ColorFormat::RGBW:
-            return (w << 24) | (r << 16) | (g << 8) | b;
+            get_pixel_data<ColorFormat::RGBW>(data, length, start_index);
+            break;
+    }
+
+    return true;
+}
+
+template <WS2812Driver::ColorFormat F>
+WS2812Driver::Pixel WS2812Driver::data_to_pixel(const uint8_t* data) {
+#if WS2812_CHANNEL_BITS == 16
+    uint8_t r, g, b, w;
+    unpackColor<F>(packData<F>(data), r, g, b, w);
+    return packColor16<F>(widen_channel(r), widen_channel(g), widen_channel(b), widen_channel(w));
+#else
+    return packData<F>(data);
+#endif
+}
+
+template <WS2812Driver::ColorFormat F>
+void WS2812Driver::pixel_to_data(Pixel pixel, uint8_t* data) {
+#if WS2812_CHANNEL_BITS == 16
+    uint16_t r, g, b, w;
+    unpackColor16<F>(pixel, r, g, b, w);
+    unpackData<F>(packColor<F>(narrow_channel(r), narrow_channel(g), narrow_channel(b), narrow_channel(w)), data);
+#else
+    unpackData<F>(pixel, data);
+#endif
+}
+
+template <WS2812Driver::ColorFormat F>
+uint WS2812Driver::set_pixel_data(const uint8_t* data, uint length, uint start_index) {
+    Pixel* pixels = _pixel_buffer + start_index;
+    uint last_changed = 0;
+    for (uint i = 0; i < length; i++) {
+        Pixel color = data_to_pixel<F>(data + i * channelCount<F>());
+        if (pixels[i] != color) {
+            pixels[i] = color;
+            last_changed = start_index + i + 1;
+        }
+    }
+    return last_changed;
+}
+
+template <WS2812Driver::ColorFormat F>
+uint WS2812Driver::set_pixel_rgb(const uint8_t* data, uint length, uint start_index) {
+    bool extract = (F == ColorFormat::RGBW) && _extract_white;
+    Pixel* pixels = _pixel_buffer + start_index;
+    uint last_changed = 0;
+    for (uint i = 0; i < length; i++) {
+        const uint8_t* rgb = data + i * 3;
+#if WS2812_CHANNEL_BITS == 16
+        uint16_t r = widen_channel(rgb[0]);
+        uint16_t g = widen_channel(rgb[1]);
+        uint16_t b = widen_channel(rgb[2]);
+        Pixel color = extract ? extractWhite16(r, g, b) : packColor16<F>(r, g, b);
+#else
+        Pixel color = extract ? extractWhite(rgb[0], rgb[1], rgb[2]) : packColor<F>(rgb[0], rgb[1], rgb[2]);
+#endif
+        if (pixels[i] != color) {
+            pixels[i] = color;
+            last_changed = start_index + i + 1;
+        }
+    }
+    return last_changed;
+}
+
+template <WS2812Driver::ColorFormat F>
+void WS2812Driver::get_pixel_data(uint8_t* data, uint length, uint start_index) const {
+    const Pixel* pixels = _pixel_buffer + start_index;
+    for (uint i = 0; i < length; i++) {
+        pixel_to_data<F>(pixels[i], data + i * channelCount<F>());
+    }
+}
+
+uint32_t WS2812Driver::packColor(ColorFormat format, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    switch (format) {
+        case ColorFormat::RGB:
+            return packColor<ColorFormat::RGB>(r, g, b, w);
+        case ColorFormat::GRB:
+            return packColor<ColorFormat::GRB>(r, g, b, w);
+        case ColorFormat::RGBW:
+            return packColor<ColorFormat::RGBW>(r, g, b, w);
         default:
             return 0;
     }
 }
 
-uint32_t WS2812Driver::colorToNative(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
-    return convert_color(r, g, b, w);
+void WS2812Driver::unpackColor(ColorFormat format, uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) {
+    switch (format) {
+        case ColorFormat::RGB:
+            unpackColor<ColorFormat::RGB>(color, r, g, b, w);
+            break;
+        case ColorFormat::GRB:
+            unpackColor<ColorFormat::GRB>(color, r, g, b, w);
+            break;
+        case ColorFormat::RGBW:
+            unpackColor<ColorFormat::RGBW>(color, r, g, b, w);
+            break;
+        default:
+            r = g = b = w = 0;
+            break;
+    }
 }
 
-void WS2812Driver::nativeToColor(uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) {
-    switch (_config.format) {
+uint64_t WS2812Driver::packColor16(ColorFormat format, uint16_t r, uint16_t g, uint16_t b, uint16_t w) {
+    switch (format) {
+        case ColorFormat::RGB:
+            return packColor16<ColorFormat::RGB>(r, g, b, w);
+        case ColorFormat::GRB:
+            return packColor16<ColorFormat::GRB>(r, g, b, w);
+        case ColorFormat::RGBW:
+            return packColor16<ColorFormat::RGBW>(r, g, b, w);
+        default:
+            return 0;
+    }
+}
+
+void WS2812Driver::unpackColor16(ColorFormat format, uint64_t color, uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& w) {
+    switch (format) {
         case ColorFormat::RGB:
-            r = (color >> 16) & 0xFF;
-            g = (color >> 8) & 0xFF;
-            b = color & 0xFF;
-            w = 0;
+            unpackColor16<ColorFormat::RGB>(color, r, g, b, w);
             break;
         case ColorFormat::GRB:
-            g = (color >> 16) & 0xFF;
-            r = (color >> 8) & 0xFF;
-            b = color & 0xFF;
-            w = 0;
+            unpackColor16<ColorFormat::GRB>(color, r, g, b, w);
             break;
         case ColorFormat::RGBW:
-            w = (color >> 24) & 0xFF;
-            r = (color >> 16) & 0xFF;
-            g = (color >> 8) & 0xFF;
-            b = color & 0xFF;
+            unpackColor16<ColorFormat::RGBW>(color, r, g, b, w);
+            break;
+        default:
+            r = g = b = w = 0;
             break;
     }
 }
 
-void WS2812Driver::setBrightness(uint8_t brightness) {
-    if (!_initialized) {
-        return;
+uint32_t WS2812Driver::convert_color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    return packColor(_config.format, r, g, b, w);
+}
+
+WS2812Driver::Pixel WS2812Driver::to_pixel(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+#if WS2812_CHANNEL_BITS == 16
+    if (_extract_white && w == 0) {
+        return extractWhite16(widen_channel(r), widen_channel(g), widen_channel(b));
+    }
+    return packColor16(_config.format, widen_channel(r), widen_channel(g), widen_channel(b), widen_channel(w));
+#else
+    if (_extract_white && w == 0) {
+        return extractWhite(r, g, b);
     }
+    return convert_color(r, g, b, w);
+#endif
+}
 
-    for (uint i = 0; i < _config.num_pixels; i++) {
-        uint8_t r, g, b, w;
-        nativeToColor(_pixel_buffer[i], r, g, b, w);
-        
-        // Apply brightness scaling
-        r = (r * brightness) / 255;
-        g = (g * brightness) / 255;
-        b = (b * brightness) / 255;
-        w = (w * brightness) / 255;
-        
-        _pixel_buffer[i] = convert_color(r, g, b, w);
+uint WS2812Driver::bits_per_entry() const {
+    if (_packed) {
+        return WS2812_BITS_PER_BYTE;
+    }
+    return (_config.format == ColorFormat::RGBW) ? WS2812_BITS_PER_RGBW_WORD : WS2812_BITS_PER_WORD;
+}
+
+WS2812Driver::Pixel WS2812Driver::read_pixel(uint index) const {
+    if (_packed) {
+        const uint8_t* bytes = (const uint8_t*)_pixel_buffer + index * 3;
+        return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8);
+    }
+    return _pixel_buffer[index];
+}
+
+void WS2812Driver::write_pixel(uint index, Pixel pixel) {
+    if (_packed) {
+        uint8_t* bytes = (uint8_t*)_pixel_buffer + index * 3;
+        bytes[0] = (uint8_t)(pixel >> 24);
+        bytes[1] = (uint8_t)(pixel >> 16);
+        bytes[2] = (uint8_t)(pixel >> 8);
+    } else {
+        _pixel_buffer[index] = pixel;
     }
 }
 
-void WS2812Driver::applyGammaCorrection(float gamma) {
+void WS2812Driver::pixel_to_color(Pixel pixel, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const {
+#if WS2812_CHANNEL_BITS == 16
+    uint16_t r16, g16, b16, w16;
+    unpackColor16(_config.format, pixel, r16, g16, b16, w16);
+    r = narrow_channel(r16);
+    g = narrow_channel(g16);
+    b = narrow_channel(b16);
+    w = narrow_channel(w16);
+#else
+    nativeToColor(pixel, r, g, b, w);
+#endif
+}
+
+uint32_t WS2812Driver::colorToNative(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    return convert_color(r, g, b, w);
+}
+
+void WS2812Driver::nativeToColor(uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const {
+    unpackColor(_config.format, color, r, g, b, w);
+}
+
+bool WS2812Driver::setTiming(const LEDTiming& timing) {
+    LEDBitCycles cycles;
+    if (!LEDTimings::synthesize(timing, clock_get_hz(clk_sys), WS2812_MAX_PHASE_CYCLES, 1, cycles)) {
+        return false;
+    }
     if (!_initialized) {
+        _timing = timing;
+        return true;
+    }
+    if (isBusy() || _continuous) {
+        return false;
+    }
+
+    // Reload the state machine with the program for the new timing
+    cleanup_pio();
+    _timing = timing;
+    return init_pio();
+}
+
+bool WS2812Driver::setBrightness(uint8_t brightness) {
+    return set_output_curve(brightness, _gamma);
+}
+
+bool WS2812Driver::setGamma(float gamma) {
+    if (gamma <= 0.0f) {
+        return false;
+    }
+    return set_output_curve(_brightness, gamma);
+}
+
+bool WS2812Driver::set_output_curve(uint8_t brightness, float gamma) {
+    // 16-bit pixels always have to be quantized for the wire
+    bool identity = (WS2812_CHANNEL_BITS == 8 && brightness == 255 && gamma == 1.0f);
+
+    // The encoded copies are only needed once the output differs from the
+    // pixel buffers. They stay allocated until end(), as DMA may be reading
+    // one of them.
+    if (!identity && _pixel_buffer != nullptr && !alloc_encoded_block()) {
+        _error_count++;
+        return false;
+    }
+
+    // pow() is slow without an FPU, so the gamma curve is cached
+    if (gamma != _gamma) {
+        for (uint i = 0; i < 256; i++) {
+            _gamma_table[i] = (gamma == 1.0f) ? (uint16_t)(i << 8)
+                                              : (uint16_t)(powf(i / 255.0f, gamma) * 65280.0f + 0.5f);
+        }
+        _gamma = gamma;
+    }
+
+    // Brightness scales the gamma-corrected value so dimming stays
+    // proportional in light output. The 8-bit table is the rounded 8.8 one,
+    // except without gamma for 8-bit pixels, where frames are scaled a word
+    // at a time with PixelMath::scale8() instead and the table matches it.
+    bool linear = (WS2812_CHANNEL_BITS == 8 && gamma == 1.0f);
+    for (uint i = 0; i < 256; i++) {
+        _output_table16[i] = (uint16_t)(((uint32_t)_gamma_table[i] * brightness) / 255);
+        _output_table[i] = linear ? (uint8_t)PixelMath::scale8((uint32_t)i, brightness)
+                                  : (uint8_t)((_output_table16[i] + 128) >> 8);
+    }
+    _brightness = brightness;
+    _output_identity = identity;
+    _output_linear = linear;
+
+    // Every LED shows the new curve from the next frame
+    mark_dirty(_config.num_pixels);
+
+    return true;
+}
+
+bool WS2812Driver::setPixelMap(const uint16_t* map) {
+    if (_stream_block != nullptr) {
+        return false;
+    }
+
+    if (map != nullptr) {
+        for (uint i = 0; i < _config.num_pixels; i++) {
+            if (map[i] >= _config.num_pixels) {
+                return false;
+            }
+        }
+        // Mapped frames are always encoded into a copy
+        if (_pixel_buffer != nullptr && !alloc_encoded_block()) {
+            _error_count++;
+            return false;
+        }
+    }
+
+    _pixel_map = map;
+    mark_dirty(_config.num_pixels);
+    return true;
+}
+
+bool WS2812Driver::alloc_encoded_block() {
+    if (_encoded_block != nullptr) {
+        return true;
+    }
+
+    uint frame_bytes = _config.num_pixels * wire_bytes();
+    _encoded_block = (uint8_t*)malloc(frame_bytes * _num_buffers);
+    for (uint i = 0; i < _num_buffers && _encoded_block != nullptr; i++) {
+        _wire_buffers[i] = _encoded_block + i * frame_bytes;
+    }
+    return _encoded_block != nullptr;
+}
+
+void* WS2812Driver::encode_frame(uint index, uint length) {
+#if WS2812_CHANNEL_BITS == 16
+    encode_into(_buffers[index], length, _wire_buffers[index]);
+#else
+    if (_output_identity && _pixel_map == nullptr) {
+        _wire_buffers[index] = _buffers[index];
+    } else {
+        _wire_buffers[index] = _encoded_block + index * _config.num_pixels * wire_bytes();
+        encode_into(_buffers[index], length, _wire_buffers[index]);
+    }
+#endif
+    return _wire_buffers[index];
+}
+
+void WS2812Driver::encode_into(const Pixel* pixels, uint count, void* out) {
+    uint frame = _dithering ? _dither_frame++ : 0;
+    if (_pixel_map == nullptr) {
+        encode_block(pixels, count, frame, out);
         return;
     }
 
-    // Create gamma correction lookup table
-    uint8_t gamma_table[256];
-    for (int i = 0; i < 256; i++) {
-        gamma_table[i] = (uint8_t)(pow(i / 255.0, gamma) * 255.0 + 0.5);
+    // Gather the pixels in wire order a block at a time and encode each
+    // block as usual. Without an output curve the wire format is the pixel
+    // format, so they are gathered straight into the output.
+    Pixel block[WS2812_MAP_BLOCK];
+    uint8_t* wire = (uint8_t*)out;
+    bool direct = _output_identity;
+    for (uint first = 0; first < count; first += WS2812_MAP_BLOCK) {
+        uint length = (count - first < WS2812_MAP_BLOCK) ? count - first : WS2812_MAP_BLOCK;
+        const uint16_t* map = _pixel_map + first;
+        Pixel* gathered = direct ? (Pixel*)(wire + first * wire_bytes()) : block;
+        if (_packed) {
+            const uint8_t* source = (const uint8_t*)pixels;
+            uint8_t* target = (uint8_t*)gathered;
+            for (uint i = 0; i < length; i++) {
+                memcpy(target + i * 3, source + map[i] * 3, 3);
+            }
+        } else {
+            for (uint i = 0; i < length; i++) {
+                gathered[i] = pixels[map[i]];
+            }
+        }
+        if (!direct) {
+            encode_block(block, length, frame + first, wire + first * wire_bytes());
+        }
     }
+}
 
-    // Apply gamma correction to all pixels
-    for (uint i = 0; i < _config.num_pixels; i++) {
-        uint8_t r, g, b, w;
-        nativeToColor(_pixel_buffer[i], r, g, b, w);
-        
-        r = gamma_table[r];
-        g = gamma_table[g];
-        b = gamma_table[b];
-        w = gamma_table[w];
-        
-        _pixel_buffer[i] = convert_color(r, g, b, w);
+void WS2812Driver::encode_block(const Pixel* pixels, uint count, uint frame, void* out) {
+#if WS2812_CHANNEL_BITS == 16
+    quantizePixels(pixels, count, _output_table16, _dithering, frame, (uint32_t*)out);
+#else
+    if (_output_identity) {
+        memcpy(out, pixels, count * wire_bytes());
+    } else if (_packed) {
+        if (_dithering) {
+            ditherPackedPixels((const uint8_t*)pixels, count, _output_table16, frame, (uint8_t*)out);
+        } else if (_output_linear) {
+            PixelMath::scaleBytes((const uint8_t*)pixels, count * 3, _brightness, (uint8_t*)out);
+        } else {
+            encodePackedPixels((const uint8_t*)pixels, count, _output_table, (uint8_t*)out);
+        }
+    } else if (_dithering) {
+        ditherPixels(pixels, count, _output_table16, frame, (uint32_t*)out);
+    } else if (_output_linear) {
+        PixelMath::scaleWords(pixels, count, _brightness, (uint32_t*)out);
+    } else {
+        encodePixels(pixels, count, _output_table, (uint32_t*)out);
+    }
+#endif
+}
+
+void WS2812Driver::quantizePixels(const uint64_t* pixels, uint count, const uint16_t* table, bool dither,
+                                  uint frame, uint32_t* out) {
+    for (uint i = 0; i < count; i++) {
+        uint32_t threshold = dither ? WS2812_DITHER_THRESHOLDS[(frame + i) & (WS2812_DITHER_PHASES - 1)] : 128;
+        uint64_t color = pixels[i];
+        uint32_t native = 0;
+        for (int shift = 48; shift >= 0; shift -= 16) {
+            uint32_t level = channel_level((uint32_t)(color >> shift) & 0xFFFF);
+            uint32_t index = level >> 8;
+            uint32_t fraction = level & 0xFF;
+
+            // Interpolate towards the next entry. Index 255 only occurs with
+            // fraction 0, so the wrapped neighbor is multiplied by 0.
+            int32_t step = (int32_t)table[(index + 1) & 0xFF] - (int32_t)table[index];
+            uint32_t value = table[index] + (uint32_t)((step * (int32_t)fraction) >> 8);
+
+            native = (native << 8) | ((value + threshold) >> 8);
+        }
+        out[i] = native;
+    }
+}
+
+void WS2812Driver::ditherPixels(const uint32_t* pixels, uint count, const uint16_t* table, uint frame, uint32_t* out) {
+    // table[] <= 0xFF00 and thresholds < 0x100, so the sum never carries
+    // out of the channel
+    for (uint i = 0; i < count; i++) {
+        uint32_t threshold = WS2812_DITHER_THRESHOLDS[(frame + i) & (WS2812_DITHER_PHASES - 1)];
+        uint32_t color = pixels[i];
+        out[i] = (((table[color >> 24] + threshold) >> 8) << 24) |
+                 (((table[(color >> 16) & 0xFF] + threshold) >> 8) << 16) |
+                 (((table[(color >> 8) & 0xFF] + threshold) >> 8) << 8) |
+                 ((table[color & 0xFF] + threshold) >> 8);
+    }
+}
+
+void WS2812Driver::encodePixels(const uint32_t* pixels, uint count, const uint8_t* table, uint32_t* out) {
+    for (uint i = 0; i < count; i++) {
+        uint32_t color = pixels[i];
+        out[i] = ((uint32_t)table[color >> 24] << 24) |
+                 ((uint32_t)table[(color >> 16) & 0xFF] << 16) |
+                 ((uint32_t)table[(color >> 8) & 0xFF] << 8) |
+                 (uint32_t)table[color & 0xFF];
+    }
+}
+
+void WS2812Driver::encodePackedPixels(const uint8_t* pixels, uint count, const uint8_t* table, uint8_t* out) {
+    for (uint i = 0; i < count * 3; i++) {
+        out[i] = table[pixels[i]];
+    }
+}
+
+void WS2812Driver::ditherPackedPixels(const uint8_t* pixels, uint count, const uint16_t* table, uint frame,
+                                      uint8_t* out) {
+    for (uint i = 0; i < count; i++) {
+        uint32_t threshold = WS2812_DITHER_THRESHOLDS[(frame + i) & (WS2812_DITHER_PHASES - 1)];
+        const uint8_t* pixel = pixels + i * 3;
+        uint8_t* encoded = out + i * 3;
+        encoded[0] = (uint8_t)((table[pixel[0]] + threshold) >> 8);
+        encoded[1] = (uint8_t)((table[pixel[1]] + threshold) >> 8);
+        encoded[2] = (uint8_t)((table[pixel[2]] + threshold) >> 8);
     }
 }
 
@@ -410,22 +1501,69 @@ void WS2812Driver::resetStatistics() {
     _error_count = 0;
 }
 
-void WS2812Driver::dma_irq_handler() {
-    if (_instance != nullptr) {
-        _instance->dma_complete_handler();
+void WS2812Driver::dma_complete_callback(uint channel, void* user_data) {
+    (void)channel;
+    static_cast<WS2812Driver*>(user_data)->dma_complete_handler();
+}
+
+uint32_t WS2812Driver::latch_delay_us() const {
+    // Words still queued in the TX FIFO, the word in the OSR and the bit on
+    // the wire when it was pulled, plus 1 us because the timer only counts
+    // whole microseconds
+    uint queued_bits = (pio_sm_get_tx_fifo_level(_config.pio_instance, _config.pio_sm) + 1) * bits_per_entry() + 1;
+    return (queued_bits * _bit_cycles.bit_ns + 999) / 1000 + _timing.reset_us + 1;
+}
+
+void WS2812Driver::latch_complete() {
+    if (_continuous) {
+        refresh_next();
+        return;
+    }
+
+    // Start the frame presented in the meantime, if any
+    uint length = 0;
+    void* next = next_frame(length);
+    if (next != nullptr) {
+        start_transfer(next, length);
+    }
+}
+
+int64_t WS2812Driver::latch_alarm_callback(alarm_id_t id, void* user_data) {
+    (void)id;
+    WS2812Driver* driver = static_cast<WS2812Driver*>(user_data);
+    driver->_latch_alarm = 0;
+    driver->latch_complete();
+    return 0;
+}
+
+void WS2812Driver::start_latch() {
+    // DMA finishes while the last pixels are still in the PIO FIFO. The
+    // LEDs latch once those are out and the line has stayed low for the
+    // reset time; a timer alarm ends that period instead of this IRQ.
+    _status = Status::LATCHING;
+    uint32_t delay_us = latch_delay_us();
+    alarm_id_t alarm = add_alarm_in_us(delay_us, latch_alarm_callback, this, true);
+    if (alarm > 0) {
+        _latch_alarm = alarm;
+    } else if (alarm < 0) {
+        // No alarm slot free: wait here as a fallback
+        _error_count++;
+        busy_wait_us(delay_us);
+        latch_complete();
     }
 }
 
 void WS2812Driver::dma_complete_handler() {
-    if (dma_channel_get_irq0_status(_dma_channel)) {
-        dma_channel_acknowledge_irq0(_dma_channel);
-        
-        // Wait for WS2812 reset time
-        busy_wait_us(WS2812_RESET_TIME_US);
-        
-        _status = Status::IDLE;
-        _update_count++;
+    if (_stream_block != nullptr) {
+        // Chunks finish in order, alternating between the two channels, so
+        // each completion is that of the oldest chunk still on the wire
+        if (_stream_sent < _stream_chunks) {
+            stream_chunk_complete();
+        }
+        return;
     }
+
+    start_latch();
 }
 
 void WS2812Driver::printStatus() const {
@@ -433,6 +1571,9 @@ void WS2812Driver::printStatus() const {
     printf("  Initialized: %s\n", _initialized ? "Yes" : "No");
     printf("  GPIO Pin: %u\n", _config.gpio_pin);
     printf("  Pixels: %u\n", _config.num_pixels);
+    printf("  Timing: %s (T0H %lu ns, T1H %lu ns, bit %lu ns, %u cycles at divider %u + %u/256)\n",
+           _timing.name, _bit_cycles.t0h_ns, _bit_cycles.t1h_ns, _bit_cycles.bit_ns,
+           _bit_cycles.cyclesPerBit(), _bit_cycles.div_int, _bit_cycles.div_frac);
     printf("  Format: ");
     
     switch (_config.format) {
@@ -448,6 +1589,18 @@ void WS2812Driver::printStatus() const {
     }
     
     printf("  DMA Enabled: %s\n", _dma_available ? "Yes" : "No");
+    printf("  Frame Buffers: %u\n", _num_buffers);
+    printf("  Packed Pixels: %s\n", _packed ? "Yes" : "No");
+    if (_extract_white) {
+        printf("  White Extraction: Yes\n");
+    }
+    if (_stream_block != nullptr) {
+        printf("  Streaming: %u chunks of %u pixels\n", WS2812_STREAM_CHUNKS, _stream_chunk_pixels);
+    }
+    printf("  Brightness: %u\n", _brightness);
+    printf("  Gamma: %.2f\n", _gamma);
+    printf("  Dithering: %s\n", _dithering ? "Yes" : "No");
+    printf("  Continuous Refresh: %s\n", _continuous ? "Yes" : "No");
     printf("  Status: ");
     
     switch (_status) {
@@ -457,6 +1610,9 @@ void WS2812Driver::printStatus() const {
         case Status::UPDATING:
             printf("UPDATING\n");
             break;
+        case Status::LATCHING:
+            printf("LATCHING\n");
+            break;
         case Status::ERROR:
             printf("ERROR\n");
             break;
@@ -467,19 +1623,24 @@ void WS2812Driver::printStatus() const {
 }
 
 void WS2812Driver::printPixelData(uint start_index, uint count) const {
+    if (_pixel_buffer == nullptr) {
+        return;
+    }
+
     printf("Pixel Data (index %u-%u):\n", start_index, start_index + count - 1);
     
     for (uint i = 0; i < count && (start_index + i) < _config.num_pixels; i++) {
         uint index = start_index + i;
         uint8_t r, g, b, w;
-        nativeToColor(_pixel_buffer[index], r, g, b, w);
+        pixel_to_color(read_pixel(index), r, g, b, w);
+        uint32_t native = packColor(_config.format, r, g, b, w);
         
         if (_config.format == ColorFormat::RGBW) {
             printf("  Pixel[%3u]: R=%3u G=%3u B=%3u W=%3u (0x%08lX)\n", 
-                   index, r, g, b, w, _pixel_buffer[index]);
+                   index, r, g, b, w, native);
         } else {
             printf("  Pixel[%3u]: R=%3u G=%3u B=%3u (0x%08lX)\n", 
-                   index, r, g, b, _pixel_buffer[index]);
+                   index, r, g, b, native);
         }
     }
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include "hardware/clocks.h"
 #include "hardware/dma.h"
 #include "../config/picoled_config.h"
+#include "pixel_map.h"
+#include "pixel_math.h"
+#include "led_timing.h"
 
 /**
  * @brief WS2812 LED Driver using PIO
@@ -17,15 +20,35 @@ public:
     enum class ColorFormat {
         RGB,    // Red, Green, Blue
         GRB,    // Green, Red, Blue (WS2812 native)
-        RGBW    // Red, Green, Blue, White (for SK6812)
+        RGBW    // Red, Green, Blue, White (SK6812, sent as G, R, B, W)
     };
 
     enum class Status {
         IDLE,
-        UPDATING,
+        UPDATING,   // Pixel data is being sent
+        LATCHING,   // Data sent, waiting out the reset time before the LEDs latch
         ERROR
     };
 
+    // Pixel buffer entry. With WS2812_CHANNEL_BITS 16 every channel is
+    // stored with 16 bits in the same order as the native format (see
+    // packColor16) and quantized to 8 bits when frames are encoded.
+#if WS2812_CHANNEL_BITS == 16
+    using Pixel = uint64_t;
+#else
+    using Pixel = uint32_t;
+#endif
+
+    /**
+     * @brief Producer for streaming mode
+     *
+     * Renders count pixels starting at first_pixel into out, one native
+     * color per pixel (see colorToNative). Called from the DMA interrupt
+     * while the previous chunks are on the wire, so it has to finish within
+     * one chunk time.
+     */
+    typedef void (*StreamCallback)(uint first_pixel, uint count, uint32_t* out, void* user_data);
+
     struct Config {
         PIO pio_instance;
         uint pio_sm;
@@ -33,41 +56,153 @@ public:
         uint num_pixels;
         ColorFormat format;
         bool use_dma;
+        uint num_buffers;       // Frame buffers: 0/1 = single, 2 = double, 3 = triple
+        bool packed_pixels = false;  // RGB/GRB: store 3 bytes per pixel (8-bit channels only)
+        uint stream_chunk_pixels = 0;  // Streaming mode: pixels per chunk (0 = frame buffers)
+        bool extract_white = false;    // RGBW: colors set without white get it extracted (see extractWhite)
+        const LEDTiming* timing = nullptr;  // Bit timing, copied (nullptr = LEDTimings::WS2812)
     };
 
 private:
     // Hardware configuration
     Config _config;
     uint _pio_program_offset;
+
+    // Bit timing and the PIO program built for it (see init_pio)
+    LEDTiming _timing;
+    LEDBitCycles _bit_cycles;
+    uint16_t _program_instructions[4];
+    struct pio_program _program;
     
-    // Pixel data buffer
-    uint32_t* _pixel_buffer;
+    // Pixel data buffers. _pixel_buffer is the back buffer that is drawn
+    // into; with more than one buffer the others hold the frame on the wire
+    // (front) and a presented frame waiting for it to finish (pending).
+    // With packed pixels the buffers hold 3 bytes per pixel in wire order
+    // and are only accessed through read_pixel() and write_pixel().
+    Pixel* _pixel_buffer;
+    Pixel* _buffers[WS2812_MAX_FRAME_BUFFERS];
+    uint _num_buffers;
+    uint _back_index;
+    volatile int _front_index;
+    volatile int _pending_index;
+
+    // Dirty tracking. Pixels at and above _dirty_end in the back buffer
+    // match what the LEDs show once the submitted frames are out, so only
+    // the prefix up to it is sent. _frame_length is the number of pixels
+    // sent for each submitted buffer.
+    uint _dirty_end;
+    uint _frame_length[WS2812_MAX_FRAME_BUFFERS];
     volatile Status _status;
     bool _initialized;
+    bool _packed;
+    bool _extract_white;            // RGBW with Config::extract_white
+
+    // Output stage. Brightness and gamma are applied through one fused
+    // per-channel table while a frame is encoded for the wire, so the pixel
+    // buffers keep the colors as drawn. With the identity table and 8-bit
+    // channels the pixel buffers are sent as they are; otherwise each frame
+    // buffer has an encoded copy in _encoded_block.
+    uint8_t _brightness;
+    float _gamma;
+    uint16_t _gamma_table[256];     // Gamma curve, 8.8 fixed point
+    uint8_t _output_table[256];
+    uint16_t _output_table16[256];  // Output table in 8.8 fixed point, for dithering
+    bool _output_identity;
+    bool _output_linear;            // No gamma: the output table is PixelMath::scale8()
+    const uint16_t* _pixel_map;     // Pixel buffer index for each pixel on the wire
+    bool _dithering;
+    uint _dither_frame;
+    uint8_t* _encoded_block;
+    void* _wire_buffers[WS2812_MAX_FRAME_BUFFERS];  // Data sent for each frame buffer
+
+    // Continuous refresh. Frames are encoded alternately into the two
+    // halves of _refresh_block: one is on the wire while the other is
+    // prepared for the next frame.
+    volatile bool _continuous;
+    uint8_t* _refresh_block;
+    uint _refresh_index;            // Half holding the prepared frame
     
+    // Streaming mode. There are no frame buffers: the producer renders
+    // each frame chunk by chunk into a ring of WS2812_STREAM_CHUNKS buffers.
+    // Two DMA channels chained to each other take turns sending the chunks,
+    // so the next one starts without a gap while the interrupt of the
+    // finished one renders a chunk further ahead.
+    uint32_t* _stream_block;
+    uint _stream_chunk_pixels;
+    uint _stream_chunks;            // Chunks in the frame being sent
+    volatile uint _stream_sent;     // Chunks of it sent so far
+    StreamCallback _stream_producer;
+    void* _stream_user_data;
+    bool _stream_encode;            // Apply the output table to each chunk
+    uint _stream_dither_frame;
+
     // DMA configuration
     int _dma_channel;
+    int _stream_dma_channel;        // Second channel in streaming mode
     bool _dma_available;
+
+    // Alarm that ends the reset time after a DMA transfer (0 = none)
+    volatile alarm_id_t _latch_alarm;
     
     // Statistics
-    uint32_t _update_count;
+    volatile uint32_t _update_count;
     uint32_t _error_count;
     
-    // PIO program for WS2812
-    static const uint16_t ws2812_program_instructions[];
-    static const struct pio_program ws2812_program;
-    
     // Internal methods
     bool init_pio();
     bool init_dma();
     void cleanup_pio();
     void cleanup_dma();
     uint32_t convert_color(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+    Pixel to_pixel(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+    uint bits_per_entry() const;
+    void pixel_to_color(Pixel pixel, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const;
+    template <ColorFormat F>
+    static Pixel data_to_pixel(const uint8_t* data);
+    template <ColorFormat F>
+    static void pixel_to_data(Pixel pixel, uint8_t* data);
+    template <ColorFormat F>
+    uint set_pixel_data(const uint8_t* data, uint length, uint start_index);
+    template <ColorFormat F>
+    void get_pixel_data(uint8_t* data, uint length, uint start_index) const;
+    template <ColorFormat F>
+    uint set_pixel_rgb(const uint8_t* data, uint length, uint start_index);
+    Pixel read_pixel(uint index) const;
+    void write_pixel(uint index, Pixel pixel);
+    template <typename Op>
+    void apply_pixels(Pixel color, Op op);
+    uint pixel_bytes() const { return _packed ? 3 : sizeof(Pixel); }
+    uint wire_bytes() const { return _packed ? 3 : sizeof(uint32_t); }
+    bool set_output_curve(uint8_t brightness, float gamma);
+    bool alloc_encoded_block();
+    void mark_dirty(uint end) { if (end > _dirty_end) _dirty_end = end; }
+    uint dirty_length() const;
+    void* encode_frame(uint index, uint length);
+    void encode_into(const Pixel* pixels, uint count, void* out);
+    void encode_block(const Pixel* pixels, uint count, uint frame, void* out);
+    const Pixel* content_buffer() const;
+    void refresh_next();
+    void start_transfer(const void* frame, uint length);
+    bool init_stream();
+    uint32_t* stream_chunk(uint chunk) const;
+    uint stream_channel(uint chunk) const;
+    void render_chunk(uint chunk);
+    void arm_chunk(uint chunk, bool trigger);
+    void stream_chunk_complete();
+    void start_latch();
+    void transmit_blocking(const void* buffer, uint length);
+    void* next_frame(uint& length);
+    uint32_t latch_delay_us() const;
+    void latch_complete();
     void dma_complete_handler();
-    static void dma_irq_handler();
-    
-    // Static instance for DMA interrupt
-    static WS2812Driver* _instance;
+    static void dma_complete_callback(uint channel, void* user_data);
+    static int64_t latch_alarm_callback(alarm_id_t id, void* user_data);
+
+    // Set by WS2812Group: start_transfer() only arms the DMA channel and
+    // the group starts all armed channels at once
+    bool _hold_start;
+    bool _armed;
+    friend class WS2812Group;
 
 public:
     /**
@@ -114,6 +249,27 @@ public:
      */
     bool getPixelColor(uint index, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w);
 
+    /**
+     * @brief Set color for specific pixel with 16 bits per channel
+     *
+     * Keeps the full precision with WS2812_CHANNEL_BITS 16; otherwise the
+     * values are rounded to 8 bits.
+     *
+     * @param index Pixel index (0-based)
+     * @param r Red value (0-65535)
+     * @param g Green value (0-65535)
+     * @param b Blue value (0-65535)
+     * @param w White value (0-65535, only for RGBW format)
+     * @return true if successful
+     */
+    bool setPixelColor16(uint index, uint16_t r, uint16_t g, uint16_t b, uint16_t w = 0);
+
+    /**
+     * @brief Get color of specific pixel with 16 bits per channel
+     * @return true if successful
+     */
+    bool getPixelColor16(uint index, uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& w);
+
     /**
      * @brief Set all pixels to the same color
      * @param r Red value (0-255)
@@ -128,17 +284,126 @@ public:
      */
     void clear();
 
+    /**
+     * @brief Scale every pixel in the buffer (see PixelMath::scale8)
+     *
+     * Unlike setBrightness() this changes the pixel colors, for effects
+     * such as trails.
+     *
+     * @param scale Scale factor (255 = unchanged, 0 = black)
+     */
+    void scalePixels(uint8_t scale);
+
+    /**
+     * @brief Fade every pixel in the buffer towards black
+     * @param amount Fraction removed (0 = unchanged, 255 = black)
+     */
+    void fadeToBlackBy(uint8_t amount) { scalePixels((uint8_t)(255 - amount)); }
+
+    /**
+     * @brief Add a color to every pixel, clamping each channel at full
+     */
+    void addColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+
+    /**
+     * @brief Blend every pixel towards a color
+     * @param amount Blend position (0 = unchanged, 255 = the color)
+     */
+    void blendColor(uint8_t amount, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+
     /**
      * @brief Update LED strip/panel with current buffer
+     *
+     * With double/triple buffering this presents the back buffer (see
+     * present()) instead of failing while a frame is on the wire.
+     *
+     * Only the pixels up to the last one that changed since the previous
+     * frame are sent; LEDs further down the chain keep their colors. If no
+     * pixel changed, nothing is sent and true is returned.
+     *
      * @param blocking If true, wait for update to complete
      * @return true if update started successfully
      */
     bool update(bool blocking = false);
 
     /**
-     * @brief Check if update is in progress
+     * @brief Queue the back buffer for transmission and swap in a new one
+     *
+     * Only for double/triple buffering (num_buffers >= 2); with a single
+     * buffer this is the same as update(false). If the line is idle the
+     * frame is sent right away, otherwise it is sent when the current frame
+     * has latched. With triple buffering a frame that is still waiting is
+     * replaced by the newer one, so present() never has to wait; with
+     * double buffering it fails while a frame is on the wire.
+     *
+     * Safe to call from interrupt context. Without DMA the frame is sent
+     * before present() returns.
+     *
+     * @param preserve_contents Copy the presented frame into the new back
+     *        buffer so drawing can continue incrementally
+     * @return true if the frame was accepted
      */
-    bool isBusy() const { return _status == Status::UPDATING; }
+    bool present(bool preserve_contents = true);
+
+    /**
+     * @brief Keep resending the current frame as fast as the line allows
+     *
+     * Requires DMA. Each frame is encoded through the output stage again,
+     * so temporal dithering (see setDithering()) advances with every
+     * refresh. The next frame is encoded in the latch interrupt while the
+     * previous one is on the wire. update()/present() only change the
+     * content that the refresh loop picks up. With a single buffer, the loop
+     * sends the pixel buffer as it is being drawn; use num_buffers >= 2 for
+     * tear-free content.
+     *
+     * @return true if the refresh loop is running
+     */
+    bool startContinuousRefresh();
+
+    /**
+     * @brief Stop the refresh loop after the frame on the wire
+     *
+     * Returns immediately; waitForCompletion() waits for the last frame.
+     */
+    void stopContinuousRefresh();
+
+    /**
+     * @brief Check if continuous refresh is running
+     */
+    bool isContinuousRefresh() const { return _continuous; }
+
+    /**
+     * @brief Send one frame rendered chunk by chunk by a producer
+     *
+     * Streaming mode only (Config::stream_chunk_pixels > 0). The driver has
+     * no frame buffers, so the strip can be longer than MAX_LED_COUNT and
+     * only WS2812_STREAM_CHUNKS chunks are kept in RAM. The first chunks are
+     * rendered before this returns, the rest from the DMA interrupt while
+     * earlier chunks are sent. Brightness, gamma and dithering apply to the
+     * rendered chunks. If the producer falls behind, the frame is cut short
+     * and an error is counted in getStatistics().
+     *
+     * @param producer Renders the pixels of each chunk
+     * @param user_data Passed to the producer
+     * @param blocking If true, wait for the frame to latch
+     * @return false if not in streaming mode or a frame is being sent
+     */
+    bool streamFrame(StreamCallback producer, void* user_data = nullptr, bool blocking = false);
+
+    /**
+     * @brief Check if the driver runs in streaming mode
+     */
+    bool isStreaming() const { return _stream_block != nullptr; }
+
+    /**
+     * @brief Check if frames are sent by DMA
+     */
+    bool isDMAEnabled() const { return _dma_available; }
+
+    /**
+     * @brief Check if update is in progress (data or reset time)
+     */
+    bool isBusy() const { return _status == Status::UPDATING || _status == Status::LATCHING; }
 
     /**
      * @brief Wait for current update to complete
@@ -155,11 +420,77 @@ public:
      */
     bool setPixelData(const uint8_t* data, uint length, uint start_index = 0);
 
+    /**
+     * @brief Copy pixels out of the pixel buffer as raw data
+     *
+     * The inverse of setPixelData(), in the same byte order.
+     *
+     * @param data Output, channelCount() bytes per pixel
+     * @param length Number of pixels to copy
+     * @param start_index Starting pixel index
+     */
+    bool getPixelData(uint8_t* data, uint length, uint start_index = 0) const;
+
+    /**
+     * @brief Set pixel buffer from RGB data, whatever the color format
+     *
+     * For RGB content such as DMX input. With RGBW and
+     * Config::extract_white the white channel is extracted on the way in
+     * (see extractWhite), otherwise white is 0.
+     *
+     * @param data 3 bytes per pixel: R, G, B
+     * @param length Number of pixels to copy
+     * @param start_index Starting pixel index
+     */
+    bool setPixelDataRGB(const uint8_t* data, uint length, uint start_index = 0);
+
     /**
      * @brief Get direct access to pixel buffer
-     * @return Pointer to pixel buffer (uint32_t per pixel)
+     *
+     * Writes through the pointer cannot be tracked, so this marks the whole
+     * frame as changed. Code that keeps the pointer across frames has to
+     * call markDirty() for what it changes.
+     *
+     * @return Pointer to the back buffer (one Pixel per pixel, see
+     *         colorToNative and packColor16). Changes with every present().
+     *         nullptr with packed pixels, see getPackedBuffer().
+     */
+    Pixel* getPixelBuffer() {
+        mark_dirty(_config.num_pixels);
+        return _packed ? nullptr : _pixel_buffer;
+    }
+
+    /**
+     * @brief Get direct access to a packed pixel buffer
+     *
+     * Marks the whole frame as changed like getPixelBuffer().
+     *
+     * @return Pointer to the back buffer, 3 bytes per pixel in the order
+     *         they are sent (G, R, B for GRB), or nullptr without packed
+     *         pixels. Changes with every present().
+     */
+    uint8_t* getPackedBuffer() {
+        mark_dirty(_config.num_pixels);
+        return _packed ? (uint8_t*)_pixel_buffer : nullptr;
+    }
+
+    /**
+     * @brief Check if the pixel buffers store 3 bytes per pixel
      */
-    uint32_t* getPixelBuffer() { return _pixel_buffer; }
+    bool isPacked() const { return _packed; }
+
+    /**
+     * @brief Mark pixels as changed so the next frame includes them
+     * @param start_index First changed pixel
+     * @param count Number of changed pixels
+     */
+    void markDirty(uint start_index, uint count = 1);
+
+    /**
+     * @brief Get the number of pixels the next frame will send
+     * @return 0 if no pixel changed since the previous frame
+     */
+    uint getDirtyLength() const { return dirty_length(); }
 
     /**
      * @brief Get number of pixels
@@ -204,10 +535,204 @@ public:
      * @param g Green value  
      * @param b Blue value
      * @param w White value (for RGBW)
-     * @return 32-bit color value in native format
+     * @return 32-bit color value in native format. Colors are MSB-aligned in
+     *         wire order, e.g. 0xGGRRBB00 for GRB and 0xGGRRBBWW for RGBW,
+     *         as the PIO shifts them out
      */
     uint32_t colorToNative(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
 
+    /**
+     * @brief Pack RGB(W) values into the native format of a color format
+     *
+     * Shared with the other WS2812 output drivers so every driver puts the
+     * same bits on the wire for a given format.
+     */
+    static uint32_t packColor(ColorFormat format, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+
+    /**
+     * @brief Unpack a native color value of a color format
+     */
+    static void unpackColor(ColorFormat format, uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w);
+
+    /**
+     * @brief Pack 16-bit RGB(W) values like packColor, with 16-bit lanes
+     * @return Pixel value for WS2812_CHANNEL_BITS 16, e.g.
+     *         0xGGGGRRRRBBBB0000 for GRB
+     */
+    static uint64_t packColor16(ColorFormat format, uint16_t r, uint16_t g, uint16_t b, uint16_t w = 0);
+
+    /**
+     * @brief Unpack a 16-bit pixel value of a color format
+     */
+    static void unpackColor16(ColorFormat format, uint64_t color, uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& w);
+
+    // Color format kernels specialized at compile time. The functions taking
+    // a ColorFormat argument dispatch to these, and buffer operations
+    // dispatch once per call instead of once per pixel.
+
+    /**
+     * @brief Bytes per pixel of raw pixel data (see setPixelData())
+     */
+    template <ColorFormat F>
+    static constexpr uint channelCount() { return (F == ColorFormat::RGBW) ? 4 : 3; }
+
+    /**
+     * @brief packColor for a color format known at compile time
+     */
+    template <ColorFormat F>
+    static constexpr uint32_t packColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+        if constexpr (F == ColorFormat::GRB) {
+            return ((uint32_t)g << 24) | ((uint32_t)r << 16) | ((uint32_t)b << 8);  // WS2812 native format
+        } else if constexpr (F == ColorFormat::RGBW) {
+            return ((uint32_t)g << 24) | ((uint32_t)r << 16) | ((uint32_t)b << 8) | w;  // SK6812 native format
+        } else {
+            return ((uint32_t)r << 24) | ((uint32_t)g << 16) | ((uint32_t)b << 8);
+        }
+    }
+
+    /**
+     * @brief unpackColor for a color format known at compile time
+     */
+    template <ColorFormat F>
+    static constexpr void unpackColor(uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) {
+        if constexpr (F == ColorFormat::RGBW) {
+            g = (color >> 24) & 0xFF;
+            r = (color >> 16) & 0xFF;
+            b = (color >> 8) & 0xFF;
+            w = color & 0xFF;
+        } else {
+            uint8_t first = (color >> 24) & 0xFF;
+            uint8_t second = (color >> 16) & 0xFF;
+            r = (F == ColorFormat::GRB) ? second : first;
+            g = (F == ColorFormat::GRB) ? first : second;
+            b = (color >> 8) & 0xFF;
+            w = 0;
+        }
+    }
+
+    /**
+     * @brief packColor16 for a color format known at compile time
+     */
+    template <ColorFormat F>
+    static constexpr uint64_t packColor16(uint16_t r, uint16_t g, uint16_t b, uint16_t w = 0) {
+        if constexpr (F == ColorFormat::GRB) {
+            return ((uint64_t)g << 48) | ((uint64_t)r << 32) | ((uint64_t)b << 16);
+        } else if constexpr (F == ColorFormat::RGBW) {
+            return ((uint64_t)g << 48) | ((uint64_t)r << 32) | ((uint64_t)b << 16) | w;
+        } else {
+            return ((uint64_t)r << 48) | ((uint64_t)g << 32) | ((uint64_t)b << 16);
+        }
+    }
+
+    /**
+     * @brief unpackColor16 for a color format known at compile time
+     */
+    template <ColorFormat F>
+    static constexpr void unpackColor16(uint64_t color, uint16_t& r, uint16_t& g, uint16_t& b, uint16_t& w) {
+        if constexpr (F == ColorFormat::RGBW) {
+            g = (color >> 48) & 0xFFFF;
+            r = (color >> 32) & 0xFFFF;
+            b = (color >> 16) & 0xFFFF;
+            w = color & 0xFFFF;
+        } else {
+            uint16_t first = (color >> 48) & 0xFFFF;
+            uint16_t second = (color >> 32) & 0xFFFF;
+            r = (F == ColorFormat::GRB) ? second : first;
+            g = (F == ColorFormat::GRB) ? first : second;
+            b = (color >> 16) & 0xFFFF;
+            w = 0;
+        }
+    }
+
+    /**
+     * @brief Native color of one pixel of raw pixel data
+     */
+    template <ColorFormat F>
+    static constexpr uint32_t packData(const uint8_t* data) {
+        if constexpr (F == ColorFormat::GRB) {
+            return packColor<F>(data[1], data[0], data[2]);
+        } else if constexpr (F == ColorFormat::RGBW) {
+            return packColor<F>(data[0], data[1], data[2], data[3]);
+        } else {
+            return packColor<F>(data[0], data[1], data[2]);
+        }
+    }
+
+    /**
+     * @brief Raw pixel data of one native color
+     */
+    template <ColorFormat F>
+    static constexpr void unpackData(uint32_t color, uint8_t* data) {
+        uint8_t r = 0, g = 0, b = 0, w = 0;
+        unpackColor<F>(color, r, g, b, w);
+        data[0] = (F == ColorFormat::GRB) ? g : r;
+        data[1] = (F == ColorFormat::GRB) ? r : g;
+        data[2] = b;
+        if constexpr (F == ColorFormat::RGBW) {
+            data[3] = w;
+        }
+    }
+
+    /**
+     * @brief Convert raw pixel data to native colors
+     * @param data channelCount<F>() bytes per pixel, as for setPixelData()
+     * @param count Number of pixels
+     * @param out Native color values
+     */
+    template <ColorFormat F>
+    static void packPixels(const uint8_t* data, uint count, uint32_t* out) {
+        for (uint i = 0; i < count; i++) {
+            out[i] = packData<F>(data + i * channelCount<F>());
+        }
+    }
+
+    /**
+     * @brief Convert native colors to raw pixel data
+     * @param pixels Native color values
+     * @param count Number of pixels
+     * @param data Output, channelCount<F>() bytes per pixel
+     */
+    template <ColorFormat F>
+    static void unpackPixels(const uint32_t* pixels, uint count, uint8_t* data) {
+        for (uint i = 0; i < count; i++) {
+            unpackData<F>(pixels[i], data + i * channelCount<F>());
+        }
+    }
+
+    /**
+     * @brief RGBW native color of an RGB color with the white extracted
+     *
+     * The part all three channels share, min(r, g, b), is moved to the
+     * white LED and taken off the colors. The mix stays the same hue while
+     * white content uses the more efficient white LED.
+     */
+    static constexpr uint32_t extractWhite(uint8_t r, uint8_t g, uint8_t b) {
+        uint8_t w = (r < g) ? r : g;
+        w = (b < w) ? b : w;
+        return packColor<ColorFormat::RGBW>(r, g, b, 0) - w * 0x01010100u + w;
+    }
+
+    /**
+     * @brief extractWhite with 16-bit channels (see packColor16)
+     */
+    static constexpr uint64_t extractWhite16(uint16_t r, uint16_t g, uint16_t b) {
+        uint16_t w = (r < g) ? r : g;
+        w = (b < w) ? b : w;
+        return packColor16<ColorFormat::RGBW>(r, g, b, 0) - w * 0x0001000100010000ull + w;
+    }
+
+    /**
+     * @brief Convert RGB data to RGBW native colors with the white extracted
+     * @param data 3 bytes per pixel: R, G, B
+     * @param count Number of pixels
+     * @param out RGBW native color values
+     */
+    static void extractWhitePixels(const uint8_t* data, uint count, uint32_t* out) {
+        for (uint i = 0; i < count; i++) {
+            out[i] = extractWhite(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
+        }
+    }
+
     /**
      * @brief Convert native format to RGB values
      * @param color 32-bit native color value
@@ -216,19 +741,200 @@ public:
      * @param b Output blue value
      * @param w Output white value
      */
-    void nativeToColor(uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w);
+    void nativeToColor(uint32_t color, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const;
+
+    /**
+     * @brief Change the bit timing (see LEDTimings)
+     *
+     * Rebuilds the PIO program and clock divider for the current clk_sys.
+     * Fails while a frame is being sent, in continuous refresh, or if the
+     * timing cannot be produced; the previous timing stays in effect then.
+     *
+     * @param timing Bit timing, copied
+     * @return true if the new timing is in effect
+     */
+    bool setTiming(const LEDTiming& timing);
+
+    /**
+     * @brief Get the bit timing
+     */
+    const LEDTiming& getTiming() const { return _timing; }
+
+    /**
+     * @brief Get the state machine cycles and divider built for the timing
+     */
+    const LEDBitCycles& getBitCycles() const { return _bit_cycles; }
+
+    /**
+     * @brief Set the global output brightness (0-255)
+     *
+     * Applied while frames are encoded for the wire; the pixel buffers are
+     * not modified, so the brightness can be changed freely without losing
+     * color precision. Takes effect from the next update()/present() and
+     * costs one 256-entry table rebuild.
+     *
+     * @param brightness Global brightness multiplier (255 = full)
+     * @return false if the encoded output buffers could not be allocated
+     */
+    bool setBrightness(uint8_t brightness);
+
+    /**
+     * @brief Get the global output brightness
+     */
+    uint8_t getBrightness() const { return _brightness; }
+
+    /**
+     * @brief Set the output gamma correction
+     *
+     * Applied together with the brightness while frames are encoded; the
+     * pixel buffers are not modified. The gamma curve is only recomputed
+     * when the value changes.
+     *
+     * @param gamma Gamma value (typically 2.2, 1.0 = off)
+     * @return false if the encoded output buffers could not be allocated
+     */
+    bool setGamma(float gamma);
 
     /**
-     * @brief Set brightness for all pixels (0-255)
-     * @param brightness Global brightness multiplier
+     * @brief Get the output gamma
      */
-    void setBrightness(uint8_t brightness);
+    float getGamma() const { return _gamma; }
 
     /**
-     * @brief Apply gamma correction to pixel buffer
+     * @brief Apply gamma correction to the output (same as setGamma)
      * @param gamma Gamma value (typically 2.2)
      */
-    void applyGammaCorrection(float gamma = 2.2f);
+    bool applyGammaCorrection(float gamma = 2.2f) { return setGamma(gamma); }
+
+    /**
+     * @brief Enable temporal dithering in the output stage
+     *
+     * The output table keeps 8 fractional bits per channel. With dithering,
+     * successive frames alternate between the two nearest 8-bit values so
+     * that their average matches the fractional level. This smooths fades
+     * at low brightness. It needs a refresh rate well above the content
+     * frame rate (see startContinuousRefresh()). It has no effect while
+     * brightness and gamma are the identity.
+     *
+     * @param enable true to dither
+     */
+    void setDithering(bool enable) {
+        _dithering = enable;
+        mark_dirty(_config.num_pixels);
+    }
+
+    /**
+     * @brief Send the pixels in wiring order
+     *
+     * The pixel buffer stays in drawing order (for a panel, row-major XY as
+     * used by setPixelColorXY()). When a frame is encoded, pixel i on the
+     * wire is taken from pixel buffer entry map[i], so serpentine, rotated
+     * and tiled panels cost nothing per pixel drawn. Build the table with
+     * PixelMap. With a map every changed frame is sent in full. Not
+     * available in streaming mode.
+     *
+     * @param map num_pixels entries, not copied and kept in use until
+     *        replaced (nullptr = send in buffer order)
+     * @return false if an entry is out of range or the encoded copies cannot
+     *         be allocated
+     */
+    bool setPixelMap(const uint16_t* map);
+
+    /**
+     * @brief Get the pixel map set with setPixelMap()
+     */
+    const uint16_t* getPixelMap() const { return _pixel_map; }
+
+    /**
+     * @brief Check if temporal dithering is enabled
+     */
+    bool isDithering() const { return _dithering; }
+
+    /**
+     * @brief Get the fused brightness and gamma table used for output
+     * @return 256 entries, indexed by channel value
+     */
+    const uint8_t* getOutputTable() const { return _output_table; }
+
+    /**
+     * @brief Get the output table in 8.8 fixed point, as used for dithering
+     * @return 256 entries, indexed by channel value
+     */
+    const uint16_t* getOutputTable16() const { return _output_table16; }
+
+    /**
+     * @brief Map every channel of native color values through a table
+     *
+     * The encoding kernel of the output stage. Works for every color format
+     * since unused channel bits are 0 and table[0] is always 0.
+     *
+     * @param pixels Native color values
+     * @param count Number of pixels
+     * @param table 256-entry per-channel table
+     * @param out Encoded values, may be the same as pixels
+     */
+    static void encodePixels(const uint32_t* pixels, uint count, const uint8_t* table, uint32_t* out);
+
+    /**
+     * @brief Temporal dithering kernel of the output stage
+     *
+     * Maps every channel through an 8.8 fixed point table and adds one of
+     * WS2812_DITHER_PHASES thresholds to the fraction before truncating. The
+     * threshold depends on the frame and the pixel index, so neighboring
+     * pixels do not all step in the same frame. Over WS2812_DITHER_PHASES
+     * frames the average output matches the table value.
+     *
+     * @param pixels Native color values
+     * @param count Number of pixels
+     * @param table 256-entry per-channel table, 8.8 fixed point (max 0xFF00)
+     * @param frame Frame counter selecting the dither phase
+     * @param out Encoded values, may be the same as pixels
+     */
+    static void ditherPixels(const uint32_t* pixels, uint count, const uint16_t* table, uint frame, uint32_t* out);
+
+    /**
+     * @brief Output stage kernel for 16-bit pixels
+     *
+     * Each 16-bit channel becomes an 8.8 level (0xFFFF maps to 0xFF00) and is
+     * mapped through the 8.8 table, interpolating between neighboring
+     * entries. The result is rounded to 8 bits, or dithered like
+     * ditherPixels.
+     *
+     * @param pixels 16-bit pixel values (see packColor16)
+     * @param count Number of pixels
+     * @param table 256-entry per-channel table, 8.8 fixed point (max 0xFF00)
+     * @param dither Dither instead of rounding
+     * @param frame Frame counter selecting the dither phase
+     * @param out Native color values
+     */
+    static void quantizePixels(const uint64_t* pixels, uint count, const uint16_t* table, bool dither,
+                               uint frame, uint32_t* out);
+
+    /**
+     * @brief Output stage kernel for packed pixels
+     *
+     * Same as encodePixels for 3 bytes per pixel.
+     *
+     * @param pixels Packed pixels
+     * @param count Number of pixels
+     * @param table 256-entry per-channel table
+     * @param out Encoded pixels, may be the same as pixels
+     */
+    static void encodePackedPixels(const uint8_t* pixels, uint count, const uint8_t* table, uint8_t* out);
+
+    /**
+     * @brief Temporal dithering kernel for packed pixels
+     *
+     * Same as ditherPixels for 3 bytes per pixel.
+     *
+     * @param pixels Packed pixels
+     * @param count Number of pixels
+     * @param table 256-entry per-channel table, 8.8 fixed point (max 0xFF00)
+     * @param frame Frame counter selecting the dither phase
+     * @param out Encoded pixels, may be the same as pixels
+     */
+    static void ditherPackedPixels(const uint8_t* pixels, uint count, const uint16_t* table, uint frame,
+                                   uint8_t* out);
 
     // Debug methods
     void printStatus() const;
@@ -0,0 +1,140 @@
+#include "ws2812_group.h"
+#include "hardware/sync.h"
+
+WS2812Group::WS2812Group()
+    : _drivers{},
+      _count(0),
+      _update_count(0),
+      _error_count(0) {
+}
+
+bool WS2812Group::add(WS2812Driver* driver) {
+    if (driver == nullptr || _count >= WS2812_MAX_INSTANCES || !driver->isInitialized() ||
+        !driver->isDMAEnabled() || driver->isStreaming()) {
+        return false;
+    }
+    for (uint i = 0; i < _count; i++) {
+        if (_drivers[i] == driver) {
+            return false;
+        }
+    }
+
+    _drivers[_count++] = driver;
+    return true;
+}
+
+void WS2812Group::clear() {
+    _count = 0;
+}
+
+bool WS2812Group::update(bool blocking) {
+    // Frames only start together from idle lines
+    for (uint i = 0; i < _count; i++) {
+        WS2812Driver* driver = _drivers[i];
+        if (!driver->isInitialized() || driver->isContinuousRefresh() || driver->isBusy()) {
+            _error_count++;
+            return false;
+        }
+    }
+
+    // Hold the state machines while the frames are encoded and the DMA
+    // channels armed, so none of them starts on its own
+    uint32_t sm_mask[NUM_PIOS] = {};
+    for (uint i = 0; i < _count; i++) {
+        const WS2812Driver::Config& config = _drivers[i]->getConfig();
+        sm_mask[pio_get_index(config.pio_instance)] |= 1u << config.pio_sm;
+    }
+    for (uint pio = 0; pio < NUM_PIOS; pio++) {
+        if (sm_mask[pio] != 0) {
+            pio_set_sm_mask_enabled(pio_get_instance(pio), sm_mask[pio], false);
+        }
+    }
+
+    uint32_t channel_mask = 0;
+    bool ok = true;
+    for (uint i = 0; i < _count; i++) {
+        WS2812Driver* driver = _drivers[i];
+        driver->_hold_start = true;
+        driver->_armed = false;
+        ok &= driver->update(false);
+        driver->_hold_start = false;
+
+        if (driver->_armed) {
+            channel_mask |= 1u << driver->_dma_channel;
+        }
+    }
+
+    // Start all channels with one write and let them fill the TX FIFOs.
+    // The DMA serves the channels one after the other, so the state
+    // machines only start once every FIFO holds data; enabling them in
+    // sync also restarts their clock dividers, so the first bit of every
+    // strip on one PIO starts in the same cycle.
+    if (channel_mask != 0) {
+        dma_start_channel_mask(channel_mask);
+        for (uint i = 0; i < _count; i++) {
+            WS2812Driver* driver = _drivers[i];
+            const WS2812Driver::Config& config = driver->getConfig();
+            if ((channel_mask & (1u << driver->_dma_channel)) == 0) {
+                continue;
+            }
+            while (!pio_sm_is_tx_fifo_full(config.pio_instance, config.pio_sm) &&
+                   dma_channel_is_busy(driver->_dma_channel)) {
+                tight_loop_contents();
+            }
+        }
+    }
+    // Each PIO has its own enable register, so pio1 starts one store after
+    // pio0, a few clk_sys cycles later (well under one bit); interrupts are
+    // off so nothing can run in between
+    uint32_t irq_state = save_and_disable_interrupts();
+    for (uint pio = 0; pio < NUM_PIOS; pio++) {
+        if (sm_mask[pio] != 0) {
+            pio_enable_sm_mask_in_sync(pio_get_instance(pio), sm_mask[pio]);
+        }
+    }
+    restore_interrupts(irq_state);
+
+    _update_count++;
+    if (!ok) {
+        _error_count++;
+    }
+
+    if (blocking) {
+        waitForCompletion();
+    }
+    return ok;
+}
+
+bool WS2812Group::isBusy() const {
+    for (uint i = 0; i < _count; i++) {
+        if (_drivers[i]->isBusy()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WS2812Group::waitForCompletion(uint32_t timeout_ms) {
+    absolute_time_t start_time = get_absolute_time();
+
+    while (isBusy()) {
+        if (timeout_ms > 0) {
+            if (absolute_time_diff_us(start_time, get_absolute_time()) > (timeout_ms * 1000)) {
+                return false;  // Timeout
+            }
+        }
+        tight_loop_contents();
+    }
+
+    return true;
+}
+
+void WS2812Group::getStatistics(uint32_t& update_count, uint32_t& error_count) const {
+    update_count = _update_count;
+    error_count = _error_count;
+}
+
+void WS2812Group::resetStatistics() {
+    _update_count = 0;
+    _error_count = 0;
+}
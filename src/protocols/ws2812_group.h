@@ -0,0 +1,95 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "ws2812_driver.h"
+#include "../config/picoled_config.h"
+
+/**
+ * @brief Updates several WS2812 drivers so their frames start together
+ *
+ * Each driver keeps its own state machine, DMA channel, pin, length and
+ * timing; up to WS2812_MAX_INSTANCES drivers can run across pio0 and pio1.
+ * update() encodes every driver's frame first, restarts the clock dividers
+ * of their state machines and then starts all DMA channels with a single
+ * write, so strips of the same length and timing on one PIO latch in the
+ * same cycle. Strips on pio1 start a few clk_sys cycles after those on
+ * pio0, since the two PIOs are enabled by back-to-back register writes.
+ * The outputs run in parallel, so pixels per second grow with the number
+ * of drivers.
+ */
+class WS2812Group {
+private:
+    WS2812Driver* _drivers[WS2812_MAX_INSTANCES];
+    uint _count;
+
+    // Statistics
+    uint32_t _update_count;
+    uint32_t _error_count;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    WS2812Group();
+
+    /**
+     * @brief Add a driver to the group
+     *
+     * The driver has to be initialized with DMA, from frame buffers (not
+     * streaming mode).
+     *
+     * @return false if the group is full or the driver cannot be added
+     */
+    bool add(WS2812Driver* driver);
+
+    /**
+     * @brief Remove all drivers from the group
+     */
+    void clear();
+
+    /**
+     * @brief Send the frames of all drivers, starting them together
+     *
+     * Drivers on one PIO start in the same cycle; those on pio1 follow
+     * pio0 by a few clk_sys cycles. Drivers with no changed pixels (see
+     * WS2812Driver::update) send nothing.
+     *
+     * @param blocking If true, wait until every driver has latched
+     * @return false if a driver is still busy or in continuous refresh
+     */
+    bool update(bool blocking = false);
+
+    /**
+     * @brief Check if any driver of the group is sending or latching
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Wait for every driver of the group to latch
+     * @param timeout_ms Maximum time to wait (0 = infinite)
+     * @return true if completed within timeout
+     */
+    bool waitForCompletion(uint32_t timeout_ms = 0);
+
+    /**
+     * @brief Get number of drivers in the group
+     */
+    uint getDriverCount() const { return _count; }
+
+    /**
+     * @brief Get a driver of the group
+     */
+    WS2812Driver* getDriver(uint index) const { return index < _count ? _drivers[index] : nullptr; }
+
+    /**
+     * @brief Get statistics
+     */
+    void getStatistics(uint32_t& update_count, uint32_t& error_count) const;
+
+    /**
+     * @brief Reset statistics
+     */
+    void resetStatistics();
+};
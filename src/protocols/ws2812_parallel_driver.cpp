@@ -0,0 +1,470 @@
+#include "ws2812_parallel_driver.h"
+#include "irq_dispatcher.h"
+#include <cstring>
+#include <cstdio>
+
+// Program delays are at most 31 cycles; T3 includes the one-cycle OUT
+static const uint WS2812_PARALLEL_MAX_PHASE_CYCLES = 32;
+static const uint WS2812_PARALLEL_MIN_T3 = 2;
+static const uint WS2812_PARALLEL_BITS_PER_WORD = 4;    // Four 8-bit planes
+
+WS2812ParallelDriver::WS2812ParallelDriver(const Config& config)
+    : _config(config),
+      _pio_program_offset(0),
+      _timing(config.timing != nullptr ? *config.timing : LEDTimings::WS2812),
+      _bit_cycles{},
+      _program_instructions{},
+      _program{_program_instructions, 4, -1},
+      _pixel_buffer(nullptr),
+      _output_buffer(nullptr),
+      _output_words(0),
+      _status(Status::IDLE),
+      _initialized(false),
+      _dma_channel(-1),
+      _dma_available(false),
+      _latch_alarm(0),
+      _update_count(0),
+      _error_count(0) {
+}
+
+WS2812ParallelDriver::~WS2812ParallelDriver() {
+    if (_initialized) {
+        end();
+    }
+}
+
+bool WS2812ParallelDriver::begin() {
+    if (_initialized) {
+        return true;
+    }
+
+    // Validate configuration
+    if (_config.num_strips == 0 || _config.num_strips > WS2812_PARALLEL_MAX_STRIPS) {
+        return false;
+    }
+    if (_config.pixels_per_strip == 0 || _config.pixels_per_strip > MAX_LED_COUNT) {
+        return false;
+    }
+    if (_config.base_pin + _config.num_strips > NUM_BANK0_GPIOS) {
+        return false;
+    }
+
+    // Allocate pixel and output buffers
+    size_t pixel_buffer_size = _config.num_strips * _config.pixels_per_strip * sizeof(uint32_t);
+    _output_words = _config.pixels_per_strip * 2 * bytes_per_pixel();
+
+    _pixel_buffer = (uint32_t*)malloc(pixel_buffer_size);
+    _output_buffer = (uint32_t*)malloc(_output_words * sizeof(uint32_t));
+    if (_pixel_buffer == nullptr || _output_buffer == nullptr) {
+        free(_pixel_buffer);
+        free(_output_buffer);
+        _pixel_buffer = nullptr;
+        _output_buffer = nullptr;
+        return false;
+    }
+
+    // Initialize buffers to all black
+    memset(_pixel_buffer, 0, pixel_buffer_size);
+    memset(_output_buffer, 0, _output_words * sizeof(uint32_t));
+
+    // Initialize PIO
+    if (!init_pio()) {
+        free(_pixel_buffer);
+        free(_output_buffer);
+        _pixel_buffer = nullptr;
+        _output_buffer = nullptr;
+        return false;
+    }
+
+    // Initialize DMA if requested and available
+    if (_config.use_dma) {
+        _dma_available = init_dma();
+    }
+
+    _initialized = true;
+    _status = Status::IDLE;
+
+    return true;
+}
+
+void WS2812ParallelDriver::end() {
+    if (!_initialized) {
+        return;
+    }
+
+    // Wait for any ongoing updates
+    waitForCompletion(1000);
+    if (_latch_alarm > 0) {
+        cancel_alarm(_latch_alarm);
+        _latch_alarm = 0;
+    }
+
+    // Cleanup resources
+    cleanup_dma();
+    cleanup_pio();
+
+    free(_pixel_buffer);
+    free(_output_buffer);
+    _pixel_buffer = nullptr;
+    _output_buffer = nullptr;
+
+    _initialized = false;
+    _status = Status::IDLE;
+}
+
+bool WS2812ParallelDriver::init_pio() {
+    // Build the program for the bit timing at the current clk_sys. Each OUT
+    // takes one bit plane (one bit for every strip) and drives all data
+    // pins with it:
+    //   out x, 8                     ; low, part of T3
+    //   mov pins, !null  [T1 - 1]    ; high for T1
+    //   mov pins, x      [T2 - 1]    ; data for T2
+    //   mov pins, null   [T3 - 2]    ; low for the rest of T3
+    if (!LEDTimings::synthesize(_timing, clock_get_hz(clk_sys), WS2812_PARALLEL_MAX_PHASE_CYCLES,
+                                WS2812_PARALLEL_MIN_T3, _bit_cycles)) {
+        return false;
+    }
+    _program_instructions[0] = (uint16_t)pio_encode_out(pio_x, 8);
+    _program_instructions[1] = (uint16_t)(pio_encode_mov_not(pio_pins, pio_null) | pio_encode_delay(_bit_cycles.t1 - 1));
+    _program_instructions[2] = (uint16_t)(pio_encode_mov(pio_pins, pio_x) | pio_encode_delay(_bit_cycles.t2 - 1));
+    _program_instructions[3] = (uint16_t)(pio_encode_mov(pio_pins, pio_null) | pio_encode_delay(_bit_cycles.t3 - 2));
+
+    // The state machine must not belong to another driver, and the program
+    // has to fit next to those already loaded on the same PIO
+    uint sm = _config.pio_sm;
+    if (pio_sm_is_claimed(_config.pio_instance, sm) || !pio_can_add_program(_config.pio_instance, &_program)) {
+        return false;
+    }
+    pio_sm_claim(_config.pio_instance, sm);
+
+    // Load PIO program
+    _pio_program_offset = pio_add_program(_config.pio_instance, &_program);
+
+    // Configure state machine
+    pio_sm_config config = pio_get_default_sm_config();
+    sm_config_set_wrap(&config, _pio_program_offset, _pio_program_offset + _program.length - 1);
+    sm_config_set_out_pins(&config, _config.base_pin, _config.num_strips);
+
+    // Four 8-bit planes per word, most significant byte first
+    sm_config_set_out_shift(&config, false, true, 32);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+
+    // Set clock divider for the bit timing
+    sm_config_set_clkdiv_int_frac(&config, _bit_cycles.div_int, _bit_cycles.div_frac);
+
+    // Configure GPIOs
+    for (uint i = 0; i < _config.num_strips; i++) {
+        pio_gpio_init(_config.pio_instance, _config.base_pin + i);
+    }
+    pio_sm_set_consecutive_pindirs(_config.pio_instance, sm, _config.base_pin, _config.num_strips, true);
+
+    // Initialize and start state machine
+    pio_sm_init(_config.pio_instance, sm, _pio_program_offset, &config);
+    pio_sm_set_enabled(_config.pio_instance, sm, true);
+
+    return true;
+}
+
+void WS2812ParallelDriver::cleanup_pio() {
+    uint sm = _config.pio_sm;
+
+    // Stop state machine
+    pio_sm_set_enabled(_config.pio_instance, sm, false);
+
+    // Unclaim state machine
+    pio_sm_unclaim(_config.pio_instance, sm);
+
+    // Remove program
+    pio_remove_program(_config.pio_instance, &_program, _pio_program_offset);
+}
+
+bool WS2812ParallelDriver::init_dma() {
+    // Try to claim a DMA channel
+    _dma_channel = dma_claim_unused_channel(false);
+    if (_dma_channel < 0) {
+        return false;  // No DMA channels available
+    }
+
+    // Configure DMA channel
+    dma_channel_config config = dma_channel_get_default_config(_dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(_config.pio_instance, _config.pio_sm, true));
+
+    // Completion interrupt, on whichever DMA line has fewer channels
+    if (!IRQDispatcher::addDMAHandler(_dma_channel, dma_complete_callback, this)) {
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+        return false;  // Both DMA lines taken by other handlers
+    }
+
+    dma_channel_configure(_dma_channel, &config,
+                         &_config.pio_instance->txf[_config.pio_sm],
+                         _output_buffer,
+                         _output_words,
+                         false);  // Don't start yet
+
+    return true;
+}
+
+void WS2812ParallelDriver::cleanup_dma() {
+    if (_dma_channel >= 0) {
+        dma_channel_abort(_dma_channel);
+        IRQDispatcher::removeDMAHandler(_dma_channel);
+        dma_channel_unclaim(_dma_channel);
+        _dma_channel = -1;
+    }
+    _dma_available = false;
+}
+
+uint WS2812ParallelDriver::bytes_per_pixel() const {
+    return (_config.format == ColorFormat::RGBW) ? 4 : 3;
+}
+
+bool WS2812ParallelDriver::setPixelColor(uint strip, uint index, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (!_initialized || strip >= _config.num_strips || index >= _config.pixels_per_strip) {
+        return false;
+    }
+
+    _pixel_buffer[strip * _config.pixels_per_strip + index] = WS2812Driver::packColor(_config.format, r, g, b, w);
+    return true;
+}
+
+bool WS2812ParallelDriver::getPixelColor(uint strip, uint index, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const {
+    if (!_initialized || strip >= _config.num_strips || index >= _config.pixels_per_strip) {
+        return false;
+    }
+
+    WS2812Driver::unpackColor(_config.format, _pixel_buffer[strip * _config.pixels_per_strip + index], r, g, b, w);
+    return true;
+}
+
+void WS2812ParallelDriver::fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (!_initialized) {
+        return;
+    }
+
+    uint32_t color = WS2812Driver::packColor(_config.format, r, g, b, w);
+    uint total_pixels = _config.num_strips * _config.pixels_per_strip;
+    for (uint i = 0; i < total_pixels; i++) {
+        _pixel_buffer[i] = color;
+    }
+}
+
+void WS2812ParallelDriver::fillStrip(uint strip, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    uint32_t* pixels = getStripBuffer(strip);
+    if (pixels == nullptr) {
+        return;
+    }
+
+    uint32_t color = WS2812Driver::packColor(_config.format, r, g, b, w);
+    for (uint i = 0; i < _config.pixels_per_strip; i++) {
+        pixels[i] = color;
+    }
+}
+
+void WS2812ParallelDriver::clear() {
+    if (!_initialized) {
+        return;
+    }
+
+    memset(_pixel_buffer, 0, _config.num_strips * _config.pixels_per_strip * sizeof(uint32_t));
+}
+
+uint32_t* WS2812ParallelDriver::getStripBuffer(uint strip) {
+    if (!_initialized || strip >= _config.num_strips) {
+        return nullptr;
+    }
+
+    return &_pixel_buffer[strip * _config.pixels_per_strip];
+}
+
+bool WS2812ParallelDriver::update(bool blocking) {
+    if (!_initialized || isBusy()) {
+        return false;
+    }
+
+    _status = Status::UPDATING;
+
+    // The output buffer is not in use while IDLE, so it can be rebuilt here
+    transpose(_pixel_buffer, _config.num_strips, _config.pixels_per_strip, bytes_per_pixel(), _output_buffer);
+
+    if (_dma_available) {
+        // Use DMA for non-blocking transfer
+        dma_channel_set_read_addr(_dma_channel, _output_buffer, true);
+
+        if (blocking) {
+            waitForCompletion();
+        }
+    } else {
+        // Use PIO directly (blocking)
+        for (uint i = 0; i < _output_words; i++) {
+            pio_sm_put_blocking(_config.pio_instance, _config.pio_sm, _output_buffer[i]);
+        }
+
+        // Wait for the FIFO to drain and the WS2812 reset time
+        _status = Status::LATCHING;
+        busy_wait_us(latch_delay_us());
+
+        _status = Status::IDLE;
+        _update_count++;
+    }
+
+    return true;
+}
+
+bool WS2812ParallelDriver::waitForCompletion(uint32_t timeout_ms) {
+    absolute_time_t start_time = get_absolute_time();
+
+    while (isBusy()) {
+        if (timeout_ms > 0) {
+            if (absolute_time_diff_us(start_time, get_absolute_time()) > (timeout_ms * 1000)) {
+                return false;  // Timeout
+            }
+        }
+        tight_loop_contents();
+    }
+
+    return true;
+}
+
+void WS2812ParallelDriver::transposePixel(const uint32_t* pixels, uint stride, uint num_strips,
+                                          uint bytes_per_pixel, uint32_t* out) {
+    uint32_t strip[WS2812_PARALLEL_MAX_STRIPS];
+    for (uint s = 0; s < WS2812_PARALLEL_MAX_STRIPS; s++) {
+        strip[s] = (s < num_strips) ? pixels[s * stride] : 0;
+    }
+
+    for (uint k = 0; k < bytes_per_pixel; k++) {
+        uint shift = 24 - 8 * k;
+
+        // 8x8 bit matrix with strip 7 in the top row, so that after the
+        // transpose strip n is bit n of every plane (Hacker's Delight 7-3)
+        uint32_t x = (((strip[7] >> shift) & 0xFF) << 24) | (((strip[6] >> shift) & 0xFF) << 16) |
+                     (((strip[5] >> shift) & 0xFF) << 8) | ((strip[4] >> shift) & 0xFF);
+        uint32_t y = (((strip[3] >> shift) & 0xFF) << 24) | (((strip[2] >> shift) & 0xFF) << 16) |
+                     (((strip[1] >> shift) & 0xFF) << 8) | ((strip[0] >> shift) & 0xFF);
+        uint32_t t;
+
+        t = (x ^ (x >> 7)) & 0x00AA00AA;
+        x = x ^ t ^ (t << 7);
+        t = (y ^ (y >> 7)) & 0x00AA00AA;
+        y = y ^ t ^ (t << 7);
+
+        t = (x ^ (x >> 14)) & 0x0000CCCC;
+        x = x ^ t ^ (t << 14);
+        t = (y ^ (y >> 14)) & 0x0000CCCC;
+        y = y ^ t ^ (t << 14);
+
+        t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+        y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+
+        // Planes for bits 7-4 of this color byte, then bits 3-0
+        out[2 * k] = t;
+        out[2 * k + 1] = y;
+    }
+}
+
+void WS2812ParallelDriver::transpose(const uint32_t* pixel_buffer, uint num_strips, uint pixels_per_strip,
+                                     uint bytes_per_pixel, uint32_t* out) {
+    uint words_per_pixel = 2 * bytes_per_pixel;
+    for (uint i = 0; i < pixels_per_strip; i++) {
+        transposePixel(&pixel_buffer[i], pixels_per_strip, num_strips, bytes_per_pixel, out);
+        out += words_per_pixel;
+    }
+}
+
+void WS2812ParallelDriver::getStatistics(uint32_t& update_count, uint32_t& error_count) const {
+    update_count = _update_count;
+    error_count = _error_count;
+}
+
+void WS2812ParallelDriver::resetStatistics() {
+    _update_count = 0;
+    _error_count = 0;
+}
+
+void WS2812ParallelDriver::dma_complete_callback(uint channel, void* user_data) {
+    (void)channel;
+    static_cast<WS2812ParallelDriver*>(user_data)->dma_complete_handler();
+}
+
+uint32_t WS2812ParallelDriver::latch_delay_us() const {
+    // Same estimate as WS2812Driver::latch_delay_us, in bit planes
+    uint queued_bits = (pio_sm_get_tx_fifo_level(_config.pio_instance, _config.pio_sm) + 1) *
+                       WS2812_PARALLEL_BITS_PER_WORD + 1;
+    return (queued_bits * _bit_cycles.bit_ns + 999) / 1000 + _timing.reset_us + 1;
+}
+
+void WS2812ParallelDriver::latch_complete() {
+    _status = Status::IDLE;
+    _update_count++;
+}
+
+int64_t WS2812ParallelDriver::latch_alarm_callback(alarm_id_t id, void* user_data) {
+    (void)id;
+    WS2812ParallelDriver* driver = static_cast<WS2812ParallelDriver*>(user_data);
+    driver->_latch_alarm = 0;
+    driver->latch_complete();
+    return 0;
+}
+
+void WS2812ParallelDriver::dma_complete_handler() {
+    // The reset time starts once the FIFO has drained; a timer alarm ends
+    // it (see WS2812Driver::start_latch)
+    _status = Status::LATCHING;
+    uint32_t delay_us = latch_delay_us();
+    alarm_id_t alarm = add_alarm_in_us(delay_us, latch_alarm_callback, this, true);
+    if (alarm > 0) {
+        _latch_alarm = alarm;
+    } else if (alarm < 0) {
+        // No alarm slot free: wait here as a fallback
+        _error_count++;
+        busy_wait_us(delay_us);
+        latch_complete();
+    }
+}
+
+void WS2812ParallelDriver::printStatus() const {
+    printf("WS2812 Parallel Driver Status:\n");
+    printf("  Initialized: %s\n", _initialized ? "Yes" : "No");
+    printf("  GPIO Pins: %u-%u\n", _config.base_pin, _config.base_pin + _config.num_strips - 1);
+    printf("  Timing: %s (T0H %lu ns, T1H %lu ns, bit %lu ns)\n",
+           _timing.name, _bit_cycles.t0h_ns, _bit_cycles.t1h_ns, _bit_cycles.bit_ns);
+    printf("  Strips: %u x %u pixels\n", _config.num_strips, _config.pixels_per_strip);
+    printf("  Format: ");
+
+    switch (_config.format) {
+        case ColorFormat::RGB:
+            printf("RGB\n");
+            break;
+        case ColorFormat::GRB:
+            printf("GRB\n");
+            break;
+        case ColorFormat::RGBW:
+            printf("RGBW\n");
+            break;
+    }
+
+    printf("  DMA Enabled: %s\n", _dma_available ? "Yes" : "No");
+    printf("  Status: ");
+
+    switch (_status) {
+        case Status::IDLE:
+            printf("IDLE\n");
+            break;
+        case Status::UPDATING:
+            printf("UPDATING\n");
+            break;
+        case Status::LATCHING:
+            printf("LATCHING\n");
+            break;
+        case Status::ERROR:
+            printf("ERROR\n");
+            break;
+    }
+
+    printf("  Updates: %lu\n", _update_count);
+    printf("  Errors: %lu\n", _error_count);
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "ws2812_driver.h"
+#include "../config/picoled_config.h"
+
+/**
+ * @brief Parallel WS2812 driver for up to 8 strips from one PIO state machine
+ *
+ * The strips are connected to consecutive GPIOs starting at base_pin. Before
+ * each update the pixel buffer is bit-transposed so that every byte of the
+ * output stream holds the same bit of one pixel for all strips; the state
+ * machine then drives all data pins in the same bit period. The frame time
+ * equals that of a single strip of pixels_per_strip pixels, so 8 strips carry
+ * 8x the pixels at the same frame rate.
+ */
+class WS2812ParallelDriver {
+public:
+    using ColorFormat = WS2812Driver::ColorFormat;
+    using Status = WS2812Driver::Status;
+
+    struct Config {
+        PIO pio_instance;
+        uint pio_sm;
+        uint base_pin;          // Strip n is on base_pin + n
+        uint num_strips;        // 1 to WS2812_PARALLEL_MAX_STRIPS
+        uint pixels_per_strip;
+        ColorFormat format;
+        bool use_dma;
+        const LEDTiming* timing = nullptr;  // Bit timing, copied (nullptr = LEDTimings::WS2812)
+    };
+
+private:
+    // Hardware configuration
+    Config _config;
+    uint _pio_program_offset;
+
+    // Bit timing and the PIO program built for it (see init_pio)
+    LEDTiming _timing;
+    LEDBitCycles _bit_cycles;
+    uint16_t _program_instructions[4];
+    struct pio_program _program;
+
+    // Pixel data, strip after strip (native format, see WS2812Driver::packColor)
+    uint32_t* _pixel_buffer;
+
+    // Bit-transposed output stream sent to the state machine
+    uint32_t* _output_buffer;
+    uint _output_words;
+
+    volatile Status _status;
+    bool _initialized;
+
+    // DMA configuration
+    int _dma_channel;
+    bool _dma_available;
+
+    // Alarm that ends the reset time after a DMA transfer (0 = none)
+    volatile alarm_id_t _latch_alarm;
+
+    // Statistics
+    uint32_t _update_count;
+    uint32_t _error_count;
+
+    // Internal methods
+    bool init_pio();
+    bool init_dma();
+    void cleanup_pio();
+    void cleanup_dma();
+    uint bytes_per_pixel() const;
+    uint32_t latch_delay_us() const;
+    void latch_complete();
+    void dma_complete_handler();
+    static void dma_complete_callback(uint channel, void* user_data);
+    static int64_t latch_alarm_callback(alarm_id_t id, void* user_data);
+
+public:
+    /**
+     * @brief Constructor
+     * @param config Driver configuration
+     */
+    WS2812ParallelDriver(const Config& config);
+
+    /**
+     * @brief Destructor
+     */
+    ~WS2812ParallelDriver();
+
+    /**
+     * @brief Initialize the parallel driver
+     * @return true if initialization successful
+     */
+    bool begin();
+
+    /**
+     * @brief Shutdown the driver
+     */
+    void end();
+
+    /**
+     * @brief Set color for a pixel on one strip
+     * @param strip Strip index (0-based, relative to base_pin)
+     * @param index Pixel index within the strip
+     * @param r Red value (0-255)
+     * @param g Green value (0-255)
+     * @param b Blue value (0-255)
+     * @param w White value (0-255, only for RGBW format)
+     * @return true if successful
+     */
+    bool setPixelColor(uint strip, uint index, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+
+    /**
+     * @brief Get color of a pixel on one strip
+     * @return true if successful
+     */
+    bool getPixelColor(uint strip, uint index, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const;
+
+    /**
+     * @brief Set all pixels of all strips to the same color
+     */
+    void fill(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+
+    /**
+     * @brief Set all pixels of one strip to the same color
+     */
+    void fillStrip(uint strip, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0);
+
+    /**
+     * @brief Clear all pixels (set to black)
+     */
+    void clear();
+
+    /**
+     * @brief Transpose the pixel buffer and send it to all strips
+     * @param blocking If true, wait for update to complete
+     * @return true if update started successfully
+     */
+    bool update(bool blocking = false);
+
+    /**
+     * @brief Check if update is in progress (data or reset time)
+     */
+    bool isBusy() const { return _status == Status::UPDATING || _status == Status::LATCHING; }
+
+    /**
+     * @brief Wait for current update to complete
+     * @param timeout_ms Maximum time to wait (0 = infinite)
+     * @return true if completed within timeout
+     */
+    bool waitForCompletion(uint32_t timeout_ms = 0);
+
+    /**
+     * @brief Get direct access to the pixels of one strip
+     * @return Pointer to pixels_per_strip native color values, or nullptr
+     */
+    uint32_t* getStripBuffer(uint strip);
+
+    /**
+     * @brief Get number of strips
+     */
+    uint getStripCount() const { return _config.num_strips; }
+
+    /**
+     * @brief Get number of pixels per strip
+     */
+    uint getPixelsPerStrip() const { return _config.pixels_per_strip; }
+
+    /**
+     * @brief Check if driver is initialized
+     */
+    bool isInitialized() const { return _initialized; }
+
+    /**
+     * @brief Get current status
+     */
+    Status getStatus() const { return _status; }
+
+    /**
+     * @brief Get driver configuration
+     */
+    const Config& getConfig() const { return _config; }
+
+    /**
+     * @brief Get statistics
+     * @param update_count Total updates performed
+     * @param error_count Total errors encountered
+     */
+    void getStatistics(uint32_t& update_count, uint32_t& error_count) const;
+
+    /**
+     * @brief Reset statistics
+     */
+    void resetStatistics();
+
+    // Debug methods
+    void printStatus() const;
+
+    /**
+     * @brief Bit-transpose one pixel of up to 8 strips into output words
+     *
+     * For each of the bytes_per_pixel color bytes (most significant first)
+     * two words are written. Each byte of those words, most significant byte
+     * first, is one bit plane: bit n is the bit of strip n, and the planes
+     * run from the color byte's MSB to its LSB. Strips at or above
+     * num_strips are sent as 0.
+     *
+     * @param pixels Native color of the pixel on strip 0
+     * @param stride Distance in words between the same pixel on adjacent strips
+     * @param num_strips Number of strips (1-8)
+     * @param bytes_per_pixel 3 for RGB/GRB, 4 for RGBW
+     * @param out Output, 2 * bytes_per_pixel words
+     */
+    static void transposePixel(const uint32_t* pixels, uint stride, uint num_strips,
+                               uint bytes_per_pixel, uint32_t* out);
+
+    /**
+     * @brief Bit-transpose a strip-major pixel buffer into an output stream
+     * @param pixel_buffer num_strips * pixels_per_strip native colors
+     * @param num_strips Number of strips (1-8)
+     * @param pixels_per_strip Pixels on each strip
+     * @param bytes_per_pixel 3 for RGB/GRB, 4 for RGBW
+     * @param out Output, pixels_per_strip * 2 * bytes_per_pixel words
+     */
+    static void transpose(const uint32_t* pixel_buffer, uint num_strips, uint pixels_per_strip,
+                          uint bytes_per_pixel, uint32_t* out);
+};